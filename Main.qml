@@ -100,6 +100,8 @@ ApplicationWindow {
                         ListElement { name: qsTr("变量接口"); icon: "🏷️️" }
                         ListElement { name: qsTr("IO和寄存器"); icon: "🏷️️" }
                         ListElement { name: qsTr("串口通信"); icon: "🔌️" }
+                        ListElement { name: qsTr("诊断指标"); icon: "📈" }
+                        ListElement { name: qsTr("日志检索"); icon: "🔎" }
                         ListElement { name: qsTr("用户手册"); icon: "📖" }
                     }
 
@@ -196,7 +198,15 @@ ApplicationWindow {
                 PageSerial {
                 }
 
-                // index 6: 使用手册管理页
+                // index 6: 诊断指标页
+                PageDiagnostics {
+                }
+
+                // index 7: 日志检索页
+                PageLogSearch {
+                }
+
+                // index 8: 使用手册管理页
                 PageUserManual {
                 }
             }
@@ -206,6 +216,79 @@ ApplicationWindow {
     // ---------------------------------------------------------
     // 底部状态栏 (Footer) - 扁平化风格
     // ---------------------------------------------------------
+    // ---------------------------------------------------------
+    // GUI 卡顿诊断浮层 (在“诊断指标”页打开)
+    // ---------------------------------------------------------
+    Rectangle {
+        id: watchdogOverlay
+        visible: WatchdogGlobal.overlayVisible
+        z: 100
+        anchors.top: parent.top
+        anchors.right: parent.right
+        anchors.margins: 12
+        width: 380
+        height: overlayColumn.implicitHeight + 16
+        radius: 8
+        color: "#dd111827"
+
+        property var stats: ({})
+        property var hotspots: []
+
+        Timer {
+            interval: 500
+            repeat: true
+            triggeredOnStart: true
+            running: watchdogOverlay.visible
+            onTriggered: {
+                watchdogOverlay.stats = WatchdogGlobal.stats()
+                watchdogOverlay.hotspots = WatchdogGlobal.hotspots(5)
+            }
+        }
+
+        ColumnLayout {
+            id: overlayColumn
+            anchors.fill: parent
+            anchors.margins: 8
+            spacing: 2
+
+            Text {
+                color: "#f9fafb"
+                font.family: "Consolas"
+                font.pixelSize: 12
+                text: {
+                    var s = watchdogOverlay.stats
+                    if (s.latencyP50Ms === undefined) return ""
+                    return "事件循环 p50 " + s.latencyP50Ms.toFixed(1) + " / p99 " + s.latencyP99Ms.toFixed(1)
+                           + " / 最大 " + s.latencyMaxMs.toFixed(0) + " ms"
+                }
+            }
+            Text {
+                Layout.fillWidth: true
+                elide: Text.ElideRight
+                color: WatchdogGlobal.stallCount > 0 ? "#fca5a5" : "#9ca3af"
+                font.family: "Consolas"
+                font.pixelSize: 12
+                text: {
+                    var e = WatchdogGlobal.lastStall
+                    var head = "卡顿 " + WatchdogGlobal.stallCount + " 次 (>" + WatchdogGlobal.stallThresholdMs + " ms)"
+                    if (e.time === undefined) return head
+                    return head + "  最近 " + e.durationMs.toFixed(0) + " ms: " + e.delivery + " → " + e.handler
+                }
+            }
+            Repeater {
+                model: watchdogOverlay.hotspots
+                delegate: Text {
+                    Layout.fillWidth: true
+                    elide: Text.ElideMiddle
+                    color: modelData.kind === "handler" ? "#93c5fd" : "#d1d5db"
+                    font.family: "Consolas"
+                    font.pixelSize: 11
+                    text: modelData.totalMs.toFixed(0) + " ms  p99 " + modelData.p99Ms.toFixed(1) + "  " + modelData.name
+                }
+            }
+        }
+    }
+
     footer: Rectangle {
         height: 36
         color: "white"
@@ -106,6 +106,11 @@ Item {
             onClicked: {
                 if (RobotGlobal.isConnected) {
                     RobotGlobal.disconnectFromRobot()
+                    ImpairGlobal.stop()
+                } else if (impairCheck.checked) {
+                    // 经本地损伤代理转发到目标控制器
+                    if (ImpairGlobal.start(ipField.text, parseInt(portField.text)))
+                        RobotGlobal.connectToRobot("127.0.0.1", ImpairGlobal.listenPort)
                 } else {
                     RobotGlobal.connectToRobot(ipField.text, parseInt(portField.text))
                 }
@@ -117,5 +122,135 @@ Item {
             color: RobotGlobal.isConnected ? "green" : "gray"
             Layout.alignment: Qt.AlignHCenter
         }
+
+        // ---------- 网络损伤代理 (测试心跳保活与弱网表现) ----------
+        CheckBox {
+            id: impairCheck
+            text: qsTr("经网络损伤代理连接 (测试用)")
+            enabled: !RobotGlobal.isConnected
+            Layout.alignment: Qt.AlignHCenter
+        }
+
+        GridLayout {
+            visible: impairCheck.checked
+            columns: 2
+            columnSpacing: 8
+            rowSpacing: 4
+            Layout.alignment: Qt.AlignHCenter
+
+            Text { text: qsTr("延迟分布") }
+            ComboBox {
+                Layout.preferredWidth: 140
+                model: ["normal", "uniform", "pareto"]
+                currentIndex: Math.max(0, model.indexOf(ImpairGlobal.settings.distribution))
+                onActivated: ImpairGlobal.settings = { distribution: currentText }
+            }
+
+            Repeater {
+                // 运行中修改立即生效
+                model: [
+                    { key: "delayMs", label: qsTr("基础延迟 (ms)"), to: 10000, step: 10 },
+                    { key: "jitterMs", label: qsTr("抖动 (ms)"), to: 10000, step: 10 },
+                    { key: "spikeMs", label: qsTr("尖峰延迟 (ms)"), to: 30000, step: 100 },
+                    { key: "spikePercent", label: qsTr("尖峰概率 (%)"), to: 100, step: 1 },
+                    { key: "bandwidthKBps", label: qsTr("带宽 (KB/s, 0=不限)"), to: 100000, step: 10 },
+                    { key: "maxSegment", label: qsTr("最大分段 (字节, 0=不拆)"), to: 65536, step: 8 },
+                    { key: "stallEveryMs", label: qsTr("停顿周期 (ms, 0=关)"), to: 600000, step: 1000 },
+                    { key: "stallMs", label: qsTr("停顿时长 (ms)"), to: 60000, step: 100 }
+                ]
+                delegate: RowLayout {
+                    Layout.columnSpan: 2
+                    Text { text: modelData.label; Layout.preferredWidth: 150 }
+                    SpinBox {
+                        Layout.preferredWidth: 140
+                        from: 0
+                        to: modelData.to
+                        stepSize: modelData.step
+                        editable: true
+                        value: modelData.key === "spikePercent"
+                               ? Math.round(ImpairGlobal.settings.spikeProbability * 100)
+                               : ImpairGlobal.settings[modelData.key]
+                        onValueModified: {
+                            var m = {}
+                            if (modelData.key === "spikePercent") m.spikeProbability = value / 100
+                            else m[modelData.key] = value
+                            ImpairGlobal.settings = m
+                        }
+                    }
+                }
+            }
+
+            Button {
+                text: qsTr("停顿 2 秒")
+                enabled: ImpairGlobal.running
+                onClicked: ImpairGlobal.stall(2000)
+            }
+            Text {
+                id: impairStats
+                color: "#6b7280"
+                font.pixelSize: 11
+                font.family: "Consolas"
+            }
+        }
+
+        Timer {
+            interval: 1000
+            repeat: true
+            running: impairCheck.checked && ImpairGlobal.running
+            onTriggered: {
+                var s = ImpairGlobal.stats()
+                impairStats.text = "心跳 " + s.heartbeats + " 次  p50 " + s.heartbeatP50Ms.toFixed(0)
+                                   + " ms  最大 " + s.heartbeatMaxMs.toFixed(0) + " ms  迟到 " + s.heartbeatLate
+                                   + "\n排队 " + s.queuedBytes + " B  日志 Logs/impair_*.log"
+            }
+        }
+
+        // ---------- 本地中继 (其他工具共用本连接) ----------
+        RowLayout {
+            Layout.alignment: Qt.AlignHCenter
+            spacing: 6
+
+            CheckBox {
+                text: qsTr("本地中继 127.0.0.1:")
+                checked: RelayGlobal.running
+                onToggled: {
+                    if (checked) RelayGlobal.start(relayPort.value)
+                    else RelayGlobal.stop()
+                }
+            }
+            SpinBox {
+                id: relayPort
+                from: 1
+                to: 65535
+                value: 9001
+                editable: true
+                enabled: !RelayGlobal.running
+                Layout.preferredWidth: 110
+                textFromValue: function(value) { return value.toString() } // 端口不要千位分隔符
+            }
+        }
+
+        Text {
+            visible: RelayGlobal.running
+            text: qsTr("下游客户端: ") + RelayGlobal.clientCount + qsTr("  (推送按订阅扇出，请求 id 自动改写)")
+            color: "#6b7280"
+            font.pixelSize: 11
+            Layout.alignment: Qt.AlignHCenter
+        }
+
+        Text {
+            id: relayLog
+            visible: text !== ""
+            color: "#9ca3af"
+            font.pixelSize: 11
+            Layout.maximumWidth: 300
+            elide: Text.ElideRight
+            Layout.alignment: Qt.AlignHCenter
+        }
+
+        Connections {
+            target: RelayGlobal
+            function onLogGenerated(line) { relayLog.text = line }
+        }
     }
 }
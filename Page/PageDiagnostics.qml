@@ -0,0 +1,459 @@
+import QtQuick
+import QtQuick.Controls
+import QtQuick.Layouts
+import Qt5Compat.GraphicalEffects
+import MyRobot 1.0 // 引入 DiagnosticsGlobal / RobotGlobal
+
+Item {
+    id: pageDiagnostics
+
+    // 指标快照 (每秒刷新，页面不可见时停止)
+    property var metrics: []
+
+    Timer {
+        id: refreshTimer
+        interval: 1000
+        repeat: true
+        triggeredOnStart: true
+        running: pageDiagnostics.visible
+        onTriggered: {
+            pageDiagnostics.metrics = DiagnosticsGlobal.metricsSnapshot()
+            pageDiagnostics.refreshTraceStats()
+        }
+    }
+
+    function refreshTraceStats() {
+        var s = DiagnosticsGlobal.traceStats()
+        traceStatsText.text = "事件 " + s.events + "  覆盖 " + s.dropped + "  线程 " + s.threads
+    }
+
+    // 数值格式化：大数字带单位，字节类指标换算 KB/MB
+    function formatValue(name, v) {
+        if (v === undefined) return "-"
+        if (name.indexOf("bytes") >= 0) {
+            if (Math.abs(v) >= 1048576) return (v / 1048576).toFixed(2) + " MB"
+            if (Math.abs(v) >= 1024) return (v / 1024).toFixed(1) + " KB"
+            return Math.round(v) + " B"
+        }
+        if (Math.abs(v) >= 1000000) return (v / 1000000).toFixed(2) + " M"
+        if (Math.abs(v) >= 10000) return (v / 1000).toFixed(1) + " K"
+        return Number.isInteger(v) ? v.toString() : v.toFixed(1)
+    }
+
+    // 直方图分位数：微秒类指标显示为 ms
+    function formatQuantile(name, v) {
+        if (v === undefined) return "-"
+        if (name.indexOf("_us") >= 0) return (v / 1000).toFixed(2) + "ms"
+        return formatValue(name, v)
+    }
+
+    ColumnLayout {
+        anchors.fill: parent
+        anchors.margins: 15
+        spacing: 10
+
+        // ================= 顶部工具栏 =================
+        RowLayout {
+            Layout.fillWidth: true
+            spacing: 10
+
+            Text {
+                text: "📈 诊断指标"
+                font.bold: true
+                font.pixelSize: 16
+                color: "#374151"
+            }
+
+            Item { Layout.fillWidth: true }
+
+            Text { text: "自动导出间隔"; color: "#6b7280" }
+            SpinBox {
+                from: 0
+                to: 3600
+                stepSize: 10
+                value: DiagnosticsGlobal.dumpIntervalSec
+                editable: true
+                onValueModified: DiagnosticsGlobal.dumpIntervalSec = value
+            }
+            Text { text: "s (0=关闭)"; color: "#6b7280" }
+
+            Button {
+                text: "💾 立即导出"
+                onClicked: {
+                    DiagnosticsGlobal.dumpNow()
+                    dumpHint.text = "已导出到 " + DiagnosticsGlobal.dumpDir
+                }
+            }
+        }
+
+        // ================= 区间追踪 =================
+        RowLayout {
+            Layout.fillWidth: true
+            spacing: 10
+
+            CheckBox {
+                id: traceCheck
+                text: "⏱ 记录消息耗时追踪"
+                checked: DiagnosticsGlobal.tracing
+                onToggled: DiagnosticsGlobal.tracing = checked
+            }
+
+            Text {
+                id: traceStatsText
+                color: "#6b7280"
+                font.family: "Consolas"
+                font.pixelSize: 12
+            }
+
+            Item { Layout.fillWidth: true }
+
+            Button {
+                text: "清空"
+                onClicked: {
+                    DiagnosticsGlobal.clearTrace()
+                    pageDiagnostics.refreshTraceStats()
+                }
+            }
+            Button {
+                text: "📤 导出追踪"
+                onClicked: {
+                    var path = DiagnosticsGlobal.exportTrace()
+                    dumpHint.text = path !== "" ? "追踪已导出: " + path + "  (chrome://tracing 或 ui.perfetto.dev 打开)"
+                                                : "追踪导出失败"
+                }
+            }
+        }
+
+        // ================= 日志格式 =================
+        RowLayout {
+            Layout.fillWidth: true
+            spacing: 10
+
+            CheckBox {
+                text: "🗜 二进制压缩日志 (*.blog)"
+                checked: RobotGlobal.binaryLog
+                onToggled: RobotGlobal.binaryLog = checked
+            }
+
+            TextField {
+                id: blogPathInput
+                Layout.fillWidth: true
+                placeholderText: "二进制日志段路径 (*.blog)"
+                selectByMouse: true
+            }
+            Button {
+                text: "转换为文本"
+                enabled: blogPathInput.text !== ""
+                onClicked: {
+                    var out = RobotGlobal.convertBinaryLog(blogPathInput.text)
+                    dumpHint.text = out !== "" ? "已转换: " + out : "转换失败，详见日志"
+                }
+            }
+        }
+
+        // ================= 请求合并 / 缓存 =================
+        RowLayout {
+            Layout.fillWidth: true
+            spacing: 10
+
+            Text { text: "♻ 读请求缓存 TTL (ms)"; color: "#374151" }
+            SpinBox {
+                from: 0
+                to: 60000
+                stepSize: 50
+                editable: true
+                value: RobotGlobal.requestCacheTtlMs
+                onValueModified: RobotGlobal.requestCacheTtlMs = value
+            }
+            Text {
+                text: "0 = 只合并相同的在途请求；写接口 (saveVars / SetIOValue ...) 会立即使相关缓存失效"
+                color: "#9ca3af"
+                font.pixelSize: 12
+            }
+        }
+
+        // ================= 推送解析基准 =================
+        RowLayout {
+            Layout.fillWidth: true
+            spacing: 10
+
+            Text { text: "⚡ 推送报文解析"; color: "#374151" }
+            Button {
+                text: "运行基准"
+                onClicked: {
+                    var r = DiagnosticsGlobal.parserBenchmark(20000)
+                    benchText.text = "QJsonDocument " + r.domNsPerFrame.toFixed(0) + " ns/帧  →  字段扫描 "
+                                     + r.scanNsPerFrame.toFixed(0) + " ns/帧  (" + r.speedup.toFixed(1) + "×"
+                                     + (r.consistent ? "" : ", 结果不一致!") + ")"
+                }
+            }
+            Text {
+                id: benchText
+                text: "RobotStatus / RobotPosture / ProjectState 只提取登记字段，不构建 DOM"
+                color: "#9ca3af"
+                font.family: "Consolas"
+                font.pixelSize: 12
+            }
+        }
+
+        // ================= 长稳测试 =================
+        RowLayout {
+            Layout.fillWidth: true
+            spacing: 10
+
+            Text { text: "🧪 长稳测试 (本地模拟控制器)"; color: "#374151" }
+            SpinBox {
+                id: soakMinutes
+                from: 0
+                to: 10080
+                stepSize: 30
+                value: 120
+                editable: true
+                enabled: !SoakGlobal.running
+            }
+            Text { text: "分钟 (0=手动停止)"; color: "#6b7280" }
+            Button {
+                text: SoakGlobal.running ? "■ 停止并出报告" : "▶ 开始"
+                onClicked: {
+                    if (SoakGlobal.running) SoakGlobal.stop()
+                    else SoakGlobal.start({ durationMin: soakMinutes.value })
+                }
+            }
+            Text {
+                Layout.fillWidth: true
+                elide: Text.ElideRight
+                color: "#6b7280"
+                font.family: "Consolas"
+                font.pixelSize: 12
+                text: {
+                    var s = SoakGlobal.lastSample
+                    if (SoakGlobal.running) {
+                        if (s.tSec === undefined) return "运行中，等待第一次采样..."
+                        return SoakGlobal.elapsedSec + "s  RSS " + s.rssMb.toFixed(1) + " MB  延迟 p50/p99 "
+                               + s.latP50Us + "/" + s.latP99Us + " us  往返 p50 " + s.rttP50Us + " us"
+                    }
+                    return SoakGlobal.verdict !== "" ? SoakGlobal.verdict + "  " + SoakGlobal.reportPath
+                                                     : "需先断开机器人；采样与报告写入 Logs/soak_*"
+                }
+            }
+        }
+
+        Connections {
+            target: SoakGlobal
+            function onErrorOccurred(message) { dumpHint.text = message }
+        }
+
+        // ================= API 延迟扫描 =================
+        RowLayout {
+            Layout.fillWidth: true
+            spacing: 10
+
+            Text { text: "⏱ API 延迟扫描"; color: "#374151" }
+            Text { text: "并发"; color: "#6b7280" }
+            SpinBox { id: sweepConcurrency; from: 1; to: 64; value: 1; editable: true; enabled: !SweepGlobal.running }
+            Text { text: "速率 (/s, 0=不限)"; color: "#6b7280" }
+            SpinBox { id: sweepRate; from: 0; to: 10000; stepSize: 10; value: 0; editable: true; enabled: !SweepGlobal.running }
+            Text { text: "次数"; color: "#6b7280" }
+            SpinBox { id: sweepCount; from: 10; to: 100000; stepSize: 100; value: 200; editable: true; enabled: !SweepGlobal.running }
+            CheckBox { id: sweepWrites; text: "含写接口"; enabled: !SweepGlobal.running }
+            Button {
+                text: SweepGlobal.running ? "■ 中止" : "▶ 开始"
+                enabled: SweepGlobal.running || RobotGlobal.isConnected
+                onClicked: {
+                    if (SweepGlobal.running) SweepGlobal.stop()
+                    else SweepGlobal.start({ concurrency: sweepConcurrency.value, ratePerSec: sweepRate.value,
+                                             count: sweepCount.value, includeWrites: sweepWrites.checked })
+                }
+            }
+            Text {
+                Layout.fillWidth: true
+                elide: Text.ElideRight
+                color: "#6b7280"
+                font.family: "Consolas"
+                font.pixelSize: 12
+                text: {
+                    if (SweepGlobal.running)
+                        return SweepGlobal.currentEndpoint + "  " + (SweepGlobal.progress * 100).toFixed(0) + "%"
+                    var rows = SweepGlobal.results
+                    if (rows.length === 0) return "表格与 JSON 写入 Logs/sweep_*"
+                    var parts = []
+                    for (var i = 0; i < rows.length; ++i)
+                        parts.push(rows[i].name + " " + (rows[i].p50Us / 1000).toFixed(1) + "/" + (rows[i].p99Us / 1000).toFixed(1))
+                    return "p50/p99 ms  " + parts.join("  ") + "  → " + SweepGlobal.reportPath
+                }
+            }
+        }
+
+        Connections {
+            target: SweepGlobal
+            function onErrorOccurred(message) { dumpHint.text = message }
+        }
+
+        // ================= GUI 卡顿检测 =================
+        RowLayout {
+            Layout.fillWidth: true
+            spacing: 10
+
+            CheckBox {
+                text: "🐢 GUI 卡顿检测"
+                checked: WatchdogGlobal.enabled
+                onToggled: WatchdogGlobal.enabled = checked
+            }
+            Text { text: "阈值 (ms)"; color: "#6b7280" }
+            SpinBox {
+                from: 5
+                to: 10000
+                stepSize: 10
+                editable: true
+                value: WatchdogGlobal.stallThresholdMs
+                onValueModified: WatchdogGlobal.stallThresholdMs = value
+            }
+            CheckBox {
+                text: "浮层"
+                checked: WatchdogGlobal.overlayVisible
+                onToggled: WatchdogGlobal.overlayVisible = checked
+            }
+            Button {
+                text: "清空记录"
+                onClicked: WatchdogGlobal.clearStalls()
+            }
+            Text {
+                Layout.fillWidth: true
+                elide: Text.ElideRight
+                color: "#6b7280"
+                font.family: "Consolas"
+                font.pixelSize: 12
+                text: {
+                    var e = WatchdogGlobal.lastStall
+                    if (e.time === undefined) return "卡顿 " + WatchdogGlobal.stallCount + " 次；明细写入 Logs/gui_stall_*.log"
+                    return "卡顿 " + WatchdogGlobal.stallCount + " 次  最近 " + e.time + " " + e.durationMs.toFixed(0)
+                           + " ms  " + e.delivery + " → " + e.handler
+                }
+            }
+        }
+
+        // ================= 控制器时钟同步 =================
+        RowLayout {
+            Layout.fillWidth: true
+            spacing: 10
+
+            CheckBox {
+                text: "🕒 控制器时钟同步"
+                checked: ClockGlobal.enabled
+                onToggled: ClockGlobal.enabled = checked
+            }
+            Button {
+                text: "重新收敛"
+                onClicked: ClockGlobal.reset()
+            }
+            Text {
+                Layout.fillWidth: true
+                elide: Text.ElideRight
+                color: "#6b7280"
+                font.family: "Consolas"
+                font.pixelSize: 12
+                text: {
+                    var rtt = ClockGlobal.minRttMs < 0 ? "--" : ClockGlobal.minRttMs.toFixed(2)
+                    if (!ClockGlobal.synced)
+                        return "未同步 (等待带时间戳的日志)  最小往返 " + rtt + " ms；延迟见 controller_to_ui_us"
+                    return "偏移 " + ClockGlobal.offsetMs.toFixed(1) + " ms  漂移 " + ClockGlobal.driftPpm.toFixed(1)
+                           + " ppm  最小往返 " + rtt + " ms  单程≈" + (ClockGlobal.minRttMs < 0 ? "--" : ClockGlobal.oneWayMs.toFixed(2)) + " ms"
+                }
+            }
+        }
+
+        Text {
+            id: dumpHint
+            text: "导出目录: " + DiagnosticsGlobal.dumpDir + "  (metrics.prom / metrics.json)"
+            color: "#9ca3af"
+            font.pixelSize: 12
+        }
+
+        // ================= 指标列表 =================
+        Rectangle {
+            Layout.fillWidth: true
+            Layout.fillHeight: true
+            color: "white"
+            radius: 8
+
+            layer.enabled: true
+            layer.effect: DropShadow { transparentBorder: true; radius: 6; color: "#08000000"; verticalOffset: 2 }
+
+            ColumnLayout {
+                anchors.fill: parent
+                anchors.margins: 10
+                spacing: 0
+
+                // 表头
+                RowLayout {
+                    Layout.fillWidth: true
+                    Layout.preferredHeight: 30
+                    spacing: 8
+                    Text { text: "指标"; font.bold: true; color: "#374151"; Layout.preferredWidth: 260 }
+                    Text { text: "标签"; font.bold: true; color: "#374151"; Layout.preferredWidth: 200 }
+                    Text { text: "值 / 均值"; font.bold: true; color: "#374151"; Layout.preferredWidth: 110 }
+                    Text { text: "速率 (/s)"; font.bold: true; color: "#374151"; Layout.preferredWidth: 90 }
+                    Text { text: "P50 / P99 / Max"; font.bold: true; color: "#374151"; Layout.fillWidth: true }
+                }
+                Rectangle { Layout.fillWidth: true; height: 1; color: "#e5e7eb" }
+
+                ListView {
+                    id: metricsList
+                    Layout.fillWidth: true
+                    Layout.fillHeight: true
+                    clip: true
+                    model: pageDiagnostics.metrics
+                    ScrollBar.vertical: ScrollBar { }
+
+                    delegate: Rectangle {
+                        width: metricsList.width
+                        height: 26
+                        color: index % 2 === 0 ? "white" : "#f9fafb"
+
+                        property var m: modelData
+
+                        RowLayout {
+                            anchors.fill: parent
+                            spacing: 8
+                            Text {
+                                text: m.name
+                                font.family: "Consolas"
+                                color: "#111827"
+                                elide: Text.ElideRight
+                                Layout.preferredWidth: 260
+                            }
+                            Text {
+                                text: m.labels
+                                font.family: "Consolas"
+                                color: "#6b7280"
+                                elide: Text.ElideRight
+                                Layout.preferredWidth: 200
+                            }
+                            Text {
+                                text: m.type === "histogram" ? formatQuantile(m.name, m.value) : formatValue(m.name, m.value)
+                                font.family: "Consolas"
+                                color: "#2563eb"
+                                Layout.preferredWidth: 110
+                            }
+                            Text {
+                                text: m.rate === undefined ? "-" : m.rate.toFixed(1)
+                                font.family: "Consolas"
+                                color: m.rate > 0 ? "#059669" : "#9ca3af"
+                                Layout.preferredWidth: 90
+                            }
+                            Text {
+                                text: m.type === "histogram"
+                                      ? formatQuantile(m.name, m.p50) + " / " + formatQuantile(m.name, m.p99)
+                                        + " / " + formatQuantile(m.name, m.max) + "  (n=" + m.count + ")"
+                                      : ""
+                                font.family: "Consolas"
+                                color: "#374151"
+                                Layout.fillWidth: true
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
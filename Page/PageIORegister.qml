@@ -21,6 +21,7 @@ Item {
 
             TabButton { text: qsTr("🔌 IO 状态监控与控制") }
             TabButton { text: qsTr("🔢 寄存器 (Register) 管理") }
+            TabButton { text: qsTr("📊 IO 逻辑分析仪") }
         }
 
         StackLayout {
@@ -39,6 +40,12 @@ Item {
                 Layout.fillHeight: true
                 Layout.fillWidth: true
             }
+
+            // ---------------- Tab 3: IO 逻辑分析仪 ----------------
+            LogicAnalyzerPage {
+                Layout.fillHeight: true
+                Layout.fillWidth: true
+            }
         }
     }
 
@@ -108,30 +115,35 @@ Item {
         }
 
         function updateIOUI(dbArray) {
-            if (!Array.isArray(dbArray)) return
-
-            dbArray.forEach(function(item) {
-                var port = item.port
-                var val = item.value
-
-                if (item.type === "DI") {
-                    if(port < diRepeater.count) diRepeater.itemAt(port).isOn = (val === 1)
-                } else if (item.type === "DO") {
-                    if(port < doRepeater.count) doRepeater.itemAt(port).isOn = (val === 1)
-                } else if (item.type === "AI") {
-                    if(port < aiRepeater.count){
-                        // 【修改】只保留3位小数
-                        var displayAI = (typeof val === 'number') ? val.toFixed(3) : "--"
-                        aiRepeater.itemAt(port).currentVal = displayAI
-                    }
-                } else if (item.type === "AO") {
-                    if(port < aoRepeater.count){
-                        // 【修改】只保留3位小数
-                        var displayAO = (typeof val === 'number') ? val.toFixed(3) : "--"
-                        aoRepeater.itemAt(port).currentVal = displayAO
+            WatchdogGlobal.enter("PageIORegister.updateIOUI")
+            try {
+                if (!Array.isArray(dbArray)) return
+
+                dbArray.forEach(function(item) {
+                    var port = item.port
+                    var val = item.value
+
+                    if (item.type === "DI") {
+                        if(port < diRepeater.count) diRepeater.itemAt(port).isOn = (val === 1)
+                    } else if (item.type === "DO") {
+                        if(port < doRepeater.count) doRepeater.itemAt(port).isOn = (val === 1)
+                    } else if (item.type === "AI") {
+                        if(port < aiRepeater.count){
+                            // 【修改】只保留3位小数
+                            var displayAI = (typeof val === 'number') ? val.toFixed(3) : "--"
+                            aiRepeater.itemAt(port).currentVal = displayAI
+                        }
+                    } else if (item.type === "AO") {
+                        if(port < aoRepeater.count){
+                            // 【修改】只保留3位小数
+                            var displayAO = (typeof val === 'number') ? val.toFixed(3) : "--"
+                            aoRepeater.itemAt(port).currentVal = displayAO
+                        }
                     }
-                }
-            })
+                })
+            } finally {
+                WatchdogGlobal.leave()
+            }
         }
 
         // 界面布局
@@ -332,15 +344,20 @@ Item {
         }
 
         function updateRegUI(db) {
-            db.forEach(function(item) {
-                // 在 model 中找到对应的 address 并更新 value
-                for(var i=0; i<regModel.count; i++) {
-                    if (regModel.get(i).address === item.address) {
-                        regModel.setProperty(i, "currValue", String(item.value))
-                        break;
+            WatchdogGlobal.enter("PageIORegister.updateRegUI")
+            try {
+                db.forEach(function(item) {
+                    // 在 model 中找到对应的 address 并更新 value
+                    for(var i=0; i<regModel.count; i++) {
+                        if (regModel.get(i).address === item.address) {
+                            regModel.setProperty(i, "currValue", String(item.value))
+                            break;
+                        }
                     }
-                }
-            })
+                })
+            } finally {
+                WatchdogGlobal.leave()
+            }
         }
 
         ColumnLayout {
@@ -483,6 +500,159 @@ Item {
     }
 
 
+    // ============================================================
+    // Tab 3 实现: IO 逻辑分析仪 (C++ 流水线轮询 GetIOValue，历史保存在 IOCaptureGlobal)
+    // ============================================================
+    component LogicAnalyzerPage : Item {
+        // 触发通道只能选数字量，端口数与 IO 页面一致
+        readonly property var triggerChannels: {
+            var list = ["无"]
+            for (var i = 0; i < 16; i++) list.push("DI" + i)
+            for (var j = 0; j < 16; j++) list.push("DO" + j)
+            return list
+        }
+        readonly property var edgeNames: ["rising", "falling", "both"]
+
+        function triggerOf(combo, edgeCombo) {
+            if (combo.currentIndex <= 0) return undefined
+            return { "channel": combo.currentText, "edge": edgeNames[edgeCombo.currentIndex] }
+        }
+
+        function formatUs(us) {
+            return us >= 1000000 ? (us / 1000000).toFixed(3) + " s" : (us / 1000).toFixed(2) + " ms"
+        }
+
+        ColumnLayout {
+            anchors.fill: parent
+            anchors.margins: 20
+            spacing: 15
+
+            // 1. 采集控制
+            ControlCard {
+                Layout.fillWidth: true
+                Layout.preferredHeight: 60
+                RowLayout {
+                    anchors.fill: parent; anchors.margins: 10; spacing: 12
+
+                    Text { text: "在途请求"; color: "#6b7280" }
+                    SpinBox { id: laDepth; from: 1; to: 64; value: 4; editable: true; enabled: !IOCaptureGlobal.running }
+                    Text { text: "速率上限 (Hz, 0=不限)"; color: "#6b7280" }
+                    SpinBox { id: laRate; from: 0; to: 10000; stepSize: 50; value: 0; editable: true; enabled: !IOCaptureGlobal.running }
+
+                    Rectangle { width: 1; height: 30; color: "#e5e7eb" }
+
+                    Text { text: "开始触发"; color: "#6b7280" }
+                    ComboBox { id: laStartCh; model: triggerChannels; Layout.preferredWidth: 80; enabled: !IOCaptureGlobal.running }
+                    ComboBox { id: laStartEdge; model: ["↑ 上升", "↓ 下降", "↕ 任意"]; Layout.preferredWidth: 90; enabled: !IOCaptureGlobal.running }
+                    Text { text: "停止触发"; color: "#6b7280" }
+                    ComboBox { id: laStopCh; model: triggerChannels; Layout.preferredWidth: 80; enabled: !IOCaptureGlobal.running }
+                    ComboBox { id: laStopEdge; model: ["↑ 上升", "↓ 下降", "↕ 任意"]; Layout.preferredWidth: 90; enabled: !IOCaptureGlobal.running }
+                    Text { text: "延后 (ms)"; color: "#6b7280" }
+                    SpinBox { id: laPost; from: 0; to: 600000; stepSize: 100; value: 0; editable: true; enabled: !IOCaptureGlobal.running }
+
+                    Item { Layout.fillWidth: true }
+
+                    Button {
+                        text: IOCaptureGlobal.running ? "■ 停止" : "▶ 开始采集"
+                        highlighted: !IOCaptureGlobal.running
+                        enabled: IOCaptureGlobal.running || RobotGlobal.isConnected
+                        onClicked: {
+                            if (IOCaptureGlobal.running) {
+                                IOCaptureGlobal.stop()
+                                return
+                            }
+                            laError.text = ""
+                            IOCaptureGlobal.start({ depth: laDepth.value, maxRateHz: laRate.value,
+                                                    startTrigger: triggerOf(laStartCh, laStartEdge),
+                                                    stopTrigger: triggerOf(laStopCh, laStopEdge),
+                                                    postTriggerMs: laPost.value })
+                        }
+                    }
+                    Button {
+                        text: "🗑️ 清空"
+                        flat: true
+                        enabled: !IOCaptureGlobal.running
+                        onClicked: IOCaptureGlobal.clear()
+                    }
+                }
+            }
+
+            // 2. 状态与缩放
+            RowLayout {
+                Layout.fillWidth: true
+                spacing: 12
+
+                Text {
+                    Layout.fillWidth: true
+                    elide: Text.ElideRight
+                    color: "#6b7280"
+                    font.family: "Consolas"
+                    font.pixelSize: 12
+                    text: {
+                        var s = IOCaptureGlobal.stats
+                        var state = { "idle": "空闲", "armed": "等待触发", "capturing": "采集中", "done": "已完成" }[IOCaptureGlobal.state]
+                        return state + "  采样 " + s.samples + " (" + Number(s.rateHz).toFixed(0) + " Hz, 最大间隔 "
+                               + formatUs(s.maxIntervalUs) + ")  边沿 " + s.edges + "  时长 " + formatUs(s.durationUs)
+                               + "  存储 " + ((s.digitalBytes + s.analogBytes) / 1024).toFixed(1) + " KB"
+                               + "  错误 " + s.errors
+                    }
+                }
+                Text {
+                    color: "#374151"
+                    font.family: "Consolas"
+                    font.pixelSize: 12
+                    visible: timeline.hoverUs >= 0
+                    text: "t = " + formatUs(timeline.hoverUs - IOCaptureGlobal.firstUs())
+                }
+                CheckBox {
+                    text: "跟随"
+                    checked: timeline.follow
+                    onToggled: timeline.follow = checked
+                }
+                Button {
+                    text: "全部"
+                    onClicked: timeline.fitAll()
+                }
+            }
+
+            // 采集错误 (未连接、参数无效、请求失败等)，重新开始时清除
+            Text {
+                id: laError
+                Layout.fillWidth: true
+                visible: text !== ""
+                wrapMode: Text.WrapAnywhere
+                color: "#dc2626"
+                font.pixelSize: 12
+            }
+
+            Connections {
+                target: IOCaptureGlobal
+                function onErrorOccurred(message) { laError.text = "⚠ " + message }
+            }
+
+            // 3. 时间轴 (滚轮缩放、拖动平移、双击显示全部)
+            ControlCard {
+                Layout.fillWidth: true
+                Layout.fillHeight: true
+
+                ScrollView {
+                    anchors.fill: parent
+                    anchors.margins: 8
+                    clip: true
+                    contentWidth: availableWidth
+                    contentHeight: timeline.implicitHeight
+
+                    IOTimeline {
+                        id: timeline
+                        width: parent.width
+                        height: implicitHeight
+                        capture: IOCaptureGlobal
+                    }
+                }
+            }
+        }
+    }
+
     // ============================================================
     // 公共组件封装
     // ============================================================
@@ -0,0 +1,166 @@
+import QtQuick
+import QtQuick.Controls
+import QtQuick.Layouts
+import Qt5Compat.GraphicalEffects
+import MyRobot 1.0 // 引入 LogSearchModel
+
+Item {
+    id: pageLogSearch
+
+    // 日志索引与搜索在后台线程执行，这里只负责显示
+    LogSearchModel {
+        id: logModel
+        onErrorOccurred: (errorMsg) => statusText.text = "⚠ " + errorMsg
+        onResultsChanged: {
+            statusText.text = "命中 " + count + " 行" + (truncated ? " (已截断)" : "") + "，耗时 " + elapsedMs + " ms"
+            resultList.positionViewAtBeginning()
+        }
+    }
+
+    // 第一次打开页面时在后台补全索引
+    onVisibleChanged: if (visible) logModel.refreshIndex()
+
+    function doSearch() {
+        logModel.search(searchInput.text, regexCheck.checked, caseCheck.checked,
+                        fromInput.text, toInput.text)
+    }
+
+    ColumnLayout {
+        anchors.fill: parent
+        anchors.margins: 15
+        spacing: 10
+
+        // ================= 搜索条件 =================
+        Rectangle {
+            Layout.fillWidth: true
+            Layout.preferredHeight: conditionLayout.implicitHeight + 24
+            color: "white"
+            radius: 8
+
+            layer.enabled: true
+            layer.effect: DropShadow { transparentBorder: true; radius: 6; color: "#08000000"; verticalOffset: 2 }
+
+            ColumnLayout {
+                id: conditionLayout
+                anchors.fill: parent
+                anchors.margins: 12
+                spacing: 8
+
+                RowLayout {
+                    Layout.fillWidth: true
+                    spacing: 10
+
+                    Text {
+                        text: "🔎 日志检索"
+                        font.bold: true
+                        font.pixelSize: 16
+                        color: "#374151"
+                    }
+
+                    TextField {
+                        id: searchInput
+                        Layout.fillWidth: true
+                        placeholderText: "关键字 / 正则 (为空则列出时间范围内所有行)"
+                        selectByMouse: true
+                        onAccepted: pageLogSearch.doSearch()
+                    }
+
+                    CheckBox { id: regexCheck; text: "正则" }
+                    CheckBox { id: caseCheck; text: "区分大小写" }
+
+                    Button {
+                        text: logModel.busy ? "取消" : "搜索"
+                        onClicked: logModel.busy ? logModel.cancel() : pageLogSearch.doSearch()
+                    }
+                }
+
+                RowLayout {
+                    Layout.fillWidth: true
+                    spacing: 10
+
+                    Text { text: "时间范围"; color: "#6b7280" }
+                    TextField {
+                        id: fromInput
+                        Layout.preferredWidth: 180
+                        placeholderText: "yyyy-MM-dd HH:mm:ss"
+                        selectByMouse: true
+                        onAccepted: pageLogSearch.doSearch()
+                    }
+                    Text { text: "~"; color: "#6b7280" }
+                    TextField {
+                        id: toInput
+                        Layout.preferredWidth: 180
+                        placeholderText: "yyyy-MM-dd HH:mm:ss"
+                        selectByMouse: true
+                        onAccepted: pageLogSearch.doSearch()
+                    }
+
+                    Item { Layout.fillWidth: true }
+
+                    BusyIndicator {
+                        running: logModel.busy
+                        visible: running
+                        Layout.preferredWidth: 24
+                        Layout.preferredHeight: 24
+                    }
+                    Text {
+                        text: logModel.fileCount + " 个文件，已索引 " + (logModel.indexedBytes / 1048576).toFixed(1) + " MB"
+                        color: "#9ca3af"
+                        font.pixelSize: 12
+                    }
+                }
+            }
+        }
+
+        Text {
+            id: statusText
+            text: "日志目录: " + logModel.logDir + " (含文本日志与二进制日志段)"
+            color: "#6b7280"
+            font.pixelSize: 12
+        }
+
+        // ================= 结果列表 (只创建可见行) =================
+        Rectangle {
+            Layout.fillWidth: true
+            Layout.fillHeight: true
+            color: "#1e1e1e"
+            radius: 6
+            border.color: "#374151"
+
+            ListView {
+                id: resultList
+                anchors.fill: parent
+                anchors.margins: 6
+                clip: true
+                model: logModel
+                reuseItems: true
+                ScrollBar.vertical: ScrollBar { }
+
+                delegate: RowLayout {
+                    width: ListView.view.width
+                    spacing: 10
+
+                    Text {
+                        text: model.time
+                        color: "#9ca3af"
+                        font.family: "Consolas"
+                        font.pixelSize: 12
+                    }
+                    Text {
+                        text: model.text
+                        color: "#4ade80"
+                        font.family: "Consolas"
+                        font.pixelSize: 12
+                        elide: Text.ElideRight
+                        Layout.fillWidth: true
+                    }
+                    Text {
+                        text: model.file
+                        color: "#6b7280"
+                        font.pixelSize: 11
+                    }
+                }
+            }
+        }
+    }
+}
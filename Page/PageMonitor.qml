@@ -12,9 +12,10 @@ Item {
     property bool isInitialized: false
 
     // --- 数据模型存储 ---
-    property var projectData: ({})
-    property var robotData: ({})
-    property var postureData: ({ "joint": [], "end": {} })
+    // 工程状态 / 机器人状态 / 位姿直接读 RobotGlobal 扫描出的结构体 (不经过 JSON DOM)
+    readonly property var projectData: RobotGlobal.projectState
+    readonly property var robotData: RobotGlobal.robotStatus
+    readonly property var postureData: RobotGlobal.robotPosture
     property var coordData: ({ "tool": {}, "user": {} })
 
     // --- 辅助函数：时间戳转字符串 ---
@@ -112,6 +113,113 @@ Item {
             anchors.margins: 20
             spacing: 15
 
+            // ========================================================
+            // 卡片 0: 遥测录制与回放 (回放的数据经 RobotGlobal 分发，下面各卡片照常显示)
+            // ========================================================
+            DataCard {
+                title: qsTr("遥测录制与回放")
+                icon: "⏺"
+
+                RowLayout {
+                    Layout.fillWidth: true
+                    spacing: 10
+
+                    Button {
+                        text: TelemetryGlobal.recording ? qsTr("⏹ 停止录制") : qsTr("⏺ 开始录制")
+                        onClicked: {
+                            if (TelemetryGlobal.recording) {
+                                TelemetryGlobal.stopRecording()
+                                telemetryPathInput.text = TelemetryGlobal.recordPath || telemetryPathInput.text
+                            } else {
+                                TelemetryGlobal.startRecording()
+                            }
+                        }
+                    }
+                    Text {
+                        visible: TelemetryGlobal.recording
+                        text: TelemetryGlobal.recordPath
+                        color: "#dc2626"
+                        font.pixelSize: 12
+                        elide: Text.ElideMiddle
+                        Layout.fillWidth: true
+                    }
+
+                    TextField {
+                        id: telemetryPathInput
+                        visible: !TelemetryGlobal.recording
+                        Layout.fillWidth: true
+                        placeholderText: qsTr("录制文件路径 (*.tcol)")
+                        selectByMouse: true
+                    }
+                    Button {
+                        visible: !TelemetryGlobal.recording
+                        text: TelemetryGlobal.playbackOpen ? qsTr("关闭") : qsTr("📂 打开")
+                        onClicked: TelemetryGlobal.playbackOpen ? TelemetryGlobal.closePlayback()
+                                                                : TelemetryGlobal.openPlayback(telemetryPathInput.text)
+                    }
+                }
+
+                RowLayout {
+                    Layout.fillWidth: true
+                    visible: TelemetryGlobal.playbackOpen
+                    spacing: 10
+
+                    Button {
+                        text: TelemetryGlobal.playing ? qsTr("⏸") : qsTr("▶")
+                        onClicked: TelemetryGlobal.playing ? TelemetryGlobal.pause() : TelemetryGlobal.play()
+                    }
+
+                    Slider {
+                        id: telemetrySlider
+                        Layout.fillWidth: true
+                        from: TelemetryGlobal.startMs
+                        to: Math.max(TelemetryGlobal.endMs, TelemetryGlobal.startMs + 1)
+                        // 拖动时不跟随播放位置，松开后恢复绑定
+                        Binding on value {
+                            value: TelemetryGlobal.positionMs
+                            when: !telemetrySlider.pressed
+                        }
+                        onMoved: TelemetryGlobal.seek(value)
+                    }
+
+                    Text {
+                        text: Qt.formatDateTime(new Date(TelemetryGlobal.positionMs), "HH:mm:ss.zzz")
+                        font.family: "Consolas"
+                        color: "#374151"
+                    }
+
+                    ComboBox {
+                        Layout.preferredWidth: 90
+                        model: [0.25, 0.5, 1, 2, 4, 8, 16]
+                        currentIndex: 2
+                        displayText: currentValue + "x"
+                        onActivated: TelemetryGlobal.speed = currentValue
+                    }
+
+                    Button {
+                        text: qsTr("📤 导出 CSV")
+                        onClicked: {
+                            var files = TelemetryGlobal.exportCsv()
+                            telemetryHint.text = files.length > 0 ? qsTr("已导出: ") + files.join("  ") : qsTr("导出失败")
+                        }
+                    }
+                }
+
+                Text {
+                    id: telemetryHint
+                    visible: text !== ""
+                    color: "#6b7280"
+                    font.pixelSize: 12
+                    wrapMode: Text.WrapAnywhere
+                    Layout.fillWidth: true
+                }
+
+                Connections {
+                    target: TelemetryGlobal
+                    function onErrorOccurred(errorMsg) { telemetryHint.text = "⚠ " + errorMsg }
+                }
+            }
+
             // ========================================================
             // 卡片 1: 工程状态 (ProjectState)
             // ========================================================
@@ -147,7 +255,7 @@ Item {
                     InfoItem {
                         label: qsTr("执行行号");
                         // 简单的逻辑取出第一个脚本的行号
-                        value: projectData.scripts ? (Object.values(projectData.scripts)[0]?.line || "--") : "--"
+                        value: projectData.scriptLine || "--"
                         visible: projectData.state === 2 || projectData.state === 3
                     }
                 }
@@ -194,15 +302,15 @@ Item {
 
                     InfoItem {
                         label: qsTr("工具 ID")
-                        value: robotData.ToolId || "-"
+                        value: robotData.toolId || "-"
                     }
                     InfoItem {
                         label: qsTr("负载 ID")
-                        value: robotData.PayloadId || "-"
+                        value: robotData.payloadId || "-"
                     }
                     InfoItem {
                         label: qsTr("坐标系 ID")
-                        value: robotData.CoordinateId || "-"
+                        value: robotData.coordinateId || "-"
                     }
                     InfoItem {
                         label: qsTr("默认工具")
@@ -329,8 +437,7 @@ Item {
                             Layout.preferredHeight: 24
                             onClicked: {
                                 // 1. 提取对象中的值，按 X,Y,Z,A,B,C 顺序组成数组
-                                var e = postureData.end || {};
-                                var rawArr = [e.x, e.y, e.z, e.a, e.b, e.c];
+                                var rawArr = postureData.end || [0,0,0,0,0,0];
 
                                 // 2. 格式化为保留3位小数的数字
                                 var formattedData = rawArr.map(function(val){
@@ -349,12 +456,12 @@ Item {
                         Repeater {
                             // 我们手动构造一个包含 Label 和 Value 的数组模型
                             model: [
-                                { label: "X", val: postureData.end?.x || 0},
-                                { label: "Y", val: postureData.end?.y || 0},
-                                { label: "Z", val: postureData.end?.z || 0},
-                                { label: "A", val: postureData.end?.a || 0},
-                                { label: "B", val: postureData.end?.b || 0},
-                                { label: "C", val: postureData.end?.c || 0}
+                                { label: "X", val: postureData.end[0] || 0},
+                                { label: "Y", val: postureData.end[1] || 0},
+                                { label: "Z", val: postureData.end[2] || 0},
+                                { label: "A", val: postureData.end[3] || 0},
+                                { label: "B", val: postureData.end[4] || 0},
+                                { label: "C", val: postureData.end[5] || 0}
                             ]
 
                             delegate: Rectangle {
@@ -710,20 +817,8 @@ Item {
     Connections {
         target: RobotGlobal
 
-        // 1. 工程状态
-        function onRecvProjectStateMessage(msg) {
-            projectData = msg
-        }
-
-        // 2. 机器人通用状态
-        function onRecvRobotStatusMessage(msg) {
-            robotData = msg
-        }
-
-        // 3. 位姿
-        function onRecvRobotPostureMessage(msg) {
-            postureData = msg
-        }
+        // 1-3. 工程状态、机器人状态、位姿：见 projectData / robotData / postureData 绑定
+        // 不在这里连接 recv*Message，否则每帧都要构建 QJsonObject
 
         // 4. 坐标系
         function onRecvRobotCoordinateMessage(msg) {
@@ -732,20 +827,25 @@ Item {
 
         // 5. 日志 (Log) - 数组格式 [type, code, time, msg]
         function onRecvLogMessage(msg) {
-            if (msg.db && Array.isArray(msg.db)) {
-                // msg.db 是一个包含多条日志的数组 [[...], [...]]
-                msg.db.forEach(function(logEntry) {
-                    logModel.insert(0, { // 插入到最前面
-                        typeCode: logEntry[0],
-                        errorCode: logEntry[1],
-                        timeStr: formatTime(logEntry[2]),
-                        message: logEntry[3]
+            WatchdogGlobal.enter("PageMonitor.onRecvLogMessage")
+            try {
+                if (msg.db && Array.isArray(msg.db)) {
+                    // msg.db 是一个包含多条日志的数组 [[...], [...]]
+                    msg.db.forEach(function(logEntry) {
+                        logModel.insert(0, { // 插入到最前面
+                            typeCode: logEntry[0],
+                            errorCode: logEntry[1],
+                            timeStr: formatTime(logEntry[2]),
+                            message: logEntry[3]
+                        })
+                        console.log(logEntry[0])
                     })
-                    console.log(logEntry[0])
-                })
 
-                // 限制日志条数，防止内存溢出
-                if (logModel.count > 100) logModel.remove(100, logModel.count - 100)
+                    // 限制日志条数，防止内存溢出
+                    if (logModel.count > 100) logModel.remove(100, logModel.count - 100)
+                }
+            } finally {
+                WatchdogGlobal.leave()
             }
         }
 
@@ -25,25 +25,40 @@ Item {
     property string forwardResult: "--"
     property string inverseResult: "--"
 
+    // 正逆解经 KinematicsGlobal 发送 (带结果缓存)，按批次号区分单点计算与路径校验
+    property int forwardBatchId: -1
+    property int inverseBatchId: -1
+    property var validateBatches: ({})
+    property int validateFailed: 0
+    property int validateTotal: 0
+
+    function formatPose(result) {
+        // 格式化为 [x, y, z, a, b, c]
+        return JSON.stringify(result.pose.map(v => v.toFixed(3))) + (result.cached ? " (缓存)" : "")
+    }
+
     // 监听计算结果
     Connections {
-        target: RobotGlobal
-        function onRecvNormalMessage(msg) {
+        target: KinematicsGlobal
+        function onBatchFinished(batchId, results) {
             // 10.1 正解返回
-            if (msg.ty === "Robot/apostocpos") {
-                if (msg.db && Array.isArray(msg.db)) {
-                    // 格式化为 [x, y, z, a, b, c]
-                    forwardResult = JSON.stringify(msg.db.map(v => v.toFixed(3)))
-                } else {
-                    forwardResult = "计算失败"
-                }
+            if (batchId === forwardBatchId) {
+                forwardResult = results[0].ok ? formatPose(results[0]) : "计算失败"
             }
             // 10.2 逆解返回
-            else if (msg.ty === "Robot/cpostoapos") {
-                if (msg.db && Array.isArray(msg.db)) {
-                    inverseResult = JSON.stringify(msg.db.map(v => v.toFixed(3)))
-                } else {
-                    inverseResult = "计算失败 (可能无解或参数错误)"
+            else if (batchId === inverseBatchId) {
+                inverseResult = results[0].ok ? formatPose(results[0]) : "计算失败 (可能无解或参数错误)"
+            }
+            // 路径校验
+            else if (validateBatches[batchId] !== undefined) {
+                delete validateBatches[batchId]
+                for (var i = 0; i < results.length; i++) {
+                    if (!results[i].ok) validateFailed++
+                }
+                if (Object.keys(validateBatches).length === 0) {
+                    var s = KinematicsGlobal.stats()
+                    queueHint.text = "路径校验完成: " + (validateTotal - validateFailed) + " / " + validateTotal + " 可达"
+                                     + "  (缓存命中 " + s.hits + "，请求 " + s.misses + ")"
                 }
             }
         }
@@ -388,16 +403,9 @@ Item {
                                    jp.push(val)
                                }
 
-                               // 构造请求数据 (简化逻辑：假设 Tool/Coor 均为 0，如果需要可以扩展输入框)
-                               var req = {
-                                   "jp": jp,
-                                   "coor": [0,0,0,0,0,0],
-                                   "tool": [0,0,0,0,0,0],
-                                   "ep": []
-                               }
-
+                               // 简化逻辑：Tool/Coor 均为 0 (服务默认值)，如果需要可以扩展输入框
                                forwardResult = "计算中..."
-                               RobotGlobal.sendJsonRequest("Robot/apostocpos", JSON.stringify(req))
+                               forwardBatchId = KinematicsGlobal.forwardBatch([jp])
                            }
                        }
 
@@ -473,15 +481,9 @@ Item {
                                     cp.push(val)
                                 }
 
-                                // 构造请求 (rj 参考关节角默认为 20,20...)
-                                var req = {
-                                    "cp": cp,
-                                    "rj": [20,20,20,20,20,20],
-                                    "ep": []
-                                }
-
+                                // rj 参考关节角默认为 20,20...
                                 inverseResult = "计算中..."
-                                RobotGlobal.sendJsonRequest("Robot/cpostoapos", JSON.stringify(req))
+                                inverseBatchId = KinematicsGlobal.inverseBatch([cp], { "rj": [20,20,20,20,20,20] })
                             }
                         }
 
@@ -501,6 +503,158 @@ Item {
                 }
             }
 
+            // ============================================================
+            // 第六行：多路点运动队列 (连续发送，按 RunTo 状态推进)
+            // ============================================================
+            MotionCard {
+                title: qsTr("🧭 路径队列 (Motion Queue)")
+                iconColor: "#f59e0b"
+
+                content: ColumnLayout {
+                    spacing: 12
+
+                    // 1. 路点来源：上方输入框或文件
+                    RowLayout {
+                        spacing: 10
+
+                        Button {
+                            text: qsTr("+ 当前关节点")
+                            enabled: !MotionQueueGlobal.running
+                            onClicked: {
+                                var jp = []
+                                for (var i = 0; i < jointRepeater.count; i++) {
+                                    var val = parseFloat(jointRepeater.itemAt(i).inputValue)
+                                    jp.push(isNaN(val) ? 0.0 : val)
+                                }
+                                MotionQueueGlobal.addJointWaypoint(jp)
+                            }
+                        }
+                        Button {
+                            text: qsTr("+ 当前直线点")
+                            enabled: !MotionQueueGlobal.running
+                            onClicked: {
+                                var cp = []
+                                for (var i = 0; i < linearRepeater.count; i++) {
+                                    var val = parseFloat(linearRepeater.itemAt(i).inputValue)
+                                    cp.push(isNaN(val) ? 0.0 : val)
+                                }
+                                MotionQueueGlobal.addLinearWaypoint(cp)
+                            }
+                        }
+
+                        TextField {
+                            id: waypointFileInput
+                            Layout.preferredWidth: 320
+                            placeholderText: qsTr("路点文件 (*.json 或每行 J/L,6 个数值)")
+                            selectByMouse: true
+                        }
+                        Button {
+                            text: qsTr("📂 加载")
+                            enabled: !MotionQueueGlobal.running
+                            onClicked: {
+                                var n = MotionQueueGlobal.loadFile(waypointFileInput.text)
+                                if (n >= 0) queueHint.text = qsTr("已加载 ") + n + qsTr(" 个路点")
+                            }
+                        }
+                        Button {
+                            text: qsTr("清空")
+                            flat: true
+                            enabled: !MotionQueueGlobal.running
+                            onClicked: MotionQueueGlobal.clear()
+                        }
+                    }
+
+                    // 2. 执行控制
+                    RowLayout {
+                        spacing: 10
+
+                        Button {
+                            text: MotionQueueGlobal.running ? qsTr("⏹ 停止队列") : qsTr("▶ 执行队列")
+                            Layout.preferredHeight: 40; Layout.preferredWidth: 120
+                            background: Rectangle {
+                                radius: 6
+                                color: MotionQueueGlobal.running ? (parent.down ? "#b91c1c" : "#dc2626")
+                                                                 : (parent.down ? "#d97706" : "#f59e0b")
+                            }
+                            contentItem: Text { text: parent.text; color: "white"; font.bold: true; horizontalAlignment: Text.AlignHCenter; verticalAlignment: Text.AlignVCenter }
+                            onClicked: MotionQueueGlobal.running ? MotionQueueGlobal.stop() : MotionQueueGlobal.start()
+                        }
+
+                        CheckBox {
+                            text: qsTr("预发送下一段")
+                            checked: MotionQueueGlobal.preSend
+                            enabled: !MotionQueueGlobal.running
+                            onToggled: MotionQueueGlobal.preSend = checked
+                        }
+
+                        Text {
+                            text: qsTr("进度: ") + MotionQueueGlobal.finishedCount + " / " + MotionQueueGlobal.count
+                                  + (MotionQueueGlobal.running ? qsTr("  (当前第 ") + (MotionQueueGlobal.currentIndex + 1) + qsTr(" 段)") : "")
+                            font.family: "Consolas"
+                            color: "#374151"
+                        }
+
+                        Item { Layout.fillWidth: true }
+
+                        Button {
+                            text: KinematicsGlobal.busy ? qsTr("校验中...") : qsTr("✔ 校验路径")
+                            enabled: !KinematicsGlobal.busy && MotionQueueGlobal.count > 0
+                            onClicked: {
+                                // 关节点做正解、直线点做逆解，各一批流水线发送
+                                var jps = [], cps = []
+                                var list = MotionQueueGlobal.waypoints()
+                                for (var i = 0; i < list.length; i++) {
+                                    if (list[i].target.jp) jps.push(list[i].target.jp)
+                                    else if (list[i].target.cp) cps.push(list[i].target.cp)
+                                }
+                                var batches = {}
+                                if (jps.length > 0) batches[KinematicsGlobal.forwardBatch(jps)] = true
+                                if (cps.length > 0) batches[KinematicsGlobal.inverseBatch(cps, { "rj": [20,20,20,20,20,20] })] = true
+                                validateBatches = batches
+                                validateFailed = 0
+                                validateTotal = jps.length + cps.length
+                                queueHint.text = validateTotal > 0 ? "路径校验中..." : "没有可校验的路点"
+                            }
+                        }
+
+                        Button {
+                            text: qsTr("📤 导出计时")
+                            onClicked: {
+                                var path = MotionQueueGlobal.exportReport()
+                                queueHint.text = path !== "" ? qsTr("计时已导出: ") + path : qsTr("导出失败")
+                            }
+                        }
+                    }
+
+                    // 3. 计时汇总
+                    Text {
+                        id: queueSummary
+                        text: "--"
+                        font.family: "Consolas"
+                        color: "#059669"
+                    }
+                    Text {
+                        id: queueHint
+                        visible: text !== ""
+                        color: "#6b7280"
+                        font.pixelSize: 12
+                    }
+
+                    Connections {
+                        target: MotionQueueGlobal
+                        function onSegmentFinished(index, timing) {
+                            var s = MotionQueueGlobal.summary()
+                            queueSummary.text = "段 " + s.segments + (s.skipped > 0 ? " (跳过 " + s.skipped + ")" : "")
+                                    + " | " + s.segmentsPerSec.toFixed(2) + " 段/s"
+                                    + " | 响应 " + s.avgAckMs.toFixed(0) + "/" + s.maxAckMs.toFixed(0) + " ms"
+                                    + " | 运动 " + s.avgMoveMs.toFixed(0) + " ms"
+                                    + " | 段间空闲 " + s.avgOverheadMs.toFixed(0) + " ms"
+                        }
+                        function onErrorOccurred(errorMsg) { queueHint.text = "⚠ " + errorMsg }
+                    }
+                }
+            }
+
             Item { Layout.fillHeight: true }
         }
     }
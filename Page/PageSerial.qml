@@ -14,17 +14,68 @@ Item {
     property bool isHexSend: true
     property bool autoScroll: true
 
-    // 自动发送定时器
+    // 发送统计刷新 (自动发送由 C++ 精确调度器执行)
     Timer {
-        id: autoSendTimer
+        id: txStatsTimer
         interval: 1000
         repeat: true
-        onTriggered: sendData()
+        running: SerialGlobal.isScheduling
+        onTriggered: refreshTxStats()
+    }
+
+    function refreshTxStats() {
+        var s = SerialGlobal.scheduleStats()
+        if (s.framesSent === undefined) return
+        txStatsText.text = "已发 " + s.framesSent + " 帧  " + s.framesPerSec.toFixed(1) + " 帧/s  "
+                + (s.bytesPerSec / 1024).toFixed(1) + " KB/s  间隔 " + (s.meanIntervalUs / 1000).toFixed(2)
+                + "ms ±" + (s.jitterUs / 1000).toFixed(2) + "ms"
+                + (s.clampedSteps > 0 ? "  (间隔已提升至 " + (s.minDelayUs / 1000) + "ms，更快请用 0 间隔)" : "")
+    }
+
+    // 分帧统计刷新
+    Timer {
+        id: frameStatsTimer
+        interval: 1000
+        repeat: true
+        running: SerialGlobal.isConnected && comboFrame.currentIndex > 0
+        onTriggered: {
+            var s = SerialGlobal.frameStats()
+            frameStatsText.text = "帧: " + s.frameCount + "  CRC错: " + s.crcError
+                    + "  丢弃: " + s.droppedBytes + "B  平均帧长: " + s.avgLength.toFixed(1)
+        }
     }
 
     // ------------------------------------------------------------------
     // 逻辑函数
     // ------------------------------------------------------------------
+    function applyFrameMode() {
+        SerialGlobal.setFrameMode(comboFrame.currentText, {
+            "delimiterHex": delimiterInput.text,
+            "headerHex": headerInput.text,
+            "lengthOffset": lengthOffsetSpin.value,
+            "lengthSize": parseInt(lengthSizeCombo.currentText),
+            "bigEndian": bigEndianCheck.checked,
+            "lengthAdjust": lengthAdjustSpin.value,
+            "crc": crcCheck.checked
+        })
+        SerialGlobal.resetFrameStats()
+    }
+
+    // 自动发送：整段内容 (或按行拆成多步) 预先编码后交给 C++ 调度器
+    function startAutoSend() {
+        var text = inputArea.text
+        if (text === "") return
+
+        var interval = parseFloat(intervalInput.text)
+        if (isNaN(interval) || interval < 0) interval = 1000
+
+        var chunks = lineSequence.checked ? text.split("\n").filter(function(l) { return l.trim() !== "" }) : [text]
+        var steps = chunks.map(function(c) { return { "data": c, "hex": isHexSend, "delayMs": interval, "repeat": 1 } })
+
+        // 间隔为 0 时进入 burst 模式，按串口吞吐极限连续发送；其余间隔最小 2ms (C++ 调度器提升并在统计中提示)
+        SerialGlobal.startSchedule(steps, 0, interval === 0)
+    }
+
     function sendData() {
         if (!SerialGlobal.isConnected) return
         var text = inputArea.text
@@ -41,6 +92,11 @@ Item {
     Connections {
         target: SerialGlobal
 
+        // 自动发送停止后再刷新一次，显示最终统计
+        function onScheduleStatusChanged() {
+            if (!SerialGlobal.isScheduling) refreshTxStats()
+        }
+
         // 核心：接收数据
         function onMessageReceived(textMsg, hexMsg) {
             var content = isHexRecv ? hexMsg : textMsg
@@ -51,6 +107,21 @@ Item {
             }
         }
 
+        // 分帧模式：一次收到多帧，拼接后一次性插入，减少 TextArea 重排
+        function onFramesReceived(frames) {
+            var lines = ""
+            for (var i = 0; i < frames.length; i++) {
+                var f = frames[i]
+                var crcText = f.crc === 1 ? " [CRC OK]" : (f.crc === -1 ? " [CRC ERR]" : "")
+                lines += "[" + f.time + "]" + crcText + " " + (isHexRecv ? f.hex : f.text) + "\n"
+            }
+            logArea.insert(logArea.length, lines)
+
+            if (autoScroll) {
+                logArea.cursorPosition = logArea.length
+            }
+        }
+
         // 错误提示
         function onErrorOccurred(msg) {
             console.error(msg) // 或者弹窗提示
@@ -134,6 +205,83 @@ Item {
                     currentIndex: 0 // 默认 1
                 }
 
+                // 6. 分帧模式
+                SettingCombo {
+                    id: comboFrame
+                    label: "帧解析 (Framing)"
+                    model: ["Raw", "Delimiter", "LengthPrefix", "ModbusRTU"]
+                    currentIndex: 0 // 默认不分帧
+                    onCurrentIndexChanged: applyFrameMode()
+                }
+
+                RowLayout {
+                    visible: comboFrame.currentIndex === 1
+                    Text { text: "分隔符(HEX)"; font.pixelSize: 12; color: "#6b7280" }
+                    TextField {
+                        id: delimiterInput
+                        text: "0D0A"
+                        Layout.fillWidth: true
+                        onEditingFinished: applyFrameMode()
+                    }
+                }
+
+                // 长度前缀：帧总长 = 长度字段偏移 + 长度字段字节数 + 长度值 + 修正
+                GridLayout {
+                    visible: comboFrame.currentIndex === 2
+                    Layout.fillWidth: true
+                    columns: 2
+                    rowSpacing: 4
+
+                    Text { text: "帧头(HEX)"; font.pixelSize: 12; color: "#6b7280" }
+                    TextField {
+                        id: headerInput
+                        Layout.fillWidth: true
+                        placeholderText: "可选，如 AA55"
+                        onEditingFinished: applyFrameMode()
+                    }
+
+                    Text { text: "长度偏移"; font.pixelSize: 12; color: "#6b7280" }
+                    SpinBox {
+                        id: lengthOffsetSpin
+                        Layout.fillWidth: true
+                        from: 0; to: 64; value: 0
+                        editable: true
+                        onValueModified: applyFrameMode()
+                    }
+
+                    Text { text: "长度字节"; font.pixelSize: 12; color: "#6b7280" }
+                    ComboBox {
+                        id: lengthSizeCombo
+                        Layout.fillWidth: true
+                        model: ["1", "2", "4"]
+                        onActivated: applyFrameMode()
+                    }
+
+                    Text { text: "长度修正"; font.pixelSize: 12; color: "#6b7280" }
+                    SpinBox {
+                        id: lengthAdjustSpin
+                        Layout.fillWidth: true
+                        from: -255; to: 255; value: 0
+                        editable: true
+                        onValueModified: applyFrameMode()
+                    }
+
+                    CheckBox {
+                        id: bigEndianCheck
+                        Layout.columnSpan: 2
+                        text: "长度大端 (高字节在前)"
+                        checked: true
+                        onCheckedChanged: applyFrameMode()
+                    }
+                }
+
+                CheckBox {
+                    id: crcCheck
+                    text: "校验帧尾 CRC16"
+                    visible: comboFrame.currentIndex === 1 || comboFrame.currentIndex === 2
+                    onCheckedChanged: applyFrameMode()
+                }
+
                 Item { Layout.fillHeight: true } // 弹簧
 
                 // 开关按钮
@@ -235,6 +383,18 @@ Item {
                     anchors.margins: 10
                     opacity: 0.5
                 }
+
+                // 分帧统计
+                Text {
+                    id: frameStatsText
+                    visible: comboFrame.currentIndex > 0
+                    color: "#6b7280"
+                    font.family: "Consolas"
+                    font.pixelSize: 12
+                    anchors.right: parent.right
+                    anchors.bottom: parent.bottom
+                    anchors.margins: 10
+                }
             }
 
             // 2. 发送区 (剩余高度)
@@ -275,8 +435,26 @@ Item {
                             CheckBox { text: "HEX发送"; checked: isHexSend; onCheckedChanged: isHexSend = checked }
                             CheckBox { text: "自动滚动"; checked: autoScroll; onCheckedChanged: autoScroll = checked }
 
+                            // 录制到文件 (工作线程内流式写盘)
+                            CheckBox {
+                                text: SerialGlobal.isCapturing ? "⏺ 录制中" : "录制"
+                                checked: SerialGlobal.isCapturing
+                                onClicked: {
+                                    if (checked) SerialGlobal.startCapture()
+                                    else SerialGlobal.stopCapture()
+                                }
+                            }
+
                             Item { Layout.fillWidth: true } // 弹簧
 
+                            Button {
+                                text: "📂 查看录制"
+                                flat: true
+                                onClicked: {
+                                    capturePathInput.text = SerialGlobal.capturePath
+                                    captureViewer.open()
+                                }
+                            }
                             Button {
                                 text: "🗑️ 清空接收"
                                 flat: true
@@ -318,18 +496,30 @@ Item {
                         Item { Layout.fillWidth: true }
 
                         // 自动发送设置
+                        Text { id: txStatsText; color: "#6b7280"; font.family: "Consolas"; font.pixelSize: 12 }
+
+                        CheckBox {
+                            id: lineSequence
+                            text: "逐行序列"
+                        }
                         CheckBox {
                             text: "自动发送"
-                            checked: autoSendTimer.running
-                            onCheckedChanged: autoSendTimer.running = checked
+                            checked: SerialGlobal.isScheduling
+                            onClicked: {
+                                if (checked) startAutoSend()
+                                else SerialGlobal.stopSchedule()
+                            }
                         }
                         TextField {
                             id: intervalInput
                             text: "1000"
                             placeholderText: "ms"
                             Layout.preferredWidth: 60
-                            validator: IntValidator { bottom: 10 }
-                            onEditingFinished: autoSendTimer.interval = parseInt(text)
+                            validator: DoubleValidator { bottom: 0 }
+                            onEditingFinished: {
+                                // 运行中修改间隔：按新参数重新排程
+                                if (SerialGlobal.isScheduling) startAutoSend()
+                            }
                         }
                         Text { text: "ms"; color: "#6b7280" }
 
@@ -359,6 +549,60 @@ Item {
         }
     }
 
+    // ------------------------------------------------------------------
+    // 录制文件查看 (内存映射，后台建索引，只按需解码可见行)
+    // ------------------------------------------------------------------
+    SerialCaptureModel { id: captureModel }
+
+    Popup {
+        id: captureViewer
+        anchors.centerIn: parent
+        width: parent.width * 0.8
+        height: parent.height * 0.8
+        modal: true
+        onClosed: captureModel.close()
+
+        ColumnLayout {
+            anchors.fill: parent
+            spacing: 10
+
+            RowLayout {
+                Layout.fillWidth: true
+                TextField {
+                    id: capturePathInput
+                    Layout.fillWidth: true
+                    placeholderText: "录制文件路径 (*.scap)"
+                }
+                Button {
+                    text: "打开"
+                    onClicked: captureModel.open(capturePathInput.text)
+                }
+                Text {
+                    text: "共 " + captureModel.recordCount + " 条"
+                          + (captureModel.indexing ? " (索引中 " + Math.round(captureModel.indexProgress * 100) + "%)" : "")
+                    color: "#6b7280"
+                }
+            }
+
+            ListView {
+                Layout.fillWidth: true
+                Layout.fillHeight: true
+                clip: true
+                model: captureModel
+                ScrollBar.vertical: ScrollBar { }
+
+                delegate: Text {
+                    width: ListView.view.width
+                    text: "[" + model.time + "] " + model.direction + " " + (isHexRecv ? model.hex : model.text)
+                    color: model.direction === "TX" ? "#2563eb" : "#059669"
+                    font.family: "Consolas"
+                    font.pixelSize: 12
+                    elide: Text.ElideRight
+                }
+            }
+        }
+    }
+
     // ------------------------------------------------------------------
     // 组件封装
     // ------------------------------------------------------------------
@@ -166,40 +166,50 @@ Item {
     }
 
     function updateGlobalTable(db) {
-        // 简单的 Diff 更新或全量重置，这里用全量重置保证一致性
-        // 生产环境可用 Diff 算法优化性能
-        globalVarModel.clear()
-        if (!db) return
-
-        for (var key in db) {
-            var item = db[key]
-            globalVarModel.append({
-                "key": key,
-                "value": String(item.val),
-                "note": String(item.nm || "")
-            })
+        WatchdogGlobal.enter("PageVariable.updateGlobalTable")
+        try {
+            // 简单的 Diff 更新或全量重置，这里用全量重置保证一致性
+            // 生产环境可用 Diff 算法优化性能
+            globalVarModel.clear()
+            if (!db) return
+
+            for (var key in db) {
+                var item = db[key]
+                globalVarModel.append({
+                    "key": key,
+                    "value": String(item.val),
+                    "note": String(item.nm || "")
+                })
+            }
+        } finally {
+            WatchdogGlobal.leave()
         }
     }
 
     function updateProjectTable(db) {
-        projectVarModel.clear()
-        if (!db) return
-
-        for (var key in db) {
-            var item = db[key]
-            var displayVal = ""
-
-            // 工程变量可能是复杂对象（如点位）
-            if (typeof item === 'object') {
-                displayVal = JSON.stringify(item)
-            } else {
-                displayVal = String(item)
-            }
+        WatchdogGlobal.enter("PageVariable.updateProjectTable")
+        try {
+            projectVarModel.clear()
+            if (!db) return
+
+            for (var key in db) {
+                var item = db[key]
+                var displayVal = ""
+
+                // 工程变量可能是复杂对象（如点位）
+                if (typeof item === 'object') {
+                    displayVal = JSON.stringify(item)
+                } else {
+                    displayVal = String(item)
+                }
 
-            projectVarModel.append({
-                "key": key,
-                "value": displayVal
-            })
+                projectVarModel.append({
+                    "key": key,
+                    "value": displayVal
+                })
+            }
+        } finally {
+            WatchdogGlobal.leave()
         }
     }
 
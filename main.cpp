@@ -4,8 +4,24 @@
 #include <QQuickStyle>
 #include <QImage>
 #include <QIcon> // 引入头文件
+#include <QDebug>
 #include "./src/RobotClient.h" // 包含头文件
 #include "./src/SerialClient.h"
+#include "./src/serialcapture.h"
+#include "./src/diagnosticsclient.h"
+#include "./src/logindex.h"
+#include "./src/binarylog.h"
+#include "./src/telemetryclient.h"
+#include "./src/motionqueue.h"
+#include "./src/kinematicsservice.h"
+#include "./src/soakharness.h"
+#include "./src/impairmentproxy.h"
+#include "./src/guiwatchdog.h"
+#include "./src/relaybroker.h"
+#include "./src/latencysweep.h"
+#include "./src/clocksync.h"
+#include "./src/iocapture.h"
+#include "./src/iotimeline.h"
 
 int main(int argc, char *argv[])
 {
@@ -14,6 +30,20 @@ int main(int argc, char *argv[])
 
     QGuiApplication app(argc, argv);
 
+    // 命令行转换二进制日志: CodroidAPITestTool --convert-log <in.blog> [out.txt]
+    const QStringList args = app.arguments();
+    const int convertIndex = args.indexOf("--convert-log");
+    if (convertIndex >= 0 && convertIndex + 1 < args.size()) {
+        const QString inPath = args.at(convertIndex + 1);
+        const QString outPath = convertIndex + 2 < args.size() ? args.at(convertIndex + 2) : inPath + ".txt";
+        QString error;
+        if (!BinaryLogReader::convertToText(inPath, outPath, &error)) {
+            qWarning() << "convert failed:" << error;
+            return 1;
+        }
+        return 0;
+    }
+
     QImage img(":/estun.png"); // 假设你原来的图其实是 png
     if (!img.isNull()) {
         img.save("real_icon.ico", "ICO"); // Qt 支持保存为 ICO
@@ -31,9 +61,60 @@ int main(int argc, char *argv[])
     qmlRegisterSingletonInstance("MyRobot", 1, 0, "RobotGlobal", robotClient);
 
 
+    // 遥测录制与回放 (回放时把记录的报文注入 RobotGlobal)
+    TelemetryClient *telemetryClient = new TelemetryClient(robotClient, &app);
+    qmlRegisterSingletonInstance("MyRobot", 1, 0, "TelemetryGlobal", telemetryClient);
+
+    // 多路点运动队列 (基于 sendRunTo，按 RunTo 状态切换推进)
+    MotionQueue *motionQueue = new MotionQueue(robotClient, &app);
+    qmlRegisterSingletonInstance("MyRobot", 1, 0, "MotionQueueGlobal", motionQueue);
+
+    // 批量正逆解 (流水线请求 + LRU 结果缓存)
+    KinematicsService *kinematicsService = new KinematicsService(robotClient, &app);
+    qmlRegisterSingletonInstance("MyRobot", 1, 0, "KinematicsGlobal", kinematicsService);
+
     SerialClient *serialClient = new SerialClient(&app);
     qmlRegisterSingletonInstance("MyRobot", 1, 0, "SerialGlobal", serialClient);
 
+    // 串口录制文件查看模型 (可在 QML 中直接实例化)
+    qmlRegisterType<SerialCaptureModel>("MyRobot", 1, 0, "SerialCaptureModel");
+
+    // 日志检索模型 (Logs/*.txt 索引与搜索)
+    qmlRegisterType<LogSearchModel>("MyRobot", 1, 0, "LogSearchModel");
+
+    // 诊断指标 (计数器/直方图快照、定期导出到 Logs/)
+    DiagnosticsClient *diagnosticsClient = new DiagnosticsClient(&app);
+    qmlRegisterSingletonInstance("MyRobot", 1, 0, "DiagnosticsGlobal", diagnosticsClient);
+
+    // 长稳测试 (本地模拟控制器 + 内存 / 延迟采样)
+    SoakHarness *soakHarness = new SoakHarness(robotClient, &app);
+    qmlRegisterSingletonInstance("MyRobot", 1, 0, "SoakGlobal", soakHarness);
+
+    // 网络损伤代理 (延迟 / 抖动 / 带宽 / 分段 / 停顿，测试心跳保活)
+    ImpairmentProxy *impairmentProxy = new ImpairmentProxy(robotClient, &app);
+    qmlRegisterSingletonInstance("MyRobot", 1, 0, "ImpairGlobal", impairmentProxy);
+
+    // 本地中继 (其他工具经本程序共用同一个控制器连接)
+    RelayBroker *relayBroker = new RelayBroker(robotClient, &app);
+    qmlRegisterSingletonInstance("MyRobot", 1, 0, "RelayGlobal", relayBroker);
+
+    // API 延迟扫描 (各端点往返时间分位数与吞吐)
+    LatencySweep *latencySweep = new LatencySweep(robotClient, &app);
+    qmlRegisterSingletonInstance("MyRobot", 1, 0, "SweepGlobal", latencySweep);
+
+    // GUI 事件循环看门狗 (卡顿检测与 QML 处理函数耗时归因)
+    GuiWatchdog *guiWatchdog = new GuiWatchdog(&app);
+    qmlRegisterSingletonInstance("MyRobot", 1, 0, "WatchdogGlobal", guiWatchdog);
+
+    // 控制器时钟同步 (偏移 / 漂移估计，控制器到界面的延迟)
+    ClockSync *clockSync = new ClockSync(robotClient, &app);
+    qmlRegisterSingletonInstance("MyRobot", 1, 0, "ClockGlobal", clockSync);
+
+    // IO 高速采集 (逻辑分析仪) 与时间轴控件
+    IOCapture *ioCapture = new IOCapture(robotClient, &app);
+    qmlRegisterSingletonInstance("MyRobot", 1, 0, "IOCaptureGlobal", ioCapture);
+    qmlRegisterType<IOTimeline>("MyRobot", 1, 0, "IOTimeline");
+
     QQmlApplicationEngine engine;
     QObject::connect(
         &engine,
@@ -43,5 +124,17 @@ int main(int argc, char *argv[])
         Qt::QueuedConnection);
     engine.loadFromModule("CodroidAPITestTool", "Main");
 
+    // 命令行长稳测试: CodroidAPITestTool --soak <分钟>，界面照常运行，结束后按结果退出 (0=通过，2=失败)
+    const int soakIndex = args.indexOf("--soak");
+    if (soakIndex >= 0) {
+        QVariantMap options;
+        if (soakIndex + 1 < args.size()) options["durationMin"] = args.at(soakIndex + 1).toInt();
+        QObject::connect(soakHarness, &SoakHarness::finished, &app, [](bool passed, const QString &reportPath) {
+            qInfo() << "soak finished:" << (passed ? "PASS" : "FAIL") << reportPath;
+            QCoreApplication::exit(passed ? 0 : 2);
+        });
+        if (!soakHarness->start(options)) return 1;
+    }
+
     return app.exec();
 }
@@ -1,4 +1,83 @@
 #include "RobotClient.h"
+#include "metrics.h"
+#include "tracer.h"
+#include "binarylog.h"
+#include "requestcache.h"
+#include "framescanner.h"
+#include "guiwatchdog.h"
+#include "relaybroker.h"
+#include "clocksync.h"
+
+#include <QSettings>
+#include <QMetaMethod>
+
+namespace {
+
+// RobotClient 热路径指标：首次使用时注册一次，之后只做原子累加
+struct RobotMetrics
+{
+    MetricCounter *bytesIn;
+    MetricCounter *bytesOut;
+    MetricCounter *framesIn;
+    MetricCounter *garbageDrops;
+    MetricCounter *discardedBytes;
+    MetricCounter *parseErrors;
+    MetricCounter *connects;
+    MetricCounter *reconnects;
+    MetricCounter *disconnects;
+    MetricCounter *requestCacheHits;
+    MetricCounter *requestsCollapsed;
+    MetricCounter *scannedFrames;
+    MetricGauge *connected;
+    MetricGauge *receiveBuffer;
+    MetricHistogram *frameSize;
+    MetricHistogram *parseTimeUs;
+    MetricHistogram *heartbeatIntervalUs;
+
+    RobotMetrics()
+    {
+        MetricsRegistry &r = MetricsRegistry::instance();
+        bytesIn = r.counter("robot_bytes_received_total", "Bytes read from the controller socket");
+        bytesOut = r.counter("robot_bytes_sent_total", "Bytes written to the controller socket");
+        framesIn = r.counter("robot_frames_received_total", "Complete JSON frames extracted from the stream");
+        garbageDrops = r.counter("robot_framer_garbage_drops_total", "Receive buffer cleared because it held no '{'");
+        discardedBytes = r.counter("robot_framer_discarded_bytes_total", "Bytes skipped before a frame start");
+        parseErrors = r.counter("robot_parse_errors_total", "Frames that failed JSON parsing");
+        connects = r.counter("robot_connects_total", "Successful connections");
+        reconnects = r.counter("robot_reconnects_total", "Connections after the first one");
+        disconnects = r.counter("robot_disconnects_total", "Disconnections");
+        requestCacheHits = r.counter("robot_request_cache_hits_total", "Idempotent reads answered from the TTL cache");
+        requestsCollapsed = r.counter("robot_requests_collapsed_total",
+                                      "Idempotent reads merged into an identical in-flight request");
+        scannedFrames = r.counter("robot_frames_scanned_total",
+                                  "publish/* frames decoded by FrameScanner without building a DOM");
+        connected = r.gauge("robot_connected", "1 while the controller socket is connected");
+        receiveBuffer = r.gauge("robot_receive_buffer_bytes", "Bytes waiting in m_receiveBuffer");
+        frameSize = r.histogram("robot_frame_size_bytes", "Size of received JSON frames",
+                                MetricsRegistry::sizeBucketsBytes());
+        parseTimeUs = r.histogram("robot_parse_time_us", "JSON parse / field scan time per frame",
+                                  MetricsRegistry::latencyBucketsUs());
+        heartbeatIntervalUs = r.histogram("robot_heartbeat_interval_us", "Interval between moveToHeartbeat sends",
+                                          { 400000, 450000, 480000, 490000, 500000, 510000, 520000,
+                                            550000, 600000, 750000, 1000000, 2000000 });
+    }
+};
+
+RobotMetrics &robotMetrics()
+{
+    static RobotMetrics metrics;
+    return metrics;
+}
+
+// DOM 路径 (回放注入、扫描失败) 的推送同样写入结构体，界面属性与实时帧一致
+template <class Frame>
+void extractFromDom(const QJsonObject &root, Frame &frame)
+{
+    frame = Frame();
+    frame.present = FrameScanner::extract(QJsonDocument(root).toJson(QJsonDocument::Compact), Frame::fields(), &frame);
+}
+
+} // namespace
 
 // 构造函数实现
 // 冒号(:)后面是“成员初始化列表”，这比在大括号里写赋值语句效率更高
@@ -6,6 +85,9 @@ RobotClient::RobotClient(QObject *parent)
     : QObject(parent)                  // 1. 先初始化基类 QObject，确立对象树关系，(parent代表实例化时需传入父类，否则为顶级对象)
     , m_socket(new QTcpSocket(this))   // 2. 实例化 Socket，传入 this 将其挂载到本对象下，随本对象自动销毁
     , m_heartbeatTimer(new QTimer(this)) // 3. 实例化定时器，同样指定 this 为父对象，无需手动 delete}
+    , m_logFlushTimer(new QTimer(this))
+    , m_requestCache(std::make_unique<RequestCache>())
+    , m_replyTimeoutTimer(new QTimer(this))
 {
     // 设置心跳间隔 500ms
     m_heartbeatTimer->setInterval(500);
@@ -26,12 +108,24 @@ RobotClient::RobotClient(QObject *parent)
 
     connect(m_socket, &QTcpSocket::errorOccurred, this, &RobotClient::onErrorOccurred);
 
-    // 连接stateChanged信号 -> 调用onSocketStateChanged()函数
-    connect(this, &RobotClient::recvRobotStatusMessage, this, &RobotClient::onhandleRobotStatus);
-
     // [新增] 初始化日志系统
     initLogSystem();
 
+    // [新增] 二进制日志：按上次的选择恢复，记录在内存块中攒批，每秒落盘一次
+    m_logFlushTimer->setInterval(1000);
+    connect(m_logFlushTimer, &QTimer::timeout, this, [this]() {
+        QMutexLocker locker(&m_logMutex);
+        if (m_binaryLog) m_binaryLog->flush();
+    });
+    QSettings settings(getAppDir() + "/config.ini", QSettings::IniFormat);
+    setBinaryLog(settings.value("Log/binary", false).toBool());
+    m_requestCache->setTtlMs(settings.value("Request/cacheTtlMs", m_requestCache->ttlMs()).toInt());
+
+    // [新增] 强类型请求回调的超时检查
+    m_replyClock.start();
+    m_replyTimeoutTimer->setInterval(1000);
+    connect(m_replyTimeoutTimer, &QTimer::timeout, this, [this]() { failReplyHandlers(false); });
+
     // 连接 bytesWritten 信号，确认数据真的发出去了
     // connect(m_socket, &QTcpSocket::bytesWritten, this, [](qint64 bytes){
     //             qDebug() << "[系统] 成功向网络层写入字节数:" << bytes;
@@ -70,6 +164,10 @@ RobotClient::~RobotClient()
         m_socket->abort();  // 立即中止
     }
     writeLog(QString("RobotClien销毁完成"));
+
+    // 二进制日志析构时把剩余内存块落盘
+    QMutexLocker locker(&m_logMutex);
+    m_binaryLog.reset();
 }
 
 // 是否连接
@@ -142,32 +240,30 @@ void RobotClient::disconnectFromRobot()
 }
 
 // 发送Json数据
-void RobotClient::sendJsonRequest(const QString &type, const QVariant &data)
+QString RobotClient::sendJsonRequest(const QString &type, const QVariant &data)
 {
-    if(!isConnected()) return;
-
-    QJsonObject root;
-    root["id"] = QString::number(++m_requestId);
-    root["ty"] = type;
+    if(!isConnected()) return QString();
 
+    // QML / 自由格式测试页面的入口：按 QVariant 的实际类型转换 db
+    QJsonValue db;
     if (data.isNull()) {
-        root["db"] = QJsonValue::Null;
+        db = QJsonValue::Null;
     }
     // 处理整数
     else if (data.typeId() == QMetaType::Int || data.typeId() == QMetaType::LongLong || data.typeId() == QMetaType::UInt) {
-        root["db"] = data.toLongLong();
+        db = data.toLongLong();
     }
     // 处理浮点数
     else if (data.typeId() == QMetaType::Double || data.typeId() == QMetaType::Float) {
-        root["db"] = data.toDouble();
+        db = data.toDouble();
     }
     // 处理 JSON 对象
     else if (data.typeId() == QMetaType::QJsonObject) {
-        root["db"] = data.toJsonObject();
+        db = data.toJsonObject();
     }
     // 处理 JSON 数组
     else if (data.typeId() == QMetaType::QJsonArray) {
-        root["db"] = data.toJsonArray();
+        db = data.toJsonArray();
     }
     // ----------------------------------------------------------------------
     // 【关键修改】优先处理字符串，尝试解析 JSON
@@ -181,44 +277,94 @@ void RobotClient::sendJsonRequest(const QString &type, const QVariant &data)
 
         if (err.error == QJsonParseError::NoError) {
             if (subDoc.isObject()) {
-                root["db"] = subDoc.object();
+                db = subDoc.object();
                 // writeLog("[DEBUG] 字符串成功解析为 JSON 对象");
             }
             else if (subDoc.isArray()) {
-                root["db"] = subDoc.array();
+                db = subDoc.array();
                 // writeLog("[DEBUG] 字符串成功解析为 JSON 数组");
             }
             else {
-                root["db"] = strData;
+                db = strData;
             }
         } else {
             // 解析失败，说明是普通字符串
-            root["db"] = strData;
+            db = strData;
         }
     }
     // 【新增】处理 QML 传过来的数组 (QVariantList) -> 转为 QJsonArray
     else if (data.canConvert<QVariantList>()) {
-        root["db"] = QJsonArray::fromVariantList(data.toList());
+        db = QJsonArray::fromVariantList(data.toList());
     }
     // 【新增】处理 QML 传过来的对象 (QVariantMap) -> 转为 QJsonObject
     else if (data.canConvert<QVariantMap>()) {
 
         QJsonObject dbObj = QJsonObject::fromVariantMap(data.toMap());
-        root["db"] = dbObj;
+        db = dbObj;
         // 【调试日志】看看转出来的 JSON 对不对
         // writeLog("C++ QVariantMap 转换结果:" + QJsonDocument(dbObj).toJson(QJsonDocument::Compact));
     }
     // 其他情况（字符串等）
     else {
-        root["db"] = QJsonValue::fromVariant(data);
+        db = QJsonValue::fromVariant(data);
+    }
+
+    return sendJsonValue(type, db);
+}
+
+// 发送 db 已构造好的请求 (强类型请求与 C++ 服务直接走这里)
+QString RobotClient::sendJsonValue(const QString &type, const QJsonValue &db)
+{
+    if(!isConnected()) return QString();
+
+    TRACE_SCOPE_ARG("sendJsonRequest", "robot", type);
+
+    QJsonObject root;
+    root["ty"] = type;
+    root["db"] = db;
+
+    // [新增] 幂等读请求合并 / 缓存，写请求使相关缓存失效
+    const RequestCache::Policy policy = RequestCache::classify(type);
+    QByteArray cacheKey;
+    if (policy.kind == RequestCache::Write) {
+        m_requestCache->invalidate(policy.resources);
+    } else if (policy.kind == RequestCache::Read) {
+        cacheKey = RequestCache::makeKey(type, db);
+
+        QJsonObject cached;
+        if (m_requestCache->lookup(cacheKey, cached)) {
+            // 缓存命中：换上新的 id 后异步分发，调用方看到的时序与真实回复一致
+            const QString id = QString::number(++m_requestId);
+            cached["id"] = id;
+            robotMetrics().requestCacheHits->add();
+            QMetaObject::invokeMethod(this, [this, cached] { injectMessage(cached); }, Qt::QueuedConnection);
+            return id;
+        }
+
+        // 相同请求在途：不再发送，回复到达时经 recvNormalMessage 广播给所有页面
+        const QString inFlightId = m_requestCache->inFlightId(cacheKey);
+        if (!inFlightId.isEmpty()) {
+            robotMetrics().requestsCollapsed->add();
+            return inFlightId;
+        }
+    }
+
+    root["id"] = QString::number(++m_requestId);
+    if (policy.kind == RequestCache::Read) {
+        m_requestCache->beginRead(root.value("id").toString(), type, cacheKey, policy);
     }
 
     QJsonDocument doc(root);
-    m_socket->write(doc.toJson(QJsonDocument::Compact));
+    const QByteArray payload = doc.toJson(QJsonDocument::Compact);
+    m_socket->write(payload);
+
+    robotMetrics().bytesOut->add(payload.size());
+    typeCounter(type, true)->add();
 
     if(type != "Robot/moveToHeartbeat") {
-        writeLog("发送: " + doc.toJson(QJsonDocument::Compact));
+        writeSendLog(type, payload);
     }
+    return root.value("id").toString();
 }
 
 void RobotClient::sendStringRequest(const QString &message)
@@ -235,12 +381,15 @@ void RobotClient::sendStringRequest(const QString &message)
         return;
     }
 
+    TRACE_SCOPE("sendStringRequest", "robot");
+
     // 3. 将 QString 转换为 UTF-8 编码的字节流
     // 网络传输通常标准为 UTF-8
     QByteArray data = message.toUtf8();
 
     // 4. 写入 Socket
     qint64 bytesWritten = m_socket->write(data);
+    if (bytesWritten > 0) robotMetrics().bytesOut->add(bytesWritten);
 
     // 【建议新增】强制刷新缓冲区，确保数据立刻发出去，而不是停在内存里
     m_socket->flush();
@@ -267,23 +416,22 @@ void RobotClient::sendRunTo(int moveType, const QJsonObject &targetJson)
         return;
     }
 
-    // 1. 构建 Robot/moveTo 的 db 字段
-    QJsonObject dbObj;
-    dbObj["type"] = moveType;
-    if (!targetJson.isEmpty()) {
-        dbObj["target"] = targetJson;
-    }
+    // 1. 构建 Robot/moveTo 请求，目标对象原样放入 target
+    RobotProtocol::Robot::MoveTo request;
+    request.type = moveType;
+    request.extraTarget = targetJson;
+    const QJsonValue dbObj = request.toDb();
 
     // --- [新增] 打印 dbObj 内容 ---
     // QJsonDocument::Compact 表示压缩格式（一行显示），如果想换行显示可以用 QJsonDocument::Indented
-    QJsonDocument doc(dbObj);
+    QJsonDocument doc(dbObj.toObject());
     QString jsonString(doc.toJson(QJsonDocument::Compact));
     writeLog(QString(">>> RunTo 数据包内容: %1").arg(jsonString));
 
 
     // 2. 发送请求
     writeLog(QString(">>> 启动 RunTo (Type: %1)").arg(moveType));
-    sendJsonRequest("Robot/moveTo", dbObj);
+    sendJsonValue(QLatin1String(request.kType), dbObj);
 
     // [新增] 每次发送新的 RunTo，重置非运行状态计数器
     m_nonRunToStateCount = 0;
@@ -293,10 +441,56 @@ void RobotClient::sendRunTo(int moveType, const QJsonObject &targetJson)
     if (!m_heartbeatTimer->isActive()) {
         writeLog(">>> 开启心跳定时器");
         m_heartbeatTimer->start();
+        m_heartbeatClock.invalidate(); // 新的心跳会话，第一次间隔不计入
     }
 
 }
 
+void RobotClient::setHeartbeatHold(bool hold)
+{
+    if (m_heartbeatHold == hold) return;
+    m_heartbeatHold = hold;
+    m_nonRunToStateCount = 0; // 释放后重新开始去抖计数
+    writeLog(hold ? ">>> 运动队列: 保持心跳会话" : "<<< 运动队列: 释放心跳会话");
+}
+
+QString RobotClient::sendProbe(const QString &type, const QJsonValue &db, QObject *context,
+                               std::function<void(const QJsonObject *root)> callback)
+{
+    if (!isConnected()) return QString();
+
+    const RequestCache::Policy policy = RequestCache::classify(type);
+    if (policy.kind == RequestCache::Write) m_requestCache->invalidate(policy.resources);
+
+    const QString id = QString::number(++m_requestId);
+    const QByteArray payload = QJsonDocument(QJsonObject{ { "id", id }, { "ty", type }, { "db", db } })
+                                   .toJson(QJsonDocument::Compact);
+    const qint64 written = m_socket->write(payload);
+    if (written < 0) return QString();
+    robotMetrics().bytesOut->add(written);
+    typeCounter(type, true)->add();
+
+    m_quietReplyIds.insert(id);
+    addReplyHandler(id, type, context, std::move(callback));
+    return id;
+}
+
+qint64 RobotClient::writeRelayFrame(const QString &type, const QByteArray &frame)
+{
+    if (!isConnected()) return -1;
+
+    // 下游的写请求同样会改变控制器状态，本地缓存的读结果要失效
+    const RequestCache::Policy policy = RequestCache::classify(type);
+    if (policy.kind == RequestCache::Write) m_requestCache->invalidate(policy.resources);
+
+    const qint64 written = m_socket->write(frame);
+    if (written > 0) {
+        robotMetrics().bytesOut->add(written);
+        typeCounter(type, true)->add();
+    }
+    return written;
+}
+
 // 心跳发送
 void RobotClient::onHeartbeatTimer()
 {
@@ -305,10 +499,17 @@ void RobotClient::onHeartbeatTimer()
         return;
     }
 
-    // 发送 Robot/moveToHeartbeat
-    // 心跳包 db 为 null，sendJsonRequest 支持传空
+    TRACE_SCOPE("heartbeat", "timer");
+
+    // 记录实际心跳间隔 (定时器被 GUI 阻塞时会明显大于 500ms)
+    if (m_heartbeatClock.isValid()) {
+        robotMetrics().heartbeatIntervalUs->observe(m_heartbeatClock.nsecsElapsed() / 1000);
+    }
+    m_heartbeatClock.start();
+
+    // 发送 Robot/moveToHeartbeat，心跳包 db 为 null
     // writeLog(">>> 发送心跳..."); // 日志可能会刷屏，可视情况注释掉
-    sendJsonRequest("Robot/moveToHeartbeat");
+    send(RobotProtocol::Robot::MoveToHeartbeat{});
 }
 
 // 手动订阅
@@ -323,21 +524,21 @@ void RobotClient::subscribeTopic(const QString &topic)
 
 }
 
+const QStringList &RobotClient::defaultTopics()
+{
+    return RobotProtocol::topics();
+}
+
 void RobotClient::subscribeAll(){
     if (!isConnected()) {
         writeLog("未连接，自动订阅取消");
         return;
     }
 
-    QStringList topics = {
-        "{\"ty\":\"publish/ProjectState\",\"tc\":0}",
-        "{\"ty\":\"publish/VarUpdate\",\"tc\":0}",
-        "{\"ty\":\"publish/RobotStatus\",\"tc\":0}",
-        "{\"ty\":\"publish/RobotPosture\",\"tc\":0}",
-        "{\"ty\":\"publish/RobotCoordinate\",\"tc\":0}",
-        "{\"ty\":\"publish/Log\",\"tc\":0}",
-        "{\"ty\":\"publish/Error\",\"tc\":0}"
-    };
+    QStringList topics;
+    for (const QString &topic : defaultTopics()) {
+        topics << QString("{\"ty\":\"%1\",\"tc\":0}").arg(topic);
+    }
 
     // 【关键修改】使用延时发送，避免瞬间发出一坨数据导致粘包
     int delay = 0;
@@ -362,14 +563,20 @@ void RobotClient::subscribeAll(){
 // [重写] 更健壮的 onReadyRead：带调试日志 + 自动去除头部杂乱数据
 void RobotClient::onReadyRead()
 {
+    TRACE_SCOPE("socket.read", "robot");
+
     QByteArray newData = m_socket->readAll();
     if (newData.isEmpty()) return;
+    m_frameRecvNs = Tracer::nowNs(); // 本次读到的各帧共用接收时刻，排在后面的帧等待前面的分发也算进界面延迟
 
     // [强制日志] 打印收到的字节数和前20个字符（转为Hex防止乱码干扰）
     // writeLog(QString(">>> 底层收到数据: %1 字节, 内容(Hex): %2")
     //              .arg(newData.size())
     //              .arg(QString(newData.toHex().left(40))));
 
+    RobotMetrics &metrics = robotMetrics();
+    metrics.bytesIn->add(newData.size());
+
     // 1. 追加数据
     m_receiveBuffer.append(newData);
 
@@ -384,6 +591,8 @@ void RobotClient::onReadyRead()
             // 稍微保留一点（防止数据还没传完），如果太长了就清空
             if (m_receiveBuffer.size() > 100) {
                  writeLog(">>> 警告: 缓冲区全是垃圾数据，清空");
+                metrics.garbageDrops->add();
+                metrics.discardedBytes->add(m_receiveBuffer.size());
                 m_receiveBuffer.clear();
             }
             break; // 等待下一次 readReady
@@ -392,6 +601,7 @@ void RobotClient::onReadyRead()
         // 如果 '{' 不是在第0位，说明前面有垃圾数据（例如换行符），删掉前面的
         if (firstBraceIndex > 0) {
             writeLog("[DEBUG] 丢弃头部无效数据字节数");
+            metrics.discardedBytes->add(firstBraceIndex);
             m_receiveBuffer.remove(0, firstBraceIndex);
         }
 
@@ -400,17 +610,20 @@ void RobotClient::onReadyRead()
         int closeBrace = 0;
         int jsonEndIndex = -1;
 
-        for (int i = 0; i < m_receiveBuffer.size(); ++i) {
-            if (m_receiveBuffer.at(i) == '{') {
-                openBrace++;
-            } else if (m_receiveBuffer.at(i) == '}') {
-                closeBrace++;
-            }
-
-            // 找到完整闭合
-            if (openBrace > 0 && openBrace == closeBrace) {
-                jsonEndIndex = i;
-                break;
+        {
+            TRACE_SCOPE("frame", "robot");
+            for (int i = 0; i < m_receiveBuffer.size(); ++i) {
+                if (m_receiveBuffer.at(i) == '{') {
+                    openBrace++;
+                } else if (m_receiveBuffer.at(i) == '}') {
+                    closeBrace++;
+                }
+
+                // 找到完整闭合
+                if (openBrace > 0 && openBrace == closeBrace) {
+                    jsonEndIndex = i;
+                    break;
+                }
             }
         }
 
@@ -424,11 +637,34 @@ void RobotClient::onReadyRead()
         QByteArray jsonData = m_receiveBuffer.left(jsonEndIndex + 1);
         m_receiveBuffer.remove(0, jsonEndIndex + 1); // 移出缓冲区
 
-        // 5. 解析
+        metrics.framesIn->add();
+        metrics.frameSize->observe(jsonData.size());
+
+        // 5. 中继模式：推送扇出给下游订阅者，下游请求的回复直接转回，不在本地分发
+        if (m_relay && m_relay->routeUpstreamFrame(jsonData)) continue;
+
+        // 6. 估计控制器发送时刻 (带控制器时间戳的报文同时作为时钟同步样本)
+        m_frameSentNs = m_clockSync ? m_clockSync->stampFrame(jsonData, m_frameRecvNs) : m_frameRecvNs;
+
+        // 7. 已登记的推送主题只提取需要的字段，不构建 DOM
+        if (processScannedFrame(jsonData)) {
+            if (m_clockSync) m_clockSync->frameDelivered();
+            continue;
+        }
+
+        // 8. 其余报文完整解析
+        QElapsedTimer parseTimer;
+        parseTimer.start();
         QJsonParseError err;
-        QJsonDocument doc = QJsonDocument::fromJson(jsonData, &err);
+        QJsonDocument doc;
+        {
+            TRACE_SCOPE("json.parse", "robot");
+            doc = QJsonDocument::fromJson(jsonData, &err);
+        }
+        metrics.parseTimeUs->observe(parseTimer.nsecsElapsed() / 1000);
 
         if (err.error != QJsonParseError::NoError) {
+            metrics.parseErrors->add();
             writeLog("[ERROR] JSON 解析失败: " + err.errorString());
             continue;
         }
@@ -437,10 +673,100 @@ void RobotClient::onReadyRead()
             // 成功解析！进入处理流程
             processOneMessage(doc.object());
         }
+        if (m_clockSync) m_clockSync->frameDelivered();
     }
+
+    metrics.receiveBuffer->set(m_receiveBuffer.size());
 }
 
 
+// 按字段表扫描 publish/RobotStatus、RobotPosture、ProjectState
+// 字段写入预分配的结构体并发出 *Frame 信号；只有在 QJsonObject 信号有接收者 (界面、遥测录制) 时才构建 DOM
+// 扫描失败或不是登记的主题时返回 false，由调用方走 QJsonDocument
+bool RobotClient::processScannedFrame(const QByteArray &frame)
+{
+    QByteArrayView type;
+    if (!FrameScanner::peekType(frame, type)) return false;
+
+    enum { Status, Posture, Project } topic;
+    if (type == QByteArrayView(RobotStatusFrame::kType)) topic = Status;
+    else if (type == QByteArrayView(RobotPostureFrame::kType)) topic = Posture;
+    else if (type == QByteArrayView(ProjectStateFrame::kType)) topic = Project;
+    else return false;
+
+    QElapsedTimer parseTimer;
+    parseTimer.start();
+    quint32 present = 0;
+    {
+        TRACE_SCOPE("json.scan", "robot");
+        // 先清空：本帧没带的字段不沿用上一帧的值
+        switch (topic) {
+        case Status:
+            m_statusFrame = RobotStatusFrame();
+            present = FrameScanner::extract(frame, RobotStatusFrame::fields(), &m_statusFrame);
+            break;
+        case Posture:
+            m_postureFrame = RobotPostureFrame();
+            present = FrameScanner::extract(frame, RobotPostureFrame::fields(), &m_postureFrame);
+            break;
+        case Project:
+            m_projectFrame = ProjectStateFrame();
+            present = FrameScanner::extract(frame, ProjectStateFrame::fields(), &m_projectFrame);
+            break;
+        }
+    }
+    if (present == 0) return false;
+
+    RobotMetrics &metrics = robotMetrics();
+    metrics.parseTimeUs->observe(parseTimer.nsecsElapsed() / 1000);
+    metrics.scannedFrames->add();
+
+    TRACE_SCOPE_ARG("processOneMessage", "robot", QString::fromLatin1(type));
+
+    // 类型计数器缓存在数组里，避免每帧构造 QString 查表
+    MetricCounter *&counter = m_scannedTypeCounters[topic];
+    if (!counter) counter = typeCounter(QString::fromLatin1(type), false);
+    counter->add();
+
+    // 界面直接读结构体属性；遥测录制、长稳测试等连接了 QJsonObject 信号时才构建 DOM
+    auto dbObject = [&frame]() {
+        TRACE_SCOPE("json.parse", "robot");
+        return QJsonDocument::fromJson(frame).object().value("db").toObject();
+    };
+
+    TRACE_SCOPE_ARG("qmlHandler", "qml", QString::fromLatin1(type));
+    GUI_DELIVERY_SCOPE("robot", QString::fromLatin1(type));
+
+    switch (topic) {
+    case Status: {
+        m_statusFrame.present = present;
+        updateRobotState(m_statusFrame.hasState() ? m_statusFrame.state : -1);
+        emit robotStatusFrame(m_statusFrame);
+        emit robotStatusChanged();
+        static const QMetaMethod signal = QMetaMethod::fromSignal(&RobotClient::recvRobotStatusMessage);
+        if (isSignalConnected(signal)) emit recvRobotStatusMessage(dbObject());
+        break;
+    }
+    case Posture: {
+        m_postureFrame.present = present;
+        emit robotPostureFrame(m_postureFrame);
+        emit robotPostureChanged();
+        static const QMetaMethod signal = QMetaMethod::fromSignal(&RobotClient::recvRobotPostureMessage);
+        if (isSignalConnected(signal)) emit recvRobotPostureMessage(dbObject());
+        break;
+    }
+    case Project: {
+        m_projectFrame.present = present;
+        emit projectStateFrame(m_projectFrame);
+        emit projectStateChanged();
+        static const QMetaMethod signal = QMetaMethod::fromSignal(&RobotClient::recvProjectStateMessage);
+        if (isSignalConnected(signal)) emit recvProjectStateMessage(dbObject());
+        break;
+    }
+    }
+    return true;
+}
+
 // 接收并处理逻辑
 void RobotClient::processOneMessage(const QJsonObject &root)
 {
@@ -455,9 +781,20 @@ void RobotClient::processOneMessage(const QJsonObject &root)
 
     if (type.isEmpty()) return;
 
+    TRACE_SCOPE_ARG("processOneMessage", "robot", type);
+
+    if (!m_injecting) typeCounter(type, false)->add();
+
+    // 信号直连 QML，emit 返回前 QML 处理函数已执行完，这个区间就是 QML 侧的耗时
+    TRACE_SCOPE_ARG("qmlHandler", "qml", type);
+    GUI_DELIVERY_SCOPE("robot", type);
+
     if (type == "publish/ProjectState") {
-        if (root.contains("db") && root.value("db").isObject())
+        if (root.contains("db") && root.value("db").isObject()) {
+            extractFromDom(root, m_projectFrame);
+            emit projectStateChanged();
             emit recvProjectStateMessage(root.value("db").toObject());
+        }
     }
     else if (type == "publish/VarUpdate") {
         if (root.contains("db") && root.value("db").isObject())
@@ -466,12 +803,19 @@ void RobotClient::processOneMessage(const QJsonObject &root)
     else if(type == "publish/RobotStatus") {
         // 这里加个日志，确认确实触发了信号
         // writeLog("[DEBUG] 触发 recvRobotStatusMessage 信号");
-        if (root.contains("db") && root.value("db").isObject())
+        if (root.contains("db") && root.value("db").isObject()) {
+            onhandleRobotStatus(root.value("db").toObject());
+            extractFromDom(root, m_statusFrame);
+            emit robotStatusChanged();
             emit recvRobotStatusMessage(root.value("db").toObject());
+        }
     }
     else if(type == "publish/RobotPosture") {
-        if (root.contains("db") && root.value("db").isObject())
+        if (root.contains("db") && root.value("db").isObject()) {
+            extractFromDom(root, m_postureFrame);
+            emit robotPostureChanged();
             emit recvRobotPostureMessage(root.value("db").toObject());
+        }
     }
     else if(type == "publish/RobotCoordinate") {
         if (root.contains("db") && root.value("db").isObject())
@@ -491,20 +835,97 @@ void RobotClient::processOneMessage(const QJsonObject &root)
         emit recvMoveToHeartbeatMessage();
     }
     else {
+        const QJsonValue idValue = root.value("id");
+        const QString id = idValue.isDouble() ? QString::number(idValue.toInteger()) : idValue.toString();
+        if (!m_injecting) m_requestCache->complete(id, type, root);
+        // 没带 id 的回复按匹配到的请求判断是否是 sendProbe 的
+        const QString replyId = m_replyHandlers.isEmpty() ? id : dispatchReplyHandler(id, type, root);
+        if (!m_quietReplyIds.isEmpty() && m_quietReplyIds.remove(replyId)) return;
+        emit recvResponseMessage(id, type, root);
         emit recvNormalMessage(root);
     }
 }
 
 // [修改] 状态监测与高级心跳停止逻辑
+void RobotClient::injectMessage(const QJsonObject &root)
+{
+    m_injecting = true;
+    processOneMessage(root);
+    m_injecting = false;
+}
+
+void RobotClient::addReplyHandler(const QString &id, const QString &type, QObject *context, ReplyHandler handler)
+{
+    m_replyHandlers.insert(id, { type, QPointer<QObject>(context), std::move(handler), m_replyClock.elapsed() });
+    if (!m_replyTimeoutTimer->isActive()) m_replyTimeoutTimer->start();
+}
+
+// 按 id 找回调，返回回复归属的请求 id
+// 只有控制器没带回 id 时才交给同类型最早的那个；id 不认识的回复 (页面直接发的请求) 不交给任何回调
+QString RobotClient::dispatchReplyHandler(const QString &id, const QString &type, const QJsonObject &root)
+{
+    QList<PendingReply> matched;
+    QString matchedId = id;
+    if (!id.isEmpty()) {
+        if (!m_replyHandlers.contains(id)) return id;
+        matched = m_replyHandlers.values(id);
+        m_replyHandlers.remove(id);
+    } else {
+        auto oldest = m_replyHandlers.end();
+        for (auto it = m_replyHandlers.begin(); it != m_replyHandlers.end(); ++it) {
+            if (it->type != type) continue;
+            if (oldest == m_replyHandlers.end() || it->sentMs < oldest->sentMs) oldest = it;
+        }
+        if (oldest == m_replyHandlers.end()) return id;
+        matchedId = oldest.key();
+        matched << oldest.value();
+        m_replyHandlers.erase(oldest);
+    }
+
+    // 先移出再回调，回调里可以继续发请求
+    for (const PendingReply &pending : std::as_const(matched)) {
+        if (pending.context) pending.handler(&root);
+    }
+    if (m_replyHandlers.isEmpty()) m_replyTimeoutTimer->stop();
+    return matchedId;
+}
+
+void RobotClient::failReplyHandlers(bool all)
+{
+    QList<PendingReply> failed;
+    const qint64 now = m_replyClock.elapsed();
+    for (auto it = m_replyHandlers.begin(); it != m_replyHandlers.end();) {
+        if (all || now - it->sentMs > kReplyTimeoutMs) {
+            failed << it.value();
+            m_quietReplyIds.remove(it.key());
+            it = m_replyHandlers.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    if (m_replyHandlers.isEmpty()) m_replyTimeoutTimer->stop();
+
+    for (const PendingReply &pending : std::as_const(failed)) {
+        if (pending.context) pending.handler(nullptr);
+    }
+}
+
 void RobotClient::onhandleRobotStatus(const QJsonObject &db)
 {
-    if (!db.contains("state")) {
+    // 回放的状态只刷新界面，不改变缓存状态和心跳
+    if (m_injecting) return;
+
+    updateRobotState(db.contains("state") ? db.value("state").toInt() : -1);
+}
+
+// 缓存状态 + 心跳停止判断，newState 为 -1 表示报文中没有 state
+void RobotClient::updateRobotState(int newState)
+{
+    if (newState < 0) {
         m_currentRobotState = -1;
         return;
     }
 
-    int newState = db.value("state").toInt();
-
     // 更新状态给 QML
     if (m_currentRobotState != newState) {
         m_currentRobotState = newState;
@@ -524,8 +945,8 @@ void RobotClient::onhandleRobotStatus(const QJsonObject &db)
             // 如果不是 RunTo，计数器 +1
             m_nonRunToStateCount++;
 
-            // 只有连续 5 次以上检测到不是 RunTo，才停止心跳
-            if (m_nonRunToStateCount > 5) {
+            // 只有连续 5 次以上检测到不是 RunTo，才停止心跳 (运动队列保持会话时不停)
+            if (m_nonRunToStateCount > 5 && !m_heartbeatHold) {
                 writeLog(QString("<<< 检测到非RunTo状态计数(%1) > 5，停止心跳发送。").arg(m_nonRunToStateCount));
                 m_heartbeatTimer->stop();
                 m_nonRunToStateCount = 0; // 归零以便下次使用
@@ -543,6 +964,8 @@ void RobotClient::onSocketStateChanged(QAbstractSocket::SocketState socketState)
         m_currentRobotState = -1;
         m_heartbeatTimer->stop(); // 断连保护
         m_receiveBuffer.clear(); // 断连清空缓冲区
+        m_requestCache->clear(); // 在途请求不会再有回复
+        failReplyHandlers(true);
     }
 }
 
@@ -559,6 +982,12 @@ void RobotClient::writeLog(const QString &msg)
     // 使用 QMutexLocker 自动加锁解锁，防止多线程同时写入导致崩溃或乱码
     QMutexLocker locker(&m_logMutex);
 
+    // 二进制模式：只追加到内存块，不逐行打开文件
+    if (m_binaryLog) {
+        m_binaryLog->append(BinaryLogFormat::Info, QByteArray(), msg.toUtf8());
+        return;
+    }
+
     QFile file(m_logFilePath);
     // 以 "追加" (Append) 和 "文本" (Text) 模式打开
     if (file.open(QIODevice::WriteOnly | QIODevice::Append | QIODevice::Text)) {
@@ -577,8 +1006,97 @@ void RobotClient::writeLog(const QString &msg)
     }
 }
 
+void RobotClient::writeSendLog(const QString &type, const QByteArray &payload)
+{
+    if (!m_binaryLog) {
+        writeLog("发送: " + QString::fromUtf8(payload));
+        return;
+    }
+
+    QString currentTime = QDateTime::currentDateTime().toString("HH:mm:ss.zzz");
+    emit logGenerated(QString("[%1] 发送: %2").arg(currentTime, QString::fromUtf8(payload)));
+
+    // 报文原样保存，类型单独存一份，不再重复编码 JSON
+    QMutexLocker locker(&m_logMutex);
+    m_binaryLog->append(BinaryLogFormat::Send, type.toUtf8(), payload);
+}
+
+void RobotClient::setBinaryLog(bool enabled)
+{
+    if (enabled == binaryLog()) return;
+
+    {
+        QMutexLocker locker(&m_logMutex);
+        if (enabled) {
+            m_binaryLog = std::make_unique<BinaryLogWriter>(getAppDir() + "/Logs");
+            m_logFlushTimer->start();
+        } else {
+            m_binaryLog.reset();
+            m_logFlushTimer->stop();
+        }
+    }
+
+    QSettings settings(getAppDir() + "/config.ini", QSettings::IniFormat);
+    settings.setValue("Log/binary", enabled);
+
+    writeLog(enabled ? "日志格式切换为二进制压缩段" : "日志格式切换为文本");
+    emit binaryLogChanged();
+}
+
+int RobotClient::requestCacheTtlMs() const
+{
+    return m_requestCache->ttlMs();
+}
+
+void RobotClient::setRequestCacheTtlMs(int ms)
+{
+    ms = qBound(0, ms, 60000);
+    if (ms == m_requestCache->ttlMs()) return;
+
+    m_requestCache->setTtlMs(ms);
+    QSettings settings(getAppDir() + "/config.ini", QSettings::IniFormat);
+    settings.setValue("Request/cacheTtlMs", ms);
+    emit requestCacheTtlMsChanged();
+}
+
+QVariantMap RobotClient::requestCacheStats() const
+{
+    QVariantMap stats;
+    stats["hits"] = m_requestCache->hits();
+    stats["collapsed"] = m_requestCache->collapsed();
+    stats["cached"] = m_requestCache->size();
+    stats["inFlight"] = m_requestCache->inFlightCount();
+    return stats;
+}
+
+QString RobotClient::convertBinaryLog(const QString &path, const QString &outPath)
+{
+    const QString target = outPath.isEmpty()
+        ? getAppDir() + "/Logs/converted/" + QFileInfo(path).completeBaseName() + ".txt"
+        : outPath;
+
+    // 正在写入的段先把内存块落盘，保证转换结果完整
+    {
+        QMutexLocker locker(&m_logMutex);
+        if (m_binaryLog) m_binaryLog->flush();
+    }
+
+    QString error;
+    if (!BinaryLogReader::convertToText(path, target, &error)) {
+        writeLog("二进制日志转换失败: " + error);
+        return QString();
+    }
+    return target;
+}
+
 void RobotClient::onConnected()
 {
+    RobotMetrics &metrics = robotMetrics();
+    metrics.connects->add();
+    if (m_everConnected) metrics.reconnects->add();
+    m_everConnected = true;
+    metrics.connected->set(1);
+
     writeLog("机器人连接成功");
     subscribeAll();
     emit connected();
@@ -586,6 +1104,9 @@ void RobotClient::onConnected()
 
 void RobotClient::onDisconnected()
 {
+    robotMetrics().disconnects->add();
+    robotMetrics().connected->set(0);
+
     writeLog("机器人连接已断开");
     m_currentRobotState = -1;
     emit disconnected();
@@ -620,6 +1141,23 @@ void RobotClient::onErrorOccurred(QAbstractSocket::SocketError error)
     emit connectionFailed(userFriendlyError);
 }
 
+// 按消息类型取计数器 (首次出现的类型才会访问注册表)
+MetricCounter *RobotClient::typeCounter(const QString &type, bool outgoing)
+{
+    QHash<QString, MetricCounter *> &cache = outgoing ? m_outTypeCounters : m_inTypeCounters;
+    MetricCounter *counter = cache.value(type, nullptr);
+    if (!counter) {
+        // 只有已知类型单独成序列，其余归为 other；缓存也只放已知类型，避免随意输入的类型撑大缓存
+        const QString label = RobotProtocol::metricType(type);
+        counter = MetricsRegistry::instance().counter(
+            outgoing ? "robot_messages_sent_total" : "robot_messages_received_total",
+            outgoing ? "Requests sent per message type" : "Messages received per message type",
+            MetricsRegistry::label("ty", label));
+        if (label == type) cache.insert(type, counter);
+    }
+    return counter;
+}
+
 void RobotClient::initLogSystem()
 {
     // 1. 确定日志目录: exe所在目录/Logs
@@ -17,6 +17,22 @@
 #include <QFileInfo>
 #include <QMutex>
 #include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QSet>
+#include <QVariantMap>
+#include <QPointer>
+#include <functional>
+#include <memory>
+
+#include "robotprotocol.h"
+#include "framescanner.h"
+
+class MetricCounter;
+class BinaryLogWriter;
+class RequestCache;
+class RelayBroker;
+class ClockSync;
 
 // 机器人客户端类
 class RobotClient : public QObject{
@@ -30,6 +46,14 @@ class RobotClient : public QObject{
     // 【新增】暴露 connectionStateString 给 QML
     // CONSTANT 表示这个值只读且不会发出变更信号（或者你可以复用 connectionStatusChanged 信号）
     Q_PROPERTY(QString connectionStateString READ connectionStateString NOTIFY connectionStatusChanged)
+    // 日志格式：false=文本 (*.txt)，true=压缩二进制段 (*.blog)，保存在 config.ini 中
+    Q_PROPERTY(bool binaryLog READ binaryLog WRITE setBinaryLog NOTIFY binaryLogChanged)
+    // 幂等读请求的缓存有效期 (毫秒)，0 表示只合并在途请求不缓存，保存在 config.ini 中
+    Q_PROPERTY(int requestCacheTtlMs READ requestCacheTtlMs WRITE setRequestCacheTtlMs NOTIFY requestCacheTtlMsChanged)
+    // 最近一帧 publish/RobotStatus、RobotPosture、ProjectState 的字段 (扫描得到，界面直接读取，不构建 DOM)
+    Q_PROPERTY(RobotStatusFrame robotStatus READ robotStatus NOTIFY robotStatusChanged)
+    Q_PROPERTY(RobotPostureFrame robotPosture READ robotPosture NOTIFY robotPostureChanged)
+    Q_PROPERTY(ProjectStateFrame projectState READ projectState NOTIFY projectStateChanged)
 
 // 公有方法
 public:
@@ -51,6 +75,14 @@ public:
     // 缓存机器人状态
     int robotState() const;
 
+    bool binaryLog() const { return m_binaryLog != nullptr; }
+    void setBinaryLog(bool enabled);
+    int requestCacheTtlMs() const;
+    void setRequestCacheTtlMs(int ms);
+    const RobotStatusFrame &robotStatus() const { return m_statusFrame; }
+    const RobotPostureFrame &robotPosture() const { return m_postureFrame; }
+    const ProjectStateFrame &projectState() const { return m_projectFrame; }
+
     // 如果想让函数在QML可调用，要么用Q_INVOKABLE，要么标记为槽函数
     // --- 给 QML 调用的接口  ---
 
@@ -63,8 +95,41 @@ public:
     // 断开连接
     Q_INVOKABLE void disconnectFromRobot();
 
-    // 发送Json
-    Q_INVOKABLE void sendJsonRequest(const QString &type, const QVariant  &data = QVariant ());
+    // 发送Json，返回本次请求的 id (未连接时返回空串)，控制器回复时原样带回
+    Q_INVOKABLE QString sendJsonRequest(const QString &type, const QVariant  &data = QVariant ());
+
+    // 发送已构造好的 db，不经过 QVariant 类型判断 (C++ 服务内部使用)
+    QString sendJsonValue(const QString &type, const QJsonValue &db);
+
+    // 强类型请求：报文类型与 db 由 RobotProtocol 中的结构体在编译期确定
+    // 例: robot->send(RobotProtocol::Robot::MoveToHeartbeat{});
+    template <class Request>
+    QString send(const Request &request)
+    {
+        return sendJsonValue(QLatin1String(Request::kType), request.toDb());
+    }
+
+    // 强类型请求 + 回复回调：callback(bool ok, const Request::Reply &reply)
+    // 回复解析失败、超时 (kReplyTimeoutMs) 或断线时 ok 为 false；context 销毁后不再回调
+    // 返回请求 id，未连接时返回空串且不回调
+    template <class Request, class Callback>
+    QString call(const Request &request, QObject *context, Callback callback)
+    {
+        const QString id = send(request);
+        if (id.isEmpty()) return id;
+        addReplyHandler(id, QLatin1String(Request::kType), context,
+                        [callback](const QJsonObject *root) {
+                            typename Request::Reply reply{};
+                            const bool ok = root && Request::parseReply(root->value("db"), reply);
+                            callback(ok, reply);
+                        });
+        return id;
+    }
+
+    // 测量用请求：不经过读缓存 / 在途合并，回复只交给 callback (root 为空表示超时或断线)，不再广播给界面
+    // 返回请求 id，未连接时返回空串且不回调
+    QString sendProbe(const QString &type, const QJsonValue &db, QObject *context,
+                      std::function<void(const QJsonObject *root)> callback);
 
     // 发送String
     Q_INVOKABLE void sendStringRequest(const QString &message);
@@ -75,6 +140,36 @@ public:
     // 手动订阅主题
     Q_INVOKABLE void subscribeTopic(const QString &topic);
 
+    // 把二进制日志段转换为文本日志格式，返回输出文件路径 (失败返回空串)
+    // outPath 为空时输出到 Logs/converted/<段文件名>.txt
+    Q_INVOKABLE QString convertBinaryLog(const QString &path, const QString &outPath = QString());
+
+    // 请求合并 / 缓存统计 { hits, collapsed, cached, inFlight }
+    Q_INVOKABLE QVariantMap requestCacheStats() const;
+
+    // 把一条报文当作从控制器收到的报文分发 (遥测回放、请求缓存命中)
+    // 注入的报文只驱动界面信号，不计入指标，也不参与心跳判断
+    void injectMessage(const QJsonObject &root);
+    bool isInjecting() const { return m_injecting; }
+
+    // 保持心跳会话：置位期间即使检测到非 RunTo 状态也不停止心跳 (运动队列在段与段之间使用)
+    void setHeartbeatHold(bool hold);
+
+    // 连接后自动订阅的推送主题
+    static const QStringList &defaultTopics();
+
+    // 中继模式：收到的每一帧先交给 relay，属于下游客户端的回复不再在本地分发
+    void setRelay(RelayBroker *relay) { m_relay = relay; }
+    // 中继转发下游的原始报文 (已改写 id)，不重新序列化；写请求同样使本地缓存失效
+    qint64 writeRelayFrame(const QString &type, const QByteArray &frame);
+
+    // 时钟同步：每帧分发前估计控制器发送时刻，分发 (含 QML 处理函数) 结束后记录控制器到界面的延迟
+    void setClockSync(ClockSync *clockSync) { m_clockSync = clockSync; }
+    // 当前正在分发的报文：本地读到的时刻 / 估计的控制器发送时刻 (Tracer::nowNs 时基)
+    // 未开启时钟同步时发送时刻等于接收时刻
+    qint64 currentFrameRecvNs() const { return m_frameRecvNs; }
+    qint64 currentFrameSentNs() const { return m_frameSentNs; }
+
 
 // --- 通知 QML 的信号  ---
 signals:
@@ -100,6 +195,10 @@ signals:
     // 接收到正常的Json数据，传给 QML
     void recvNormalMessage(const QJsonObject &NormalMessage);
 
+    // 接收到请求的回复 (非订阅推送)，id 为回复中带回的请求 id (控制器未带时为空)
+    // 在 recvNormalMessage 之前发出，供 C++ 服务按 id 匹配请求
+    void recvResponseMessage(const QString &id, const QString &type, const QJsonObject &root);
+
     // 接收到工程状态Json数据，传给 QML
     void recvProjectStateMessage(const QJsonObject &ProjectStateMessage);
 
@@ -112,6 +211,16 @@ signals:
     // 接收到机器人位姿Json数据，传给 QML
     void recvRobotPostureMessage(const QJsonObject &RobotPostureMessage);
 
+    // 实时推送按字段表扫描后的结构体 (C++ 使用，不构建 DOM；回放注入的报文不发出)
+    // 只有 present 中置位的字段是本帧的值
+    void robotStatusFrame(const RobotStatusFrame &frame);
+    void robotPostureFrame(const RobotPostureFrame &frame);
+    void projectStateFrame(const ProjectStateFrame &frame);
+    // robotStatus / robotPosture / projectState 属性更新 (回放注入的报文也会更新)
+    void robotStatusChanged();
+    void robotPostureChanged();
+    void projectStateChanged();
+
     // 接收到机器人坐标系Json数据，传给 QML
     void recvRobotCoordinateMessage(const QJsonObject &RobotCoordinateMessage);
 
@@ -130,6 +239,12 @@ signals:
     // 日志
     void logGenerated(const QString &log);
 
+    // 日志格式切换
+    void binaryLogChanged();
+
+    // 请求缓存有效期改变
+    void requestCacheTtlMsChanged();
+
 // --- C++ 内部逻辑 QML 无法调用 ---
 private slots:
 
@@ -169,6 +284,9 @@ private:
     // // 写入日志
     void writeLog(const QString &msg);// 修改原有的 writeLog
 
+    // 发送报文日志：二进制模式下按 (方向, 类型, 原始 JSON) 结构化记录
+    void writeSendLog(const QString &type, const QByteArray &payload);
+
     // 全部订阅
     void subscribeAll();
 
@@ -184,6 +302,14 @@ private:
     // [新增] 内部函数：处理单条解析好的JSON，将onReadyRead逻辑剥离
     void processOneMessage(const QJsonObject &root);
 
+    // [新增] 登记主题的快速路径：不构建 DOM 直接提取字段，未处理时返回 false
+    bool processScannedFrame(const QByteArray &frame);
+    void updateRobotState(int newState);
+    RobotStatusFrame m_statusFrame;
+    RobotPostureFrame m_postureFrame;
+    ProjectStateFrame m_projectFrame;
+    MetricCounter *m_scannedTypeCounters[3] = {};
+
     // [新增] 日志系统相关成员
     QString m_logFilePath; // 当前使用的日志文件路径
     QMutex m_logMutex;     // 互斥锁，保证多线程写入安全
@@ -191,6 +317,51 @@ private:
     // [新增] 内部函数
     void initLogSystem();  // 初始化日志系统（创建文件夹、清理旧文件、确定文件名）
 
+    // [新增] 二进制日志 (开启时替代文本文件，界面日志信号不变)
+    std::unique_ptr<BinaryLogWriter> m_binaryLog;
+    QTimer *m_logFlushTimer; // 每秒把内存中的日志块落盘
+
+    // [新增] 指标：按消息类型计数 (只在 GUI 线程访问，缓存注册表返回的指针)
+    MetricCounter *typeCounter(const QString &type, bool outgoing);
+    QHash<QString, MetricCounter *> m_inTypeCounters;
+    QHash<QString, MetricCounter *> m_outTypeCounters;
+    QElapsedTimer m_heartbeatClock; // 测量实际心跳间隔
+    bool m_everConnected = false;   // 用于区分首次连接与重连
+
+    // [新增] 幂等读请求合并与缓存
+    std::unique_ptr<RequestCache> m_requestCache;
+    RelayBroker *m_relay = nullptr;
+
+    // [新增] 时钟同步与当前帧的时间戳
+    ClockSync *m_clockSync = nullptr;
+    qint64 m_frameRecvNs = 0;
+    qint64 m_frameSentNs = 0;
+
+    // [新增] 正在分发注入的报文
+    bool m_injecting = false;
+
+    // [新增] 心跳保持 (运动队列执行期间)
+    bool m_heartbeatHold = false;
+
+    // [新增] 强类型请求的回复回调，root 为空表示失败 (超时 / 断线)
+    using ReplyHandler = std::function<void(const QJsonObject *root)>;
+    struct PendingReply
+    {
+        QString type;
+        QPointer<QObject> context;
+        ReplyHandler handler;
+        qint64 sentMs;
+    };
+    static constexpr qint64 kReplyTimeoutMs = 30000;
+    void addReplyHandler(const QString &id, const QString &type, QObject *context, ReplyHandler handler);
+    QString dispatchReplyHandler(const QString &id, const QString &type, const QJsonObject &root);
+    void failReplyHandlers(bool all); // all=false 时只处理超时的
+    // 请求 id -> 回调 (合并的读请求共享 id，一个 id 可能对应多个回调)
+    QMultiHash<QString, PendingReply> m_replyHandlers;
+    QSet<QString> m_quietReplyIds; // sendProbe 的请求，回复不发给界面
+    QElapsedTimer m_replyClock;
+    QTimer *m_replyTimeoutTimer; // 有待回复的回调时每秒检查一次超时
+
 
 };
 #endif // ROBOTCLIENT_H
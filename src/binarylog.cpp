@@ -0,0 +1,314 @@
+#include "binarylog.h"
+
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QThreadPool>
+#include <QtEndian>
+#include <chrono>
+#include <cstring>
+
+namespace {
+
+// 写入中的段每 64KB 落盘一次；压缩时重新合并为 256KB 的块，压缩率更高
+constexpr qsizetype kWriteBlockBytes = 64 * 1024;
+constexpr qsizetype kCompressBlockBytes = 256 * 1024;
+
+qint64 monotonicNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void appendBlock(QByteArray &out, const QByteArray &stored, quint32 rawSize, quint8 flags)
+{
+    char header[BinaryLogFormat::kBlockHeaderSize] = {};
+    qToLittleEndian<quint32>(rawSize, header);
+    qToLittleEndian<quint32>(static_cast<quint32>(stored.size()), header + 4);
+    header[8] = static_cast<char>(flags);
+    out.append(header, sizeof(header));
+    out.append(stored);
+}
+
+// 读出整个段的原始 (解压后) 记录数据，块不完整时停在最后一个完整块
+bool readSegment(const QString &path, QByteArray &raw, bool *allCompressed, QString *error)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        if (error) *error = file.errorString();
+        return false;
+    }
+    const QByteArray content = file.readAll();
+    if (content.size() < BinaryLogFormat::kFileHeaderSize
+        || std::memcmp(content.constData(), BinaryLogFormat::kMagic, 4) != 0) {
+        if (error) *error = QString("不是二进制日志文件: %1").arg(path);
+        return false;
+    }
+
+    bool compressed = true;
+    qsizetype pos = BinaryLogFormat::kFileHeaderSize;
+    while (pos + BinaryLogFormat::kBlockHeaderSize <= content.size()) {
+        const char *p = content.constData() + pos;
+        const quint32 rawSize = qFromLittleEndian<quint32>(p);
+        const quint32 storedSize = qFromLittleEndian<quint32>(p + 4);
+        const quint8 flags = static_cast<quint8>(p[8]);
+        if (pos + BinaryLogFormat::kBlockHeaderSize + storedSize > content.size()) break; // 半个块
+
+        const QByteArray stored = QByteArray::fromRawData(p + BinaryLogFormat::kBlockHeaderSize, storedSize);
+        if (flags & BinaryLogFormat::kBlockCompressed) {
+            const QByteArray block = qUncompress(stored);
+            if (block.size() != static_cast<qsizetype>(rawSize)) {
+                if (error) *error = QString("数据块损坏: %1 @%2").arg(path).arg(pos);
+                return false;
+            }
+            raw.append(block);
+        } else {
+            compressed = false;
+            raw.append(stored);
+        }
+        pos += BinaryLogFormat::kBlockHeaderSize + storedSize;
+    }
+
+    if (allCompressed) *allCompressed = compressed;
+    return true;
+}
+
+} // namespace
+
+// ==========================================================
+// BinaryLogWriter
+// ==========================================================
+
+BinaryLogWriter::BinaryLogWriter(const QString &dir, qint64 segmentBytes, qint64 retentionBytes)
+    : m_dir(dir)
+    , m_segmentBytes(segmentBytes)
+    , m_retentionBytes(retentionBytes)
+{
+    QDir().mkpath(m_dir);
+
+    // 先清理超出预算的旧段，再在后台压缩上次运行 (或异常退出) 留下的未压缩段
+    enforceRetention();
+    const QFileInfoList segments = QDir(m_dir).entryInfoList({ "*.blog" }, QDir::Files, QDir::Name);
+    for (const QFileInfo &info : segments) {
+        const QString path = info.absoluteFilePath();
+        QThreadPool::globalInstance()->start([path] { BinaryLogWriter::compactSegment(path); });
+    }
+
+    openSegment();
+}
+
+BinaryLogWriter::~BinaryLogWriter()
+{
+    // 退出时只落盘不压缩，下次启动时再压缩，避免拖慢退出
+    closeSegment(false);
+}
+
+void BinaryLogWriter::openSegment()
+{
+    const QString timeStr = QDateTime::currentDateTime().toString("yyyyMMdd_HHmmss_zzz");
+    m_file.setFileName(m_dir + "/log_" + timeStr + ".blog");
+    if (!m_file.open(QIODevice::WriteOnly | QIODevice::Truncate)) return;
+
+    char header[BinaryLogFormat::kFileHeaderSize] = {};
+    std::memcpy(header, BinaryLogFormat::kMagic, 4);
+    qToLittleEndian<quint32>(BinaryLogFormat::kVersion, header + 4);
+    qToLittleEndian<qint64>(QDateTime::currentMSecsSinceEpoch(), header + 8);
+    qToLittleEndian<qint64>(monotonicNs(), header + 16);
+    m_file.write(header, sizeof(header));
+
+    m_block.clear();
+    m_block.reserve(kWriteBlockBytes + 4096);
+    m_segmentRawBytes = 0;
+}
+
+void BinaryLogWriter::closeSegment(bool compact)
+{
+    if (!m_file.isOpen()) return;
+    flush();
+    m_file.close();
+
+    if (compact) {
+        const QString path = m_file.fileName();
+        QThreadPool::globalInstance()->start([path] { BinaryLogWriter::compactSegment(path); });
+    }
+}
+
+void BinaryLogWriter::append(BinaryLogFormat::Direction direction, const QByteArray &type, const QByteArray &payload)
+{
+    if (!m_file.isOpen()) return;
+
+    const quint16 typeLength = static_cast<quint16>(qMin<qsizetype>(type.size(), 0xFFFF));
+    char header[BinaryLogFormat::kRecordHeaderSize] = {};
+    qToLittleEndian<quint32>(static_cast<quint32>(typeLength + payload.size()), header);
+    qToLittleEndian<qint64>(monotonicNs(), header + 4);
+    qToLittleEndian<qint64>(QDateTime::currentMSecsSinceEpoch(), header + 12);
+    header[20] = static_cast<char>(direction);
+    qToLittleEndian<quint16>(typeLength, header + 22);
+
+    m_block.append(header, sizeof(header));
+    m_block.append(type.constData(), typeLength);
+    m_block.append(payload);
+
+    if (m_block.size() >= kWriteBlockBytes) flush();
+}
+
+void BinaryLogWriter::flush()
+{
+    if (!m_file.isOpen() || m_block.isEmpty()) return;
+
+    QByteArray out;
+    out.reserve(m_block.size() + BinaryLogFormat::kBlockHeaderSize);
+    appendBlock(out, m_block, static_cast<quint32>(m_block.size()), 0);
+    m_file.write(out);
+    m_file.flush();
+
+    m_segmentRawBytes += m_block.size();
+    m_block.resize(0);
+
+    if (m_segmentRawBytes >= m_segmentBytes) {
+        closeSegment(true);
+        enforceRetention();
+        openSegment();
+    }
+}
+
+void BinaryLogWriter::enforceRetention()
+{
+    // 按文件名 (创建时间) 从旧到新，超出总预算时删除最旧的，正在写入的段不删
+    QFileInfoList segments = QDir(m_dir).entryInfoList({ "*.blog" }, QDir::Files, QDir::Name);
+    qint64 total = 0;
+    for (const QFileInfo &info : segments) total += info.size();
+
+    const QString current = QFileInfo(m_file.fileName()).absoluteFilePath();
+    while (total > m_retentionBytes && !segments.isEmpty()) {
+        const QFileInfo oldest = segments.takeFirst();
+        if (oldest.absoluteFilePath() == current) break;
+        total -= oldest.size();
+        QFile::remove(oldest.absoluteFilePath());
+    }
+}
+
+bool BinaryLogWriter::compactSegment(const QString &path, QString *error)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        if (error) *error = file.errorString();
+        return false;
+    }
+    const QByteArray header = file.read(BinaryLogFormat::kFileHeaderSize);
+    file.close();
+
+    QByteArray raw;
+    bool allCompressed = false;
+    if (!readSegment(path, raw, &allCompressed, error)) return false;
+    if (allCompressed) return true;
+
+    // 按记录边界切块，保证每个压缩块都能独立解码
+    QByteArray out = header;
+    qsizetype blockStart = 0;
+    qsizetype pos = 0;
+    while (pos + BinaryLogFormat::kRecordHeaderSize <= raw.size()) {
+        const quint32 length = qFromLittleEndian<quint32>(raw.constData() + pos);
+        const qsizetype next = pos + BinaryLogFormat::kRecordHeaderSize + length;
+        if (next > raw.size()) break;
+        pos = next;
+
+        if (pos - blockStart >= kCompressBlockBytes) {
+            const QByteArray chunk = raw.mid(blockStart, pos - blockStart);
+            appendBlock(out, qCompress(chunk, 6), static_cast<quint32>(chunk.size()), BinaryLogFormat::kBlockCompressed);
+            blockStart = pos;
+        }
+    }
+    if (pos > blockStart) {
+        const QByteArray chunk = raw.mid(blockStart, pos - blockStart);
+        appendBlock(out, qCompress(chunk, 6), static_cast<quint32>(chunk.size()), BinaryLogFormat::kBlockCompressed);
+    }
+
+    // QSaveFile 原子替换，压缩中途退出也不会损坏原段
+    QSaveFile save(path);
+    if (!save.open(QIODevice::WriteOnly)) {
+        if (error) *error = save.errorString();
+        return false;
+    }
+    save.write(out);
+    if (!save.commit()) {
+        if (error) *error = save.errorString();
+        return false;
+    }
+    return true;
+}
+
+// ==========================================================
+// BinaryLogReader
+// ==========================================================
+
+bool BinaryLogReader::forEachRecord(const QString &path, const std::function<bool(const BinaryLogRecord &)> &callback,
+                                    QString *error)
+{
+    QByteArray raw;
+    if (!readSegment(path, raw, nullptr, error)) return false;
+
+    BinaryLogRecord record;
+    qsizetype pos = 0;
+    while (pos + BinaryLogFormat::kRecordHeaderSize <= raw.size()) {
+        const char *p = raw.constData() + pos;
+        const quint32 length = qFromLittleEndian<quint32>(p);
+        const quint16 typeLength = qFromLittleEndian<quint16>(p + 22);
+        if (typeLength > length || pos + BinaryLogFormat::kRecordHeaderSize + length > raw.size()) break;
+
+        record.monoNs = qFromLittleEndian<qint64>(p + 4);
+        record.wallMs = qFromLittleEndian<qint64>(p + 12);
+        record.direction = static_cast<quint8>(p[20]);
+        const char *body = p + BinaryLogFormat::kRecordHeaderSize;
+        record.type = QByteArray(body, typeLength);
+        record.payload = QByteArray(body + typeLength, length - typeLength);
+
+        if (!callback(record)) break;
+        pos += BinaryLogFormat::kRecordHeaderSize + length;
+    }
+    return true;
+}
+
+QByteArray BinaryLogReader::formatRecord(const BinaryLogRecord &record)
+{
+    QByteArray line = "[" + QDateTime::fromMSecsSinceEpoch(record.wallMs).toString("HH:mm:ss.zzz").toLatin1() + "] ";
+    if (record.direction == BinaryLogFormat::Send) line += "发送: ";
+    else if (record.direction == BinaryLogFormat::Receive) line += "收到: ";
+    line += record.payload;
+    return line;
+}
+
+bool BinaryLogReader::convertToText(const QString &inPath, const QString &outPath, QString *error)
+{
+    QDir().mkpath(QFileInfo(outPath).absolutePath());
+
+    QSaveFile out(outPath);
+    if (!out.open(QIODevice::WriteOnly)) {
+        if (error) *error = out.errorString();
+        return false;
+    }
+
+    QByteArray buffer;
+    buffer.reserve(1024 * 1024);
+    const bool ok = forEachRecord(inPath, [&](const BinaryLogRecord &record) {
+        buffer += formatRecord(record);
+        buffer += '\n';
+        if (buffer.size() >= 1024 * 1024) {
+            out.write(buffer);
+            buffer.resize(0);
+        }
+        return true;
+    }, error);
+    if (!ok) {
+        out.cancelWriting();
+        return false;
+    }
+
+    out.write(buffer);
+    if (!out.commit()) {
+        if (error) *error = out.errorString();
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,85 @@
+#ifndef BINARYLOG_H
+#define BINARYLOG_H
+
+#include <QByteArray>
+#include <QFile>
+#include <QString>
+#include <functional>
+
+// 二进制日志段文件格式 (小端)
+// 文件头: "BLOG" + u32 版本 + i64 创建时墙钟时间(ms) + i64 创建时单调时钟(ns)
+// 数据块: u32 原始长度 + u32 存储长度 + u8 标志(bit0=zlib 压缩) + 3 字节保留 + 数据
+// 块内记录: u32 记录长度(不含记录头) + i64 单调时钟(ns) + i64 墙钟(ms) + u8 方向 + u8 保留 + u16 类型长度 + 类型 + 负载
+// 写入中的段使用未压缩的小块，段关闭 (轮转) 后在后台重写为压缩的大块
+namespace BinaryLogFormat {
+constexpr char kMagic[4] = {'B', 'L', 'O', 'G'};
+constexpr quint32 kVersion = 1;
+constexpr int kFileHeaderSize = 24;
+constexpr int kBlockHeaderSize = 12;
+constexpr int kRecordHeaderSize = 24;
+constexpr quint8 kBlockCompressed = 0x01;
+
+enum Direction : quint8 {
+    Info = 0,    // 普通日志 (writeLog)
+    Send = 1,    // 发送给控制器的报文
+    Receive = 2  // 从控制器收到的报文
+};
+}
+
+// 一条解码后的记录
+struct BinaryLogRecord
+{
+    qint64 monoNs = 0;
+    qint64 wallMs = 0;
+    quint8 direction = BinaryLogFormat::Info;
+    QByteArray type;
+    QByteArray payload;
+};
+
+// 二进制日志写入器：记录先攒在内存块中，满 64KB 或调用 flush() 时才写盘
+// 段达到 segmentBytes 时轮转，所有段总大小超过 retentionBytes 时删除最旧的段
+// 不加锁，由调用方 (RobotClient 的日志锁) 保证串行
+class BinaryLogWriter
+{
+public:
+    BinaryLogWriter(const QString &dir, qint64 segmentBytes = 10 * 1024 * 1024,
+                    qint64 retentionBytes = 500LL * 1024 * 1024);
+    ~BinaryLogWriter();
+
+    void append(BinaryLogFormat::Direction direction, const QByteArray &type, const QByteArray &payload);
+    void flush();
+
+    QString currentPath() const { return m_file.fileName(); }
+
+    // 把已关闭的段重写为压缩块 (已压缩的段直接跳过)，可在任意线程调用
+    static bool compactSegment(const QString &path, QString *error = nullptr);
+
+private:
+    void openSegment();
+    void closeSegment(bool compact);
+    void enforceRetention();
+
+    QString m_dir;
+    qint64 m_segmentBytes;
+    qint64 m_retentionBytes;
+    QFile m_file;
+    QByteArray m_block;
+    qint64 m_segmentRawBytes = 0;
+};
+
+// 读取与转换
+class BinaryLogReader
+{
+public:
+    // 逐条回调，回调返回 false 时停止；段尾不完整的块 (进程异常退出) 会被忽略
+    static bool forEachRecord(const QString &path, const std::function<bool(const BinaryLogRecord &)> &callback,
+                              QString *error = nullptr);
+
+    // 转换为与文本日志相同的格式: "[HH:mm:ss.zzz] 内容"，发送报文前加 "发送: "
+    static bool convertToText(const QString &inPath, const QString &outPath, QString *error = nullptr);
+
+    // 单条记录的文本形式 (不含换行)
+    static QByteArray formatRecord(const BinaryLogRecord &record);
+};
+
+#endif // BINARYLOG_H
@@ -0,0 +1,443 @@
+#include "clocksync.h"
+#include "Robotclient.h"
+#include "framescanner.h"
+#include "metrics.h"
+#include "robotprotocol.h"
+#include "tracer.h"
+
+#include <QDateTime>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+namespace {
+
+constexpr double kInf = std::numeric_limits<double>::infinity();
+// 窗口跨度不足时只估计偏移，不估计漂移
+constexpr double kMinDriftSpanMs = 30000.0;
+// 离群判定：残差超过 3 倍 MAD (折算为标准差) 且不小于 1 ms
+constexpr double kOutlierMads = 3.0;
+constexpr double kMinOutlierMs = 1.0;
+
+struct Fit
+{
+    double offset = 0;
+    double slope = 0;
+};
+
+// 最小二乘拟合 y = offset + slope * (x - origin)
+Fit fitLine(const std::vector<double> &xs, const std::vector<double> &ys, double origin)
+{
+    Fit fit;
+    const size_t n = xs.size();
+    if (n == 0) return fit;
+
+    double meanX = 0, meanY = 0;
+    for (size_t i = 0; i < n; ++i) {
+        meanX += xs[i] - origin;
+        meanY += ys[i];
+    }
+    meanX /= double(n);
+    meanY /= double(n);
+
+    const auto [minX, maxX] = std::minmax_element(xs.begin(), xs.end());
+    double sxx = 0, sxy = 0;
+    for (size_t i = 0; i < n; ++i) {
+        const double dx = xs[i] - origin - meanX;
+        sxx += dx * dx;
+        sxy += dx * (ys[i] - meanY);
+    }
+    if (n >= 3 && *maxX - *minX >= kMinDriftSpanMs && sxx > 0) fit.slope = sxy / sxx;
+    fit.offset = meanY - fit.slope * meanX;
+    return fit;
+}
+
+double median(std::vector<double> values)
+{
+    if (values.empty()) return 0;
+    const auto mid = values.begin() + values.size() / 2;
+    std::nth_element(values.begin(), mid, values.end());
+    return *mid;
+}
+
+} // namespace
+
+ClockSync::ClockSync(RobotClient *robot, QObject *parent)
+    : QObject(parent)
+    , m_robot(robot)
+    , m_probeTimer(new QTimer(this))
+{
+    m_probeTimer->setInterval(kProbeIntervalMs);
+    connect(m_probeTimer, &QTimer::timeout, this, &ClockSync::onProbeTimer);
+    m_probeTimer->start();
+
+    // 重连后网络路径可能变了 (例如换成损伤代理)，往返时间重新统计；时钟样本保留
+    connect(robot, &RobotClient::connected, this, [this] {
+        m_rtts.clear();
+        m_minRttUs = -1;
+        m_dirty = true;
+    });
+
+    MetricsRegistry &r = MetricsRegistry::instance();
+    m_offsetGauge = r.gauge("clock_offset_us", "Estimated controller clock minus local wall clock");
+    m_driftGauge = r.gauge("clock_drift_ppb", "Estimated controller clock drift against the local monotonic clock");
+    m_minRttGauge = r.gauge("clock_min_rtt_us", "Minimum request round trip in the clock-sync window");
+    m_samplesCounter = r.counter("clock_sync_samples_total", "Controller timestamps and probe replies fed to clock sync");
+    m_outliersCounter = r.counter("clock_outliers_total", "Clock-sync samples or buckets rejected as outliers");
+    m_stepsCounter = r.counter("clock_steps_total", "Controller clock steps detected (estimate reset)");
+
+    robot->setClockSync(this);
+}
+
+ClockSync::~ClockSync()
+{
+    if (m_robot) m_robot->setClockSync(nullptr);
+}
+
+void ClockSync::setEnabled(bool enabled)
+{
+    if (m_enabled == enabled) return;
+    m_enabled = enabled;
+    m_current = nullptr;
+    if (enabled) m_probeTimer->start();
+    else m_probeTimer->stop();
+    emit enabledChanged();
+}
+
+double ClockSync::offsetMs() const
+{
+    return m_synced ? offsetAt(nowMs()) - wallMinusMonoMs() : 0.0;
+}
+
+double ClockSync::estimateSendNs(double recvNs, double controllerTs) const
+{
+    if (controllerTs >= 0 && m_synced) {
+        const double sentMs = toControllerMs(controllerTs) - offsetAt(recvNs / 1e6);
+        return std::min(sentMs * 1e6, recvNs);
+    }
+    if (m_minRttUs >= 0) return recvNs - double(m_minRttUs) * 500.0;
+    return recvNs;
+}
+
+double ClockSync::controllerToLocalMs(double controllerTs) const
+{
+    const double controllerMs = toControllerMs(controllerTs);
+    if (!m_synced) return controllerMs;
+    return controllerMs - offsetAt(nowMs()) + wallMinusMonoMs();
+}
+
+QVariantMap ClockSync::stats() const
+{
+    QVariantMap map;
+    map["synced"] = m_synced;
+    map["offsetMs"] = offsetMs();
+    map["driftPpm"] = driftPpm();
+    map["minRttMs"] = minRttMs();
+    map["oneWayMs"] = oneWayMs();
+    map["buckets"] = qint64(m_buckets.size());
+    map["samples"] = m_samples;
+    map["outliers"] = m_outliers;
+    map["steps"] = m_steps;
+    map["probes"] = m_probes;
+    return map;
+}
+
+void ClockSync::reset()
+{
+    m_buckets.clear();
+    m_rtts.clear();
+    m_minRttUs = -1;
+    m_stepStreak = 0;
+    m_synced = false;
+    m_dirty = false;
+    m_slope = 0;
+    emit estimateChanged();
+}
+
+// ==========================================================
+// 每帧时间戳
+// ==========================================================
+
+qint64 ClockSync::stampFrame(const QByteArray &frame, qint64 recvNs)
+{
+    m_current = nullptr;
+    if (!m_enabled) return recvNs;
+
+    QByteArrayView type;
+    if (!FrameScanner::peekType(frame, type)) return recvNs;
+
+    // 日志 / 报警取最新一条的时间 (最接近发送时刻，下界最紧)；其余报文看顶层 "ts"
+    double controllerMs = -1;
+    if (type == QByteArrayView("publish/Log") || type == QByteArrayView("publish/Error")) {
+        QByteArrayView db;
+        if (FrameScanner::findValue(frame, "db", db)) {
+            const QJsonArray entries = QJsonDocument::fromJson(db.toByteArray()).array();
+            for (const QJsonValue &entry : entries) {
+                const QJsonValue ts = entry.toArray().at(2);
+                if (ts.isDouble() && ts.toDouble() > 0) controllerMs = std::max(controllerMs, toControllerMs(ts.toDouble()));
+            }
+        }
+    } else {
+        QByteArrayView ts;
+        bool ok = false;
+        if (FrameScanner::findValue(frame, "ts", ts)) {
+            const double value = ts.toDouble(&ok);
+            if (ok && value > 0) controllerMs = toControllerMs(value);
+        }
+    }
+
+    const bool timed = controllerMs > 0;
+    if (timed) {
+        const double recvMs = recvNs / 1e6;
+        addLowerBound(recvMs, controllerMs - recvMs);
+    }
+
+    m_current = typeMetrics(type);
+    m_currentSentNs = qint64(estimateSendNs(double(recvNs), controllerMs));
+    m_currentValid = timed ? m_synced : m_minRttUs >= 0;
+    if (timed && m_synced) m_current->toRecv->observe((recvNs - m_currentSentNs) / 1000);
+    return m_currentSentNs;
+}
+
+void ClockSync::frameDelivered()
+{
+    if (!m_current) return;
+    if (m_currentValid) m_current->toUi->observe((Tracer::nowNs() - m_currentSentNs) / 1000);
+    m_current = nullptr;
+}
+
+ClockSync::TypeMetrics *ClockSync::typeMetrics(QByteArrayView type)
+{
+    for (TypeMetrics &t : m_types) {
+        if (QByteArrayView(t.type) == type) return &t;
+    }
+    // 只按推送主题分开统计，请求回复等其他报文归为 other，序列数固定
+    const bool topic = RobotProtocol::topics().contains(QString::fromUtf8(type));
+    const QByteArray key = topic ? type.toByteArray() : QByteArrayLiteral("other");
+    if (!topic) {
+        for (TypeMetrics &t : m_types) {
+            if (t.type == key) return &t;
+        }
+    }
+    MetricsRegistry &r = MetricsRegistry::instance();
+    const QString labels = MetricsRegistry::label("ty", QString::fromUtf8(key));
+    m_types.push_back({ key,
+                        r.histogram("controller_to_recv_us", "Controller timestamp to local socket read (clock-sync corrected)",
+                                    MetricsRegistry::latencyBucketsUs(), labels),
+                        r.histogram("controller_to_ui_us", "Estimated controller send to end of GUI dispatch",
+                                    MetricsRegistry::latencyBucketsUs(), labels) });
+    return &m_types.back();
+}
+
+// ==========================================================
+// 样本与拟合
+// ==========================================================
+
+double ClockSync::toControllerMs(double controllerTs)
+{
+    // 控制器日志时间是秒 (带毫秒小数)，模拟控制器等写的是毫秒；1e11 秒远在未来，毫秒则是 1973 年
+    return controllerTs < 1e11 ? controllerTs * 1000.0 : controllerTs;
+}
+
+double ClockSync::nowMs()
+{
+    return Tracer::nowNs() / 1e6;
+}
+
+double ClockSync::wallMinusMonoMs()
+{
+    return double(QDateTime::currentMSecsSinceEpoch()) - nowMs();
+}
+
+double ClockSync::offsetAt(double localMs) const
+{
+    return m_offsetMs + m_slope * (localMs - m_originMs);
+}
+
+void ClockSync::addLowerBound(double localMs, double offsetMs)
+{
+    ++m_samples;
+    m_samplesCounter->add();
+    // 下界高出估计太多：估计偏低或控制器时钟向前跳了
+    if (m_synced && checkStep(offsetMs - offsetAt(localMs))) return;
+
+    Bucket &bucket = bucketAt(localMs);
+    if (offsetMs > bucket.lowerMs) {
+        bucket.lowerMs = offsetMs;
+        bucket.lowerAtMs = localMs;
+        m_dirty = true;
+    }
+}
+
+void ClockSync::addUpperBound(double localMs, double offsetMs)
+{
+    ++m_samples;
+    m_samplesCounter->add();
+    if (m_synced && checkStep(offsetAt(localMs) - offsetMs)) return;
+
+    Bucket &bucket = bucketAt(localMs);
+    if (offsetMs < bucket.upperMs) {
+        bucket.upperMs = offsetMs;
+        m_dirty = true;
+    }
+}
+
+bool ClockSync::checkStep(double excessMs)
+{
+    if (excessMs <= kStepToleranceMs) {
+        m_stepStreak = 0;
+        return false;
+    }
+    ++m_outliers;
+    m_outliersCounter->add();
+    if (++m_stepStreak < kStepSamples) return true;
+
+    // 连续多个样本都与估计矛盾：控制器时钟被调整过，丢掉旧样本从当前样本重新收敛
+    ++m_steps;
+    m_stepsCounter->add();
+    m_buckets.clear();
+    m_stepStreak = 0;
+    m_synced = false;
+    m_slope = 0;
+    emit estimateChanged();
+    return false;
+}
+
+ClockSync::Bucket &ClockSync::bucketAt(double localMs)
+{
+    const qint64 index = qint64(std::floor(localMs / double(kBucketMs)));
+
+    // 上界样本记在发送时刻，可能落在较早的时间段
+    auto it = m_buckets.end();
+    while (it != m_buckets.begin() && std::prev(it)->index > index) --it;
+    if (it != m_buckets.begin() && std::prev(it)->index == index) return *std::prev(it);
+
+    it = m_buckets.insert(it, Bucket{ index, -kInf, localMs, kInf });
+    const qint64 oldest = m_buckets.back().index - kWindowMs / kBucketMs;
+    while (m_buckets.front().index <= oldest) {
+        if (&m_buckets.front() == &*it) break; // 刚插入的过期样本也要返回有效引用
+        m_buckets.pop_front();
+    }
+    return *it;
+}
+
+void ClockSync::refit()
+{
+    m_dirty = false;
+    const double oneWay = m_minRttUs < 0 ? 0.0 : m_minRttUs / 2000.0;
+
+    // 每段的偏移估计：上下界都有取中点；只有下界时补上单程延迟；只有上界时减去单程延迟
+    std::vector<Bucket *> owners;
+    std::vector<double> xs, ys;
+    for (Bucket &b : m_buckets) {
+        double y;
+        if (b.lowerMs > -kInf && b.upperMs < kInf) y = b.upperMs >= b.lowerMs ? (b.lowerMs + b.upperMs) / 2 : b.lowerMs;
+        else if (b.lowerMs > -kInf) y = b.lowerMs + oneWay;
+        else if (b.upperMs < kInf) y = b.upperMs - oneWay;
+        else continue;
+        owners.push_back(&b);
+        xs.push_back(b.lowerAtMs);
+        ys.push_back(y);
+    }
+
+    const bool wasSynced = m_synced;
+    m_synced = !xs.empty();
+    if (m_synced) {
+        const double origin = xs.back();
+        Fit fit = fitLine(xs, ys, origin);
+
+        // 剔除残差离群的段 (整段报文都被排队延迟的日志等) 后重新拟合
+        std::vector<double> residuals(xs.size());
+        for (size_t i = 0; i < xs.size(); ++i) residuals[i] = ys[i] - (fit.offset + fit.slope * (xs[i] - origin));
+        const double center = median(residuals);
+        std::vector<double> deviations(residuals.size());
+        for (size_t i = 0; i < residuals.size(); ++i) deviations[i] = std::abs(residuals[i] - center);
+        const double limit = std::max(kOutlierMads * 1.4826 * median(deviations), kMinOutlierMs);
+
+        std::vector<double> keptX, keptY;
+        for (size_t i = 0; i < xs.size(); ++i) {
+            const bool rejected = std::abs(residuals[i] - center) > limit;
+            if (rejected && !owners[i]->rejected) {
+                ++m_outliers;
+                m_outliersCounter->add();
+            }
+            owners[i]->rejected = rejected;
+            if (!rejected) {
+                keptX.push_back(xs[i]);
+                keptY.push_back(ys[i]);
+            }
+        }
+        if (!keptX.empty() && keptX.size() < xs.size()) fit = fitLine(keptX, keptY, origin);
+
+        m_originMs = origin;
+        m_offsetMs = fit.offset;
+        m_slope = fit.slope;
+        m_offsetGauge->set(qint64(offsetMs() * 1000.0));
+        m_driftGauge->set(qint64(m_slope * 1e9));
+    }
+    if (m_synced || wasSynced) emit estimateChanged();
+}
+
+// ==========================================================
+// 往返测量
+// ==========================================================
+
+void ClockSync::onProbeTimer()
+{
+    // 窗口外的往返样本过期后重新取最小值
+    const double now = nowMs();
+    bool rttExpired = false;
+    while (!m_rtts.empty() && m_rtts.front().first < now - double(kWindowMs)) {
+        m_rtts.pop_front();
+        rttExpired = true;
+    }
+    if (rttExpired) {
+        m_minRttUs = -1;
+        for (const auto &sample : m_rtts) {
+            if (m_minRttUs < 0 || sample.second < m_minRttUs) m_minRttUs = sample.second;
+        }
+        m_minRttGauge->set(std::max<qint64>(m_minRttUs, 0));
+        m_dirty = true;
+    }
+    if (m_dirty) refit();
+
+    if (m_probeInFlight || !m_robot || !m_robot->isConnected()) return;
+
+    // 只读、回复很小的请求；不经过缓存，回复不广播给界面
+    const qint64 sentNs = Tracer::nowNs();
+    const QString id = m_robot->sendProbe(QLatin1String(RobotProtocol::GlobalVarApi::GetProjectVarUpdate::kType), QJsonValue(),
+                                          this, [this, sentNs](const QJsonObject *root) { onProbeReply(sentNs, root); });
+    if (id.isEmpty()) return;
+    m_probeInFlight = true;
+    ++m_probes;
+}
+
+void ClockSync::onProbeReply(qint64 sentNs, const QJsonObject *root)
+{
+    m_probeInFlight = false;
+    if (!root || !m_robot) return; // 超时或断线
+
+    // 回调在回复分发期间执行，当前帧的接收时刻就是回复到达的时刻
+    const qint64 recvNs = m_robot->currentFrameRecvNs();
+    const qint64 rttUs = (recvNs - sentNs) / 1000;
+    if (rttUs < 0) return;
+
+    ++m_samples;
+    m_samplesCounter->add();
+    m_rtts.emplace_back(recvNs / 1e6, rttUs);
+    if (m_minRttUs < 0 || rttUs < m_minRttUs) {
+        m_minRttUs = rttUs;
+        m_minRttGauge->set(rttUs);
+        m_dirty = true;
+    }
+
+    // 回复带控制器时间时还给出上界 (下界已在 stampFrame 中登记)
+    const QJsonValue ts = root->value("ts");
+    if (ts.isDouble() && ts.toDouble() > 0) {
+        const double sentMs = sentNs / 1e6;
+        addUpperBound(sentMs, toControllerMs(ts.toDouble()) - sentMs);
+    }
+}
@@ -0,0 +1,151 @@
+#ifndef CLOCKSYNC_H
+#define CLOCKSYNC_H
+
+#include <QObject>
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QJsonObject>
+#include <QPointer>
+#include <QTimer>
+#include <QVariantMap>
+#include <deque>
+
+class RobotClient;
+class MetricCounter;
+class MetricGauge;
+class MetricHistogram;
+
+// 控制器时钟同步：估计控制器时钟 (Unix 毫秒) 相对本地单调时钟 (Tracer::nowNs) 的偏移与漂移
+// - 带控制器时间戳的报文 (publish/Log、publish/Error 的 logEntry[2]，以及顶层带 "ts" 的回复) 给出下界：偏移 >= 控制器时间 - 本地接收时间
+// - 定期发送测量请求得到往返时间，最小往返的一半作为单程延迟；回复带 "ts" 时同时给出上界：偏移 <= 控制器时间 - 本地发送时间
+// - 按时间段取最紧的上下界，剔除离群段后线性拟合得到偏移与漂移；控制器时钟跳变 (连续大幅超出估计) 时清空重新收敛
+// RobotClient 每帧分发前调用 stampFrame() 得到估计的控制器发送时刻，分发 (含 QML 处理函数) 结束后调用 frameDelivered() 记录延迟
+// 只在 GUI 线程使用
+class ClockSync : public QObject
+{
+    Q_OBJECT
+
+    // 关闭后不再发送测量请求，也不再给报文打时间戳 (RobotClient 把接收时刻当作发送时刻)
+    Q_PROPERTY(bool enabled READ enabled WRITE setEnabled NOTIFY enabledChanged)
+    Q_PROPERTY(bool synced READ synced NOTIFY estimateChanged)
+    // 控制器时钟减去本机系统时钟 (ms)
+    Q_PROPERTY(double offsetMs READ offsetMs NOTIFY estimateChanged)
+    // 控制器时钟相对本地单调时钟的漂移 (ppm，正数表示控制器走得快)
+    Q_PROPERTY(double driftPpm READ driftPpm NOTIFY estimateChanged)
+    // 窗口内最小往返时间与估计的单程延迟 (ms)，未测到时为 -1
+    Q_PROPERTY(double minRttMs READ minRttMs NOTIFY estimateChanged)
+    Q_PROPERTY(double oneWayMs READ oneWayMs NOTIFY estimateChanged)
+
+public:
+    // 测量请求间隔
+    static constexpr int kProbeIntervalMs = 2000;
+    // 时间段长度与拟合窗口
+    static constexpr qint64 kBucketMs = 2000;
+    static constexpr qint64 kWindowMs = 120000;
+    // 新样本超出估计这么多视为离群，连续 kStepSamples 次视为控制器时钟跳变
+    static constexpr double kStepToleranceMs = 500.0;
+    static constexpr int kStepSamples = 3;
+
+    explicit ClockSync(RobotClient *robot, QObject *parent = nullptr);
+    ~ClockSync();
+
+    bool enabled() const { return m_enabled; }
+    void setEnabled(bool enabled);
+    bool synced() const { return m_synced; }
+    double offsetMs() const;
+    double driftPpm() const { return m_synced ? m_slope * 1e6 : 0.0; }
+    double minRttMs() const { return m_minRttUs < 0 ? -1.0 : m_minRttUs / 1000.0; }
+    double oneWayMs() const { return m_minRttUs < 0 ? -1.0 : m_minRttUs / 2000.0; }
+
+    // 估计报文的控制器发送时刻 (Tracer::nowNs 时基)
+    // controllerTs 为报文自带的控制器时间 (秒或毫秒，< 0 表示没有)：已同步时按时钟映射换算
+    // 否则用接收时刻减去估计的单程延迟
+    Q_INVOKABLE double estimateSendNs(double recvNs, double controllerTs = -1) const;
+    // 控制器时间 (秒或毫秒) 换算为本机系统时间 (Unix 毫秒)，未同步时原样返回 (统一为毫秒)
+    Q_INVOKABLE double controllerToLocalMs(double controllerTs) const;
+
+    // { synced, offsetMs, driftPpm, minRttMs, oneWayMs, buckets, samples, outliers, steps, probes }
+    Q_INVOKABLE QVariantMap stats() const;
+    // 清空样本重新收敛
+    Q_INVOKABLE void reset();
+
+    // RobotClient 在每帧分发前调用：取控制器时间戳登记样本，返回估计的发送时刻
+    qint64 stampFrame(const QByteArray &frame, qint64 recvNs);
+    // 该帧分发结束后调用，记录控制器到界面的延迟
+    void frameDelivered();
+
+signals:
+    void enabledChanged();
+    void estimateChanged();
+
+private slots:
+    void onProbeTimer();
+
+private:
+    // 一个时间段内最紧的上下界 (偏移 = 控制器毫秒 - 本地单调毫秒)
+    struct Bucket
+    {
+        qint64 index;
+        double lowerMs;     // 最大下界
+        double lowerAtMs;   // 最大下界对应的本地时刻
+        double upperMs;     // 最小上界 (没有时为 +inf)
+        bool rejected = false;
+    };
+
+    // 每个推送主题 + other 的延迟直方图 (不超过 8 组，线性查找)
+    struct TypeMetrics
+    {
+        QByteArray type;
+        MetricHistogram *toRecv;
+        MetricHistogram *toUi;
+    };
+
+    static double toControllerMs(double controllerTs);
+    static double nowMs();
+    static double wallMinusMonoMs();
+    double offsetAt(double localMs) const;
+    void addLowerBound(double localMs, double offsetMs);
+    void addUpperBound(double localMs, double offsetMs);
+    bool checkStep(double excessMs);
+    Bucket &bucketAt(double localMs);
+    void refit();
+    void onProbeReply(qint64 sentNs, const QJsonObject *root);
+    TypeMetrics *typeMetrics(QByteArrayView type);
+
+    QPointer<RobotClient> m_robot; // 退出时 RobotClient 先于本对象析构
+    QTimer *m_probeTimer;
+    bool m_enabled = true;
+    bool m_probeInFlight = false;
+
+    std::deque<Bucket> m_buckets;
+    std::deque<std::pair<double, qint64>> m_rtts; // (本地毫秒, 往返 us)
+    qint64 m_minRttUs = -1;
+    int m_stepStreak = 0;
+    bool m_dirty = false;
+
+    // 拟合结果：offset(t) = m_offset + m_slope * (t - m_origin)
+    bool m_synced = false;
+    double m_originMs = 0;
+    double m_offsetMs = 0;
+    double m_slope = 0;
+
+    // 当前正在分发的帧
+    TypeMetrics *m_current = nullptr;
+    qint64 m_currentSentNs = -1;
+    bool m_currentValid = false; // 没有时间戳且还没测到往返时间的帧不记录延迟
+    std::deque<TypeMetrics> m_types; // deque: 追加时已有元素地址不变
+
+    quint64 m_samples = 0;
+    quint64 m_outliers = 0;
+    quint64 m_steps = 0;
+    quint64 m_probes = 0;
+
+    MetricGauge *m_offsetGauge;
+    MetricGauge *m_driftGauge;
+    MetricGauge *m_minRttGauge;
+    MetricCounter *m_samplesCounter;
+    MetricCounter *m_outliersCounter;
+    MetricCounter *m_stepsCounter;
+};
+
+#endif // CLOCKSYNC_H
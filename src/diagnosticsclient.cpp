@@ -0,0 +1,240 @@
+#include "diagnosticsclient.h"
+#include "metrics.h"
+#include "tracer.h"
+#include "framescanner.h"
+
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMetaProperty>
+#include <QSaveFile>
+#include <QVariantMap>
+#include <QDebug>
+
+DiagnosticsClient::DiagnosticsClient(QObject *parent)
+    : QObject(parent)
+    , m_dumpTimer(new QTimer(this))
+{
+    // 与日志放在同一目录，方便一起收集
+    m_dumpDir = QCoreApplication::applicationDirPath() + "/Logs";
+    QDir().mkpath(m_dumpDir);
+
+    connect(m_dumpTimer, &QTimer::timeout, this, &DiagnosticsClient::dumpNow);
+    setDumpIntervalSec(m_dumpIntervalSec);
+}
+
+DiagnosticsClient::~DiagnosticsClient()
+{
+    // 退出前再导出一次，保留最后的统计
+    dumpNow();
+}
+
+void DiagnosticsClient::setDumpIntervalSec(int seconds)
+{
+    seconds = qMax(0, seconds);
+    if (seconds == m_dumpIntervalSec && m_dumpTimer->isActive() == (seconds > 0)) return;
+
+    m_dumpIntervalSec = seconds;
+    if (seconds > 0) {
+        m_dumpTimer->start(seconds * 1000);
+    } else {
+        m_dumpTimer->stop();
+    }
+    emit dumpIntervalSecChanged();
+}
+
+QVariantList DiagnosticsClient::metricsSnapshot()
+{
+    QVariantList list = MetricsRegistry::instance().snapshot();
+
+    const double elapsedSec = m_rateClock.isValid() ? m_rateClock.restart() / 1000.0 : 0.0;
+    if (!m_rateClock.isValid()) m_rateClock.start();
+
+    for (QVariant &item : list) {
+        QVariantMap map = item.toMap();
+        if (map.value("type").toString() == "gauge") continue;
+
+        // 直方图按观测次数计算速率
+        const QString key = map.value("name").toString() + "{" + map.value("labels").toString() + "}";
+        const double current = map.value("type").toString() == "histogram"
+                                   ? map.value("count").toDouble() : map.value("value").toDouble();
+        const double previous = m_lastValues.value(key, current);
+        map["rate"] = elapsedSec > 0 ? (current - previous) / elapsedSec : 0.0;
+        m_lastValues.insert(key, current);
+        item = map;
+    }
+    return list;
+}
+
+void DiagnosticsClient::dumpNow()
+{
+    const MetricsRegistry &registry = MetricsRegistry::instance();
+
+    // QSaveFile 先写临时文件再原子替换，外部工具读取时不会读到半个文件
+    QSaveFile prom(m_dumpDir + "/metrics.prom");
+    if (prom.open(QIODevice::WriteOnly)) {
+        prom.write(registry.toPrometheusText());
+        prom.commit();
+    } else {
+        qDebug() << "Failed to dump metrics:" << prom.fileName();
+    }
+
+    QSaveFile json(m_dumpDir + "/metrics.json");
+    if (json.open(QIODevice::WriteOnly)) {
+        json.write(registry.toJson());
+        json.commit();
+    }
+}
+
+bool DiagnosticsClient::tracing() const
+{
+    return Tracer::isEnabled();
+}
+
+void DiagnosticsClient::setTracing(bool enabled)
+{
+    if (enabled == Tracer::isEnabled()) return;
+    Tracer::instance().setEnabled(enabled);
+    emit tracingChanged();
+}
+
+QString DiagnosticsClient::exportTrace(const QString &path)
+{
+    const QString target = path.isEmpty()
+        ? m_dumpDir + "/trace_" + QDateTime::currentDateTime().toString("yyyyMMdd_HHmmss") + ".json"
+        : path;
+
+    if (!Tracer::instance().exportChromeJson(target)) {
+        qDebug() << "Failed to export trace:" << target;
+        return QString();
+    }
+    return target;
+}
+
+void DiagnosticsClient::clearTrace()
+{
+    Tracer::instance().clear();
+}
+
+QVariantMap DiagnosticsClient::traceStats() const
+{
+    return Tracer::instance().stats();
+}
+
+namespace {
+
+// 基准样本：与控制器推送的字段一致，另带几个未登记的键
+QList<QByteArray> benchmarkFrames()
+{
+    QJsonObject status{ { "state", 4 }, { "mode", 1 }, { "moveRate", 50.0 }, { "manualMoveRate", 10.0 },
+                        { "runDuration", 12345.6 }, { "ToolId", 1 }, { "CoordinateId", 0 }, { "PayloadId", 0 },
+                        { "defaultToolId", 0 }, { "defaultCoordinateId", 0 }, { "defaultPayloadId", 0 },
+                        { "modeSwitch", 0 }, { "recoveryState", 0 }, { "rescueFlag", false },
+                        { "teachingPendant", true }, { "type", 0 }, { "isSimulation", false },
+                        { "stateName", "RunTo" },
+                        { "collision", QJsonObject{ { "enable", true }, { "level", 3 } } } };
+    QJsonObject posture{ { "joint", QJsonArray{ 12.345, -45.678, 90.123, 0.001, 45.5, -179.999 } },
+                         { "end", QJsonObject{ { "x", 512.25 }, { "y", -33.5 }, { "z", 780.125 },
+                                               { "a", 180.0 }, { "b", 0.5 }, { "c", -90.25 } } },
+                         { "ep", QJsonArray{ 0.0, 0.0 } } };
+    QJsonObject project{ { "state", 2 }, { "projectType", 1 }, { "id", "main" }, { "isStep", false },
+                         { "scripts", QJsonObject{ { "main", QJsonObject{ { "line", 42 } } } } } };
+
+    QList<QByteArray> frames;
+    frames << QJsonDocument(QJsonObject{ { "ty", "publish/RobotStatus" }, { "db", status } }).toJson(QJsonDocument::Compact);
+    frames << QJsonDocument(QJsonObject{ { "ty", "publish/RobotPosture" }, { "db", posture } }).toJson(QJsonDocument::Compact);
+    frames << QJsonDocument(QJsonObject{ { "ty", "publish/ProjectState" }, { "db", project } }).toJson(QJsonDocument::Compact);
+    return frames;
+}
+
+// 按 QML 读取值类型的方式 (QMetaProperty::readOnGadget) 读出全部属性，返回读到的属性个数
+template <class Frame>
+int readAllProperties(const Frame &frame)
+{
+    const QMetaObject &meta = Frame::staticMetaObject;
+    int n = 0;
+    for (int i = meta.propertyOffset(); i < meta.propertyCount(); ++i) {
+        if (meta.property(i).readOnGadget(&frame).isValid()) ++n;
+    }
+    return n;
+}
+
+} // namespace
+
+QVariantMap DiagnosticsClient::parserBenchmark(int iterations)
+{
+    iterations = qBound(1, iterations, 1000000);
+    const QList<QByteArray> frames = benchmarkFrames();
+
+    // 原路径：完整 DOM，db 转成 QVariantMap (近似 QML 收到 QJsonObject 后转成 JS 对象的开销)
+    double domSum = 0;
+    qint64 domTouched = 0;
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < iterations; ++i) {
+        for (const QByteArray &frame : frames) {
+            const QJsonObject root = QJsonDocument::fromJson(frame).object();
+            const QString type = root.value("ty").toString();
+            const QJsonObject db = root.value("db").toObject();
+            domTouched += db.toVariantMap().size();
+            if (type == QLatin1String(RobotStatusFrame::kType)) {
+                domSum += db.value("state").toInt();
+            } else if (type == QLatin1String(RobotPostureFrame::kType)) {
+                const QJsonArray joint = db.value("joint").toArray();
+                for (const QJsonValue &v : joint) domSum += v.toDouble();
+                domSum += db.value("end").toObject().value("z").toDouble();
+            } else if (type == QLatin1String(ProjectStateFrame::kType)) {
+                domSum += db.value("state").toInt();
+                domSum += db.value("scripts").toObject().value("main").toObject().value("line").toInt();
+            }
+        }
+    }
+    const qint64 domNs = timer.nsecsElapsed();
+
+    // 应用实际使用的路径 (RobotClient::processScannedFrame + PageMonitor)：
+    // 读 ty，清空结构体后按字段表提取，再像 QML 绑定一样经元对象读出全部属性
+    RobotStatusFrame status;
+    RobotPostureFrame posture;
+    ProjectStateFrame project;
+    double scanSum = 0;
+    qint64 scanTouched = 0;
+    timer.restart();
+    for (int i = 0; i < iterations; ++i) {
+        for (const QByteArray &frame : frames) {
+            QByteArrayView type;
+            if (!FrameScanner::peekType(frame, type)) continue;
+            if (type == QByteArrayView(RobotStatusFrame::kType)) {
+                status = RobotStatusFrame();
+                status.present = FrameScanner::extract(frame, RobotStatusFrame::fields(), &status);
+                scanTouched += readAllProperties(status);
+                scanSum += status.state;
+            } else if (type == QByteArrayView(RobotPostureFrame::kType)) {
+                posture = RobotPostureFrame();
+                posture.present = FrameScanner::extract(frame, RobotPostureFrame::fields(), &posture);
+                scanTouched += readAllProperties(posture);
+                for (double v : posture.joint) scanSum += v;
+                scanSum += posture.end[2];
+            } else if (type == QByteArrayView(ProjectStateFrame::kType)) {
+                project = ProjectStateFrame();
+                project.present = FrameScanner::extract(frame, ProjectStateFrame::fields(), &project);
+                scanTouched += readAllProperties(project);
+                scanSum += project.state;
+                scanSum += project.scriptLine;
+            }
+        }
+    }
+    const qint64 scanNs = timer.nsecsElapsed();
+
+    const double count = double(iterations) * frames.size();
+    QVariantMap result;
+    result["frames"] = count;
+    result["domNsPerFrame"] = domNs / count;
+    result["scanNsPerFrame"] = scanNs / count;
+    result["speedup"] = scanNs > 0 ? double(domNs) / scanNs : 0.0;
+    result["consistent"] = qFuzzyCompare(domSum, scanSum) && domTouched > 0 && scanTouched > 0;
+    return result;
+}
@@ -0,0 +1,64 @@
+#ifndef DIAGNOSTICSCLIENT_H
+#define DIAGNOSTICSCLIENT_H
+
+#include <QObject>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QVariantList>
+#include <QVariantMap>
+
+// 诊断客户端：把内部指标暴露给 QML，并定期导出到文件
+class DiagnosticsClient : public QObject
+{
+    Q_OBJECT
+
+    // 定期导出间隔 (秒)，0 表示关闭
+    Q_PROPERTY(int dumpIntervalSec READ dumpIntervalSec WRITE setDumpIntervalSec NOTIFY dumpIntervalSecChanged)
+    Q_PROPERTY(QString dumpDir READ dumpDir CONSTANT)
+    // 区间追踪开关 (关闭时埋点几乎零开销)
+    Q_PROPERTY(bool tracing READ tracing WRITE setTracing NOTIFY tracingChanged)
+
+public:
+    explicit DiagnosticsClient(QObject *parent = nullptr);
+    ~DiagnosticsClient();
+
+    int dumpIntervalSec() const { return m_dumpIntervalSec; }
+    void setDumpIntervalSec(int seconds);
+    QString dumpDir() const { return m_dumpDir; }
+    bool tracing() const;
+    void setTracing(bool enabled);
+
+    // 指标快照，计数器额外带上相对上次调用的速率 rate (每秒)
+    Q_INVOKABLE QVariantList metricsSnapshot();
+
+    // 立即导出 metrics.prom / metrics.json
+    Q_INVOKABLE void dumpNow();
+
+    // 导出追踪数据为 Chrome trace-event JSON (chrome://tracing / ui.perfetto.dev 打开)
+    // path 为空时写到 Logs/trace_yyyyMMdd_HHmmss.json，返回实际路径，失败返回空串
+    Q_INVOKABLE QString exportTrace(const QString &path = QString());
+    Q_INVOKABLE void clearTrace();
+    // { enabled, events, dropped, threads }
+    Q_INVOKABLE QVariantMap traceStats() const;
+
+    // 推送报文解析基准：同一组 publish/* 样本帧解析 iterations 轮
+    // DOM 路径到 QVariantMap 为止；扫描路径与 RobotClient 实际使用的一致 (提取到结构体 + 按 QML 方式读出全部属性)
+    // { frames, domNsPerFrame, scanNsPerFrame, speedup, consistent }
+    Q_INVOKABLE QVariantMap parserBenchmark(int iterations = 20000);
+
+signals:
+    void dumpIntervalSecChanged();
+    void tracingChanged();
+
+private:
+    QTimer *m_dumpTimer;
+    int m_dumpIntervalSec = 30;
+    QString m_dumpDir;
+
+    // 计算速率用的上次快照
+    QElapsedTimer m_rateClock;
+    QHash<QString, double> m_lastValues;
+};
+
+#endif // DIAGNOSTICSCLIENT_H
@@ -0,0 +1,479 @@
+#include "framescanner.h"
+
+#include <QtAlgorithms>
+#include <charconv>
+#include <cstring>
+
+namespace FrameScanner {
+
+namespace {
+
+inline const char *skipWs(const char *p, const char *end)
+{
+    while (p < end && (*p == ' ' || *p == '\n' || *p == '\r' || *p == '\t')) ++p;
+    return p;
+}
+
+// p 指向开引号，返回闭引号之后的位置；不完整返回 nullptr
+const char *skipString(const char *p, const char *end)
+{
+    ++p;
+    const char *from = p;
+    for (;;) {
+        const char *q = static_cast<const char *>(std::memchr(from, '"', end - from));
+        if (!q) return nullptr;
+        // 前面连续的反斜杠为奇数个时这个引号是转义的
+        const char *b = q;
+        while (b > from && b[-1] == '\\') --b;
+        if (((q - b) & 1) == 0) return q + 1;
+        from = q + 1;
+    }
+}
+
+// 跳过任意值，返回值之后的位置
+const char *skipValue(const char *p, const char *end)
+{
+    p = skipWs(p, end);
+    if (p >= end) return nullptr;
+
+    if (*p == '"') return skipString(p, end);
+
+    if (*p == '{' || *p == '[') {
+        int depth = 0;
+        while (p < end) {
+            const char c = *p;
+            if (c == '"') {
+                p = skipString(p, end);
+                if (!p) return nullptr;
+                continue;
+            }
+            if (c == '{' || c == '[') {
+                ++depth;
+            } else if (c == '}' || c == ']') {
+                if (--depth == 0) return p + 1;
+            }
+            ++p;
+        }
+        return nullptr;
+    }
+
+    // 数值 / true / false / null
+    while (p < end && *p != ',' && *p != '}' && *p != ']' && *p != ' ' && *p != '\n' && *p != '\r' && *p != '\t') ++p;
+    return p;
+}
+
+const char *parseDouble(const char *p, const char *end, double &value)
+{
+    const std::from_chars_result r = std::from_chars(p, end, value);
+    return r.ec == std::errc() ? r.ptr : nullptr;
+}
+
+const char *parseInt(const char *p, const char *end, qint32 &value)
+{
+    if (end - p >= 4 && std::memcmp(p, "true", 4) == 0) {
+        value = 1;
+        return p + 4;
+    }
+    if (end - p >= 5 && std::memcmp(p, "false", 5) == 0) {
+        value = 0;
+        return p + 5;
+    }
+    // 控制器可能把整数写成 4.0，按数值解析后截断
+    double d = 0;
+    const char *q = parseDouble(p, end, d);
+    if (q) value = static_cast<qint32>(d);
+    return q;
+}
+
+const char *parseArray(const char *p, const char *end, double *values, int count, bool &complete)
+{
+    if (*p != '[') return nullptr;
+    p = skipWs(p + 1, end);
+    int n = 0;
+    if (p < end && *p == ']') {
+        complete = count == 0;
+        return p + 1;
+    }
+    for (;;) {
+        p = skipWs(p, end);
+        if (p >= end) return nullptr;
+        if (n < count) {
+            p = parseDouble(p, end, values[n]);
+        } else {
+            p = skipValue(p, end);
+        }
+        if (!p) return nullptr;
+        ++n;
+        p = skipWs(p, end);
+        if (p >= end) return nullptr;
+        if (*p == ',') {
+            ++p;
+            continue;
+        }
+        if (*p == ']') break;
+        return nullptr;
+    }
+    complete = n >= count;
+    return p + 1;
+}
+
+// 把一个码点按 UTF-8 写入 dst[n..capacity)，放不下时不写并返回 false (截断只发生在码点边界)
+bool appendCodePoint(char32_t cp, char *dst, int &n, int capacity)
+{
+    char buf[4];
+    int len;
+    if (cp < 0x80) {
+        buf[0] = char(cp);
+        len = 1;
+    } else if (cp < 0x800) {
+        buf[0] = char(0xC0 | (cp >> 6));
+        buf[1] = char(0x80 | (cp & 0x3F));
+        len = 2;
+    } else if (cp < 0x10000) {
+        buf[0] = char(0xE0 | (cp >> 12));
+        buf[1] = char(0x80 | ((cp >> 6) & 0x3F));
+        buf[2] = char(0x80 | (cp & 0x3F));
+        len = 3;
+    } else {
+        buf[0] = char(0xF0 | (cp >> 18));
+        buf[1] = char(0x80 | ((cp >> 12) & 0x3F));
+        buf[2] = char(0x80 | ((cp >> 6) & 0x3F));
+        buf[3] = char(0x80 | (cp & 0x3F));
+        len = 4;
+    }
+    if (n + len > capacity) return false;
+    std::memcpy(dst + n, buf, len);
+    n += len;
+    return true;
+}
+
+// 读 \u 后的 4 位十六进制
+bool parseHex4(const char *p, const char *end, char32_t &value)
+{
+    if (end - p < 4) return false;
+    value = 0;
+    for (int i = 0; i < 4; ++i) {
+        const char c = p[i];
+        value <<= 4;
+        if (c >= '0' && c <= '9') value |= char32_t(c - '0');
+        else if (c >= 'a' && c <= 'f') value |= char32_t(c - 'a' + 10);
+        else if (c >= 'A' && c <= 'F') value |= char32_t(c - 'A' + 10);
+        else return false;
+    }
+    return true;
+}
+
+// 解码字符串内容 [p, end) (不含引号) 到 dst，最多写 capacity - 1 字节并以 '\0' 结尾
+// 处理全部 JSON 转义 (含 \uXXXX 代理对)；超长时在码点边界截断；转义非法返回 false
+bool decodeEscaped(const char *p, const char *end, char *dst, int capacity)
+{
+    const int limit = capacity - 1;
+    int n = 0;
+    bool full = false;
+    while (p < end && !full) {
+        const uchar c = uchar(*p);
+        if (c != '\\') {
+            // 原样复制一个 UTF-8 序列
+            const int len = c < 0x80 ? 1 : (c >> 5) == 0x6 ? 2 : (c >> 4) == 0xE ? 3 : (c >> 3) == 0x1E ? 4 : 1;
+            if (end - p < len) return false;
+            if (n + len > limit) break;
+            std::memcpy(dst + n, p, len);
+            n += len;
+            p += len;
+            continue;
+        }
+
+        if (end - p < 2) return false;
+        char32_t cp;
+        switch (p[1]) {
+        case '"': cp = '"'; break;
+        case '\\': cp = '\\'; break;
+        case '/': cp = '/'; break;
+        case 'b': cp = '\b'; break;
+        case 'f': cp = '\f'; break;
+        case 'n': cp = '\n'; break;
+        case 'r': cp = '\r'; break;
+        case 't': cp = '\t'; break;
+        case 'u': {
+            if (!parseHex4(p + 2, end, cp)) return false;
+            p += 6;
+            if (cp >= 0xD800 && cp < 0xDC00) {
+                // 高代理后面应紧跟 \uDC00..\uDFFF
+                char32_t low = 0;
+                if (end - p >= 6 && p[0] == '\\' && p[1] == 'u' && parseHex4(p + 2, end, low)
+                    && low >= 0xDC00 && low < 0xE000) {
+                    cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+                    p += 6;
+                } else {
+                    cp = 0xFFFD;
+                }
+            } else if (cp >= 0xDC00 && cp < 0xE000) {
+                cp = 0xFFFD;
+            }
+            full = !appendCodePoint(cp, dst, n, limit);
+            continue;
+        }
+        default:
+            return false;
+        }
+        p += 2;
+        full = !appendCodePoint(cp, dst, n, limit);
+    }
+    dst[n] = '\0';
+    return true;
+}
+
+struct ScanContext
+{
+    const std::vector<FieldTable::Entry> &entries;
+    char *out;
+    quint32 all;
+    quint32 present = 0;
+
+    bool done() const { return (present & all) == all; }
+};
+
+// 解析一个登记字段，失败返回 nullptr (调用方改为跳过该值)
+const char *parseField(const char *p, const char *end, const FieldTable::Entry &entry, char *out, bool &ok)
+{
+    ok = false;
+    switch (entry.kind) {
+    case FieldKind::Int32: {
+        qint32 v = 0;
+        p = parseInt(p, end, v);
+        if (p) {
+            std::memcpy(out + entry.offset, &v, sizeof(v));
+            ok = true;
+        }
+        return p;
+    }
+    case FieldKind::Float64: {
+        double v = 0;
+        p = parseDouble(p, end, v);
+        if (p) {
+            std::memcpy(out + entry.offset, &v, sizeof(v));
+            ok = true;
+        }
+        return p;
+    }
+    case FieldKind::Float64Array:
+        return parseArray(p, end, reinterpret_cast<double *>(out + entry.offset), entry.count, ok);
+    case FieldKind::Utf8: {
+        if (*p != '"') return nullptr;
+        const char *q = skipString(p, end);
+        if (!q) return nullptr;
+        char *dst = out + entry.offset;
+        ok = decodeEscaped(p + 1, q - 1, dst, entry.count);
+        if (!ok) dst[0] = '\0';
+        return q;
+    }
+    }
+    return nullptr;
+}
+
+// p 指向 '{'，candidates 为路径前 depth 段已匹配的字段
+const char *scanObject(const char *p, const char *end, ScanContext &ctx, quint32 candidates, int depth)
+{
+    p = skipWs(p + 1, end);
+    if (p < end && *p == '}') return p + 1;
+
+    for (;;) {
+        p = skipWs(p, end);
+        if (p >= end || *p != '"') return nullptr;
+        const char *keyBegin = p + 1;
+        p = skipString(p, end);
+        if (!p) return nullptr;
+        const QByteArrayView key(keyBegin, p - 1 - keyBegin);
+
+        p = skipWs(p, end);
+        if (p >= end || *p != ':') return nullptr;
+        p = skipWs(p + 1, end);
+        if (p >= end) return nullptr;
+
+        quint32 terminal = 0;
+        quint32 deeper = 0;
+        for (quint32 m = candidates; m; m &= m - 1) {
+            const int i = qCountTrailingZeroBits(m);
+            const std::vector<QByteArray> &segments = ctx.entries[i].segments;
+            if (int(segments.size()) <= depth) continue;
+            if (segments[depth] != key && segments[depth] != "*") continue;
+            if (int(segments.size()) == depth + 1) terminal |= 1u << i;
+            else deeper |= 1u << i;
+        }
+
+        // 通配路径可能匹配多次，只取第一次
+        terminal &= ~ctx.present;
+        if (terminal) {
+            const int i = qCountTrailingZeroBits(terminal);
+            bool ok = false;
+            const char *q = parseField(p, end, ctx.entries[i], ctx.out, ok);
+            if (ok) ctx.present |= 1u << i;
+            p = q ? q : skipValue(p, end);
+            if (!p) return nullptr;
+            // 登记的字段都拿到了，剩下的部分不再扫描
+            if (ctx.done()) return p;
+        } else if (deeper && *p == '{') {
+            p = scanObject(p, end, ctx, deeper, depth + 1);
+            if (!p) return nullptr;
+            if (ctx.done()) return p;
+        } else {
+            p = skipValue(p, end);
+            if (!p) return nullptr;
+        }
+
+        p = skipWs(p, end);
+        if (p >= end) return nullptr;
+        if (*p == ',') {
+            ++p;
+            continue;
+        }
+        if (*p == '}') return p + 1;
+        return nullptr;
+    }
+}
+
+} // namespace
+
+FieldTable::FieldTable(const FieldSpec *specs, int count)
+{
+    Q_ASSERT(count <= 32);
+    m_entries.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        Entry entry;
+        for (const QByteArray &segment : QByteArray(specs[i].path).split('.')) entry.segments.push_back(segment);
+        entry.kind = specs[i].kind;
+        entry.offset = specs[i].offset;
+        entry.count = specs[i].count;
+        m_entries.push_back(std::move(entry));
+    }
+    m_allMask = count >= 32 ? ~0u : (1u << count) - 1;
+}
+
+bool findValue(QByteArrayView frame, QByteArrayView key, QByteArrayView &value)
+{
+    const char *p = frame.data();
+    const char *end = p + frame.size();
+    p = skipWs(p, end);
+    if (p >= end || *p != '{') return false;
+    p = skipWs(p + 1, end);
+
+    while (p < end && *p == '"') {
+        const char *keyBegin = p + 1;
+        p = skipString(p, end);
+        if (!p) return false;
+        const QByteArrayView name(keyBegin, p - 1 - keyBegin);
+
+        p = skipWs(p, end);
+        if (p >= end || *p != ':') return false;
+        p = skipWs(p + 1, end);
+        if (p >= end) return false;
+
+        const char *valueBegin = p;
+        p = skipValue(p, end);
+        if (!p) return false;
+        if (name == key) {
+            value = QByteArrayView(valueBegin, p - valueBegin);
+            return true;
+        }
+
+        p = skipWs(p, end);
+        if (p < end && *p == ',') p = skipWs(p + 1, end);
+    }
+    return false;
+}
+
+bool peekType(QByteArrayView frame, QByteArrayView &type)
+{
+    QByteArrayView value;
+    if (!findValue(frame, "ty", value)) return false;
+    if (value.size() < 2 || value.front() != '"') return false;
+    type = value.sliced(1, value.size() - 2);
+    // 带转义的类型名交给 QJsonDocument
+    return !type.contains('\\');
+}
+
+qsizetype objectLength(QByteArrayView buffer)
+{
+    if (buffer.isEmpty() || buffer.front() != '{') return -1;
+    const char *p = skipValue(buffer.data(), buffer.data() + buffer.size());
+    return p ? p - buffer.data() : 0;
+}
+
+quint32 extract(QByteArrayView frame, const FieldTable &table, void *out)
+{
+    const char *p = frame.data();
+    const char *end = p + frame.size();
+    p = skipWs(p, end);
+    if (p >= end || *p != '{') return 0;
+
+    ScanContext ctx{ table.entries(), static_cast<char *>(out), table.allMask() };
+    if (!scanObject(p, end, ctx, table.allMask(), 0)) return 0;
+    return ctx.present;
+}
+
+} // namespace FrameScanner
+
+// ==========================================================
+// 主题字段表
+// ==========================================================
+
+using FrameScanner::FieldKind;
+using FrameScanner::FieldSpec;
+using FrameScanner::FieldTable;
+
+const FieldTable &RobotStatusFrame::fields()
+{
+    static const FieldSpec specs[] = {
+        { "db.state", FieldKind::Int32, offsetof(RobotStatusFrame, state), 1 },
+        { "db.mode", FieldKind::Int32, offsetof(RobotStatusFrame, mode), 1 },
+        { "db.moveRate", FieldKind::Float64, offsetof(RobotStatusFrame, moveRate), 1 },
+        { "db.manualMoveRate", FieldKind::Float64, offsetof(RobotStatusFrame, manualMoveRate), 1 },
+        { "db.runDuration", FieldKind::Float64, offsetof(RobotStatusFrame, runDuration), 1 },
+        { "db.ToolId", FieldKind::Int32, offsetof(RobotStatusFrame, toolId), 1 },
+        { "db.CoordinateId", FieldKind::Int32, offsetof(RobotStatusFrame, coordinateId), 1 },
+        { "db.PayloadId", FieldKind::Int32, offsetof(RobotStatusFrame, payloadId), 1 },
+        { "db.defaultToolId", FieldKind::Int32, offsetof(RobotStatusFrame, defaultToolId), 1 },
+        { "db.defaultCoordinateId", FieldKind::Int32, offsetof(RobotStatusFrame, defaultCoordinateId), 1 },
+        { "db.defaultPayloadId", FieldKind::Int32, offsetof(RobotStatusFrame, defaultPayloadId), 1 },
+        { "db.modeSwitch", FieldKind::Int32, offsetof(RobotStatusFrame, modeSwitch), 1 },
+        { "db.recoveryState", FieldKind::Int32, offsetof(RobotStatusFrame, recoveryState), 1 },
+        { "db.rescueFlag", FieldKind::Int32, offsetof(RobotStatusFrame, rescueFlag), 1 },
+        { "db.teachingPendant", FieldKind::Int32, offsetof(RobotStatusFrame, teachingPendant), 1 },
+        { "db.type", FieldKind::Int32, offsetof(RobotStatusFrame, type), 1 },
+        { "db.isSimulation", FieldKind::Int32, offsetof(RobotStatusFrame, isSimulation), 1 },
+        { "db.stateName", FieldKind::Utf8, offsetof(RobotStatusFrame, stateName), int(sizeof(RobotStatusFrame::stateName)) },
+        { "db.soakTs", FieldKind::Float64, offsetof(RobotStatusFrame, soakTs), 1 },
+    };
+    static const FieldTable table(specs, int(std::size(specs)));
+    return table;
+}
+
+const FieldTable &RobotPostureFrame::fields()
+{
+    static const FieldSpec specs[] = {
+        { "db.joint", FieldKind::Float64Array, offsetof(RobotPostureFrame, joint), 6 },
+        { "db.end.x", FieldKind::Float64, offsetof(RobotPostureFrame, end) + 0 * sizeof(double), 1 },
+        { "db.end.y", FieldKind::Float64, offsetof(RobotPostureFrame, end) + 1 * sizeof(double), 1 },
+        { "db.end.z", FieldKind::Float64, offsetof(RobotPostureFrame, end) + 2 * sizeof(double), 1 },
+        { "db.end.a", FieldKind::Float64, offsetof(RobotPostureFrame, end) + 3 * sizeof(double), 1 },
+        { "db.end.b", FieldKind::Float64, offsetof(RobotPostureFrame, end) + 4 * sizeof(double), 1 },
+        { "db.end.c", FieldKind::Float64, offsetof(RobotPostureFrame, end) + 5 * sizeof(double), 1 },
+        { "db.soakTs", FieldKind::Float64, offsetof(RobotPostureFrame, soakTs), 1 },
+    };
+    static const FieldTable table(specs, int(std::size(specs)));
+    return table;
+}
+
+const FieldTable &ProjectStateFrame::fields()
+{
+    static const FieldSpec specs[] = {
+        { "db.state", FieldKind::Int32, offsetof(ProjectStateFrame, state), 1 },
+        { "db.projectType", FieldKind::Int32, offsetof(ProjectStateFrame, projectType), 1 },
+        { "db.isStep", FieldKind::Int32, offsetof(ProjectStateFrame, isStep), 1 },
+        { "db.id", FieldKind::Utf8, offsetof(ProjectStateFrame, id), int(sizeof(ProjectStateFrame::id)) },
+        { "db.scripts.*.line", FieldKind::Int32, offsetof(ProjectStateFrame, scriptLine), 1 },
+        { "db.soakTs", FieldKind::Float64, offsetof(ProjectStateFrame, soakTs), 1 },
+    };
+    static const FieldTable table(specs, int(std::size(specs)));
+    return table;
+}
@@ -0,0 +1,179 @@
+#ifndef FRAMESCANNER_H
+#define FRAMESCANNER_H
+
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QList>
+#include <QObject>
+#include <QString>
+#include <QtGlobal>
+#include <cstddef>
+#include <iterator>
+#include <vector>
+
+// 按需提取的 JSON 帧扫描器 (只在 GUI 线程使用，无内部状态，可重入)
+// - peekType: 直接从原始字节中读出顶层 "ty"，不构建 DOM
+// - extract: 按字段表只解析登记的字段，写入预分配的结构体，其余值按括号/字符串快速跳过
+// 字符串跳过用 memchr (C 库内部是向量化的)，其余为标量扫描
+// 未登记的报文类型仍走 QJsonDocument
+namespace FrameScanner {
+
+enum class FieldKind : quint8 {
+    Int32,   // 整数 / true / false
+    Float64, // 数值
+    Float64Array, // 数值数组，最多 count 个
+    Utf8 // 字符串，解码转义后写入 count 字节的 char 数组 (以 '\0' 结尾，超长时在码点边界截断)
+};
+
+// 字段描述：path 为从根对象起的点分路径，如 "db.state"、"db.end.x"
+// 路径段为 "*" 时匹配任意键 (取第一个匹配到的值)，如 "db.scripts.*.line"
+struct FieldSpec
+{
+    const char *path;
+    FieldKind kind;
+    std::size_t offset; // 在目标结构体中的偏移
+    int count;          // Float64Array 的元素个数
+};
+
+// 编译后的字段表：路径预先拆段，扫描时逐层比较键名
+class FieldTable
+{
+public:
+    FieldTable(const FieldSpec *specs, int count);
+
+    struct Entry
+    {
+        std::vector<QByteArray> segments;
+        FieldKind kind;
+        std::size_t offset;
+        int count;
+    };
+
+    const std::vector<Entry> &entries() const { return m_entries; }
+    quint32 allMask() const { return m_allMask; }
+
+private:
+    std::vector<Entry> m_entries;
+    quint32 m_allMask = 0;
+};
+
+// 读出顶层 "ty" 的原始字节 (不处理转义，类型名不含转义字符)
+bool peekType(QByteArrayView frame, QByteArrayView &type);
+
+// 找到顶层键 key 的值，value 指向 frame 内的原始字节 (字符串含引号)，可据此原地替换
+bool findValue(QByteArrayView frame, QByteArrayView key, QByteArrayView &value);
+
+// buffer 以 '{' 开头时返回第一个完整对象的字节数 (括号计数跳过字符串内容)
+// 数据不完整返回 0，不以 '{' 开头返回 -1
+qsizetype objectLength(QByteArrayView buffer);
+
+// 按字段表提取，返回提取成功的字段位掩码 (第 i 位对应第 i 个字段)
+// 帧不是合法对象时返回 0；未提取到的字段保持原值
+quint32 extract(QByteArrayView frame, const FieldTable &table, void *out);
+
+} // namespace FrameScanner
+
+// ==========================================================
+// 已登记的推送主题 (字段与遥测录制的列一致)
+// 结构体是 Q_GADGET，经 RobotClient 的 robotStatus / robotPosture / projectState 属性直接给 QML 读取
+// ==========================================================
+
+// publish/RobotStatus
+struct RobotStatusFrame
+{
+    Q_GADGET
+    Q_PROPERTY(int state MEMBER state)
+    Q_PROPERTY(int mode MEMBER mode)
+    Q_PROPERTY(double moveRate MEMBER moveRate)
+    Q_PROPERTY(double manualMoveRate MEMBER manualMoveRate)
+    Q_PROPERTY(double runDuration MEMBER runDuration)
+    Q_PROPERTY(int toolId MEMBER toolId)
+    Q_PROPERTY(int coordinateId MEMBER coordinateId)
+    Q_PROPERTY(int payloadId MEMBER payloadId)
+    Q_PROPERTY(int defaultToolId MEMBER defaultToolId)
+    Q_PROPERTY(int defaultCoordinateId MEMBER defaultCoordinateId)
+    Q_PROPERTY(int defaultPayloadId MEMBER defaultPayloadId)
+    Q_PROPERTY(int modeSwitch MEMBER modeSwitch)
+    Q_PROPERTY(int recoveryState MEMBER recoveryState)
+    Q_PROPERTY(int rescueFlag MEMBER rescueFlag)
+    Q_PROPERTY(int teachingPendant MEMBER teachingPendant)
+    Q_PROPERTY(int type MEMBER type)
+    Q_PROPERTY(int isSimulation MEMBER isSimulation)
+    Q_PROPERTY(QString stateName READ stateNameString)
+
+public:
+    qint32 state = -1;
+    qint32 mode = 0;
+    double moveRate = 0;
+    double manualMoveRate = 0;
+    double runDuration = 0;
+    qint32 toolId = 0;
+    qint32 coordinateId = 0;
+    qint32 payloadId = 0;
+    qint32 defaultToolId = 0;
+    qint32 defaultCoordinateId = 0;
+    qint32 defaultPayloadId = 0;
+    qint32 modeSwitch = 0;
+    qint32 recoveryState = 0;
+    qint32 rescueFlag = 0;
+    qint32 teachingPendant = 0;
+    qint32 type = 0;
+    qint32 isSimulation = 0;
+    char stateName[96] = {};
+    // 长稳测试模拟控制器写入的发送时刻 (ns)，真实控制器不带，保持 -1；不作为 QML 属性
+    double soakTs = -1;
+    quint32 present = 0; // 字段位掩码，第 0 位为 state
+
+    static constexpr char kType[] = "publish/RobotStatus";
+    static const FrameScanner::FieldTable &fields();
+    bool hasState() const { return present & 1u; }
+    QString stateNameString() const { return QString::fromUtf8(stateName); }
+};
+
+// publish/RobotPosture
+struct RobotPostureFrame
+{
+    Q_GADGET
+    Q_PROPERTY(QList<double> joint READ jointList)
+    Q_PROPERTY(QList<double> end READ endList)
+
+public:
+    double joint[6] = {};
+    double end[6] = {}; // x y z a b c
+    // 长稳测试模拟控制器写入的发送时刻 (ns)，真实控制器不带，保持 -1；不作为 QML 属性
+    double soakTs = -1;
+    quint32 present = 0; // 第 0 位 joint，第 1-6 位 end.x ~ end.c
+
+    static constexpr char kType[] = "publish/RobotPosture";
+    static const FrameScanner::FieldTable &fields();
+    QList<double> jointList() const { return QList<double>(std::begin(joint), std::end(joint)); }
+    QList<double> endList() const { return QList<double>(std::begin(end), std::end(end)); }
+};
+
+// publish/ProjectState
+struct ProjectStateFrame
+{
+    Q_GADGET
+    Q_PROPERTY(int state MEMBER state)
+    Q_PROPERTY(int projectType MEMBER projectType)
+    Q_PROPERTY(int isStep MEMBER isStep)
+    Q_PROPERTY(QString id READ idString)
+    // 第一个脚本的执行行号，没有脚本时为 0
+    Q_PROPERTY(int scriptLine MEMBER scriptLine)
+
+public:
+    qint32 state = -1;
+    qint32 projectType = 0;
+    qint32 isStep = 0;
+    qint32 scriptLine = 0;
+    char id[128] = {};
+    // 长稳测试模拟控制器写入的发送时刻 (ns)，真实控制器不带，保持 -1；不作为 QML 属性
+    double soakTs = -1;
+    quint32 present = 0;
+
+    static constexpr char kType[] = "publish/ProjectState";
+    static const FrameScanner::FieldTable &fields();
+    QString idString() const { return QString::fromUtf8(id); }
+};
+
+#endif // FRAMESCANNER_H
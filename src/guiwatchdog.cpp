@@ -0,0 +1,371 @@
+#include "guiwatchdog.h"
+#include "metrics.h"
+#include "robotprotocol.h"
+#include "tracer.h"
+
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QDir>
+#include <QThread>
+#include <QDebug>
+#include <algorithm>
+
+namespace {
+
+// 探针投递间隔；卡顿期间的采样间隔
+constexpr qint64 kProbeIntervalMs = 20;
+constexpr unsigned long kSampleIntervalMs = 2;
+// 保留的卡顿记录条数
+constexpr int kMaxEvents = 200;
+
+quint64 sampleKey(int delivery, int handler)
+{
+    return (quint64(quint32(delivery)) << 32) | quint32(handler);
+}
+
+} // namespace
+
+GuiWatchdog *GuiWatchdog::s_instance = nullptr;
+std::atomic<bool> GuiWatchdog::s_active{false};
+
+void GuiDeliveryScope::begin(const char *source, const QString &type)
+{
+    m_startNs = Tracer::nowNs();
+    m_site = m_watchdog->beginDelivery(source, type, m_handlerDepth);
+}
+
+GuiWatchdog::GuiWatchdog(QObject *parent)
+    : QObject(parent)
+{
+    MetricsRegistry &r = MetricsRegistry::instance();
+    m_latencyHist = r.histogram("gui_event_loop_latency_us", "Delay between posting a probe event to the GUI thread and its execution",
+                                MetricsRegistry::latencyBucketsUs());
+    m_stallHist = r.histogram("gui_stall_duration_us", "Duration of GUI event-loop stalls above the threshold",
+                              MetricsRegistry::latencyBucketsUs());
+    m_stallCounter = r.counter("gui_stalls_total", "GUI event-loop stalls above the threshold");
+    m_probeCounter = r.counter("gui_probes_total", "Probe events answered by the GUI thread");
+
+    s_instance = this;
+    setEnabled(true);
+}
+
+GuiWatchdog::~GuiWatchdog()
+{
+    stopProbe();
+    s_active.store(false, std::memory_order_relaxed);
+    if (s_instance == this) s_instance = nullptr;
+}
+
+void GuiWatchdog::setEnabled(bool enabled)
+{
+    if (enabled == isActive() && (m_probeThread != nullptr) == enabled) return;
+
+    if (enabled) {
+        s_active.store(true, std::memory_order_relaxed);
+        startProbe();
+    } else {
+        s_active.store(false, std::memory_order_relaxed);
+        stopProbe();
+    }
+    emit enabledChanged();
+}
+
+void GuiWatchdog::setStallThresholdMs(int ms)
+{
+    ms = qBound(5, ms, 10000);
+    if (ms == stallThresholdMs()) return;
+    m_stallThresholdMs.store(ms, std::memory_order_relaxed);
+    emit stallThresholdMsChanged();
+}
+
+void GuiWatchdog::setOverlayVisible(bool visible)
+{
+    if (visible == m_overlayVisible) return;
+    m_overlayVisible = visible;
+    emit overlayVisibleChanged();
+}
+
+int GuiWatchdog::stallCount() const
+{
+    return int(m_stallCounter->value());
+}
+
+QVariantMap GuiWatchdog::lastStall() const
+{
+    QMutexLocker locker(&m_eventMutex);
+    return m_events.empty() ? QVariantMap() : m_events.front();
+}
+
+// ==========================================================
+// 站点与 GUI 线程位置
+// ==========================================================
+
+int GuiWatchdog::intern(SiteKind kind, const QString &source, const QString &rawName)
+{
+    // 报文类型与 robot_messages_*_total 一样只保留已知类型，其余合并为 other，站点与指标序列都有上限
+    const QString name = kind == Delivery ? RobotProtocol::metricType(rawName) : rawName;
+    const QString key = QString::number(kind) + '|' + source + '|' + name;
+    {
+        // 只有 GUI 线程新增站点，查找不需要和自己竞争
+        const auto it = m_siteIndex.constFind(key);
+        if (it != m_siteIndex.constEnd()) return it.value();
+    }
+
+    MetricsRegistry &r = MetricsRegistry::instance();
+    MetricHistogram *hist = nullptr;
+    QString display;
+    if (kind == Delivery) {
+        const QString labels = MetricsRegistry::label("source", source) + ',' + MetricsRegistry::label("ty", name);
+        hist = r.histogram("gui_signal_delivery_us", "Time spent in receiving handlers per delivered signal",
+                           MetricsRegistry::latencyBucketsUs(), labels);
+        display = source + ":" + name;
+    } else {
+        hist = r.histogram("gui_qml_handler_us", "Time spent in annotated QML handlers",
+                           MetricsRegistry::latencyBucketsUs(), MetricsRegistry::label("handler", name));
+        display = name;
+    }
+
+    QMutexLocker locker(&m_siteMutex);
+    const int site = int(m_sites.size());
+    m_sites.push_back({ kind, display, hist });
+    m_siteIndex.insert(key, site);
+    return site;
+}
+
+QString GuiWatchdog::siteName(int site) const
+{
+    QMutexLocker locker(&m_siteMutex);
+    return site >= 0 && site < int(m_sites.size()) ? m_sites[site].name : QString();
+}
+
+int GuiWatchdog::beginDelivery(const char *source, const QString &type, int &handlerDepth)
+{
+    const int site = intern(Delivery, QString::fromLatin1(source), type);
+    m_deliveryStack.push_back(site);
+    m_currentDelivery.store(site, std::memory_order_relaxed);
+    handlerDepth = int(m_handlerStack.size());
+    return site;
+}
+
+void GuiWatchdog::endDelivery(int site, qint64 startNs, int handlerDepth)
+{
+    const qint64 now = Tracer::nowNs();
+    m_sites[site].hist->observe((now - startNs) / 1000);
+
+    // 未配对的 enter() 在这里收尾
+    if (int(m_handlerStack.size()) > handlerDepth) m_handlerStack.resize(handlerDepth);
+    m_currentHandler.store(m_handlerStack.empty() ? -1 : m_handlerStack.back().site, std::memory_order_relaxed);
+
+    if (!m_deliveryStack.empty()) m_deliveryStack.pop_back();
+    m_currentDelivery.store(m_deliveryStack.empty() ? -1 : m_deliveryStack.back(), std::memory_order_relaxed);
+}
+
+void GuiWatchdog::enter(const QString &handler)
+{
+    if (!isActive()) return;
+    const int site = intern(Handler, QStringLiteral("qml"), handler);
+    m_handlerStack.push_back({ site, Tracer::nowNs() });
+    m_currentHandler.store(site, std::memory_order_relaxed);
+}
+
+void GuiWatchdog::leave()
+{
+    if (m_handlerStack.empty()) return;
+    const HandlerFrame frame = m_handlerStack.back();
+    m_handlerStack.pop_back();
+    m_sites[frame.site].hist->observe((Tracer::nowNs() - frame.startNs) / 1000);
+    m_currentHandler.store(m_handlerStack.empty() ? -1 : m_handlerStack.back().site, std::memory_order_relaxed);
+}
+
+// ==========================================================
+// 探测线程
+// ==========================================================
+
+void GuiWatchdog::startProbe()
+{
+    if (m_probeThread) return;
+    m_stopProbe.store(false);
+    m_probeThread = QThread::create([this] { probeLoop(); });
+    m_probeThread->setObjectName("GuiWatchdogProbe");
+    // 与串口工作线程相同的优先级，GUI 线程卡住时探测线程仍能按时醒来
+    m_probeThread->start(QThread::TimeCriticalPriority);
+}
+
+void GuiWatchdog::stopProbe()
+{
+    if (!m_probeThread) return;
+    m_stopProbe.store(true);
+    m_probeThread->wait();
+    delete m_probeThread;
+    m_probeThread = nullptr;
+}
+
+void GuiWatchdog::probeLoop()
+{
+    quint64 seq = m_ackSeq.load();
+    qint64 postedNs = -1;
+    qint64 nextPostNs = 0;
+    QHash<quint64, int> samples; // (分发, 处理函数) -> 采样次数
+
+    while (!m_stopProbe.load(std::memory_order_relaxed)) {
+        const qint64 now = Tracer::nowNs();
+        const qint64 thresholdNs = qint64(stallThresholdMs()) * 1000000;
+
+        if (postedNs >= 0) {
+            if (m_ackSeq.load(std::memory_order_acquire) == seq) {
+                const qint64 latencyNs = m_ackNs.load(std::memory_order_relaxed) - postedNs;
+                m_latencyHist->observe(latencyNs / 1000);
+                m_probeCounter->add();
+                if (latencyNs >= thresholdNs) reportStall(postedNs, latencyNs, samples);
+                samples.clear();
+                postedNs = -1;
+            } else if (now - postedNs >= thresholdNs) {
+                // 卡顿中：记下 GUI 线程此刻所在的位置
+                ++samples[sampleKey(m_currentDelivery.load(std::memory_order_relaxed),
+                                    m_currentHandler.load(std::memory_order_relaxed))];
+            }
+        }
+
+        if (postedNs < 0 && now >= nextPostNs) {
+            ++seq;
+            postedNs = now;
+            nextPostNs = now + kProbeIntervalMs * 1000000;
+            QMetaObject::invokeMethod(this, [this, seq] {
+                m_ackNs.store(Tracer::nowNs(), std::memory_order_relaxed);
+                m_ackSeq.store(seq, std::memory_order_release);
+            }, Qt::QueuedConnection);
+        }
+
+        QThread::msleep(postedNs >= 0 ? kSampleIntervalMs : 5);
+    }
+
+    if (m_stallLog.isOpen()) m_stallLog.close();
+}
+
+// 探测线程中调用：按采样次数最多的 (分发, 处理函数) 归因
+void GuiWatchdog::reportStall(qint64 postedNs, qint64 latencyNs, const QHash<quint64, int> &samples)
+{
+    m_stallCounter->add();
+    m_stallHist->observe(latencyNs / 1000);
+
+    int total = 0;
+    quint64 topKey = sampleKey(-1, -1);
+    int topCount = 0;
+    for (auto it = samples.constBegin(); it != samples.constEnd(); ++it) {
+        total += it.value();
+        if (it.value() > topCount) {
+            topCount = it.value();
+            topKey = it.key();
+        }
+    }
+    const int delivery = int(qint32(topKey >> 32));
+    const int handler = int(qint32(topKey & 0xffffffffu));
+
+    QString deliveryName = siteName(delivery);
+    if (deliveryName.isEmpty()) deliveryName = total > 0 ? QStringLiteral("(其他事件: 绘制 / 布局 / 定时器)") : QStringLiteral("(未采样)");
+    QString handlerName = siteName(handler);
+    if (handlerName.isEmpty()) handlerName = QStringLiteral("(未标注)");
+
+    const QDateTime startTime = QDateTime::currentDateTime().addMSecs(-(Tracer::nowNs() - postedNs) / 1000000);
+
+    QVariantMap event;
+    event["time"] = startTime.toString("HH:mm:ss.zzz");
+    event["durationMs"] = latencyNs / 1000000.0;
+    event["delivery"] = deliveryName;
+    event["handler"] = handlerName;
+    event["samples"] = total;
+    event["sharePercent"] = total > 0 ? 100.0 * topCount / total : 0.0;
+
+    {
+        QMutexLocker locker(&m_eventMutex);
+        m_events.push_front(event);
+        if (int(m_events.size()) > kMaxEvents) m_events.pop_back();
+    }
+
+    if (!m_stallLog.isOpen()) {
+        const QString dir = QCoreApplication::applicationDirPath() + "/Logs";
+        QDir().mkpath(dir);
+        m_stallLog.setFileName(dir + "/gui_stall_" + QDateTime::currentDateTime().toString("yyyyMMdd") + ".log");
+        if (!m_stallLog.open(QIODevice::WriteOnly | QIODevice::Append | QIODevice::Text)) {
+            qWarning() << "gui stall log open failed:" << m_stallLog.fileName();
+        }
+    }
+    if (m_stallLog.isOpen()) {
+        const QString line = QString("%1 卡顿 %2 ms  分发: %3  处理函数: %4  (采样 %5 次，占 %6%)\n")
+                                 .arg(startTime.toString("yyyy-MM-dd HH:mm:ss.zzz"))
+                                 .arg(latencyNs / 1000000.0, 0, 'f', 1)
+                                 .arg(deliveryName, handlerName)
+                                 .arg(total)
+                                 .arg(event["sharePercent"].toDouble(), 0, 'f', 0);
+        m_stallLog.write(line.toUtf8());
+        m_stallLog.flush();
+    }
+
+    QMetaObject::invokeMethod(this, [this, event] { emit stallDetected(event); }, Qt::QueuedConnection);
+}
+
+// ==========================================================
+// 给 QML 的查询
+// ==========================================================
+
+QVariantMap GuiWatchdog::stats() const
+{
+    QVariantMap map;
+    map["latencyP50Ms"] = m_latencyHist->quantile(0.5) / 1000.0;
+    map["latencyP99Ms"] = m_latencyHist->quantile(0.99) / 1000.0;
+    map["latencyMaxMs"] = m_latencyHist->max() / 1000.0;
+    map["probes"] = m_probeCounter->value();
+    map["stalls"] = m_stallCounter->value();
+    map["thresholdMs"] = stallThresholdMs();
+    return map;
+}
+
+QVariantList GuiWatchdog::stallEvents() const
+{
+    QMutexLocker locker(&m_eventMutex);
+    QVariantList list;
+    list.reserve(int(m_events.size()));
+    for (const QVariantMap &event : m_events) list.append(event);
+    return list;
+}
+
+QVariantList GuiWatchdog::hotspots(int limit) const
+{
+    struct Row
+    {
+        const Site *site;
+        qint64 sumUs;
+    };
+    std::vector<Row> rows;
+    {
+        QMutexLocker locker(&m_siteMutex);
+        rows.reserve(m_sites.size());
+        for (const Site &site : m_sites) {
+            if (site.hist->count() > 0) rows.push_back({ &site, site.hist->sum() });
+        }
+    }
+    std::sort(rows.begin(), rows.end(), [](const Row &a, const Row &b) { return a.sumUs > b.sumUs; });
+
+    QVariantList list;
+    for (const Row &row : rows) {
+        if (limit > 0 && list.size() >= limit) break;
+        QVariantMap map;
+        map["kind"] = row.site->kind == Delivery ? "delivery" : "handler";
+        map["name"] = row.site->name;
+        map["count"] = row.site->hist->count();
+        map["totalMs"] = row.sumUs / 1000.0;
+        map["p99Ms"] = row.site->hist->quantile(0.99) / 1000.0;
+        map["maxMs"] = row.site->hist->max() / 1000.0;
+        list.append(map);
+    }
+    return list;
+}
+
+void GuiWatchdog::clearStalls()
+{
+    {
+        QMutexLocker locker(&m_eventMutex);
+        m_events.clear();
+    }
+    emit stallDetected(QVariantMap());
+}
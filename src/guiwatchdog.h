@@ -0,0 +1,168 @@
+#ifndef GUIWATCHDOG_H
+#define GUIWATCHDOG_H
+
+#include <QObject>
+#include <QFile>
+#include <QHash>
+#include <QMutex>
+#include <QVariantList>
+#include <QVariantMap>
+#include <atomic>
+#include <deque>
+#include <vector>
+
+class QThread;
+class MetricCounter;
+class MetricHistogram;
+
+// GUI 事件循环看门狗
+// 高优先级探测线程定期向 GUI 线程投递探针事件，探针从投递到执行的时间就是事件循环延迟
+// RobotClient / SerialClient 的信号分发包在 GUI_DELIVERY_SCOPE 里，QML 处理函数用 enter() / leave() 标注自己
+// 探针超过阈值仍未执行时判定为卡顿，探测线程持续采样 GUI 线程当前所在的分发与处理函数，卡顿结束后按采样次数归因
+class GuiWatchdog : public QObject
+{
+    Q_OBJECT
+
+    Q_PROPERTY(bool enabled READ enabled WRITE setEnabled NOTIFY enabledChanged)
+    // 事件循环延迟超过该值记为一次卡顿
+    Q_PROPERTY(int stallThresholdMs READ stallThresholdMs WRITE setStallThresholdMs NOTIFY stallThresholdMsChanged)
+    // 主窗口右上角的诊断浮层
+    Q_PROPERTY(bool overlayVisible READ overlayVisible WRITE setOverlayVisible NOTIFY overlayVisibleChanged)
+    Q_PROPERTY(int stallCount READ stallCount NOTIFY stallDetected)
+    Q_PROPERTY(QVariantMap lastStall READ lastStall NOTIFY stallDetected)
+
+public:
+    explicit GuiWatchdog(QObject *parent = nullptr);
+    ~GuiWatchdog();
+
+    // 埋点通过它找到实例，未创建时为空
+    static GuiWatchdog *instance() { return s_instance; }
+    // 关闭时每个埋点只有一次 relaxed 原子读
+    static bool isActive() { return s_active.load(std::memory_order_relaxed); }
+
+    bool enabled() const { return isActive(); }
+    void setEnabled(bool enabled);
+    int stallThresholdMs() const { return m_stallThresholdMs.load(std::memory_order_relaxed); }
+    void setStallThresholdMs(int ms);
+    bool overlayVisible() const { return m_overlayVisible; }
+    void setOverlayVisible(bool visible);
+    int stallCount() const;
+    QVariantMap lastStall() const;
+
+    // QML 处理函数标注，必须成对调用 (建议放在 try / finally 里)
+    // 处理函数抛异常漏掉 leave() 时，外层分发结束会把栈恢复到分发开始时的深度
+    Q_INVOKABLE void enter(const QString &handler);
+    Q_INVOKABLE void leave();
+
+    // { latencyP50Ms, latencyP99Ms, latencyMaxMs, probes, stalls, thresholdMs }
+    Q_INVOKABLE QVariantMap stats() const;
+    // 最近的卡顿 (新的在前)：[{ time, durationMs, delivery, handler, samples, sharePercent }]
+    Q_INVOKABLE QVariantList stallEvents() const;
+    // 分发与处理函数按累计耗时排序：[{ kind, name, count, totalMs, p99Ms, maxMs }]
+    Q_INVOKABLE QVariantList hotspots(int limit = 20) const;
+    Q_INVOKABLE void clearStalls();
+
+    // 分发区间 (仅 GUI 线程，由 GuiDeliveryScope 调用)
+    int beginDelivery(const char *source, const QString &type, int &handlerDepth);
+    void endDelivery(int site, qint64 startNs, int handlerDepth);
+
+signals:
+    void enabledChanged();
+    void stallThresholdMsChanged();
+    void overlayVisibleChanged();
+    void stallDetected(const QVariantMap &event);
+
+private:
+    enum SiteKind { Delivery = 0, Handler = 1 };
+
+    // 一个分发点 (source + 消息类型) 或一个 QML 处理函数
+    struct Site
+    {
+        SiteKind kind;
+        QString name;
+        MetricHistogram *hist;
+    };
+
+    struct HandlerFrame
+    {
+        int site;
+        qint64 startNs;
+    };
+
+    int intern(SiteKind kind, const QString &source, const QString &name);
+    QString siteName(int site) const;
+    void startProbe();
+    void stopProbe();
+    void probeLoop();
+    void reportStall(qint64 postedNs, qint64 latencyNs, const QHash<quint64, int> &samples);
+
+    static GuiWatchdog *s_instance;
+    static std::atomic<bool> s_active;
+
+    // 站点表：只有 GUI 线程新增，探测线程读取名字时加锁
+    mutable QMutex m_siteMutex;
+    std::deque<Site> m_sites;
+    QHash<QString, int> m_siteIndex;
+
+    // GUI 线程当前位置，探测线程采样
+    std::vector<int> m_deliveryStack;
+    std::vector<HandlerFrame> m_handlerStack;
+    std::atomic<int> m_currentDelivery{-1};
+    std::atomic<int> m_currentHandler{-1};
+
+    // 探针应答
+    std::atomic<quint64> m_ackSeq{0};
+    std::atomic<qint64> m_ackNs{0};
+
+    QThread *m_probeThread = nullptr;
+    std::atomic<bool> m_stopProbe{false};
+    std::atomic<int> m_stallThresholdMs{50};
+    bool m_overlayVisible = false;
+
+    // 卡顿记录：探测线程写入，GUI 线程读取
+    mutable QMutex m_eventMutex;
+    std::deque<QVariantMap> m_events;
+    QFile m_stallLog; // 只在探测线程中访问
+
+    MetricHistogram *m_latencyHist;
+    MetricHistogram *m_stallHist;
+    MetricCounter *m_stallCounter;
+    MetricCounter *m_probeCounter;
+};
+
+// RAII 分发区间：构造时入栈，析构时记录耗时并出栈
+class GuiDeliveryScope
+{
+public:
+    GuiDeliveryScope()
+        : m_watchdog(GuiWatchdog::isActive() ? GuiWatchdog::instance() : nullptr)
+    {
+    }
+
+    ~GuiDeliveryScope()
+    {
+        if (m_site >= 0) m_watchdog->endDelivery(m_site, m_startNs, m_handlerDepth);
+    }
+
+    GuiDeliveryScope(const GuiDeliveryScope &) = delete;
+    GuiDeliveryScope &operator=(const GuiDeliveryScope &) = delete;
+
+    bool active() const { return m_watchdog != nullptr; }
+    void begin(const char *source, const QString &type);
+
+private:
+    GuiWatchdog *m_watchdog;
+    int m_site = -1;
+    int m_handlerDepth = 0;
+    qint64 m_startNs = 0;
+};
+
+#define GUI_DELIVERY_CONCAT_INNER(a, b) a##b
+#define GUI_DELIVERY_CONCAT(a, b) GUI_DELIVERY_CONCAT_INNER(a, b)
+
+// 用法：GUI_DELIVERY_SCOPE("robot", type); 类型表达式只在看门狗开启时才求值
+#define GUI_DELIVERY_SCOPE(source, type)                                                        \
+    GuiDeliveryScope GUI_DELIVERY_CONCAT(_guiScope, __LINE__);                                  \
+    if (GUI_DELIVERY_CONCAT(_guiScope, __LINE__).active()) GUI_DELIVERY_CONCAT(_guiScope, __LINE__).begin(source, type)
+
+#endif // GUIWATCHDOG_H
@@ -0,0 +1,401 @@
+#include "impairmentproxy.h"
+#include "Robotclient.h"
+#include "metrics.h"
+
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+constexpr int kSummaryMs = 5000;
+const QByteArray kHeartbeatKey = "Robot/moveToHeartbeat";
+
+} // namespace
+
+ImpairmentProxy::ImpairmentProxy(RobotClient *robot, QObject *parent)
+    : QObject(parent)
+    , m_robot(robot)
+    , m_server(new QTcpServer(this))
+    , m_deliverTimer(new QTimer(this))
+    , m_summaryTimer(new QTimer(this))
+{
+    m_settings = QVariantMap{ { "delayMs", 20 }, { "jitterMs", 10 }, { "distribution", "normal" },
+                              { "spikeProbability", 0.0 }, { "spikeMs", 300 }, { "bandwidthKBps", 0 },
+                              { "maxSegment", 0 }, { "stallEveryMs", 0 }, { "stallMs", 0 },
+                              { "direction", "both" }, { "seed", 0 }, { "heartbeatLateMs", 600 } };
+
+    m_clock.start();
+    connect(m_server, &QTcpServer::newConnection, this, &ImpairmentProxy::onNewConnection);
+
+    m_deliverTimer->setSingleShot(true);
+    m_deliverTimer->setTimerType(Qt::PreciseTimer);
+    connect(m_deliverTimer, &QTimer::timeout, this, &ImpairmentProxy::onDeliver);
+
+    m_summaryTimer->setInterval(kSummaryMs);
+    connect(m_summaryTimer, &QTimer::timeout, this, &ImpairmentProxy::onSummary);
+
+    MetricsRegistry &r = MetricsRegistry::instance();
+    const char *dirLabels[2] = { "dir=\"up\"", "dir=\"down\"" };
+    for (int i = 0; i < 2; ++i) {
+        m_links[i].bytesCounter = r.counter("impair_bytes_total", "Bytes relayed by the impairment proxy", dirLabels[i]);
+        m_links[i].delayHist = r.histogram("impair_delay_us", "Time a segment spent queued in the impairment proxy",
+                                           MetricsRegistry::latencyBucketsUs(), dirLabels[i]);
+    }
+    m_heartbeatHist = r.histogram("impair_heartbeat_interval_us", "moveToHeartbeat inter-arrival time at the controller side",
+                                  { 400000, 450000, 480000, 490000, 500000, 510000, 520000, 550000, 600000,
+                                    750000, 1000000, 2000000, 5000000 });
+}
+
+ImpairmentProxy::~ImpairmentProxy()
+{
+    stop();
+}
+
+bool ImpairmentProxy::running() const
+{
+    return m_server->isListening();
+}
+
+int ImpairmentProxy::listenPort() const
+{
+    return m_server->isListening() ? m_server->serverPort() : 0;
+}
+
+void ImpairmentProxy::setSettings(const QVariantMap &settings)
+{
+    // 只覆盖传入的键，QML 可以单独修改某一项
+    for (auto it = settings.begin(); it != settings.end(); ++it) m_settings[it.key()] = it.value();
+    if (running()) logEvent("参数: " + QJsonDocument(QJsonObject::fromVariantMap(m_settings)).toJson(QJsonDocument::Compact));
+    emit settingsChanged();
+}
+
+bool ImpairmentProxy::start(const QString &host, int port, int listenPort)
+{
+    stop();
+
+    if (!m_server->listen(QHostAddress::LocalHost, quint16(listenPort))) return false;
+    m_targetHost = host;
+    m_targetPort = quint16(port);
+
+    const quint64 seed = m_settings.value("seed").toULongLong();
+    m_rng.seed(seed ? seed : quint64(QDateTime::currentMSecsSinceEpoch()));
+
+    const QString dir = QCoreApplication::applicationDirPath() + "/Logs";
+    QDir().mkpath(dir);
+    m_logFile.setFileName(dir + "/impair_" + QDateTime::currentDateTime().toString("yyyyMMdd_HHmmss") + ".log");
+    if (!m_logFile.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) {
+        qWarning() << "impairment log open failed:" << m_logFile.fileName();
+    }
+
+    // 客户端心跳启停与状态变化写进同一份日志，方便对照控制器侧的心跳间隔
+    m_robotConnections << connect(m_robot, &RobotClient::logGenerated, this, [this](const QString &line) {
+        if (line.contains("心跳") || line.contains("状态变更") || line.contains("连接")) logEvent("[client] " + line);
+    });
+
+    m_summaryTimer->start();
+    logEvent(QString("代理 127.0.0.1:%1 -> %2:%3").arg(this->listenPort()).arg(host).arg(port));
+    logEvent("参数: " + QJsonDocument(QJsonObject::fromVariantMap(m_settings)).toJson(QJsonDocument::Compact));
+    emit runningChanged();
+    return true;
+}
+
+void ImpairmentProxy::stop()
+{
+    if (!running()) return;
+
+    closeSession();
+    m_server->close();
+    m_summaryTimer->stop();
+    for (const QMetaObject::Connection &c : std::as_const(m_robotConnections)) disconnect(c);
+    m_robotConnections.clear();
+
+    logEvent("代理已停止");
+    m_logFile.close();
+    emit runningChanged();
+}
+
+void ImpairmentProxy::stall(int ms)
+{
+    m_manualStallUntilNs = std::max(m_manualStallUntilNs, m_clock.nsecsElapsed() + qint64(ms) * 1000000);
+    logEvent(QString("手动停顿 %1 ms").arg(ms));
+}
+
+void ImpairmentProxy::onNewConnection()
+{
+    while (QTcpSocket *socket = m_server->nextPendingConnection()) {
+        // 只代理一个会话 (RobotClient 只有一条连接)
+        if (m_client) {
+            socket->abort();
+            socket->deleteLater();
+            continue;
+        }
+
+        m_client = socket;
+        m_upstream = new QTcpSocket(this);
+        // 关闭 Nagle，拆分出的段按段发出
+        m_client->setSocketOption(QAbstractSocket::LowDelayOption, 1);
+        m_upstream->setSocketOption(QAbstractSocket::LowDelayOption, 1);
+
+        connect(m_client, &QTcpSocket::readyRead, this, [this] { enqueue(Up, m_client->readAll()); });
+        connect(m_upstream, &QTcpSocket::readyRead, this, [this] { enqueue(Down, m_upstream->readAll()); });
+        connect(m_upstream, &QTcpSocket::connected, this, [this] {
+            logEvent("已连接目标控制器");
+            scheduleDelivery(); // 连接前到达的请求现在可以发出
+        });
+        connect(m_client, &QTcpSocket::disconnected, this, [this] {
+            logEvent("客户端断开");
+            closeSession();
+        });
+        connect(m_upstream, &QTcpSocket::disconnected, this, [this] {
+            logEvent("目标控制器断开");
+            closeSession();
+        });
+        connect(m_upstream, &QTcpSocket::errorOccurred, this, [this](QAbstractSocket::SocketError) {
+            if (!m_upstream) return;
+            logEvent("目标控制器连接错误: " + m_upstream->errorString());
+            closeSession();
+        });
+
+        logEvent("客户端接入，连接目标控制器...");
+        m_upstream->connectToHost(m_targetHost, m_targetPort);
+    }
+}
+
+bool ImpairmentProxy::impaired(Direction dir) const
+{
+    const QString direction = m_settings.value("direction").toString();
+    if (direction == "up") return dir == Up;
+    if (direction == "down") return dir == Down;
+    return true;
+}
+
+qint64 ImpairmentProxy::sampleDelayNs()
+{
+    const double base = m_settings.value("delayMs").toDouble();
+    const double jitter = m_settings.value("jitterMs").toDouble();
+    const QString distribution = m_settings.value("distribution").toString();
+
+    double ms = base;
+    if (jitter > 0) {
+        if (distribution == "uniform") {
+            ms += std::uniform_real_distribution<double>(-jitter, jitter)(m_rng);
+        } else if (distribution == "pareto") {
+            // 帕累托长尾 (alpha = 1.5)：大多数接近基础延迟，偶尔很长
+            const double u = std::uniform_real_distribution<double>(1e-9, 1.0)(m_rng);
+            ms += jitter * (std::pow(u, -1.0 / 1.5) - 1.0);
+        } else {
+            ms += std::normal_distribution<double>(0.0, jitter)(m_rng);
+        }
+    }
+
+    const double spikeProbability = m_settings.value("spikeProbability").toDouble();
+    if (spikeProbability > 0 && std::uniform_real_distribution<double>(0.0, 1.0)(m_rng) < spikeProbability) {
+        ms += m_settings.value("spikeMs").toDouble();
+    }
+    return qint64(std::max(0.0, ms) * 1e6);
+}
+
+// 落在停顿区间内的段推迟到区间结束
+qint64 ImpairmentProxy::applyStall(qint64 dueNs) const
+{
+    if (dueNs < m_manualStallUntilNs) dueNs = m_manualStallUntilNs;
+
+    const qint64 everyNs = m_settings.value("stallEveryMs").toLongLong() * 1000000;
+    const qint64 stallNs = m_settings.value("stallMs").toLongLong() * 1000000;
+    if (everyNs > 0 && stallNs > 0) {
+        const qint64 phase = dueNs % everyNs;
+        if (phase < stallNs) dueNs += stallNs - phase;
+    }
+    return dueNs;
+}
+
+void ImpairmentProxy::enqueue(Direction dir, const QByteArray &data)
+{
+    if (data.isEmpty()) return;
+
+    Link &link = m_links[dir];
+    const qint64 now = m_clock.nsecsElapsed();
+    link.bytes += data.size();
+    link.bytesCounter->add(data.size());
+
+    if (!impaired(dir)) {
+        link.lastDueNs = std::max(now, link.lastDueNs);
+        link.queue.push_back({ link.lastDueNs, now, data });
+        link.queuedBytes += data.size();
+        scheduleDelivery();
+        return;
+    }
+
+    const int maxSegment = m_settings.value("maxSegment").toInt();
+    const double bytesPerNs = m_settings.value("bandwidthKBps").toDouble() * 1024.0 / 1e9;
+
+    qsizetype offset = 0;
+    while (offset < data.size()) {
+        qsizetype size = data.size() - offset;
+        if (maxSegment > 0) {
+            size = std::min<qsizetype>(size, std::uniform_int_distribution<int>(1, maxSegment)(m_rng));
+        }
+        const QByteArray chunk = data.mid(offset, size);
+        offset += size;
+
+        // 带宽：排队等线路空闲再加上传输时间，之后才是传播延迟
+        qint64 sentNs = now;
+        if (bytesPerNs > 0) {
+            sentNs = std::max(now, link.wireFreeNs) + qint64(chunk.size() / bytesPerNs);
+            link.wireFreeNs = sentNs;
+        }
+        qint64 dueNs = applyStall(sentNs + sampleDelayNs());
+        dueNs = std::max(dueNs, link.lastDueNs);
+        link.lastDueNs = dueNs;
+
+        link.queue.push_back({ dueNs, now, chunk });
+        link.queuedBytes += chunk.size();
+    }
+    scheduleDelivery();
+}
+
+void ImpairmentProxy::scheduleDelivery()
+{
+    qint64 earliest = -1;
+    for (const Link &link : m_links) {
+        if (!link.queue.empty() && (earliest < 0 || link.queue.front().dueNs < earliest)) earliest = link.queue.front().dueNs;
+    }
+    if (earliest < 0) {
+        m_deliverTimer->stop();
+        return;
+    }
+    const qint64 waitNs = earliest - m_clock.nsecsElapsed();
+    m_deliverTimer->start(waitNs <= 0 ? 0 : int((waitNs + 999999) / 1000000));
+}
+
+void ImpairmentProxy::onDeliver()
+{
+    const qint64 now = m_clock.nsecsElapsed();
+
+    for (int dir = Up; dir <= Down; ++dir) {
+        Link &link = m_links[dir];
+        QTcpSocket *target = dir == Up ? m_upstream.data() : m_client.data();
+
+        while (!link.queue.empty() && link.queue.front().dueNs <= now) {
+            // 目标还没连上：保留在队列中，连接后重新调度
+            if (!target || target->state() != QAbstractSocket::ConnectedState) break;
+
+            const Segment &segment = link.queue.front();
+            target->write(segment.data);
+            target->flush();
+            link.delayHist->observe((now - segment.arrivedNs) / 1000);
+            if (dir == Up) scanHeartbeats(segment.data);
+            link.queuedBytes -= segment.data.size();
+            link.queue.pop_front();
+        }
+    }
+    scheduleDelivery();
+}
+
+// 统计控制器实际收到心跳的间隔 (关键字可能被拆在两个段里)
+void ImpairmentProxy::scanHeartbeats(const QByteArray &data)
+{
+    const QByteArray window = m_heartbeatTail + data;
+    const qint64 now = m_clock.nsecsElapsed();
+    const qint64 lateNs = m_settings.value("heartbeatLateMs").toLongLong() * 1000000;
+
+    qsizetype from = 0;
+    qsizetype index;
+    while ((index = window.indexOf(kHeartbeatKey, from)) >= 0) {
+        from = index + kHeartbeatKey.size();
+        if (from <= m_heartbeatTail.size()) continue; // 上一段已经统计过
+
+        ++m_heartbeats;
+        if (m_lastHeartbeatNs >= 0) {
+            const qint64 gap = now - m_lastHeartbeatNs;
+            m_heartbeatHist->observe(gap / 1000);
+            m_heartbeatMaxGapNs = std::max(m_heartbeatMaxGapNs, gap);
+            // 心跳会话之间的长间隔不算迟到 (客户端已停止心跳)
+            if (gap > lateNs && gap < 5 * lateNs) {
+                ++m_heartbeatsLate;
+                logEvent(QString("控制器侧心跳迟到: 间隔 %1 ms").arg(gap / 1e6, 0, 'f', 1));
+            }
+        }
+        m_lastHeartbeatNs = now;
+    }
+    m_heartbeatTail = window.right(kHeartbeatKey.size() - 1);
+}
+
+void ImpairmentProxy::closeSession()
+{
+    if (m_client) {
+        m_client->disconnect(this);
+        m_client->abort();
+        m_client->deleteLater();
+    }
+    if (m_upstream) {
+        m_upstream->disconnect(this);
+        m_upstream->abort();
+        m_upstream->deleteLater();
+    }
+    m_client = nullptr;
+    m_upstream = nullptr;
+
+    m_deliverTimer->stop();
+    for (Link &link : m_links) {
+        link.queue.clear();
+        link.queuedBytes = 0;
+        link.lastDueNs = 0;
+        link.wireFreeNs = 0;
+    }
+    m_heartbeatTail.clear();
+    m_lastHeartbeatNs = -1;
+}
+
+void ImpairmentProxy::onSummary()
+{
+    if (!m_client) return;
+    const QVariantMap s = stats();
+    logEvent(QString("汇总: 上行 %1 B (排队 p50/p99 %2/%3 us) 下行 %4 B (%5/%6 us) 心跳 %7 次 p50 %8 ms 最大 %9 ms 迟到 %10")
+                 .arg(s["upBytes"].toULongLong())
+                 .arg(s["upDelayP50Us"].toDouble(), 0, 'f', 0)
+                 .arg(s["upDelayP99Us"].toDouble(), 0, 'f', 0)
+                 .arg(s["downBytes"].toULongLong())
+                 .arg(s["downDelayP50Us"].toDouble(), 0, 'f', 0)
+                 .arg(s["downDelayP99Us"].toDouble(), 0, 'f', 0)
+                 .arg(s["heartbeats"].toULongLong())
+                 .arg(s["heartbeatP50Ms"].toDouble(), 0, 'f', 1)
+                 .arg(s["heartbeatMaxMs"].toDouble(), 0, 'f', 1)
+                 .arg(s["heartbeatLate"].toULongLong()));
+}
+
+QVariantMap ImpairmentProxy::stats() const
+{
+    QVariantMap s;
+    s["upBytes"] = m_links[Up].bytes;
+    s["downBytes"] = m_links[Down].bytes;
+    s["upDelayP50Us"] = m_links[Up].delayHist->quantile(0.50);
+    s["upDelayP99Us"] = m_links[Up].delayHist->quantile(0.99);
+    s["downDelayP50Us"] = m_links[Down].delayHist->quantile(0.50);
+    s["downDelayP99Us"] = m_links[Down].delayHist->quantile(0.99);
+    s["heartbeats"] = m_heartbeats;
+    s["heartbeatP50Ms"] = m_heartbeatHist->quantile(0.50) / 1000.0;
+    s["heartbeatMaxMs"] = m_heartbeatMaxGapNs / 1e6;
+    s["heartbeatLate"] = m_heartbeatsLate;
+    s["queuedBytes"] = m_links[Up].queuedBytes + m_links[Down].queuedBytes;
+    s["logPath"] = m_logFile.fileName();
+    return s;
+}
+
+void ImpairmentProxy::logEvent(const QString &msg)
+{
+    const QString line = QString("[%1] %2").arg(QDateTime::currentDateTime().toString("HH:mm:ss.zzz"), msg);
+    if (m_logFile.isOpen()) {
+        m_logFile.write(line.toUtf8() + "\n");
+        m_logFile.flush();
+    }
+    emit eventLogged(line);
+}
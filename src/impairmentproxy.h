@@ -0,0 +1,128 @@
+#ifndef IMPAIRMENTPROXY_H
+#define IMPAIRMENTPROXY_H
+
+#include <QObject>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QPointer>
+#include <QVariantMap>
+#include <deque>
+#include <random>
+
+class QTcpServer;
+class QTcpSocket;
+class RobotClient;
+class MetricCounter;
+class MetricHistogram;
+
+// 网络损伤代理：监听 127.0.0.1，把唯一的客户端连接转发到目标控制器 (或本地模拟控制器)
+// 两个方向分别按设置注入：延迟分布 (均匀 / 正态 / 帕累托长尾 + 突发尖峰)、带宽上限、TCP 分段、周期性或手动停顿
+// 字节顺序始终保持 (与真实 TCP 一致，后发的段不会早于先发的段到达)
+// 在控制器一侧统计 Robot/moveToHeartbeat 的实际到达间隔，与 RobotClient 的状态变化一起写入 Logs/impair_*.log
+class ImpairmentProxy : public QObject
+{
+    Q_OBJECT
+
+    Q_PROPERTY(bool running READ running NOTIFY runningChanged)
+    Q_PROPERTY(int listenPort READ listenPort NOTIFY runningChanged)
+    // 损伤参数 (运行中修改立即生效):
+    //   delayMs / jitterMs      基础单向延迟与抖动
+    //   distribution            "uniform" | "normal" | "pareto"
+    //   spikeProbability / spikeMs  每段以该概率额外延迟 spikeMs
+    //   bandwidthKBps           带宽上限，0 = 不限
+    //   maxSegment              每段最大字节数，0 = 不拆分 (拆分时段长在 1..maxSegment 间随机)
+    //   stallEveryMs / stallMs  周期性停顿，0 = 关闭
+    //   direction               "both" | "up" (客户端→控制器) | "down"
+    //   seed                    随机种子，0 = 每次不同
+    //   heartbeatLateMs         控制器侧心跳间隔超过该值记为迟到 (默认 600)
+    Q_PROPERTY(QVariantMap settings READ settings WRITE setSettings NOTIFY settingsChanged)
+
+public:
+    explicit ImpairmentProxy(RobotClient *robot, QObject *parent = nullptr);
+    ~ImpairmentProxy();
+
+    bool running() const;
+    int listenPort() const;
+    QVariantMap settings() const { return m_settings; }
+    void setSettings(const QVariantMap &settings);
+
+    // 开始代理到 host:port，listenPort 为 0 时自动分配，返回是否成功
+    Q_INVOKABLE bool start(const QString &host, int port, int listenPort = 0);
+    Q_INVOKABLE void stop();
+    // 立即停顿 ms 毫秒 (两个方向)
+    Q_INVOKABLE void stall(int ms);
+    // { upBytes, downBytes, upDelayP50Us, upDelayP99Us, downDelayP50Us, downDelayP99Us,
+    //   heartbeats, heartbeatP50Ms, heartbeatMaxMs, heartbeatLate, queuedBytes, logPath }
+    Q_INVOKABLE QVariantMap stats() const;
+
+signals:
+    void runningChanged();
+    void settingsChanged();
+    void eventLogged(const QString &line);
+
+private slots:
+    void onNewConnection();
+    void onDeliver();
+    void onSummary();
+
+private:
+    enum Direction { Up = 0, Down = 1 };
+
+    struct Segment
+    {
+        qint64 dueNs;
+        qint64 arrivedNs;
+        QByteArray data;
+    };
+
+    // 单方向的排队状态
+    struct Link
+    {
+        std::deque<Segment> queue;
+        qint64 lastDueNs = 0;  // 保序：后段不早于前段
+        qint64 wireFreeNs = 0; // 带宽：上一段发送完的时刻
+        qint64 queuedBytes = 0;
+        quint64 bytes = 0;
+        MetricCounter *bytesCounter = nullptr;
+        MetricHistogram *delayHist = nullptr;
+    };
+
+    void enqueue(Direction dir, const QByteArray &data);
+    qint64 sampleDelayNs();
+    qint64 applyStall(qint64 dueNs) const;
+    bool impaired(Direction dir) const;
+    void scheduleDelivery();
+    void scanHeartbeats(const QByteArray &data);
+    void closeSession();
+    void logEvent(const QString &msg);
+
+    RobotClient *m_robot;
+    QTcpServer *m_server;
+    QPointer<QTcpSocket> m_client;
+    QPointer<QTcpSocket> m_upstream;
+    QString m_targetHost;
+    quint16 m_targetPort = 0;
+
+    QVariantMap m_settings;
+    std::mt19937_64 m_rng;
+
+    QElapsedTimer m_clock;
+    QTimer *m_deliverTimer;
+    QTimer *m_summaryTimer;
+    Link m_links[2];
+    qint64 m_manualStallUntilNs = 0;
+
+    // 控制器侧心跳到达统计
+    QByteArray m_heartbeatTail; // 上一段末尾，处理跨段的关键字
+    qint64 m_lastHeartbeatNs = -1;
+    quint64 m_heartbeats = 0;
+    quint64 m_heartbeatsLate = 0;
+    qint64 m_heartbeatMaxGapNs = 0;
+    MetricHistogram *m_heartbeatHist;
+
+    QFile m_logFile;
+    QList<QMetaObject::Connection> m_robotConnections;
+};
+
+#endif // IMPAIRMENTPROXY_H
@@ -0,0 +1,463 @@
+#include "iocapture.h"
+#include "Robotclient.h"
+#include "metrics.h"
+#include "tracer.h"
+
+#include <QtAlgorithms>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+using namespace RobotProtocol;
+
+namespace {
+
+constexpr int kMaxDigitalPorts = 64;
+constexpr int kMaxAnalogPorts = 64;
+
+// LEB128 无符号变长整数：小于 128 的值只占 1 字节
+void putVarint(QByteArray &out, quint64 value)
+{
+    while (value >= 0x80) {
+        out.append(char(value | 0x80));
+        value >>= 7;
+    }
+    out.append(char(value));
+}
+
+quint64 getVarint(const QByteArray &in, qsizetype &offset)
+{
+    quint64 value = 0;
+    int shift = 0;
+    while (offset < in.size()) {
+        const quint8 byte = quint8(in.at(offset++));
+        value |= quint64(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) break;
+        shift += 7;
+    }
+    return value;
+}
+
+} // namespace
+
+// ==========================================================
+// DigitalTrack
+// ==========================================================
+
+void DigitalTrack::reset(qint64 timeUs, quint64 level)
+{
+    m_data.clear();
+    m_index.clear();
+    m_startUs = m_lastEdgeUs = m_lastSampleUs = timeUs;
+    m_initial = m_level = level;
+    m_edges = 0;
+}
+
+bool DigitalTrack::append(qint64 timeUs, quint64 level)
+{
+    if (level == m_level) {
+        m_lastSampleUs = timeUs;
+        return false;
+    }
+
+    if (m_edges % kCheckpointEvery == 0) m_index.push_back({ m_lastEdgeUs, m_level, m_data.size() });
+    putVarint(m_data, quint64(timeUs - m_lastEdgeUs));
+    putVarint(m_data, quint64(timeUs - m_lastSampleUs));
+    putVarint(m_data, level ^ m_level);
+
+    m_level = level;
+    m_lastEdgeUs = m_lastSampleUs = timeUs;
+    ++m_edges;
+    return true;
+}
+
+DigitalTrack::Cursor DigitalTrack::seek(qint64 timeUs) const
+{
+    Cursor cursor{ 0, m_startUs, m_initial };
+    const auto it = std::upper_bound(m_index.begin(), m_index.end(), timeUs,
+                                     [](qint64 t, const Checkpoint &c) { return t < c.timeUs; });
+    if (it != m_index.begin()) {
+        const Checkpoint &c = *std::prev(it);
+        cursor = { c.offset, c.timeUs, c.level };
+    }
+
+    // 检查点之后最多解码 kCheckpointEvery 条记录
+    Cursor probe = cursor;
+    Edge edge;
+    while (next(probe, edge) && edge.timeUs <= timeUs) cursor = probe;
+    return cursor;
+}
+
+bool DigitalTrack::next(Cursor &cursor, Edge &edge) const
+{
+    if (cursor.offset >= m_data.size()) return false;
+    edge.timeUs = cursor.timeUs + qint64(getVarint(m_data, cursor.offset));
+    edge.windowUs = qint64(getVarint(m_data, cursor.offset));
+    edge.changed = getVarint(m_data, cursor.offset);
+    edge.level = cursor.level ^ edge.changed;
+    cursor.timeUs = edge.timeUs;
+    cursor.level = edge.level;
+    return true;
+}
+
+// ==========================================================
+// IOCapture
+// ==========================================================
+
+IOCapture::IOCapture(RobotClient *robot, QObject *parent)
+    : QObject(parent)
+    , m_robot(robot)
+    , m_pumpTimer(new QTimer(this))
+    , m_uiTimer(new QTimer(this))
+{
+    m_pumpTimer->setSingleShot(true);
+    m_pumpTimer->setTimerType(Qt::PreciseTimer);
+    connect(m_pumpTimer, &QTimer::timeout, this, &IOCapture::pump);
+
+    m_uiTimer->setInterval(kUiIntervalMs);
+    connect(m_uiTimer, &QTimer::timeout, this, &IOCapture::progressChanged);
+
+    // 断线时在途请求会以失败回调，这里只负责停止继续发送
+    connect(m_robot, &RobotClient::disconnected, this, [this] {
+        if (!running()) return;
+        emit errorOccurred("连接断开，IO 采集停止");
+        stop();
+    });
+
+    MetricsRegistry &r = MetricsRegistry::instance();
+    m_samplesCounter = r.counter("iocapture_samples_total", "IO logic-analyzer samples (GetIOValue replies)");
+    m_edgesCounter = r.counter("iocapture_edges_total", "Digital IO edges recorded by the logic analyzer");
+    m_intervalUs = r.histogram("iocapture_sample_interval_us", "Interval between consecutive IO samples",
+                               MetricsRegistry::latencyBucketsUs());
+}
+
+QString IOCapture::state() const
+{
+    switch (m_state) {
+    case Idle: return QStringLiteral("idle");
+    case Armed: return QStringLiteral("armed");
+    case Capturing: return QStringLiteral("capturing");
+    case Done: return QStringLiteral("done");
+    }
+    return QStringLiteral("idle");
+}
+
+QVariantMap IOCapture::stats() const
+{
+    qint64 analogBytes = qint64(m_analogTimesUs.size() * sizeof(quint32));
+    for (const auto &values : m_analog) analogBytes += qint64(values.size() * sizeof(float));
+
+    const double elapsedSec = m_previousUs / 1e6;
+    QVariantMap map;
+    map["samples"] = m_samples;
+    map["requests"] = m_requests;
+    map["errors"] = m_errors;
+    map["edges"] = m_di.edgeCount() + m_do.edgeCount();
+    map["durationUs"] = lastUs() - firstUs();
+    map["rateHz"] = elapsedSec > 0 ? m_samples / elapsedSec : 0.0;
+    map["meanIntervalUs"] = m_samples > 1 ? double(m_intervalSumUs) / double(m_samples - 1) : 0.0;
+    map["maxIntervalUs"] = m_maxIntervalUs;
+    map["digitalBytes"] = m_di.byteSize() + m_do.byteSize();
+    map["analogBytes"] = analogBytes;
+    map["triggerUs"] = m_triggerUs;
+    map["stopUs"] = m_stopUs;
+    return map;
+}
+
+bool IOCapture::start(const QVariantMap &options)
+{
+    if (running()) return false;
+    if (!m_robot->isConnected()) {
+        emit errorOccurred("未连接机器人，无法采集 IO");
+        return false;
+    }
+
+    m_diCount = qBound(0, options.value("diCount", 16).toInt(), kMaxDigitalPorts);
+    m_doCount = qBound(0, options.value("doCount", 16).toInt(), kMaxDigitalPorts);
+    m_aiCount = qBound(0, options.value("aiCount", 4).toInt(), kMaxAnalogPorts);
+    m_aoCount = qBound(0, options.value("aoCount", 4).toInt(), kMaxAnalogPorts);
+    if (m_diCount + m_doCount + m_aiCount + m_aoCount == 0) {
+        emit errorOccurred("没有要采集的端口");
+        return false;
+    }
+
+    m_channelNames.clear();
+    IOManager::GetIOValue request;
+    auto addPorts = [this, &request](IOType type, int count) {
+        for (int port = 0; port < count; ++port) {
+            request.ports.push_back({ type, port });
+            m_channelNames << QString("%1%2").arg(QLatin1String(ioTypeName(type))).arg(port);
+        }
+    };
+    addPorts(IOType::DI, m_diCount);
+    addPorts(IOType::DO, m_doCount);
+    addPorts(IOType::AI, m_aiCount);
+    addPorts(IOType::AO, m_aoCount);
+    m_requestDb = request.toDb();
+
+    if (!parseTrigger(options.value("startTrigger"), m_startTrigger)
+        || !parseTrigger(options.value("stopTrigger"), m_stopTrigger)) {
+        emit errorOccurred("触发条件无效：通道须为已采集的 DI / DO");
+        return false;
+    }
+
+    m_depth = qBound(1, options.value("depth", 4).toInt(), 64);
+    const double maxRateHz = std::max(0.0, options.value("maxRateHz", 0).toDouble());
+    m_periodNs = maxRateHz > 0 ? qint64(1e9 / maxRateHz) : 0;
+    m_postTriggerUs = std::max<qint64>(0, options.value("postTriggerMs", 0).toLongLong()) * 1000;
+    m_maxDurationUs = qBound<qint64>(1, options.value("maxDurationMs", 600000).toLongLong(), kMaxDurationMs) * 1000;
+
+    ++m_generation;
+    m_inFlight = 0;
+    m_nextSendNs = 0;
+    m_startNs = Tracer::nowNs();
+    m_triggerUs = m_stopUs = -1;
+    m_havePrevious = false;
+    m_previousUs = 0;
+    m_di.reset(0, 0);
+    m_do.reset(0, 0);
+    m_analogTimesUs.clear();
+    m_analog.assign(size_t(m_aiCount + m_aoCount), {});
+    m_samples = m_requests = m_errors = 0;
+    m_maxIntervalUs = m_intervalSumUs = 0;
+
+    setState(m_startTrigger.channel >= 0 ? Armed : Capturing);
+    m_uiTimer->start();
+    pump();
+    return true;
+}
+
+void IOCapture::stop()
+{
+    if (!running()) return;
+    finish();
+}
+
+void IOCapture::clear()
+{
+    stop();
+    m_triggerUs = m_stopUs = -1;
+    m_di.reset(0, 0);
+    m_do.reset(0, 0);
+    m_analogTimesUs.clear();
+    m_analogTimesUs.shrink_to_fit();
+    m_analog.clear();
+    m_samples = m_requests = m_errors = 0;
+    m_maxIntervalUs = m_intervalSumUs = 0;
+    setState(Idle);
+    emit progressChanged();
+}
+
+void IOCapture::finish()
+{
+    ++m_generation;
+    m_pumpTimer->stop();
+    m_uiTimer->stop();
+    setState(m_triggerUs >= 0 ? Done : Idle);
+    emit progressChanged();
+}
+
+void IOCapture::setState(State state)
+{
+    if (m_state == state) return;
+    m_state = state;
+    emit stateChanged();
+}
+
+double IOCapture::firstUs() const
+{
+    return m_triggerUs >= 0 ? double(m_di.startUs()) : 0.0;
+}
+
+double IOCapture::lastUs() const
+{
+    return m_triggerUs >= 0 ? double(m_di.lastSampleUs()) : 0.0;
+}
+
+bool IOCapture::isDigital(int channel) const
+{
+    return channel >= 0 && channel < m_diCount + m_doCount;
+}
+
+const DigitalTrack *IOCapture::digitalTrack(int channel, int *bit) const
+{
+    if (channel < 0) return nullptr;
+    if (channel < m_diCount) {
+        *bit = channel;
+        return &m_di;
+    }
+    if (channel < m_diCount + m_doCount) {
+        *bit = channel - m_diCount;
+        return &m_do;
+    }
+    return nullptr;
+}
+
+const std::vector<float> *IOCapture::analogValues(int channel) const
+{
+    const int index = channel - m_diCount - m_doCount;
+    if (channel < 0 || index < 0 || index >= int(m_analog.size())) return nullptr;
+    return &m_analog[size_t(index)];
+}
+
+double IOCapture::valueAt(int channel, double timeUs) const
+{
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    if (m_triggerUs < 0 || timeUs < firstUs() || timeUs > lastUs()) return nan;
+
+    int bit = 0;
+    if (const DigitalTrack *track = digitalTrack(channel, &bit)) return double((track->seek(qint64(timeUs)).level >> bit) & 1);
+
+    const std::vector<float> *values = analogValues(channel);
+    if (!values) return nan;
+    const quint32 relativeUs = quint32(timeUs - firstUs());
+    const auto it = std::upper_bound(m_analogTimesUs.begin(), m_analogTimesUs.end(), relativeUs);
+    if (it == m_analogTimesUs.begin()) return nan;
+    return double((*values)[size_t(std::prev(it) - m_analogTimesUs.begin())]);
+}
+
+// ==========================================================
+// 轮询
+// ==========================================================
+
+void IOCapture::pump()
+{
+    while (running() && m_inFlight < m_depth) {
+        const qint64 now = Tracer::nowNs();
+        if (m_periodNs > 0 && now < m_nextSendNs) {
+            m_pumpTimer->start(int((m_nextSendNs - now) / 1000000));
+            return;
+        }
+
+        const quint64 generation = m_generation;
+        const QString id = m_robot->sendProbe(QLatin1String(IOManager::GetIOValue::kType), m_requestDb, this,
+                                              [this, generation, now](const QJsonObject *root) { onReply(generation, now, root); });
+        if (id.isEmpty()) {
+            emit errorOccurred("发送失败，IO 采集停止");
+            stop();
+            return;
+        }
+        ++m_inFlight;
+        ++m_requests;
+        // 按计划时刻推进，不因前面的延迟而补发成突发
+        if (m_periodNs > 0) m_nextSendNs = std::max(m_nextSendNs, now) + m_periodNs;
+    }
+}
+
+void IOCapture::onReply(quint64 generation, qint64 sentNs, const QJsonObject *root)
+{
+    if (generation != m_generation) return;
+    --m_inFlight;
+
+    IOManager::GetIOValue::Reply values;
+    if (!root || !IOManager::GetIOValue::parseReply(root->value("db"), values)) {
+        ++m_errors;
+    } else {
+        // 控制器在收到请求之后、发出回复之前读取 IO；同一次读取的多个回复共用估计的发送时刻，至少不早于请求发出
+        const qint64 recvNs = m_robot->currentFrameRecvNs();
+        const qint64 sampleNs = std::clamp(m_robot->currentFrameSentNs(), sentNs, std::max(sentNs, recvNs));
+        addSample(std::max((sampleNs - m_startNs) / 1000, m_previousUs), values);
+    }
+    pump();
+}
+
+void IOCapture::addSample(qint64 timeUs, const std::vector<IOValue> &values)
+{
+    quint64 di = 0;
+    quint64 dout = 0;
+    std::vector<float> analog(m_analog.size(), std::numeric_limits<float>::quiet_NaN());
+    for (const IOValue &v : values) {
+        switch (v.type) {
+        case IOType::DI: if (v.port >= 0 && v.port < m_diCount && v.value != 0) di |= quint64(1) << v.port; break;
+        case IOType::DO: if (v.port >= 0 && v.port < m_doCount && v.value != 0) dout |= quint64(1) << v.port; break;
+        case IOType::AI: if (v.port >= 0 && v.port < m_aiCount) analog[size_t(v.port)] = float(v.value); break;
+        case IOType::AO: if (v.port >= 0 && v.port < m_aoCount) analog[size_t(m_aiCount + v.port)] = float(v.value); break;
+        }
+    }
+
+    ++m_samples;
+    m_samplesCounter->add();
+    if (m_havePrevious) {
+        const qint64 intervalUs = timeUs - m_previousUs;
+        m_intervalUs->observe(intervalUs);
+        m_intervalSumUs += intervalUs;
+        m_maxIntervalUs = std::max(m_maxIntervalUs, intervalUs);
+    }
+
+    if (m_state == Armed) {
+        if (m_havePrevious && fired(m_startTrigger, m_previousDi, m_previousDo, di, dout)) {
+            // 记录从触发前最后一次采样开始，触发边沿作为第一条变化
+            beginRecording(m_previousUs, m_previousDi, m_previousDo);
+            setState(Capturing);
+            emit triggered(double(timeUs));
+        }
+    } else if (m_state == Capturing && m_triggerUs < 0) {
+        beginRecording(timeUs, di, dout);
+    }
+
+    if (m_state == Capturing) {
+        const uint edges = qPopulationCount(di ^ m_di.level()) + qPopulationCount(dout ^ m_do.level());
+        m_di.append(timeUs, di);
+        m_do.append(timeUs, dout);
+        if (edges > 0) m_edgesCounter->add(edges);
+
+        m_analogTimesUs.push_back(quint32(timeUs - m_triggerUs));
+        for (size_t i = 0; i < m_analog.size(); ++i) m_analog[i].push_back(analog[i]);
+
+        if (m_stopUs < 0 && m_stopTrigger.channel >= 0 && m_havePrevious
+            && fired(m_stopTrigger, m_previousDi, m_previousDo, di, dout)) {
+            m_stopUs = timeUs;
+        }
+    }
+
+    m_havePrevious = true;
+    m_previousUs = timeUs;
+    m_previousDi = di;
+    m_previousDo = dout;
+
+    if (m_state != Capturing) return;
+    if ((m_stopUs >= 0 && timeUs - m_stopUs >= m_postTriggerUs) || timeUs - m_triggerUs >= m_maxDurationUs) finish();
+}
+
+void IOCapture::beginRecording(qint64 timeUs, quint64 diLevel, quint64 doLevel)
+{
+    m_triggerUs = timeUs;
+    m_di.reset(timeUs, diLevel);
+    m_do.reset(timeUs, doLevel);
+    m_analogTimesUs.clear();
+    for (auto &values : m_analog) values.clear();
+}
+
+bool IOCapture::parseTrigger(const QVariant &value, Trigger &trigger) const
+{
+    trigger = Trigger();
+    const QVariantMap map = value.toMap();
+    const QString channel = map.value("channel").toString().trimmed().toUpper();
+    if (channel.isEmpty()) return true;
+
+    trigger.channel = int(m_channelNames.indexOf(channel));
+    if (!isDigital(trigger.channel)) return false;
+
+    const QString edge = map.value("edge", "rising").toString();
+    if (edge == "falling") trigger.edge = Trigger::Falling;
+    else if (edge == "both") trigger.edge = Trigger::Both;
+    else trigger.edge = Trigger::Rising;
+    return true;
+}
+
+bool IOCapture::fired(const Trigger &trigger, quint64 diBefore, quint64 doBefore, quint64 diNow, quint64 doNow) const
+{
+    int bit = 0;
+    const DigitalTrack *track = digitalTrack(trigger.channel, &bit);
+    if (!track) return false;
+    const bool isDi = track == &m_di;
+    const bool before = ((isDi ? diBefore : doBefore) >> bit) & 1;
+    const bool now = ((isDi ? diNow : doNow) >> bit) & 1;
+    if (before == now) return false;
+    switch (trigger.edge) {
+    case Trigger::Rising: return now;
+    case Trigger::Falling: return !now;
+    case Trigger::Both: return true;
+    }
+    return false;
+}
@@ -0,0 +1,208 @@
+#ifndef IOCAPTURE_H
+#define IOCAPTURE_H
+
+#include <QObject>
+#include <QByteArray>
+#include <QJsonObject>
+#include <QJsonValue>
+#include <QStringList>
+#include <QTimer>
+#include <QVariantMap>
+#include <vector>
+#include "robotprotocol.h"
+
+class RobotClient;
+class MetricCounter;
+class MetricHistogram;
+
+// 一组数字量 (DI 或 DO，最多 64 路) 的电平历史
+// 只在电平变化时追加一条记录，记录按变长整数打包：
+//   距上一条记录的时间 (us) + 变化前最后一次采样到本次采样的间隔 (us，边沿就发生在这个窗口内) + 变化位掩码
+// 每 kCheckpointEvery 条记录建一个检查点 (时间、电平、偏移)，按时间定位时二分查找检查点后顺序解码
+class DigitalTrack
+{
+public:
+    static constexpr int kCheckpointEvery = 64;
+
+    struct Edge
+    {
+        qint64 timeUs;   // 观察到新电平的采样时刻
+        qint64 windowUs; // 边沿发生在 (timeUs - windowUs, timeUs] 内
+        quint64 level;   // 变化后的电平
+        quint64 changed; // 变化的位
+    };
+
+    // 解码位置：已解码到的最后一条记录之后的状态
+    struct Cursor
+    {
+        qsizetype offset = 0;
+        qint64 timeUs = 0;
+        quint64 level = 0;
+    };
+
+    void reset(qint64 timeUs, quint64 level);
+    // 一次采样，电平变化时追加记录并返回 true
+    bool append(qint64 timeUs, quint64 level);
+
+    quint64 level() const { return m_level; }
+    qint64 startUs() const { return m_startUs; }
+    qint64 lastSampleUs() const { return m_lastSampleUs; }
+    qint64 edgeCount() const { return m_edges; }
+    qint64 byteSize() const { return m_data.size() + qint64(m_index.size() * sizeof(Checkpoint)); }
+
+    // 定位到 timeUs：cursor.level 为该时刻的电平，之后 next() 依次返回 timeUs 之后的边沿
+    Cursor seek(qint64 timeUs) const;
+    bool next(Cursor &cursor, Edge &edge) const;
+
+private:
+    struct Checkpoint
+    {
+        qint64 timeUs;
+        quint64 level;
+        qsizetype offset;
+    };
+
+    QByteArray m_data;
+    std::vector<Checkpoint> m_index;
+    qint64 m_startUs = 0;
+    quint64 m_initial = 0;
+    quint64 m_level = 0;
+    qint64 m_lastEdgeUs = 0;
+    qint64 m_lastSampleUs = 0;
+    qint64 m_edges = 0;
+};
+
+// IO 高速采集 (逻辑分析仪)
+// 用 IOManager/GetIOValue 流水线轮询 (同时在途 depth 个请求，回复一到就补发)，请求经 sendProbe 发送，不经过缓存也不刷新 IO 页面
+// 采样时刻取 RobotClient 估计的控制器发送时刻 (开启时钟同步时扣除单程延迟)
+// DI / DO 存为 DigitalTrack 变化记录，AI / AO 存为 float 数组 + 共用的 32 位相对时间戳
+// 时间都以 us 计，相对于 start() 时刻；单次记录最长 kMaxDurationMs
+class IOCapture : public QObject
+{
+    Q_OBJECT
+
+    // "idle" / "armed" (等待开始触发) / "capturing" / "done"
+    Q_PROPERTY(QString state READ state NOTIFY stateChanged)
+    Q_PROPERTY(bool running READ running NOTIFY stateChanged)
+    Q_PROPERTY(QStringList channels READ channels NOTIFY stateChanged)
+    Q_PROPERTY(QVariantMap stats READ stats NOTIFY progressChanged)
+
+public:
+    static constexpr qint64 kMaxDurationMs = 60 * 60 * 1000; // 32 位 us 时间戳可表示约 71 分钟
+
+    struct Trigger
+    {
+        int channel = -1; // channels() 中的序号，-1 = 不触发
+        enum Edge { Rising, Falling, Both } edge = Rising;
+    };
+
+    explicit IOCapture(RobotClient *robot, QObject *parent = nullptr);
+
+    QString state() const;
+    bool running() const { return m_state == Armed || m_state == Capturing; }
+    // 通道名：DI0.. DO0.. AI0.. AO0..
+    QStringList channels() const { return m_channelNames; }
+
+    // { samples, requests, errors, edges, durationUs, rateHz, meanIntervalUs, maxIntervalUs, digitalBytes, analogBytes,
+    //   triggerUs, stopUs }
+    QVariantMap stats() const;
+
+    // options (均可省略):
+    //   diCount / doCount (16)  aiCount / aoCount (4)   采集的端口数 (数字量每组最多 64)
+    //   depth (4)               同时在途的请求数
+    //   maxRateHz (0)           轮询速率上限，0 = 控制器能回多快就多快
+    //   startTrigger            { channel: "DI3", edge: "rising" | "falling" | "both" }，省略 = 立即开始
+    //   stopTrigger             同上，省略 = 手动停止
+    //   postTriggerMs (0)       停止触发后继续采集的时间
+    //   maxDurationMs (600000)  最长采集时间 (上限 kMaxDurationMs)
+    // 未连接或正在采集时返回 false
+    Q_INVOKABLE bool start(const QVariantMap &options = QVariantMap());
+    Q_INVOKABLE void stop();
+    Q_INVOKABLE void clear();
+
+    // 已采集数据的时间范围 (us)，没有数据时两者相同
+    Q_INVOKABLE double firstUs() const;
+    Q_INVOKABLE double lastUs() const;
+    // 某通道在某时刻的值 (数字量 0 / 1，模拟量取该时刻之前最后一次采样)，无数据返回 NaN
+    Q_INVOKABLE double valueAt(int channel, double timeUs) const;
+
+    // 时间轴绘制使用
+    int channelCount() const { return int(m_channelNames.size()); }
+    bool isDigital(int channel) const;
+    // 数字通道所在的记录与位号
+    const DigitalTrack *digitalTrack(int channel, int *bit) const;
+    // 模拟通道的采样值，与 analogTimesUs() 一一对应；模拟量时间戳相对 firstUs() (等待触发可能超过 32 位可表示的时长)
+    const std::vector<float> *analogValues(int channel) const;
+    const std::vector<quint32> &analogTimesUs() const { return m_analogTimesUs; }
+
+signals:
+    void stateChanged();
+    // 采集中每 kUiIntervalMs 发一次，时间轴据此重绘
+    void progressChanged();
+    void triggered(double timeUs);
+    void errorOccurred(const QString &message);
+
+private slots:
+    void pump();
+
+private:
+    enum State { Idle, Armed, Capturing, Done };
+    static constexpr int kUiIntervalMs = 100;
+
+    bool parseTrigger(const QVariant &value, Trigger &trigger) const;
+    bool fired(const Trigger &trigger, quint64 diBefore, quint64 doBefore, quint64 diNow, quint64 doNow) const;
+    void onReply(quint64 generation, qint64 sentNs, const QJsonObject *root);
+    void addSample(qint64 timeUs, const std::vector<RobotProtocol::IOValue> &values);
+    void beginRecording(qint64 timeUs, quint64 diLevel, quint64 doLevel);
+    void finish();
+    void setState(State state);
+
+    RobotClient *m_robot;
+    QTimer *m_pumpTimer;
+    QTimer *m_uiTimer;
+
+    State m_state = Idle;
+    quint64 m_generation = 0; // stop() 后迟到的回复按代号丢弃
+    int m_depth = 4;
+    qint64 m_periodNs = 0;
+    qint64 m_nextSendNs = 0;
+    int m_inFlight = 0;
+    qint64 m_startNs = 0;
+    qint64 m_maxDurationUs = 0;
+    QJsonValue m_requestDb;
+
+    int m_diCount = 0;
+    int m_doCount = 0;
+    int m_aiCount = 0;
+    int m_aoCount = 0;
+    QStringList m_channelNames;
+
+    Trigger m_startTrigger;
+    Trigger m_stopTrigger;
+    qint64 m_postTriggerUs = 0;
+    qint64 m_triggerUs = -1;
+    qint64 m_stopUs = -1; // 停止触发时刻，加上 m_postTriggerUs 后结束
+
+    // 上一次采样 (等待触发时也更新，用于判断边沿与记录起始电平)
+    bool m_havePrevious = false;
+    qint64 m_previousUs = 0;
+    quint64 m_previousDi = 0;
+    quint64 m_previousDo = 0;
+
+    DigitalTrack m_di;
+    DigitalTrack m_do;
+    std::vector<quint32> m_analogTimesUs;
+    std::vector<std::vector<float>> m_analog; // [aiCount + aoCount][样本]
+
+    qint64 m_samples = 0;
+    qint64 m_requests = 0;
+    qint64 m_errors = 0;
+    qint64 m_maxIntervalUs = 0;
+    qint64 m_intervalSumUs = 0;
+
+    MetricCounter *m_samplesCounter;
+    MetricCounter *m_edgesCounter;
+    MetricHistogram *m_intervalUs;
+};
+
+#endif // IOCAPTURE_H
@@ -0,0 +1,426 @@
+#include "iotimeline.h"
+
+#include <QPainter>
+#include <QWheelEvent>
+#include <QtAlgorithms>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+namespace {
+
+// 两个边沿相距小于这么多像素时合并成实心块
+constexpr qreal kMinEdgePx = 2.0;
+// 不确定窗口至少这么宽才画出来
+constexpr qreal kMinWindowPx = 2.0;
+
+const QColor kGrid(0xe5, 0xe7, 0xeb);
+const QColor kLabel(0x6b, 0x72, 0x80);
+const QColor kDigital(0x25, 0x63, 0xeb);
+const QColor kWindow(0x93, 0xc5, 0xfd, 90);
+const QColor kAnalog(0xea, 0x58, 0x0c);
+const QColor kTrigger(0x16, 0xa3, 0x4a);
+const QColor kStop(0xdc, 0x26, 0x26);
+
+// 1 / 2 / 5 × 10^n 的刻度间隔
+double niceStep(double raw)
+{
+    const double base = std::pow(10.0, std::floor(std::log10(raw)));
+    for (double m : { 1.0, 2.0, 5.0 }) {
+        if (base * m >= raw) return base * m;
+    }
+    return base * 10.0;
+}
+
+QString formatTime(double us, double step)
+{
+    if (step >= 1e6) return QString::number(us / 1e6, 'f', 0) + " s";
+    if (step >= 1000) return QString::number(us / 1000, 'f', 0) + " ms";
+    return QString::number(us / 1000, 'f', 3) + " ms";
+}
+
+} // namespace
+
+IOTimeline::IOTimeline(QQuickItem *parent)
+    : QQuickPaintedItem(parent)
+{
+    setAcceptedMouseButtons(Qt::LeftButton);
+    setAcceptHoverEvents(true);
+    setAntialiasing(false); // 数字波形要清晰的直角
+    updateImplicitHeight();
+}
+
+void IOTimeline::setCapture(IOCapture *capture)
+{
+    if (m_capture == capture) return;
+    if (m_capture) m_capture->disconnect(this);
+    m_capture = capture;
+    if (capture) {
+        connect(capture, &IOCapture::progressChanged, this, &IOTimeline::onCaptureProgress);
+        connect(capture, &IOCapture::stateChanged, this, [this] {
+            updateImplicitHeight();
+            if (m_capture->running()) setFollow(true);
+            else fitAll();
+        });
+    }
+    updateImplicitHeight();
+    emit captureChanged();
+    update();
+}
+
+void IOTimeline::setViewStartUs(double us)
+{
+    if (qFuzzyCompare(m_viewStartUs, us)) return;
+    m_viewStartUs = us;
+    emit viewChanged();
+    update();
+}
+
+void IOTimeline::setViewSpanUs(double us)
+{
+    us = std::max(us, kMinSpanUs);
+    if (qFuzzyCompare(m_viewSpanUs, us)) return;
+    m_viewSpanUs = us;
+    emit viewChanged();
+    update();
+}
+
+void IOTimeline::setFollow(bool follow)
+{
+    if (m_follow == follow) return;
+    m_follow = follow;
+    emit followChanged();
+    if (follow) onCaptureProgress();
+}
+
+void IOTimeline::fitAll()
+{
+    if (!m_capture) return;
+    const double first = m_capture->firstUs();
+    const double span = std::max(m_capture->lastUs() - first, 1000.0);
+    m_viewStartUs = first - span * 0.01;
+    m_viewSpanUs = span * 1.02;
+    emit viewChanged();
+    update();
+}
+
+void IOTimeline::onCaptureProgress()
+{
+    // 跟随时保持缩放比例，最新数据贴在右边
+    if (m_follow && m_capture && m_capture->running()) {
+        const double last = m_capture->lastUs();
+        const double first = m_capture->firstUs();
+        m_viewStartUs = last - first > m_viewSpanUs ? last - m_viewSpanUs : first;
+        emit viewChanged();
+    }
+    update();
+}
+
+void IOTimeline::updateImplicitHeight()
+{
+    int height = kAxisHeight;
+    if (m_capture) {
+        for (int c = 0; c < m_capture->channelCount(); ++c)
+            height += m_capture->isDigital(c) ? kDigitalRowHeight : kAnalogRowHeight;
+    }
+    setImplicitHeight(height);
+}
+
+double IOTimeline::toX(double timeUs) const
+{
+    return kGutterWidth + (timeUs - m_viewStartUs) / m_viewSpanUs * (width() - kGutterWidth);
+}
+
+double IOTimeline::toTime(double x) const
+{
+    return m_viewStartUs + (x - kGutterWidth) / std::max(1.0, width() - kGutterWidth) * m_viewSpanUs;
+}
+
+// ==========================================================
+// 绘制
+// ==========================================================
+
+void IOTimeline::paint(QPainter *painter)
+{
+    painter->fillRect(boundingRect(), Qt::white);
+    if (!m_capture || width() <= kGutterWidth) return;
+
+    paintAxis(painter);
+
+    const int channels = m_capture->channelCount();
+    qreal top = kAxisHeight;
+    for (int c = 0; c < channels;) {
+        int bit = 0;
+        if (const DigitalTrack *track = m_capture->digitalTrack(c, &bit)) {
+            // 同一组 (DI 或 DO) 的通道一次解码
+            int count = 1;
+            int nextBit = 0;
+            while (c + count < channels && m_capture->digitalTrack(c + count, &nextBit) == track) ++count;
+            paintDigital(painter, *track, c, count, top);
+            top += count * kDigitalRowHeight;
+            c += count;
+        } else {
+            paintAnalog(painter, c, top);
+            top += kAnalogRowHeight;
+            ++c;
+        }
+    }
+
+    // 开始 / 停止触发与鼠标位置
+    const QVariantMap stats = m_capture->stats();
+    const double stopUs = stats.value("stopUs").toDouble();
+    const qreal bottom = top;
+    if (stats.value("triggerUs").toDouble() >= 0) {
+        painter->setPen(QPen(kTrigger, 1, Qt::DashLine));
+        const qreal x = toX(m_capture->firstUs());
+        if (x >= kGutterWidth) painter->drawLine(QPointF(x, kAxisHeight), QPointF(x, bottom));
+    }
+    if (stopUs >= 0) {
+        painter->setPen(QPen(kStop, 1, Qt::DashLine));
+        const qreal x = toX(stopUs);
+        if (x >= kGutterWidth) painter->drawLine(QPointF(x, kAxisHeight), QPointF(x, bottom));
+    }
+    if (m_hoverUs >= 0) {
+        const qreal x = toX(m_hoverUs);
+        painter->setPen(QPen(Qt::black, 1, Qt::DotLine));
+        painter->drawLine(QPointF(x, 0), QPointF(x, bottom));
+    }
+}
+
+void IOTimeline::paintAxis(QPainter *painter)
+{
+    const qreal plotWidth = width() - kGutterWidth;
+    const double step = niceStep(m_viewSpanUs / std::max(1.0, plotWidth / 100.0));
+    const double origin = m_capture->firstUs(); // 刻度相对记录起点 (触发时刻)
+    const double firstTick = std::ceil((m_viewStartUs - origin) / step) * step + origin;
+
+    painter->setFont(QFont("Consolas", 8));
+    for (double t = firstTick; t <= m_viewStartUs + m_viewSpanUs; t += step) {
+        const qreal x = toX(t);
+        painter->setPen(kGrid);
+        painter->drawLine(QPointF(x, kAxisHeight - 4), QPointF(x, height()));
+        painter->setPen(kLabel);
+        painter->drawText(QPointF(x + 2, kAxisHeight - 8), formatTime(t - origin, step));
+    }
+    painter->setPen(kGrid);
+    painter->drawLine(QPointF(0, kAxisHeight), QPointF(width(), kAxisHeight));
+}
+
+void IOTimeline::paintDigital(QPainter *painter, const DigitalTrack &track, int firstChannel, int count, qreal top)
+{
+    int firstBit = 0;
+    m_capture->digitalTrack(firstChannel, &firstBit);
+
+    const qreal plotRight = width();
+    painter->setFont(QFont("Consolas", 8));
+    for (int i = 0; i < count; ++i) {
+        const qreal y = top + i * kDigitalRowHeight;
+        painter->setPen(kLabel);
+        painter->drawText(QRectF(4, y, kGutterWidth - 8, kDigitalRowHeight), Qt::AlignVCenter,
+                          m_capture->channels().value(firstChannel + i));
+        painter->setPen(kGrid);
+        painter->drawLine(QPointF(kGutterWidth, y + kDigitalRowHeight), QPointF(plotRight, y + kDigitalRowHeight));
+    }
+    if (m_capture->firstUs() >= m_capture->lastUs()) return;
+
+    // 只画有数据的区间
+    const double fromUs = std::max(m_viewStartUs, double(track.startUs()));
+    const double toUs = std::min(m_viewStartUs + m_viewSpanUs, double(track.lastSampleUs()));
+    if (fromUs >= toUs) return;
+    const qreal xFrom = std::max<qreal>(toX(fromUs), kGutterWidth);
+    const qreal xTo = std::min<qreal>(toX(toUs), plotRight);
+
+    auto levelY = [top](int row, bool high) {
+        return top + row * kDigitalRowHeight + (high ? 4.0 : kDigitalRowHeight - 4.0);
+    };
+
+    struct RowState
+    {
+        qreal lastX;
+        qreal busyFrom = -1; // 实心块起点，-1 表示不在块内
+    };
+    std::vector<RowState> rows(size_t(count), RowState{ xFrom });
+    const quint64 mask = (count >= 64 ? ~quint64(0) : ((quint64(1) << count) - 1)) << firstBit;
+
+    painter->setPen(kDigital);
+    DigitalTrack::Cursor cursor = track.seek(qint64(fromUs));
+    DigitalTrack::Edge edge;
+    bool more = false;
+    while ((more = track.next(cursor, edge)) && edge.timeUs <= toUs) {
+        quint64 bits = edge.changed & mask;
+        if (!bits) continue;
+        const qreal x = toX(double(edge.timeUs));
+        while (bits) {
+            const int bit = qCountTrailingZeroBits(bits);
+            bits &= bits - 1;
+            const int row = bit - firstBit;
+            RowState &state = rows[size_t(row)];
+            const bool before = !((edge.level >> bit) & 1);
+
+            if (x - state.lastX < kMinEdgePx) {
+                if (state.busyFrom < 0) state.busyFrom = state.lastX;
+            } else {
+                if (state.busyFrom >= 0) {
+                    painter->fillRect(QRectF(QPointF(state.busyFrom, levelY(row, true)), QPointF(state.lastX, levelY(row, false))), kDigital);
+                    state.busyFrom = -1;
+                }
+                const qreal windowX = toX(double(edge.timeUs - edge.windowUs));
+                if (x - windowX >= kMinWindowPx) {
+                    painter->fillRect(QRectF(QPointF(std::max(windowX, state.lastX), levelY(row, true)), QPointF(x, levelY(row, false))), kWindow);
+                }
+                painter->drawLine(QPointF(state.lastX, levelY(row, before)), QPointF(x, levelY(row, before)));
+                painter->drawLine(QPointF(x, levelY(row, true)), QPointF(x, levelY(row, false)));
+            }
+            state.lastX = x;
+        }
+    }
+
+    // 最后一个边沿之后的电平：循环因越过可见范围退出时 cursor 已经多解码了一条，要把它撤回
+    const quint64 finalLevel = more ? cursor.level ^ edge.changed : cursor.level;
+    for (int row = 0; row < count; ++row) {
+        RowState &state = rows[size_t(row)];
+        if (state.busyFrom >= 0) {
+            painter->fillRect(QRectF(QPointF(state.busyFrom, levelY(row, true)), QPointF(state.lastX, levelY(row, false))), kDigital);
+        }
+        const bool high = (finalLevel >> (firstBit + row)) & 1;
+        painter->drawLine(QPointF(state.lastX, levelY(row, high)), QPointF(xTo, levelY(row, high)));
+    }
+}
+
+void IOTimeline::paintAnalog(QPainter *painter, int channel, qreal top)
+{
+    painter->setPen(kLabel);
+    painter->setFont(QFont("Consolas", 8));
+    painter->drawText(QRectF(4, top, kGutterWidth - 8, kAnalogRowHeight), Qt::AlignVCenter,
+                      m_capture->channels().value(channel));
+    painter->setPen(kGrid);
+    painter->drawLine(QPointF(kGutterWidth, top + kAnalogRowHeight), QPointF(width(), top + kAnalogRowHeight));
+
+    const std::vector<float> *values = m_capture->analogValues(channel);
+    const std::vector<quint32> &times = m_capture->analogTimesUs();
+    if (!values || values->empty()) return;
+
+    // 模拟量时间戳相对记录起点；多取两边各一个点，线条延伸到可见范围边缘
+    const double base = m_capture->firstUs();
+    const double fromRel = std::max(0.0, m_viewStartUs - base);
+    const double toRel = m_viewStartUs + m_viewSpanUs - base;
+    if (toRel < 0) return;
+    size_t begin = size_t(std::lower_bound(times.begin(), times.end(), quint32(fromRel)) - times.begin());
+    size_t end = size_t(std::upper_bound(times.begin(), times.end(), quint32(std::min(toRel, 4294967295.0))) - times.begin());
+    if (begin > 0) --begin;
+    if (end < times.size()) ++end;
+    if (begin >= end) return;
+
+    float lo = std::numeric_limits<float>::max();
+    float hi = std::numeric_limits<float>::lowest();
+    for (size_t i = begin; i < end; ++i) {
+        const float v = (*values)[i];
+        if (std::isnan(v)) continue;
+        lo = std::min(lo, v);
+        hi = std::max(hi, v);
+    }
+    if (lo > hi) return;
+    if (hi - lo < 1e-6f) {
+        lo -= 0.5f;
+        hi += 0.5f;
+    }
+    const qreal plotTop = top + 4;
+    const qreal plotHeight = kAnalogRowHeight - 14;
+    auto toY = [=](float v) { return plotTop + (hi - v) / (hi - lo) * plotHeight; };
+
+    painter->setPen(kLabel);
+    painter->drawText(QPointF(kGutterWidth + 2, top + kAnalogRowHeight - 2),
+                      QString("%1 .. %2").arg(lo, 0, 'f', 3).arg(hi, 0, 'f', 3));
+
+    // 每个像素列保留首、最小、最大、末四个点，几十万个采样缩到屏幕宽度
+    QPolygonF polyline;
+    int column = std::numeric_limits<int>::min();
+    float first = 0, colMin = 0, colMax = 0, last = 0;
+    auto flush = [&] {
+        if (column == std::numeric_limits<int>::min()) return;
+        polyline << QPointF(column, toY(first)) << QPointF(column, toY(colMin)) << QPointF(column, toY(colMax))
+                 << QPointF(column, toY(last));
+    };
+    for (size_t i = begin; i < end; ++i) {
+        const float v = (*values)[i];
+        if (std::isnan(v)) continue;
+        const int x = int(std::lround(toX(base + times[i])));
+        if (x != column) {
+            flush();
+            column = x;
+            first = colMin = colMax = v;
+        }
+        colMin = std::min(colMin, v);
+        colMax = std::max(colMax, v);
+        last = v;
+    }
+    flush();
+
+    painter->save();
+    painter->setClipRect(QRectF(kGutterWidth, top, width() - kGutterWidth, kAnalogRowHeight));
+    painter->setPen(kAnalog);
+    painter->drawPolyline(polyline);
+    painter->restore();
+}
+
+// ==========================================================
+// 交互
+// ==========================================================
+
+void IOTimeline::wheelEvent(QWheelEvent *event)
+{
+    const qreal x = event->position().x();
+    if (x < kGutterWidth) {
+        event->ignore(); // 名称栏上滚动交给外层 ScrollView
+        return;
+    }
+    const double anchorUs = toTime(x);
+    const double factor = std::pow(0.8, event->angleDelta().y() / 120.0);
+    const double dataSpan = m_capture ? m_capture->lastUs() - m_capture->firstUs() : 0.0;
+    const double span = std::clamp(m_viewSpanUs * factor, kMinSpanUs, std::max(dataSpan * 2.0, 1e6));
+
+    setFollow(false);
+    m_viewSpanUs = span;
+    m_viewStartUs = anchorUs - (x - kGutterWidth) / std::max(1.0, width() - kGutterWidth) * span;
+    emit viewChanged();
+    update();
+    event->accept();
+}
+
+void IOTimeline::mousePressEvent(QMouseEvent *event)
+{
+    m_pressX = event->position().x();
+    m_pressStartUs = m_viewStartUs;
+    event->accept();
+}
+
+void IOTimeline::mouseMoveEvent(QMouseEvent *event)
+{
+    const qreal dx = event->position().x() - m_pressX;
+    setFollow(false);
+    setViewStartUs(m_pressStartUs - dx / std::max(1.0, width() - kGutterWidth) * m_viewSpanUs);
+    event->accept();
+}
+
+void IOTimeline::mouseDoubleClickEvent(QMouseEvent *event)
+{
+    setFollow(false);
+    fitAll();
+    event->accept();
+}
+
+void IOTimeline::hoverMoveEvent(QHoverEvent *event)
+{
+    const qreal x = event->position().x();
+    m_hoverUs = x >= kGutterWidth ? toTime(x) : -1;
+    emit hoverChanged();
+    update();
+}
+
+void IOTimeline::hoverLeaveEvent(QHoverEvent *)
+{
+    m_hoverUs = -1;
+    emit hoverChanged();
+    update();
+}
@@ -0,0 +1,83 @@
+#ifndef IOTIMELINE_H
+#define IOTIMELINE_H
+
+#include <QPointer>
+#include <QQuickPaintedItem>
+#include "iocapture.h" // Q_PROPERTY 的指针类型需要完整定义
+
+// IO 采集的逻辑分析仪时间轴 (在 QML 中实例化，capture 指向 IOCaptureGlobal)
+// 数字通道画电平波形，边沿的不确定窗口 (两次采样之间) 用浅色标出；一个像素内有多个边沿时画成实心块
+// 模拟通道按像素列取最小 / 最大值画包络，纵轴按可见范围自动缩放
+// 滚轮以鼠标位置为中心缩放，左键拖动平移，双击显示全部
+class IOTimeline : public QQuickPaintedItem
+{
+    Q_OBJECT
+
+    Q_PROPERTY(IOCapture *capture READ capture WRITE setCapture NOTIFY captureChanged)
+    // 可见范围 (us，与 IOCapture 时间一致)
+    Q_PROPERTY(double viewStartUs READ viewStartUs WRITE setViewStartUs NOTIFY viewChanged)
+    Q_PROPERTY(double viewSpanUs READ viewSpanUs WRITE setViewSpanUs NOTIFY viewChanged)
+    // 采集中自动滚动到最新数据，手动缩放 / 平移后关闭
+    Q_PROPERTY(bool follow READ follow WRITE setFollow NOTIFY followChanged)
+    // 鼠标所在时刻，鼠标不在波形区时为 -1
+    Q_PROPERTY(double hoverUs READ hoverUs NOTIFY hoverChanged)
+
+public:
+    static constexpr int kGutterWidth = 64;
+    static constexpr int kAxisHeight = 22;
+    static constexpr int kDigitalRowHeight = 20;
+    static constexpr int kAnalogRowHeight = 56;
+    static constexpr double kMinSpanUs = 100.0;
+
+    explicit IOTimeline(QQuickItem *parent = nullptr);
+
+    IOCapture *capture() const { return m_capture; }
+    void setCapture(IOCapture *capture);
+    double viewStartUs() const { return m_viewStartUs; }
+    void setViewStartUs(double us);
+    double viewSpanUs() const { return m_viewSpanUs; }
+    void setViewSpanUs(double us);
+    bool follow() const { return m_follow; }
+    void setFollow(bool follow);
+    double hoverUs() const { return m_hoverUs; }
+
+    // 显示全部已采集数据
+    Q_INVOKABLE void fitAll();
+
+    void paint(QPainter *painter) override;
+
+signals:
+    void captureChanged();
+    void viewChanged();
+    void followChanged();
+    void hoverChanged();
+
+protected:
+    void wheelEvent(QWheelEvent *event) override;
+    void mousePressEvent(QMouseEvent *event) override;
+    void mouseMoveEvent(QMouseEvent *event) override;
+    void mouseDoubleClickEvent(QMouseEvent *event) override;
+    void hoverMoveEvent(QHoverEvent *event) override;
+    void hoverLeaveEvent(QHoverEvent *event) override;
+
+private:
+    void onCaptureProgress();
+    void updateImplicitHeight();
+    double toX(double timeUs) const;
+    double toTime(double x) const;
+    void paintAxis(QPainter *painter);
+    void paintDigital(QPainter *painter, const DigitalTrack &track, int firstChannel, int count, qreal top);
+    void paintAnalog(QPainter *painter, int channel, qreal top);
+
+    QPointer<IOCapture> m_capture;
+    double m_viewStartUs = 0;
+    double m_viewSpanUs = 1e6;
+    bool m_follow = true;
+    double m_hoverUs = -1;
+
+    // 拖动平移
+    qreal m_pressX = 0;
+    double m_pressStartUs = 0;
+};
+
+#endif // IOTIMELINE_H
@@ -0,0 +1,399 @@
+#include "kinematicsservice.h"
+#include "Robotclient.h"
+#include "metrics.h"
+
+#include <algorithm>
+#include <cmath>
+
+// ==========================================================
+// KinematicsCache
+// ==========================================================
+
+bool KinematicsCache::lookup(const QByteArray &key, RobotProtocol::Pose6 &result)
+{
+    auto it = m_index.find(key);
+    if (it == m_index.end()) return false;
+
+    m_order.splice(m_order.begin(), m_order, it.value());
+    result = it.value()->result;
+    return true;
+}
+
+void KinematicsCache::insert(const QByteArray &key, const RobotProtocol::Pose6 &result)
+{
+    if (m_capacity <= 0) return;
+
+    auto it = m_index.find(key);
+    if (it != m_index.end()) {
+        it.value()->result = result;
+        m_order.splice(m_order.begin(), m_order, it.value());
+        return;
+    }
+
+    m_order.push_front({ key, result });
+    m_index.insert(key, m_order.begin());
+    while (static_cast<int>(m_order.size()) > m_capacity) {
+        m_index.remove(m_order.back().key);
+        m_order.pop_back();
+    }
+}
+
+void KinematicsCache::clear()
+{
+    m_order.clear();
+    m_index.clear();
+}
+
+void KinematicsCache::setCapacity(int capacity)
+{
+    m_capacity = qMax(0, capacity);
+    while (static_cast<int>(m_order.size()) > m_capacity) {
+        m_index.remove(m_order.back().key);
+        m_order.pop_back();
+    }
+}
+
+// ==========================================================
+// KinematicsService
+// ==========================================================
+
+namespace {
+
+// 超时检查周期
+constexpr int kTimeoutCheckMs = 100;
+
+using RobotProtocol::Pose6;
+using RobotProtocol::Robot::ForwardKinematics;
+using RobotProtocol::Robot::InverseKinematics;
+
+// 数值按量化步长转为整数追加到键中，数组长度也写入以区分 [] 与缺省
+template <class Values>
+void appendQuantized(QByteArray &key, const Values &values)
+{
+    const qint32 length = qint32(values.size());
+    key.append(reinterpret_cast<const char *>(&length), sizeof(length));
+    for (double v : values) {
+        const qint64 q = std::llround(v / KinematicsService::kQuantum);
+        key.append(reinterpret_cast<const char *>(&q), sizeof(q));
+    }
+}
+
+bool toPose(const QVariant &value, Pose6 &pose)
+{
+    const QVariantList list = value.toList();
+    if (list.size() != 6) return false;
+    for (int i = 0; i < 6; ++i) {
+        bool ok = false;
+        pose[i] = list.at(i).toDouble(&ok);
+        if (!ok) return false;
+    }
+    return true;
+}
+
+// 缺省时为全 0
+bool poseOption(const QVariantMap &options, const char *name, Pose6 &pose)
+{
+    pose.fill(0.0);
+    return !options.contains(name) || toPose(options.value(name), pose);
+}
+
+std::vector<double> listOption(const QVariantMap &options, const char *name)
+{
+    std::vector<double> values;
+    const QVariantList list = options.value(name).toList();
+    values.reserve(list.size());
+    for (const QVariant &v : list) values.push_back(v.toDouble());
+    return values;
+}
+
+QVariantList poseToList(const Pose6 &pose)
+{
+    QVariantList list;
+    list.reserve(6);
+    for (double v : pose) list.append(v);
+    return list;
+}
+
+QVariantMap failure(const QString &error)
+{
+    return QVariantMap{ { "ok", false }, { "error", error }, { "cached", false } };
+}
+
+} // namespace
+
+KinematicsService::KinematicsService(RobotClient *robot, QObject *parent)
+    : QObject(parent)
+    , m_robot(robot)
+    , m_timeoutTimer(new QTimer(this))
+{
+    m_timeoutTimer->setInterval(kTimeoutCheckMs);
+    connect(m_timeoutTimer, &QTimer::timeout, this, &KinematicsService::onTimeoutCheck);
+    m_clock.start();
+
+    MetricsRegistry &r = MetricsRegistry::instance();
+    m_hitCounter = r.counter("kinematics_cache_hits_total", "FK/IK results served from the LRU cache");
+    m_missCounter = r.counter("kinematics_cache_misses_total", "FK/IK poses sent to the controller");
+    m_timeoutCounter = r.counter("kinematics_timeouts_total", "FK/IK requests without a reply before timeoutMs");
+    m_latencyHist = r.histogram("kinematics_request_latency_us", "Round trip of a single FK/IK request",
+                                MetricsRegistry::latencyBucketsUs());
+}
+
+void KinematicsService::setMaxInFlight(int n)
+{
+    n = qBound(1, n, 256);
+    if (n == m_maxInFlight) return;
+    m_maxInFlight = n;
+    emit settingsChanged();
+    pump();
+}
+
+void KinematicsService::setTimeoutMs(int ms)
+{
+    ms = qMax(100, ms);
+    if (ms == m_timeoutMs) return;
+    m_timeoutMs = ms;
+    emit settingsChanged();
+}
+
+void KinematicsService::setCacheCapacity(int capacity)
+{
+    if (capacity == m_cache.capacity()) return;
+    m_cache.setCapacity(capacity);
+    emit settingsChanged();
+}
+
+QByteArray KinematicsService::makeKey(Direction direction, const Item &item)
+{
+    QByteArray key;
+    key.reserve(160);
+    key.append(static_cast<char>(direction));
+    if (direction == Forward) {
+        appendQuantized(key, item.forward.jp);
+        appendQuantized(key, item.forward.coor);
+        appendQuantized(key, item.forward.tool);
+        appendQuantized(key, item.forward.ep);
+    } else {
+        appendQuantized(key, item.inverse.cp);
+        appendQuantized(key, item.inverse.rj);
+        appendQuantized(key, item.inverse.ep);
+    }
+    return key;
+}
+
+int KinematicsService::forwardBatch(const QVariantList &poses, const QVariantMap &options)
+{
+    return submit(Forward, poses, options);
+}
+
+int KinematicsService::inverseBatch(const QVariantList &poses, const QVariantMap &options)
+{
+    return submit(Inverse, poses, options);
+}
+
+int KinematicsService::submit(Direction direction, const QVariantList &poses, const QVariantMap &options)
+{
+    const bool wasBusy = busy();
+    Batch &batch = m_batches[m_nextBatchId];
+    batch.id = m_nextBatchId++;
+    batch.direction = direction;
+    batch.items.resize(poses.size());
+
+    // 同一批的公共参数
+    ForwardKinematics forward;
+    InverseKinematics inverse;
+    const bool optionsOk = direction == Forward
+                               ? poseOption(options, "coor", forward.coor) && poseOption(options, "tool", forward.tool)
+                               : poseOption(options, "rj", inverse.rj);
+    forward.ep = inverse.ep = listOption(options, "ep");
+
+    for (int i = 0; i < poses.size(); ++i) {
+        Item &item = batch.items[i];
+        Pose6 pose;
+        if (!optionsOk || !toPose(poses.at(i), pose)) {
+            item.result = failure(optionsOk ? "位姿格式错误 (需要 6 个数值)" : "coor / tool / rj 格式错误 (需要 6 个数值)");
+            item.done = true;
+            ++batch.done;
+            continue;
+        }
+
+        if (direction == Forward) {
+            item.forward = forward;
+            item.forward.jp = pose;
+        } else {
+            item.inverse = inverse;
+            item.inverse.cp = pose;
+        }
+        item.key = makeKey(direction, item);
+
+        // 命中缓存直接完成，不占用请求
+        Pose6 cached;
+        if (m_cache.lookup(item.key, cached)) {
+            ++m_hits;
+            m_hitCounter->add();
+            item.result = QVariantMap{ { "ok", true }, { "pose", poseToList(cached) }, { "cached", true }, { "ms", 0.0 } };
+            item.done = true;
+            ++batch.done;
+            continue;
+        }
+        m_queue.emplace_back(batch.id, i);
+    }
+
+    const int batchId = batch.id;
+    if (!wasBusy) emit busyChanged();
+    pump();
+
+    // 全部命中缓存时也异步发出结果，保证调用方先拿到批次号
+    QMetaObject::invokeMethod(this, [this, batchId] { finishBatchIfDone(batchId); }, Qt::QueuedConnection);
+    return batchId;
+}
+
+void KinematicsService::pump()
+{
+    while (static_cast<int>(m_inFlight.size()) < m_maxInFlight && !m_queue.empty()) {
+        const int batchId = m_queue.front().first;
+        const int index = m_queue.front().second;
+        m_queue.pop_front();
+
+        auto it = m_batches.find(batchId);
+        if (it == m_batches.end()) continue; // 已取消
+
+        Batch &batch = it.value();
+        const Item &item = batch.items[index];
+        const quint64 ticket = ++m_nextTicket;
+        auto callback = [this, ticket](const QJsonObject *root) { onReply(ticket, root); };
+        const QString requestId = batch.direction == Forward
+                                      ? m_robot->sendProbe(QLatin1String(ForwardKinematics::kType),
+                                                           item.forward.toDb(), this, callback)
+                                      : m_robot->sendProbe(QLatin1String(InverseKinematics::kType),
+                                                           item.inverse.toDb(), this, callback);
+        if (requestId.isEmpty()) {
+            complete(batch, index, failure("未连接"));
+            QMetaObject::invokeMethod(this, [this, batchId] { finishBatchIfDone(batchId); }, Qt::QueuedConnection);
+            continue;
+        }
+
+        ++m_misses;
+        m_missCounter->add();
+        m_inFlight.push_back({ ticket, batchId, index, batch.direction, m_clock.nsecsElapsed() });
+    }
+
+    if (!m_inFlight.empty() && !m_timeoutTimer->isActive()) m_timeoutTimer->start();
+}
+
+// root 为空表示 RobotClient 判定失败 (断线或超过 kReplyTimeoutMs)
+void KinematicsService::onReply(quint64 ticket, const QJsonObject *root)
+{
+    auto it = std::find_if(m_inFlight.begin(), m_inFlight.end(),
+                           [ticket](const Pending &p) { return p.ticket == ticket; });
+    if (it == m_inFlight.end()) return; // 已按 timeoutMs 判为超时
+
+    const Pending pending = *it;
+    m_inFlight.erase(it);
+    if (root) {
+        resolve(pending, *root);
+    } else {
+        auto batch = m_batches.find(pending.batchId);
+        if (batch != m_batches.end()) {
+            complete(batch.value(), pending.index, failure("未收到回复"));
+            finishBatchIfDone(pending.batchId);
+        }
+    }
+    pump();
+    if (m_inFlight.empty()) m_timeoutTimer->stop();
+}
+
+void KinematicsService::resolve(const Pending &pending, const QJsonObject &root)
+{
+    const qint64 elapsedNs = m_clock.nsecsElapsed() - pending.sentNs;
+    m_latencyHist->observe(elapsedNs / 1000);
+
+    auto it = m_batches.find(pending.batchId);
+    if (it == m_batches.end()) return;
+    Batch &batch = it.value();
+
+    const QJsonValue db = root.value("db");
+    Pose6 pose;
+    const bool ok = pending.direction == Forward ? ForwardKinematics::parseReply(db, pose)
+                                                 : InverseKinematics::parseReply(db, pose);
+
+    if (ok) {
+        m_cache.insert(batch.items[pending.index].key, pose);
+        complete(batch, pending.index, QVariantMap{ { "ok", true }, { "pose", poseToList(pose) },
+                                                    { "cached", false }, { "ms", elapsedNs / 1e6 } });
+    } else {
+        // 无解或参数错误时控制器返回的不是 6 元数组，原样带回便于排查
+        QVariantMap result = failure("无解或参数错误");
+        result["reply"] = db.toVariant();
+        complete(batch, pending.index, result);
+    }
+    finishBatchIfDone(pending.batchId);
+}
+
+void KinematicsService::onTimeoutCheck()
+{
+    const qint64 now = m_clock.nsecsElapsed();
+    const qint64 limitNs = qint64(m_timeoutMs) * 1000000;
+
+    // 按发送顺序排列，最早的在前
+    QList<int> touched;
+    while (!m_inFlight.empty() && now - m_inFlight.front().sentNs > limitNs) {
+        const Pending pending = m_inFlight.front();
+        m_inFlight.pop_front();
+        m_timeoutCounter->add();
+
+        auto it = m_batches.find(pending.batchId);
+        if (it == m_batches.end()) continue;
+        complete(it.value(), pending.index, failure("超时"));
+        if (!touched.contains(pending.batchId)) touched << pending.batchId;
+    }
+    for (int batchId : touched) finishBatchIfDone(batchId);
+
+    pump();
+    if (m_inFlight.empty()) m_timeoutTimer->stop();
+}
+
+void KinematicsService::complete(Batch &batch, int index, const QVariantMap &result)
+{
+    Item &item = batch.items[index];
+    if (item.done) return;
+    item.result = result;
+    item.done = true;
+    ++batch.done;
+    emit batchProgress(batch.id, batch.done, static_cast<int>(batch.items.size()));
+}
+
+void KinematicsService::finishBatchIfDone(int batchId)
+{
+    auto it = m_batches.find(batchId);
+    if (it == m_batches.end() || it->done < static_cast<int>(it->items.size())) return;
+
+    QVariantList results;
+    results.reserve(static_cast<qsizetype>(it->items.size()));
+    for (const Item &item : it->items) results.append(item.result);
+    m_batches.erase(it);
+
+    emit batchFinished(batchId, results);
+    if (!busy()) emit busyChanged();
+}
+
+void KinematicsService::cancel(int batchId)
+{
+    // 队列中的条目在 pump() 时跳过，在途请求的回复被丢弃
+    if (m_batches.remove(batchId) && !busy()) emit busyChanged();
+}
+
+void KinematicsService::clearCache()
+{
+    m_cache.clear();
+}
+
+QVariantMap KinematicsService::stats() const
+{
+    QVariantMap result;
+    result["hits"] = m_hits;
+    result["misses"] = m_misses;
+    result["cacheSize"] = m_cache.size();
+    result["inFlight"] = static_cast<int>(m_inFlight.size());
+    result["queued"] = static_cast<int>(m_queue.size());
+    return result;
+}
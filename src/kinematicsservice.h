@@ -0,0 +1,160 @@
+#ifndef KINEMATICSSERVICE_H
+#define KINEMATICSSERVICE_H
+
+#include <QObject>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QJsonObject>
+#include <QVariantList>
+#include <QVariantMap>
+#include <deque>
+#include <list>
+#include <vector>
+#include "robotprotocol.h"
+
+class RobotClient;
+class MetricCounter;
+class MetricHistogram;
+
+// 按量化后的位姿缓存正逆解结果的 LRU
+// 键: 方向 + 位姿 + 参考参数 (coor/tool 或 rj)，按 kQuantum 量化为整数后拼接
+class KinematicsCache
+{
+public:
+    explicit KinematicsCache(int capacity = 4096) : m_capacity(capacity) {}
+
+    // 命中时移到最新位置
+    bool lookup(const QByteArray &key, RobotProtocol::Pose6 &result);
+    void insert(const QByteArray &key, const RobotProtocol::Pose6 &result);
+    void clear();
+    void setCapacity(int capacity);
+    int capacity() const { return m_capacity; }
+    int size() const { return static_cast<int>(m_order.size()); }
+
+private:
+    struct Entry
+    {
+        QByteArray key;
+        RobotProtocol::Pose6 result;
+    };
+
+    int m_capacity;
+    std::list<Entry> m_order; // 前端最新
+    QHash<QByteArray, std::list<Entry>::iterator> m_index;
+};
+
+// 批量正逆解服务：
+// 一批位姿拆成单条 RobotProtocol::Robot::ForwardKinematics / InverseKinematics 请求，最多 maxInFlight 条同时在途 (流水线)，
+// 请求经 RobotClient::sendProbe 发送，回复由 RobotClient 按 id 直接交回本服务 (不广播给界面)，全部完成后按输入顺序返回
+// 只在 GUI 线程使用
+class KinematicsService : public QObject
+{
+    Q_OBJECT
+
+    // 同时在途的请求上限
+    Q_PROPERTY(int maxInFlight READ maxInFlight WRITE setMaxInFlight NOTIFY settingsChanged)
+    // 单条请求超时 (毫秒)，超时的条目结果为失败
+    Q_PROPERTY(int timeoutMs READ timeoutMs WRITE setTimeoutMs NOTIFY settingsChanged)
+    Q_PROPERTY(int cacheCapacity READ cacheCapacity WRITE setCacheCapacity NOTIFY settingsChanged)
+    Q_PROPERTY(bool busy READ busy NOTIFY busyChanged)
+
+public:
+    // 量化步长：关节角 (°) 与笛卡尔位置 (mm) / 姿态 (°) 都取 0.001
+    static constexpr double kQuantum = 1e-3;
+
+    explicit KinematicsService(RobotClient *robot, QObject *parent = nullptr);
+
+    int maxInFlight() const { return m_maxInFlight; }
+    void setMaxInFlight(int n);
+    int timeoutMs() const { return m_timeoutMs; }
+    void setTimeoutMs(int ms);
+    int cacheCapacity() const { return m_cache.capacity(); }
+    void setCacheCapacity(int capacity);
+    bool busy() const { return !m_batches.isEmpty(); }
+
+    // 批量正解：poses 为关节角数组的列表，options 可带 coor / tool / ep (默认全 0 / 空)
+    // 返回批次号，完成时发出 batchFinished
+    Q_INVOKABLE int forwardBatch(const QVariantList &poses, const QVariantMap &options = QVariantMap());
+    // 批量逆解：poses 为笛卡尔位姿数组的列表，options 可带 rj (参考关节角) / ep
+    Q_INVOKABLE int inverseBatch(const QVariantList &poses, const QVariantMap &options = QVariantMap());
+    // 取消批次 (已在途的请求回复后丢弃)
+    Q_INVOKABLE void cancel(int batchId);
+
+    Q_INVOKABLE void clearCache();
+    // { hits, misses, cacheSize, inFlight, queued }
+    Q_INVOKABLE QVariantMap stats() const;
+
+signals:
+    void settingsChanged();
+    void busyChanged();
+    void batchProgress(int batchId, int done, int total);
+    // results 与输入一一对应: { ok, pose: [6], cached, ms }
+    void batchFinished(int batchId, const QVariantList &results);
+
+private slots:
+    void onTimeoutCheck();
+
+private:
+    enum Direction { Forward = 0, Inverse = 1 };
+
+    struct Item
+    {
+        // 按批次方向只用其中一个
+        RobotProtocol::Robot::ForwardKinematics forward;
+        RobotProtocol::Robot::InverseKinematics inverse;
+        QByteArray key;
+        QVariantMap result;
+        bool done = false;
+    };
+
+    struct Batch
+    {
+        int id = 0;
+        Direction direction = Forward;
+        std::vector<Item> items;
+        int done = 0;
+    };
+
+    // 已发出等待回复的请求
+    struct Pending
+    {
+        quint64 ticket; // 回调据此找到自己的条目；本地超时后条目已移除，迟到的回复被忽略
+        int batchId;
+        int index;
+        Direction direction;
+        qint64 sentNs;
+    };
+
+    int submit(Direction direction, const QVariantList &poses, const QVariantMap &options);
+    static QByteArray makeKey(Direction direction, const Item &item);
+    void pump();
+    void complete(Batch &batch, int index, const QVariantMap &result);
+    void finishBatchIfDone(int batchId);
+    void onReply(quint64 ticket, const QJsonObject *root);
+    void resolve(const Pending &pending, const QJsonObject &root);
+
+    RobotClient *m_robot;
+    KinematicsCache m_cache;
+    int m_maxInFlight = 8;
+    int m_timeoutMs = 3000;
+
+    int m_nextBatchId = 1;
+    QHash<int, Batch> m_batches;
+    // 待发送队列 (批次号, 条目序号)，按提交顺序
+    std::deque<std::pair<int, int>> m_queue;
+    // 在途请求，按发送顺序 (用于超时检查)
+    std::deque<Pending> m_inFlight;
+    quint64 m_nextTicket = 0;
+    QElapsedTimer m_clock;
+    QTimer *m_timeoutTimer;
+
+    quint64 m_hits = 0;
+    quint64 m_misses = 0;
+    MetricCounter *m_hitCounter;
+    MetricCounter *m_missCounter;
+    MetricCounter *m_timeoutCounter;
+    MetricHistogram *m_latencyHist;
+};
+
+#endif // KINEMATICSSERVICE_H
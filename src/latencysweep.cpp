@@ -0,0 +1,410 @@
+#include "latencysweep.h"
+#include "Robotclient.h"
+#include "robotprotocol.h"
+
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+#include <algorithm>
+
+using namespace RobotProtocol;
+
+namespace {
+
+// 写接口测试用的全局变量名
+const QString kScratchVar = QStringLiteral("sweep_tmp");
+
+qint64 quantile(const std::vector<qint64> &sorted, double q)
+{
+    if (sorted.empty()) return -1;
+    const size_t index = std::min(sorted.size() - 1, size_t(q * (sorted.size() - 1) + 0.5));
+    return sorted[index];
+}
+
+template <class Request>
+QJsonValue dbOf(const Request &request)
+{
+    return request.toDb();
+}
+
+} // namespace
+
+LatencySweep::LatencySweep(RobotClient *robot, QObject *parent)
+    : QObject(parent)
+    , m_robot(robot)
+    , m_pumpTimer(new QTimer(this))
+{
+    m_pumpTimer->setSingleShot(true);
+    m_pumpTimer->setTimerType(Qt::PreciseTimer);
+    connect(m_pumpTimer, &QTimer::timeout, this, &LatencySweep::pump);
+
+    // 断线时在途请求会以失败回调，这里只负责停止继续发送
+    connect(m_robot, &RobotClient::disconnected, this, [this] {
+        if (!m_running) return;
+        emit errorOccurred("连接断开，扫描中止");
+        stop();
+    });
+}
+
+QString LatencySweep::currentEndpoint() const
+{
+    return m_running && m_current >= 0 && m_current < int(m_suite.size()) ? m_suite[m_current].name : QString();
+}
+
+double LatencySweep::progress() const
+{
+    if (!m_running || m_suite.empty()) return m_results.isEmpty() ? 0.0 : 1.0;
+    const double perEndpoint = double(m_phase.completed) / std::max(1, m_warmup + m_count);
+    return (m_current + perEndpoint) / m_suite.size();
+}
+
+// ==========================================================
+// 端点表
+// ==========================================================
+
+std::vector<LatencySweep::Endpoint> LatencySweep::suite(const QVariantMap &options)
+{
+    std::vector<Endpoint> list;
+    auto add = [&list](const char *name, const char *family, const char *type, const QJsonValue &db, bool writes) {
+        list.push_back({ QString::fromLatin1(name), QString::fromLatin1(family), QString::fromLatin1(type), db, writes });
+    };
+
+    // ---- 只读 / 纯计算 ----
+    IOManager::GetIOValue io;
+    for (int port = 0; port < 8; ++port) {
+        io.ports.push_back({ IOType::DI, port });
+        io.ports.push_back({ IOType::DO, port });
+    }
+    add("io.get", "IOManager", io.kType, dbOf(io), false);
+
+    RegisterManager::GetRegisterValue reg;
+    for (int i = 0; i < 8; ++i) reg.addresses.push_back(10000 + i);
+    add("register.get", "RegisterManager", reg.kType, dbOf(reg), false);
+
+    add("var.getVars", "globalVar", GlobalVarApi::GetVars::kType, dbOf(GlobalVarApi::GetVars{}), false);
+    add("var.projectVars", "globalVar", GlobalVarApi::GetProjectVarUpdate::kType,
+        dbOf(GlobalVarApi::GetProjectVarUpdate{}), false);
+
+    Robot::ForwardKinematics fk;
+    fk.jp = { 0, 0, 90, 0, 90, 0 };
+    add("robot.forwardKinematics", "Robot", fk.kType, dbOf(fk), false);
+
+    Robot::InverseKinematics ik;
+    ik.cp = { 400, 0, 500, 180, 0, 180 };
+    ik.rj = { 0, 0, 90, 0, 90, 0 };
+    add("robot.inverseKinematics", "Robot", ik.kType, dbOf(ik), false);
+
+    // ---- 写接口 (显式打开) ----
+    if (options.value("includeWrites", false).toBool()) {
+        GlobalVarApi::SaveVars save;
+        save.name = kScratchVar;
+        save.val = 0;
+        save.nm = QStringLiteral("API 延迟扫描临时变量");
+        add("var.saveVars", "globalVar", save.kType, dbOf(save), true);
+
+        GlobalVarApi::RemoveVars remove;
+        remove.names << kScratchVar;
+        add("var.removeVars", "globalVar", remove.kType, dbOf(remove), true);
+
+        add("project.setStartLine", "project", Project::SetStartLine::kType, dbOf(Project::SetStartLine{}), true);
+        add("project.clearStartLine", "project", Project::ClearStartLine::kType, dbOf(Project::ClearStartLine{}), true);
+
+        const int scratchRegister = options.value("scratchRegister", -1).toInt();
+        if (scratchRegister >= 0) {
+            add("register.set", "RegisterManager", RegisterManager::SetRegisterValue::kType,
+                dbOf(RegisterManager::SetRegisterValue{ scratchRegister, 0 }), true);
+        }
+        const int scratchDO = options.value("scratchDO", -1).toInt();
+        if (scratchDO >= 0) {
+            add("io.setDO", "IOManager", IOManager::SetIOValue::kType,
+                dbOf(IOManager::SetIOValue{ IOType::DO, scratchDO, 0 }), true);
+        }
+    }
+
+    // 只跑指定的端点
+    const QStringList only = options.value("endpoints").toStringList();
+    if (!only.isEmpty()) {
+        list.erase(std::remove_if(list.begin(), list.end(), [&only](const Endpoint &e) { return !only.contains(e.name); }),
+                   list.end());
+    }
+    return list;
+}
+
+QVariantList LatencySweep::endpoints(const QVariantMap &options) const
+{
+    QVariantList list;
+    for (const Endpoint &e : suite(options)) {
+        list.append(QVariantMap{ { "name", e.name }, { "family", e.family }, { "type", e.type }, { "writes", e.writes } });
+    }
+    return list;
+}
+
+// ==========================================================
+// 运行
+// ==========================================================
+
+bool LatencySweep::start(const QVariantMap &options)
+{
+    if (m_running) return false;
+    if (!m_robot->isConnected()) {
+        emit errorOccurred("未连接机器人，无法扫描");
+        return false;
+    }
+
+    m_options = options;
+    m_concurrency = qBound(1, options.value("concurrency", 1).toInt(), 256);
+    m_ratePerSec = std::max(0.0, options.value("ratePerSec", 0).toDouble());
+    m_count = qMax(1, options.value("count", 200).toInt());
+    m_warmup = qMax(0, options.value("warmup", 10).toInt());
+    m_suite = suite(options);
+    if (m_suite.empty()) {
+        emit errorOccurred("没有可运行的端点");
+        return false;
+    }
+
+    ++m_generation;
+    m_results.clear();
+    m_reportPath.clear();
+    m_startedAt = QDateTime::currentDateTime().toString(Qt::ISODate);
+    m_clock.start();
+    m_running = true;
+    m_current = -1;
+    emit runningChanged();
+
+    nextEndpoint();
+    return true;
+}
+
+void LatencySweep::stop()
+{
+    if (!m_running) return;
+    // 当前端点已有的数据也计入报告
+    if (m_current >= 0 && m_current < int(m_suite.size()) && m_phase.completed > 0) {
+        m_phase.endNs = m_clock.nsecsElapsed();
+        m_results.append(summarize(m_suite[m_current], m_phase));
+    }
+    finish();
+}
+
+void LatencySweep::nextEndpoint()
+{
+    if (m_current >= 0) {
+        m_phase.endNs = m_clock.nsecsElapsed();
+        m_results.append(summarize(m_suite[m_current], m_phase));
+    }
+
+    ++m_current;
+    if (m_current >= int(m_suite.size())) {
+        finish();
+        return;
+    }
+
+    m_phase = Phase();
+    m_phase.latencyUs.reserve(m_count);
+    m_phase.startNs = m_clock.nsecsElapsed();
+    m_inFlight = 0;
+    m_nextSendNs = m_phase.startNs;
+    emit progressChanged();
+    pump();
+}
+
+void LatencySweep::pump()
+{
+    if (!m_running) return;
+
+    const Endpoint &endpoint = m_suite[m_current];
+    const int total = m_warmup + m_count;
+    const qint64 periodNs = m_ratePerSec > 0 ? qint64(1e9 / m_ratePerSec) : 0;
+
+    while (m_inFlight < m_concurrency && m_phase.sent < total) {
+        const qint64 now = m_clock.nsecsElapsed();
+        if (periodNs > 0 && now < m_nextSendNs) {
+            m_pumpTimer->start(int((m_nextSendNs - now) / 1000000));
+            return;
+        }
+
+        const quint64 generation = m_generation;
+        const int sequence = m_phase.sent;
+        const qint64 sentNs = m_clock.nsecsElapsed();
+        const QString id = m_robot->sendProbe(endpoint.type, endpoint.db, this,
+                                              [this, generation, sequence, sentNs](const QJsonObject *root) {
+                                                  onReply(generation, sequence, sentNs, root != nullptr);
+                                              });
+        if (id.isEmpty()) {
+            emit errorOccurred("发送失败，扫描中止");
+            stop();
+            return;
+        }
+
+        ++m_phase.sent;
+        ++m_inFlight;
+        // 按计划时刻推进，不因前面的延迟而补发成突发
+        if (periodNs > 0) m_nextSendNs = std::max(m_nextSendNs, now) + periodNs;
+    }
+}
+
+void LatencySweep::onReply(quint64 generation, int sequence, qint64 sentNs, bool ok)
+{
+    if (!m_running || generation != m_generation) return;
+
+    const qint64 rttUs = (m_clock.nsecsElapsed() - sentNs) / 1000;
+    --m_inFlight;
+    ++m_phase.completed;
+    if (!ok) {
+        ++m_phase.errors;
+    } else if (sequence >= m_warmup) {
+        m_phase.latencyUs.push_back(rttUs);
+    }
+    // 预热结束时重新计时，吞吐只统计正式请求
+    if (m_phase.completed == m_warmup) m_phase.startNs = m_clock.nsecsElapsed();
+
+    if (m_phase.completed >= m_warmup + m_count) {
+        nextEndpoint();
+        return;
+    }
+    if (m_phase.completed % 16 == 0) emit progressChanged();
+    pump();
+}
+
+QVariantMap LatencySweep::summarize(const Endpoint &endpoint, Phase &phase) const
+{
+    std::sort(phase.latencyUs.begin(), phase.latencyUs.end());
+    const std::vector<qint64> &v = phase.latencyUs;
+    double mean = 0;
+    for (qint64 us : v) mean += us;
+    if (!v.empty()) mean /= v.size();
+    const double seconds = (phase.endNs - phase.startNs) / 1e9;
+
+    QVariantMap row;
+    row["name"] = endpoint.name;
+    row["family"] = endpoint.family;
+    row["type"] = endpoint.type;
+    row["writes"] = endpoint.writes;
+    row["count"] = int(v.size());
+    row["errors"] = phase.errors;
+    row["p50Us"] = quantile(v, 0.5);
+    row["p90Us"] = quantile(v, 0.9);
+    row["p99Us"] = quantile(v, 0.99);
+    row["maxUs"] = v.empty() ? qint64(-1) : v.back();
+    row["meanUs"] = qRound64(mean);
+    row["throughputPerSec"] = seconds > 0 ? v.size() / seconds : 0.0;
+    return row;
+}
+
+void LatencySweep::finish()
+{
+    m_pumpTimer->stop();
+    m_running = false;
+    ++m_generation;
+    writeReport();
+    emit runningChanged();
+    emit progressChanged();
+    emit finished(m_reportPath);
+}
+
+// ==========================================================
+// 报告
+// ==========================================================
+
+void LatencySweep::writeReport()
+{
+    const QString dir = QCoreApplication::applicationDirPath() + "/Logs";
+    QDir().mkpath(dir);
+    const QString base = dir + "/sweep_" + QDateTime::currentDateTime().toString("yyyyMMdd_HHmmss");
+
+    // 对比基线：按端点名匹配
+    QHash<QString, QJsonObject> baseline;
+    const QString baselinePath = m_options.value("baseline").toString();
+    if (!baselinePath.isEmpty()) {
+        QFile file(baselinePath);
+        if (file.open(QIODevice::ReadOnly)) {
+            const QJsonArray rows = QJsonDocument::fromJson(file.readAll()).object().value("endpoints").toArray();
+            for (const QJsonValue &row : rows) baseline.insert(row.toObject().value("name").toString(), row.toObject());
+        } else {
+            emit errorOccurred("无法读取基线文件: " + baselinePath);
+        }
+    }
+
+    auto change = [](qint64 now, qint64 before) -> QVariant {
+        if (now < 0 || before <= 0) return QVariant();
+        return 100.0 * (now - before) / before;
+    };
+    for (QVariant &item : m_results) {
+        QVariantMap row = item.toMap();
+        const auto it = baseline.constFind(row.value("name").toString());
+        if (it == baseline.constEnd()) continue;
+        row["p50ChangePercent"] = change(row.value("p50Us").toLongLong(), it->value("p50Us").toInteger());
+        row["p99ChangePercent"] = change(row.value("p99Us").toLongLong(), it->value("p99Us").toInteger());
+        item = row;
+    }
+
+    // ---- JSON ----
+    QJsonObject root;
+    root["startedAt"] = m_startedAt;
+    root["finishedAt"] = QDateTime::currentDateTime().toString(Qt::ISODate);
+    QVariantMap options = m_options;
+    options["concurrency"] = m_concurrency;
+    options["ratePerSec"] = m_ratePerSec;
+    options["count"] = m_count;
+    options["warmup"] = m_warmup;
+    root["options"] = QJsonObject::fromVariantMap(options);
+    root["endpoints"] = QJsonArray::fromVariantList(m_results);
+
+    QSaveFile json(base + ".json");
+    if (json.open(QIODevice::WriteOnly)) {
+        json.write(QJsonDocument(root).toJson(QJsonDocument::Indented));
+        json.commit();
+    }
+
+    // ---- 表格 ----
+    auto ms = [](const QVariant &us) {
+        const qint64 v = us.toLongLong();
+        return v < 0 ? QString("-") : QString::number(v / 1000.0, 'f', 2);
+    };
+    auto pct = [](const QVariant &v) {
+        return v.isValid() ? QString("%1%2%").arg(v.toDouble() >= 0 ? "+" : "").arg(v.toDouble(), 0, 'f', 1) : QString();
+    };
+
+    QStringList lines;
+    lines << QString("API 延迟扫描  %1").arg(m_startedAt);
+    lines << QString("并发 %1  速率 %2  每端点 %3 次 (预热 %4 次)")
+                 .arg(m_concurrency)
+                 .arg(m_ratePerSec > 0 ? QString("%1/s").arg(m_ratePerSec) : QString("不限"))
+                 .arg(m_count)
+                 .arg(m_warmup);
+    if (!baseline.isEmpty()) lines << QString("基线: %1").arg(baselinePath);
+    lines << QString();
+    lines << QString("%1 %2 %3 %4 %5 %6 %7 %8 %9 %10 %11")
+                 .arg(QStringLiteral("endpoint"), -26).arg(QStringLiteral("n"), 6).arg(QStringLiteral("err"), 5)
+                 .arg(QStringLiteral("p50 ms"), 9).arg(QStringLiteral("p90 ms"), 9).arg(QStringLiteral("p99 ms"), 9)
+                 .arg(QStringLiteral("max ms"), 9).arg(QStringLiteral("mean ms"), 9).arg(QStringLiteral("req/s"), 9)
+                 .arg(QStringLiteral("p50 Δ"), 8).arg(QStringLiteral("p99 Δ"), 8);
+    for (const QVariant &item : std::as_const(m_results)) {
+        const QVariantMap row = item.toMap();
+        lines << QString("%1 %2 %3 %4 %5 %6 %7 %8 %9 %10 %11")
+                     .arg(row.value("name").toString(), -26)
+                     .arg(row.value("count").toInt(), 6)
+                     .arg(row.value("errors").toInt(), 5)
+                     .arg(ms(row.value("p50Us")), 9)
+                     .arg(ms(row.value("p90Us")), 9)
+                     .arg(ms(row.value("p99Us")), 9)
+                     .arg(ms(row.value("maxUs")), 9)
+                     .arg(ms(row.value("meanUs")), 9)
+                     .arg(QString::number(row.value("throughputPerSec").toDouble(), 'f', 1), 9)
+                     .arg(pct(row.value("p50ChangePercent")), 8)
+                     .arg(pct(row.value("p99ChangePercent")), 8);
+    }
+
+    QSaveFile table(base + ".txt");
+    if (table.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        table.write(lines.join('\n').toUtf8());
+        table.write("\n");
+        table.commit();
+    }
+    m_reportPath = base + ".txt";
+}
@@ -0,0 +1,114 @@
+#ifndef LATENCYSWEEP_H
+#define LATENCYSWEEP_H
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QJsonValue>
+#include <QTimer>
+#include <QVariantList>
+#include <QVariantMap>
+#include <vector>
+
+class RobotClient;
+
+// API 延迟扫描：按端点依次压测控制器接口，按 id 匹配回复测量往返时间
+// 每个端点先发 warmup 次预热 (不计入)，再以设定的并发与速率发 count 次
+// 结果 (p50 / p90 / p99 / max / 吞吐) 写入 Logs/sweep_*.txt (表格) 与 Logs/sweep_*.json，可与上一次的 JSON 对比
+// 默认只包含只读 / 纯计算接口；写接口需要显式打开，且只写测试用的变量、寄存器和 DO
+class LatencySweep : public QObject
+{
+    Q_OBJECT
+
+    Q_PROPERTY(bool running READ running NOTIFY runningChanged)
+    Q_PROPERTY(QString currentEndpoint READ currentEndpoint NOTIFY progressChanged)
+    Q_PROPERTY(double progress READ progress NOTIFY progressChanged)
+    Q_PROPERTY(QVariantList results READ results NOTIFY finished)
+    Q_PROPERTY(QString reportPath READ reportPath NOTIFY finished)
+
+public:
+    explicit LatencySweep(RobotClient *robot, QObject *parent = nullptr);
+
+    bool running() const { return m_running; }
+    QString currentEndpoint() const;
+    double progress() const;
+    QVariantList results() const { return m_results; }
+    QString reportPath() const { return m_reportPath; }
+
+    // 可选端点：[{ name, family, type, writes }] (options 同 start，决定写接口是否出现)
+    Q_INVOKABLE QVariantList endpoints(const QVariantMap &options = QVariantMap()) const;
+
+    // options (均可省略):
+    //   concurrency (1)        同时在途的请求数
+    //   ratePerSec (0)         每个端点的发送速率上限，0 = 只受并发限制
+    //   count (200)            每个端点计入统计的请求数
+    //   warmup (10)            每个端点的预热请求数
+    //   endpoints ([])         只跑这些端点 (名字)，空 = 全部
+    //   includeWrites (false)  包含写接口 (globalVar 临时变量、project 起始行)
+    //   scratchRegister (-1)   寄存器写测试地址，-1 = 不测
+    //   scratchDO (-1)         DO 写测试端口 (写入 0)，-1 = 不测
+    //   baseline ("")          上一次的 sweep_*.json，表格中附上 p50 / p99 变化
+    // 机器人未连接或正在运行时返回 false
+    Q_INVOKABLE bool start(const QVariantMap &options = QVariantMap());
+    // 中止，已完成的端点照常出报告
+    Q_INVOKABLE void stop();
+
+signals:
+    void runningChanged();
+    void progressChanged();
+    void errorOccurred(const QString &message);
+    void finished(const QString &reportPath);
+
+private slots:
+    void pump();
+
+private:
+    struct Endpoint
+    {
+        QString name;
+        QString family;
+        QString type;
+        QJsonValue db;
+        bool writes;
+    };
+
+    struct Phase
+    {
+        int sent = 0;
+        int completed = 0;
+        int errors = 0;
+        qint64 startNs = 0;
+        qint64 endNs = 0;
+        std::vector<qint64> latencyUs; // 只含预热之后的成功请求
+    };
+
+    static std::vector<Endpoint> suite(const QVariantMap &options);
+    void onReply(quint64 generation, int sequence, qint64 sentNs, bool ok);
+    void nextEndpoint();
+    void finish();
+    QVariantMap summarize(const Endpoint &endpoint, Phase &phase) const;
+    void writeReport();
+
+    RobotClient *m_robot;
+    QTimer *m_pumpTimer;
+    QElapsedTimer m_clock;
+
+    bool m_running = false;
+    quint64 m_generation = 0; // stop() 后迟到的回复按代号丢弃
+    QVariantMap m_options;
+    int m_concurrency = 1;
+    double m_ratePerSec = 0;
+    int m_count = 200;
+    int m_warmup = 10;
+
+    std::vector<Endpoint> m_suite;
+    int m_current = -1;
+    Phase m_phase;
+    int m_inFlight = 0;
+    qint64 m_nextSendNs = 0;
+
+    QString m_startedAt;
+    QVariantList m_results;
+    QString m_reportPath;
+};
+
+#endif // LATENCYSWEEP_H
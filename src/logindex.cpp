@@ -0,0 +1,637 @@
+#include "logindex.h"
+#include "binarylog.h"
+
+#include <QCoreApplication>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QSemaphore>
+#include <algorithm>
+#include <cstring>
+#include <functional>
+
+namespace {
+
+constexpr qint64 kDayMs = 24LL * 3600 * 1000;
+// 时间回退超过 1 小时视为跨过了午夜 (小幅回退按系统校时处理)
+constexpr qint64 kRolloverMs = 3600LL * 1000;
+// 稀疏索引密度：每 512 行或每 32KB 记录一项，10MB 文件约 300 项
+constexpr int kLinesPerEntry = 512;
+constexpr qint64 kBytesPerEntry = 32 * 1024;
+
+constexpr quint32 kIndexMagic = 0x5844494C; // "LIDX"
+constexpr quint32 kIndexVersion = 1;
+
+inline char toLowerAscii(char c)
+{
+    return (c >= 'A' && c <= 'Z') ? char(c + ('a' - 'A')) : c;
+}
+
+// 忽略大小写的子串搜索 (只折叠 ASCII，中文不受影响)
+struct AsciiFoldHash
+{
+    std::size_t operator()(char c) const { return static_cast<unsigned char>(toLowerAscii(c)); }
+};
+
+struct AsciiFoldEqual
+{
+    bool operator()(char a, char b) const { return toLowerAscii(a) == toLowerAscii(b); }
+};
+
+// 把 count 个任务分发到全局线程池并等待全部完成
+// 调用方在协调线程中，不占用全局线程池，不会因为等待而死锁
+template <typename Fn>
+void parallelFor(int count, Fn fn)
+{
+    QSemaphore done;
+    for (int i = 0; i < count; ++i) {
+        QThreadPool::globalInstance()->start([&fn, &done, i] {
+            fn(i);
+            done.release();
+        });
+    }
+    done.acquire(count);
+}
+
+QDateTime parseQueryTime(const QString &text)
+{
+    const QString trimmed = text.trimmed();
+    for (const char *format : { "yyyy-MM-dd HH:mm:ss", "yyyy-MM-dd HH:mm", "yyyy-MM-dd" }) {
+        const QDateTime dt = QDateTime::fromString(trimmed, QString::fromLatin1(format));
+        if (dt.isValid()) return dt;
+    }
+    return QDateTime();
+}
+
+} // namespace
+
+// ==========================================================
+// LogMapping
+// ==========================================================
+
+LogMapping::~LogMapping()
+{
+    if (data) file.unmap(reinterpret_cast<uchar *>(const_cast<char *>(data)));
+}
+
+// ==========================================================
+// LogFile
+// ==========================================================
+
+LogFile::LogFile(const QString &path, const QString &name)
+    : m_path(path)
+    , m_name(name.isEmpty() ? QFileInfo(path).fileName() : name)
+{
+    // log_yyyyMMdd_HHmmss.txt / log_yyyyMMdd_HHmmss_zzz.blog，文件名不规范时退回到文件创建时间
+    QDate date = QDate::fromString(m_name.mid(4, 8), "yyyyMMdd");
+    if (!date.isValid()) {
+        QFileInfo info(path);
+        date = (info.birthTime().isValid() ? info.birthTime() : info.lastModified()).date();
+    }
+    m_baseDayMs = date.startOfDay().toMSecsSinceEpoch();
+    m_dayMs = m_baseDayMs;
+}
+
+QString LogFile::fileName() const
+{
+    return m_name;
+}
+
+std::shared_ptr<const LogMapping> LogFile::mapping()
+{
+    const qint64 size = QFileInfo(m_path).size();
+    if (m_mapping && m_mapping->size == size) return m_mapping;
+
+    auto map = std::make_shared<LogMapping>();
+    map->file.setFileName(m_path);
+    if (size <= 0 || !map->file.open(QIODevice::ReadOnly)) {
+        m_mapping.reset();
+        return m_mapping;
+    }
+
+    // 以这一刻的大小映射，之后追加的内容留给下一次映射
+    map->data = reinterpret_cast<const char *>(map->file.map(0, size));
+    if (!map->data) {
+        m_mapping.reset();
+        return m_mapping;
+    }
+    map->size = size;
+    m_mapping = map;
+    return m_mapping;
+}
+
+int LogFile::parseTimeOfDay(const char *line, qint64 length)
+{
+    // "[HH:mm:ss.zzz]"
+    if (length < 14 || line[0] != '[' || line[3] != ':' || line[6] != ':' || line[9] != '.' || line[13] != ']') {
+        return -1;
+    }
+
+    auto digits = [line](int pos, int count) -> int {
+        int value = 0;
+        for (int i = 0; i < count; ++i) {
+            const char c = line[pos + i];
+            if (c < '0' || c > '9') return -1;
+            value = value * 10 + (c - '0');
+        }
+        return value;
+    };
+
+    const int h = digits(1, 2);
+    const int m = digits(4, 2);
+    const int s = digits(7, 2);
+    const int ms = digits(10, 3);
+    if (h < 0 || m < 0 || s < 0 || ms < 0) return -1;
+    return ((h * 60 + m) * 60 + s) * 1000 + ms;
+}
+
+bool LogFile::updateIndex(const std::atomic<quint64> &generation, quint64 myGeneration)
+{
+    std::shared_ptr<const LogMapping> map = mapping();
+    const qint64 size = map ? map->size : 0;
+
+    // 文件变小说明被替换过，从头重建
+    if (size < m_indexedBytes) {
+        m_entries.clear();
+        m_indexedBytes = 0;
+        m_dayMs = m_baseDayMs;
+        m_lastTodMs = -1;
+        m_lastTimestampMs = -1;
+        m_linesSinceEntry = 0;
+    }
+    if (!map || size == m_indexedBytes) return false;
+
+    const char *base = map->data;
+    qint64 pos = m_indexedBytes;
+    qint64 lastEntryOffset = m_entries.empty() ? -1 : m_entries.back().offset;
+    quint32 lines = 0;
+
+    while (pos < size) {
+        const char *newline = static_cast<const char *>(std::memchr(base + pos, '\n', size - pos));
+        if (!newline) break; // 最后半行还在写入，下次再索引
+
+        const qint64 lineEnd = newline - base;
+        const int tod = parseTimeOfDay(base + pos, lineEnd - pos);
+        if (tod >= 0) {
+            if (m_lastTodMs >= 0 && tod < m_lastTodMs - kRolloverMs) m_dayMs += kDayMs;
+            m_lastTodMs = tod;
+            m_lastTimestampMs = m_dayMs + tod;
+        }
+
+        if (m_entries.empty() || m_linesSinceEntry >= kLinesPerEntry || pos - lastEntryOffset >= kBytesPerEntry) {
+            LogIndexEntry entry;
+            entry.offset = pos;
+            entry.timestampMs = m_lastTimestampMs >= 0 ? m_lastTimestampMs : m_dayMs;
+            entry.dayMs = m_dayMs;
+            m_entries.push_back(entry);
+            lastEntryOffset = pos;
+            m_linesSinceEntry = 0;
+        }
+        ++m_linesSinceEntry;
+        pos = lineEnd + 1;
+
+        // 有新的搜索请求时尽快让出，已处理的部分仍然有效
+        if ((++lines & 0xFFFF) == 0 && generation.load(std::memory_order_relaxed) != myGeneration) break;
+    }
+
+    const bool changed = pos != m_indexedBytes;
+    m_indexedBytes = pos;
+    return changed;
+}
+
+bool LogFile::loadIndex(const QString &indexDir)
+{
+    QFile file(indexDir + "/" + fileName() + ".idx");
+    if (!file.open(QIODevice::ReadOnly)) return false;
+
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_6_0);
+
+    quint32 magic = 0, version = 0, count = 0;
+    qint64 indexedBytes = 0, dayMs = 0, lastTimestampMs = -1;
+    qint32 lastTodMs = -1, linesSinceEntry = 0;
+    in >> magic >> version;
+    if (magic != kIndexMagic || version != kIndexVersion) return false;
+    in >> indexedBytes >> dayMs >> lastTodMs >> lastTimestampMs >> linesSinceEntry >> count;
+
+    // 索引比文件还长：日志被替换过，作废
+    if (in.status() != QDataStream::Ok || indexedBytes > QFileInfo(m_path).size()) return false;
+    if (count > quint64(indexedBytes) / 2 + 1) return false; // 损坏的索引文件
+
+    std::vector<LogIndexEntry> entries(count);
+    for (LogIndexEntry &entry : entries) {
+        in >> entry.offset >> entry.timestampMs >> entry.dayMs;
+    }
+    if (in.status() != QDataStream::Ok) return false;
+
+    m_entries = std::move(entries);
+    m_indexedBytes = indexedBytes;
+    m_dayMs = dayMs;
+    m_lastTodMs = lastTodMs;
+    m_lastTimestampMs = lastTimestampMs;
+    m_linesSinceEntry = linesSinceEntry;
+    return true;
+}
+
+bool LogFile::saveIndex(const QString &indexDir) const
+{
+    QSaveFile file(indexDir + "/" + fileName() + ".idx");
+    if (!file.open(QIODevice::WriteOnly)) return false;
+
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_6_0);
+    out << kIndexMagic << kIndexVersion
+        << m_indexedBytes << m_dayMs << qint32(m_lastTodMs) << m_lastTimestampMs << qint32(m_linesSinceEntry)
+        << quint32(m_entries.size());
+    for (const LogIndexEntry &entry : m_entries) {
+        out << entry.offset << entry.timestampMs << entry.dayMs;
+    }
+    return file.commit();
+}
+
+qint64 LogFile::offsetForTime(qint64 ms) const
+{
+    // 第一个 >= ms 的索引项的前一项：它之前的行都早于 ms
+    auto it = std::lower_bound(m_entries.begin(), m_entries.end(), ms,
+                               [](const LogIndexEntry &e, qint64 value) { return e.timestampMs < value; });
+    if (it == m_entries.begin()) return 0;
+    return (it - 1)->offset;
+}
+
+qint64 LogFile::offsetAfterTime(qint64 ms) const
+{
+    // 第一个 > ms 的索引项：它之后的行都晚于 ms
+    auto it = std::upper_bound(m_entries.begin(), m_entries.end(), ms,
+                               [](qint64 value, const LogIndexEntry &e) { return value < e.timestampMs; });
+    return it == m_entries.end() ? m_indexedBytes : it->offset;
+}
+
+qint64 LogFile::timestampOfLine(const char *line, qint64 length, qint64 offset) const
+{
+    auto it = std::upper_bound(m_entries.begin(), m_entries.end(), offset,
+                               [](qint64 value, const LogIndexEntry &e) { return value < e.offset; });
+    if (it == m_entries.begin()) return m_baseDayMs;
+    const LogIndexEntry &entry = *(it - 1);
+
+    const int tod = parseTimeOfDay(line, length);
+    if (tod < 0) return entry.timestampMs;
+
+    // 索引段内跨过午夜
+    qint64 day = entry.dayMs;
+    if (tod < (entry.timestampMs - entry.dayMs) - kRolloverMs) day += kDayMs;
+    return day + tod;
+}
+
+void LogFile::search(const LogMapping &map, const LogQuery &query, int fileIndex, std::vector<LogHit> &out,
+                     const std::atomic<quint64> &generation, quint64 myGeneration) const
+{
+    const qint64 limit = qMin(m_indexedBytes, map.size);
+    if (limit <= 0) return;
+
+    // 整个文件都不在时间范围内，直接跳过
+    if (query.toMs >= 0 && firstTimestampMs() > query.toMs) return;
+    if (query.fromMs >= 0 && m_lastTimestampMs >= 0 && m_lastTimestampMs < query.fromMs) return;
+
+    const qint64 begin = query.fromMs >= 0 ? offsetForTime(query.fromMs) : 0;
+    const qint64 end = query.toMs >= 0 ? qMin(limit, offsetAfterTime(query.toMs)) : limit;
+    const bool timeFilter = query.fromMs >= 0 || query.toMs >= 0;
+    const char *base = map.data;
+
+    // 时间过滤 + 收集，返回 false 表示已达上限
+    auto collect = [&](qint64 lineStart, qint64 lineEnd, qint64 timestampMs) {
+        qint64 length = lineEnd - lineStart;
+        if (length > 0 && base[lineEnd - 1] == '\r') --length;
+        LogHit hit;
+        hit.fileIndex = fileIndex;
+        hit.offset = lineStart;
+        hit.length = static_cast<int>(length);
+        hit.timestampMs = timestampMs;
+        out.push_back(hit);
+        return static_cast<int>(out.size()) < query.maxHits;
+    };
+    auto inRange = [&](qint64 ts) {
+        return !timeFilter || ((query.fromMs < 0 || ts >= query.fromMs) && (query.toMs < 0 || ts <= query.toMs));
+    };
+
+    quint32 steps = 0;
+    auto cancelled = [&]() {
+        return (++steps & 0x3FF) == 0 && generation.load(std::memory_order_relaxed) != myGeneration;
+    };
+
+    if (!query.useRegex && !query.text.isEmpty()) {
+        // 子串：直接在映射内存上跳跃搜索，只对命中的行定位行首行尾
+        const char *first = base + begin;
+        const char *last = base + end;
+        auto run = [&](const auto &searcher) {
+            const char *pos = first;
+            while (pos < last) {
+                const char *match = std::search(pos, last, searcher);
+                if (match == last) break;
+
+                const char *lineStart = match;
+                while (lineStart > first && lineStart[-1] != '\n') --lineStart;
+                const char *lineEnd = static_cast<const char *>(std::memchr(match, '\n', last - match));
+                if (!lineEnd) lineEnd = last;
+
+                const qint64 ts = timestampOfLine(lineStart, lineEnd - lineStart, lineStart - base);
+                if (inRange(ts) && !collect(lineStart - base, lineEnd - base, ts)) return;
+
+                pos = lineEnd + 1;
+                if (cancelled()) return;
+            }
+        };
+
+        if (query.caseSensitive) {
+            run(std::boyer_moore_horspool_searcher(query.text.cbegin(), query.text.cend()));
+        } else {
+            run(std::boyer_moore_horspool_searcher(query.text.cbegin(), query.text.cend(),
+                                                   AsciiFoldHash(), AsciiFoldEqual()));
+        }
+        return;
+    }
+
+    // 正则 / 只按时间：逐行处理，先过滤时间再做较贵的正则匹配
+    qint64 pos = begin;
+    while (pos < end) {
+        const char *newline = static_cast<const char *>(std::memchr(base + pos, '\n', end - pos));
+        const qint64 lineEnd = newline ? newline - base : end;
+        qint64 length = lineEnd - pos;
+        if (length > 0 && base[lineEnd - 1] == '\r') --length;
+
+        const qint64 ts = timestampOfLine(base + pos, length, pos);
+        if (inRange(ts)) {
+            const bool matched = !query.useRegex
+                                 || query.regex.match(QString::fromUtf8(base + pos, length)).hasMatch();
+            if (matched && !collect(pos, lineEnd, ts)) return;
+        }
+
+        pos = lineEnd + 1;
+        if (cancelled()) return;
+    }
+}
+
+// ==========================================================
+// LogSearchModel
+// ==========================================================
+
+struct LogSearchModel::SearchResult
+{
+    quint64 generation = 0;
+    bool hasHits = false;
+    std::vector<LogHit> hits;
+    std::vector<std::shared_ptr<const LogMapping>> mappings;
+    QStringList fileNames;
+    bool truncated = false;
+    int elapsedMs = 0;
+    int fileCount = 0;
+    qint64 indexedBytes = 0;
+};
+
+LogSearchModel::LogSearchModel(QObject *parent)
+    : QAbstractListModel(parent)
+{
+    // 与 RobotClient::initLogSystem 使用同一目录，索引和二进制段的文本缓存放在子目录中，不影响日志轮转
+    m_logDir = QCoreApplication::applicationDirPath() + "/Logs";
+    m_indexDir = m_logDir + "/.index";
+    QDir().mkpath(m_indexDir);
+
+    m_coordinator.setMaxThreadCount(1);
+}
+
+LogSearchModel::~LogSearchModel()
+{
+    ++m_generation;
+    m_coordinator.waitForDone();
+}
+
+int LogSearchModel::rowCount(const QModelIndex &parent) const
+{
+    if (parent.isValid()) return 0;
+    return static_cast<int>(m_hits.size());
+}
+
+QHash<int, QByteArray> LogSearchModel::roleNames() const
+{
+    return {
+        { TimeRole, "time" },
+        { TimestampRole, "timestampMs" },
+        { FileRole, "file" },
+        { TextRole, "text" },
+        { OffsetRole, "offset" }
+    };
+}
+
+QVariant LogSearchModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= static_cast<int>(m_hits.size())) return QVariant();
+
+    const LogHit &hit = m_hits[index.row()];
+    switch (role) {
+    case TimeRole:
+        return QDateTime::fromMSecsSinceEpoch(hit.timestampMs).toString("yyyy-MM-dd HH:mm:ss.zzz");
+    case TimestampRole:
+        return hit.timestampMs;
+    case FileRole:
+        return m_fileNames.value(hit.fileIndex);
+    case TextRole: {
+        // 只在显示时从映射内存解码
+        const LogMapping *map = m_mappings[hit.fileIndex].get();
+        return map ? QString::fromUtf8(map->data + hit.offset, hit.length) : QString();
+    }
+    case OffsetRole:
+        return hit.offset;
+    default:
+        return QVariant();
+    }
+}
+
+void LogSearchModel::refreshIndex()
+{
+    // 不增加 generation：不打断正在进行的搜索
+    const quint64 generation = m_generation.load();
+    ++m_pending;
+    setBusy(true);
+
+    m_coordinator.start([this, generation] {
+        updateAllIndexes(generation);
+
+        auto result = std::make_shared<SearchResult>();
+        result->generation = generation;
+        result->fileCount = static_cast<int>(m_files.size());
+        for (const auto &file : m_files) result->indexedBytes += file->indexedBytes();
+
+        QMetaObject::invokeMethod(this, [this, result] { applyResult(result); }, Qt::QueuedConnection);
+    });
+}
+
+void LogSearchModel::search(const QString &text, bool useRegex, bool caseSensitive,
+                            const QString &from, const QString &to)
+{
+    LogQuery query;
+    query.useRegex = useRegex;
+    query.caseSensitive = caseSensitive;
+
+    if (useRegex) {
+        query.regex.setPattern(text);
+        query.regex.setPatternOptions(caseSensitive ? QRegularExpression::NoPatternOption
+                                                    : QRegularExpression::CaseInsensitiveOption);
+        if (!query.regex.isValid()) {
+            emit errorOccurred(QString("正则表达式错误: %1").arg(query.regex.errorString()));
+            return;
+        }
+        query.regex.optimize();
+    } else {
+        query.text = text.toUtf8();
+    }
+
+    if (!from.trimmed().isEmpty()) {
+        const QDateTime dt = parseQueryTime(from);
+        if (!dt.isValid()) {
+            emit errorOccurred(QString("起始时间格式错误: %1").arg(from));
+            return;
+        }
+        query.fromMs = dt.toMSecsSinceEpoch();
+    }
+    if (!to.trimmed().isEmpty()) {
+        const QDateTime dt = parseQueryTime(to);
+        if (!dt.isValid()) {
+            emit errorOccurred(QString("结束时间格式错误: %1").arg(to));
+            return;
+        }
+        query.toMs = dt.toMSecsSinceEpoch();
+    }
+
+    // 新搜索使旧的搜索失效 (旧任务在下一次检查时退出，结果被丢弃)
+    const quint64 generation = ++m_generation;
+    ++m_pending;
+    setBusy(true);
+
+    m_coordinator.start([this, query, generation] {
+        QElapsedTimer timer;
+        timer.start();
+
+        // 先把新写入的日志补进索引 (通常只有最新文件的末尾几 KB)
+        updateAllIndexes(generation);
+
+        auto result = std::make_shared<SearchResult>();
+        result->generation = generation;
+        result->hasHits = true;
+        result->fileCount = static_cast<int>(m_files.size());
+
+        const int count = result->fileCount;
+        result->mappings.resize(count);
+        for (int i = 0; i < count; ++i) {
+            result->mappings[i] = m_files[i]->mapping();
+            result->fileNames.append(m_files[i]->fileName());
+            result->indexedBytes += m_files[i]->indexedBytes();
+        }
+
+        // 每个文件独立搜索，文件名带时间，按顺序合并即为时间顺序
+        std::vector<std::vector<LogHit>> perFile(count);
+        parallelFor(count, [&](int i) {
+            if (!result->mappings[i] || m_generation.load() != generation) return;
+            m_files[i]->search(*result->mappings[i], query, i, perFile[i], m_generation, generation);
+        });
+
+        const size_t maxHits = static_cast<size_t>(query.maxHits);
+        for (const std::vector<LogHit> &hits : perFile) {
+            // 单个文件达到上限时它自己就已经被截断
+            if (hits.size() >= maxHits) result->truncated = true;
+
+            const size_t room = maxHits - result->hits.size();
+            if (hits.size() > room) {
+                result->hits.insert(result->hits.end(), hits.begin(), hits.begin() + room);
+                result->truncated = true;
+                break;
+            }
+            result->hits.insert(result->hits.end(), hits.begin(), hits.end());
+        }
+        result->elapsedMs = static_cast<int>(timer.elapsed());
+
+        QMetaObject::invokeMethod(this, [this, result] { applyResult(result); }, Qt::QueuedConnection);
+    });
+}
+
+void LogSearchModel::cancel()
+{
+    ++m_generation;
+}
+
+void LogSearchModel::updateAllIndexes(quint64 generation)
+{
+    QDir dir(m_logDir);
+    const QFileInfoList infos = dir.entryInfoList({ "*.txt", "*.blog" }, QDir::Files | QDir::NoSymLinks, QDir::Name);
+
+    // 复用已有对象 (保留内存中的索引和映射)，新文件先尝试读取持久化的索引
+    std::vector<std::shared_ptr<LogFile>> files;
+    files.reserve(infos.size());
+    for (const QFileInfo &info : infos) {
+        QString path = info.absoluteFilePath();
+        if (info.suffix() == QLatin1String("blog")) {
+            // 二进制段转换为同格式的文本："[HH:mm:ss.zzz] 内容"
+            // 转换是确定的，段追加或被压缩重写后结果只会在末尾增长，已有索引继续增量使用
+            // 缓存仍被旧的搜索结果映射时 (Windows) 替换会失败，沿用旧缓存，下次刷新再转换
+            const QString text = m_indexDir + "/" + info.fileName() + ".txt";
+            const QFileInfo textInfo(text);
+            if (!textInfo.exists() || textInfo.lastModified() <= info.lastModified()) {
+                if (!BinaryLogReader::convertToText(path, text) && !textInfo.exists()) continue;
+            }
+            path = text;
+        }
+
+        auto it = std::find_if(m_files.begin(), m_files.end(),
+                               [&path](const std::shared_ptr<LogFile> &f) { return f->path() == path; });
+        if (it != m_files.end()) {
+            files.push_back(*it);
+        } else {
+            auto file = std::make_shared<LogFile>(path, info.fileName());
+            file->loadIndex(m_indexDir);
+            files.push_back(file);
+        }
+    }
+    m_files = std::move(files);
+
+    // 日志被轮转删除后，对应的索引和文本缓存也删掉 (二者的 completeBaseName 都是原日志文件名)
+    const QFileInfoList indexes = QDir(m_indexDir).entryInfoList({ "*.idx", "*.blog.txt" }, QDir::Files);
+    for (const QFileInfo &info : indexes) {
+        if (!QFileInfo::exists(m_logDir + "/" + info.completeBaseName())) QFile::remove(info.absoluteFilePath());
+    }
+
+    // 各文件并行增量索引，有变化才落盘
+    const int count = static_cast<int>(m_files.size());
+    parallelFor(count, [&](int i) {
+        if (m_files[i]->updateIndex(m_generation, generation)) m_files[i]->saveIndex(m_indexDir);
+    });
+}
+
+void LogSearchModel::setBusy(bool busy)
+{
+    if (m_busy == busy) return;
+    m_busy = busy;
+    emit busyChanged();
+}
+
+void LogSearchModel::applyResult(const std::shared_ptr<SearchResult> &result)
+{
+    --m_pending;
+    setBusy(m_pending > 0);
+
+    m_fileCount = result->fileCount;
+    m_indexedBytesTotal = result->indexedBytes;
+    emit indexChanged();
+
+    // 过期 (被取消或被更新的搜索取代) 的结果直接丢弃
+    if (!result->hasHits || result->generation != m_generation.load()) return;
+
+    beginResetModel();
+    m_hits = std::move(result->hits);
+    m_mappings = std::move(result->mappings);
+    m_fileNames = result->fileNames;
+    m_truncated = result->truncated;
+    m_elapsedMs = result->elapsedMs;
+    endResetModel();
+    emit resultsChanged();
+}
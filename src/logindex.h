@@ -0,0 +1,190 @@
+#ifndef LOGINDEX_H
+#define LOGINDEX_H
+
+#include <QAbstractListModel>
+#include <QFile>
+#include <QRegularExpression>
+#include <QString>
+#include <QStringList>
+#include <QThreadPool>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+// 一次只读内存映射 (创建后不可变)
+// 搜索结果持有它的共享指针：日志文件增长后重新映射，不影响界面正在显示的旧结果
+struct LogMapping
+{
+    QFile file;
+    const char *data = nullptr;
+    qint64 size = 0;
+
+    ~LogMapping();
+};
+
+// 稀疏索引项：每隔若干行记录一次 (行首偏移, 该行时间戳, 当天零点)
+struct LogIndexEntry
+{
+    qint64 offset = 0;
+    qint64 timestampMs = 0;
+    qint64 dayMs = 0;
+};
+
+// 搜索条件
+struct LogQuery
+{
+    QByteArray text;              // 子串 (UTF-8)
+    QRegularExpression regex;     // useRegex 时使用
+    bool useRegex = false;
+    bool caseSensitive = false;
+    qint64 fromMs = -1;           // -1 表示不限
+    qint64 toMs = -1;
+    int maxHits = 200000;
+};
+
+// 命中的一行
+struct LogHit
+{
+    int fileIndex = 0;
+    qint64 offset = 0;
+    int length = 0;
+    qint64 timestampMs = 0;
+};
+
+// 单个日志文件：内存映射 + 行偏移 -> 时间戳的稀疏索引
+// 日志行格式为 "[HH:mm:ss.zzz] ..."，日期取自文件名 log_yyyyMMdd_HHmmss*，时间回退时视为跨天
+// name 为显示名 (也用于日期和索引文件名)，二进制日志段转换出的文本用原段名
+class LogFile
+{
+public:
+    explicit LogFile(const QString &path, const QString &name = QString());
+
+    QString path() const { return m_path; }
+    QString fileName() const;
+
+    // 返回覆盖当前文件大小的映射 (大小未变时复用上次的映射)
+    std::shared_ptr<const LogMapping> mapping();
+
+    // 从上次索引到的位置继续建立索引，返回是否有新内容
+    bool updateIndex(const std::atomic<quint64> &generation, quint64 myGeneration);
+
+    // 索引持久化到 indexDir/<文件名>.idx，文件变小 (被替换) 时丢弃旧索引
+    bool loadIndex(const QString &indexDir);
+    bool saveIndex(const QString &indexDir) const;
+
+    qint64 indexedBytes() const { return m_indexedBytes; }
+    qint64 firstTimestampMs() const { return m_entries.empty() ? -1 : m_entries.front().timestampMs; }
+    qint64 lastTimestampMs() const { return m_lastTimestampMs; }
+
+    // 时间 -> 字节范围 (按稀疏索引二分，边界附近的行由调用方逐行过滤)
+    qint64 offsetForTime(qint64 ms) const;
+    qint64 offsetAfterTime(qint64 ms) const;
+
+    // 计算一行的时间戳，行首没有时间的续行返回所在索引段的时间
+    qint64 timestampOfLine(const char *line, qint64 length, qint64 offset) const;
+
+    // 按条件搜索已索引的部分，结果追加到 out (最多 query.maxHits 条)
+    void search(const LogMapping &map, const LogQuery &query, int fileIndex, std::vector<LogHit> &out,
+                const std::atomic<quint64> &generation, quint64 myGeneration) const;
+
+    // 解析行首 "[HH:mm:ss.zzz]"，失败返回 -1
+    static int parseTimeOfDay(const char *line, qint64 length);
+
+private:
+    QString m_path;
+    QString m_name;
+    qint64 m_baseDayMs = 0;                   // 文件名中的日期 (本地零点)
+    std::shared_ptr<const LogMapping> m_mapping;
+
+    std::vector<LogIndexEntry> m_entries;
+    qint64 m_indexedBytes = 0;                // 已索引到的位置 (总在行边界)
+    qint64 m_dayMs = 0;                       // 最后一行所在日期
+    int m_lastTodMs = -1;                     // 最后一行的当日时间
+    qint64 m_lastTimestampMs = -1;
+    int m_linesSinceEntry = 0;
+};
+
+// 日志检索模型：后台建立/增量更新索引，多文件并行搜索，结果按需从映射内存读取行内容
+// 文本日志 (*.txt) 直接索引；二进制日志段 (*.blog) 先转换为文本缓存在索引目录中，段有新内容时重新转换
+// 结果可达几十万行，配合 ListView 只解码可见行
+class LogSearchModel : public QAbstractListModel
+{
+    Q_OBJECT
+    Q_PROPERTY(int count READ rowCount NOTIFY resultsChanged)
+    Q_PROPERTY(bool busy READ busy NOTIFY busyChanged)
+    Q_PROPERTY(bool truncated READ truncated NOTIFY resultsChanged)
+    Q_PROPERTY(int elapsedMs READ elapsedMs NOTIFY resultsChanged)
+    Q_PROPERTY(int fileCount READ fileCount NOTIFY indexChanged)
+    Q_PROPERTY(qint64 indexedBytes READ indexedBytes NOTIFY indexChanged)
+    Q_PROPERTY(QString logDir READ logDir CONSTANT)
+
+public:
+    enum Roles {
+        TimeRole = Qt::UserRole + 1, // "yyyy-MM-dd HH:mm:ss.zzz"
+        TimestampRole,               // ms since epoch
+        FileRole,                    // 文件名
+        TextRole,                    // 整行内容
+        OffsetRole                   // 行在文件中的偏移
+    };
+
+    explicit LogSearchModel(QObject *parent = nullptr);
+    ~LogSearchModel();
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role) const override;
+    QHash<int, QByteArray> roleNames() const override;
+
+    bool busy() const { return m_busy; }
+    bool truncated() const { return m_truncated; }
+    int elapsedMs() const { return m_elapsedMs; }
+    int fileCount() const { return m_fileCount; }
+    qint64 indexedBytes() const { return m_indexedBytesTotal; }
+    QString logDir() const { return m_logDir; }
+
+    // 后台增量更新索引 (页面打开时调用一次即可)
+    Q_INVOKABLE void refreshIndex();
+
+    // 搜索：text 为空时列出时间范围内的所有行
+    // from / to 形如 "2025-01-01 08:00:00"，为空表示不限
+    Q_INVOKABLE void search(const QString &text, bool useRegex, bool caseSensitive,
+                            const QString &from = QString(), const QString &to = QString());
+
+    // 取消正在进行的搜索
+    Q_INVOKABLE void cancel();
+
+signals:
+    void resultsChanged();
+    void busyChanged();
+    void indexChanged();
+    void errorOccurred(const QString &errorMsg);
+
+private:
+    struct SearchResult;
+
+    // 以下在后台协调线程执行
+    void updateAllIndexes(quint64 generation);
+
+    void setBusy(bool busy);
+    void applyResult(const std::shared_ptr<SearchResult> &result);
+
+    QString m_logDir;
+    QString m_indexDir;
+
+    // 协调线程 (单线程，保证索引更新和搜索串行)，逐文件的工作交给全局线程池
+    QThreadPool m_coordinator;
+    std::atomic<quint64> m_generation{0};
+    std::vector<std::shared_ptr<LogFile>> m_files; // 只在协调线程访问
+
+    // 当前显示的结果 (GUI 线程)
+    std::vector<LogHit> m_hits;
+    std::vector<std::shared_ptr<const LogMapping>> m_mappings;
+    QStringList m_fileNames;
+    bool m_truncated = false;
+    int m_elapsedMs = 0;
+    bool m_busy = false;
+    int m_pending = 0;
+    int m_fileCount = 0;
+    qint64 m_indexedBytesTotal = 0;
+};
+
+#endif // LOGINDEX_H
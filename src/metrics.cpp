@@ -0,0 +1,253 @@
+#include "metrics.h"
+
+#include <QDateTime>
+#include <QDebug>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QVariantMap>
+#include <algorithm>
+
+// ==========================================================
+// MetricHistogram
+// ==========================================================
+
+MetricHistogram::MetricHistogram(const std::vector<qint64> &upperBounds)
+    : m_bounds(upperBounds)
+    , m_counts(new std::atomic<quint64>[upperBounds.size() + 1])
+{
+    std::sort(m_bounds.begin(), m_bounds.end());
+    for (size_t i = 0; i <= m_bounds.size(); ++i) {
+        m_counts[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+void MetricHistogram::observe(qint64 value)
+{
+    // 桶数量很少 (十几个)，线性查找比二分更快
+    size_t i = 0;
+    while (i < m_bounds.size() && value > m_bounds[i]) ++i;
+
+    m_counts[i].fetch_add(1, std::memory_order_relaxed);
+    m_count.fetch_add(1, std::memory_order_relaxed);
+    m_sum.fetch_add(value, std::memory_order_relaxed);
+
+    qint64 current = m_max.load(std::memory_order_relaxed);
+    while (value > current && !m_max.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+    }
+}
+
+double MetricHistogram::quantile(double q) const
+{
+    const quint64 total = count();
+    if (total == 0) return 0.0;
+
+    const double rank = q * total;
+    quint64 cumulative = 0;
+    for (size_t i = 0; i <= m_bounds.size(); ++i) {
+        const quint64 c = bucketCount(i);
+        if (c > 0 && cumulative + c >= rank) {
+            const double lower = (i == 0) ? 0.0 : double(m_bounds[i - 1]);
+            // +Inf 桶用观测到的最大值作为上界
+            const double upper = (i < m_bounds.size()) ? double(m_bounds[i]) : double(max());
+            return lower + (upper - lower) * ((rank - cumulative) / double(c));
+        }
+        cumulative += c;
+    }
+    return double(max());
+}
+
+// ==========================================================
+// MetricsRegistry
+// ==========================================================
+
+MetricsRegistry &MetricsRegistry::instance()
+{
+    static MetricsRegistry registry;
+    return registry;
+}
+
+std::vector<qint64> MetricsRegistry::latencyBucketsUs()
+{
+    return { 50, 100, 250, 500, 1000, 2500, 5000, 10000, 25000, 50000, 100000, 250000, 500000, 1000000, 5000000 };
+}
+
+std::vector<qint64> MetricsRegistry::sizeBucketsBytes()
+{
+    return { 64, 128, 256, 512, 1024, 2048, 4096, 8192, 16384, 65536, 262144 };
+}
+
+MetricsRegistry::Entry *MetricsRegistry::findOrCreate(const QString &name, const QString &help,
+                                                      const QString &labels, Type type)
+{
+    const QString key = labels.isEmpty() ? name : name + "{" + labels + "}";
+    auto it = m_index.constFind(key);
+    if (it != m_index.constEnd() && it.value()->type == type) return it.value();
+
+    // 同一指标族 (不论标签) 只能有一种类型，否则导出的 TYPE 行与样本对不上
+    bool conflict = it != m_index.constEnd();
+    for (size_t i = 0; i < m_entries.size() && !conflict; ++i) {
+        const Entry *other = m_entries[i].get();
+        conflict = other->exported && other->name == name && other->type != type;
+    }
+    if (conflict) {
+        qWarning("metric %s already registered with a different type", qPrintable(name));
+        Q_ASSERT_X(false, "MetricsRegistry", "metric name reused with a different type");
+    }
+
+    auto entry = std::make_unique<Entry>();
+    entry->name = name;
+    entry->help = help;
+    entry->labels = labels;
+    entry->type = type;
+    entry->exported = !conflict;
+
+    Entry *raw = entry.get();
+    m_entries.push_back(std::move(entry));
+    if (!conflict) m_index.insert(key, raw);
+    return raw;
+}
+
+QString MetricsRegistry::escapeLabelValue(const QString &value)
+{
+    QString escaped;
+    escaped.reserve(value.size());
+    for (const QChar c : value) {
+        if (c == u'\\') escaped += QLatin1String("\\\\");
+        else if (c == u'"') escaped += QLatin1String("\\\"");
+        else if (c == u'\n') escaped += QLatin1String("\\n");
+        else escaped += c;
+    }
+    return escaped;
+}
+
+QString MetricsRegistry::label(const QString &name, const QString &value)
+{
+    return name + "=\"" + escapeLabelValue(value) + "\"";
+}
+
+MetricCounter *MetricsRegistry::counter(const QString &name, const QString &help, const QString &labels)
+{
+    QMutexLocker locker(&m_mutex);
+    Entry *entry = findOrCreate(name, help, labels, Counter);
+    if (!entry->counter) entry->counter = std::make_unique<MetricCounter>();
+    return entry->counter.get();
+}
+
+MetricGauge *MetricsRegistry::gauge(const QString &name, const QString &help, const QString &labels)
+{
+    QMutexLocker locker(&m_mutex);
+    Entry *entry = findOrCreate(name, help, labels, Gauge);
+    if (!entry->gauge) entry->gauge = std::make_unique<MetricGauge>();
+    return entry->gauge.get();
+}
+
+MetricHistogram *MetricsRegistry::histogram(const QString &name, const QString &help,
+                                            const std::vector<qint64> &upperBounds, const QString &labels)
+{
+    QMutexLocker locker(&m_mutex);
+    Entry *entry = findOrCreate(name, help, labels, Histogram);
+    if (!entry->histogram) entry->histogram = std::make_unique<MetricHistogram>(upperBounds);
+    return entry->histogram.get();
+}
+
+QByteArray MetricsRegistry::toPrometheusText() const
+{
+    QMutexLocker locker(&m_mutex);
+
+    // 同一指标族的不同标签可能在不同时间注册，输出前按名称归并 (稳定排序保持标签注册顺序)
+    std::vector<const Entry *> sorted;
+    sorted.reserve(m_entries.size());
+    for (const auto &entry : m_entries) {
+        if (entry->exported) sorted.push_back(entry.get());
+    }
+    std::stable_sort(sorted.begin(), sorted.end(), [](const Entry *a, const Entry *b) {
+        return a->name < b->name;
+    });
+
+    QByteArray out;
+    out.reserve(16 * 1024);
+    QString lastFamily;
+
+    for (const Entry *entry : sorted) {
+        // 同一指标族只输出一次 HELP/TYPE
+        if (entry->name != lastFamily) {
+            const char *typeName = entry->type == Counter ? "counter" : (entry->type == Gauge ? "gauge" : "histogram");
+            out += "# HELP " + entry->name.toUtf8() + " " + entry->help.toUtf8() + "\n";
+            out += "# TYPE " + entry->name.toUtf8() + " " + typeName + "\n";
+            lastFamily = entry->name;
+        }
+
+        const QByteArray name = entry->name.toUtf8();
+        const QByteArray labels = entry->labels.toUtf8();
+        const QByteArray braces = labels.isEmpty() ? QByteArray() : "{" + labels + "}";
+
+        if (entry->type == Counter) {
+            out += name + braces + " " + QByteArray::number(entry->counter->value()) + "\n";
+        } else if (entry->type == Gauge) {
+            out += name + braces + " " + QByteArray::number(entry->gauge->value()) + "\n";
+        } else {
+            const MetricHistogram *h = entry->histogram.get();
+            const QByteArray sep = labels.isEmpty() ? QByteArray() : labels + ",";
+            quint64 cumulative = 0;
+            for (size_t i = 0; i < h->upperBounds().size(); ++i) {
+                cumulative += h->bucketCount(i);
+                out += name + "_bucket{" + sep + "le=\"" + QByteArray::number(h->upperBounds()[i]) + "\"} "
+                       + QByteArray::number(cumulative) + "\n";
+            }
+            cumulative += h->bucketCount(h->upperBounds().size());
+            out += name + "_bucket{" + sep + "le=\"+Inf\"} " + QByteArray::number(cumulative) + "\n";
+            out += name + "_sum" + braces + " " + QByteArray::number(h->sum()) + "\n";
+            out += name + "_count" + braces + " " + QByteArray::number(h->count()) + "\n";
+        }
+    }
+    return out;
+}
+
+QByteArray MetricsRegistry::toJson() const
+{
+    QJsonArray metrics;
+    const QVariantList items = snapshot();
+    for (const QVariant &item : items) {
+        metrics.append(QJsonObject::fromVariantMap(item.toMap()));
+    }
+
+    QJsonObject root;
+    root["timestamp"] = QDateTime::currentDateTime().toString(Qt::ISODateWithMs);
+    root["metrics"] = metrics;
+    return QJsonDocument(root).toJson(QJsonDocument::Indented);
+}
+
+QVariantList MetricsRegistry::snapshot() const
+{
+    QMutexLocker locker(&m_mutex);
+
+    QVariantList list;
+    list.reserve(static_cast<int>(m_entries.size()));
+    for (const auto &entry : m_entries) {
+        if (!entry->exported) continue;
+        QVariantMap item;
+        item["name"] = entry->name;
+        item["labels"] = entry->labels;
+
+        if (entry->type == Counter) {
+            item["type"] = "counter";
+            item["value"] = double(entry->counter->value());
+        } else if (entry->type == Gauge) {
+            item["type"] = "gauge";
+            item["value"] = double(entry->gauge->value());
+        } else {
+            const MetricHistogram *h = entry->histogram.get();
+            item["type"] = "histogram";
+            item["count"] = double(h->count());
+            item["sum"] = double(h->sum());
+            item["value"] = h->count() ? double(h->sum()) / h->count() : 0.0; // 均值
+            item["p50"] = h->quantile(0.50);
+            item["p90"] = h->quantile(0.90);
+            item["p99"] = h->quantile(0.99);
+            item["max"] = double(h->max());
+        }
+        list.append(item);
+    }
+    return list;
+}
@@ -0,0 +1,117 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QString>
+#include <QVariantList>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+// 计数器：只增不减 (字节数、消息数、错误次数 ...)
+class MetricCounter
+{
+public:
+    void add(quint64 n = 1) { m_value.fetch_add(n, std::memory_order_relaxed); }
+    quint64 value() const { return m_value.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<quint64> m_value{0};
+};
+
+// 仪表：可任意设置的瞬时值 (队列深度、连接状态 ...)
+class MetricGauge
+{
+public:
+    void set(qint64 v) { m_value.store(v, std::memory_order_relaxed); }
+    void add(qint64 n) { m_value.fetch_add(n, std::memory_order_relaxed); }
+    qint64 value() const { return m_value.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<qint64> m_value{0};
+};
+
+// 固定桶直方图：记录整数观测值 (微秒、字节)，桶边界创建后不可变，observe 全程无锁
+class MetricHistogram
+{
+public:
+    explicit MetricHistogram(const std::vector<qint64> &upperBounds);
+
+    void observe(qint64 value);
+
+    const std::vector<qint64> &upperBounds() const { return m_bounds; }
+    // 第 i 个桶的计数 (非累计)，最后一个为 +Inf 桶
+    quint64 bucketCount(size_t i) const { return m_counts[i].load(std::memory_order_relaxed); }
+    quint64 count() const { return m_count.load(std::memory_order_relaxed); }
+    qint64 sum() const { return m_sum.load(std::memory_order_relaxed); }
+    qint64 max() const { return m_max.load(std::memory_order_relaxed); }
+
+    // 按桶线性插值估算分位数 (q: 0~1)
+    double quantile(double q) const;
+
+private:
+    std::vector<qint64> m_bounds;
+    std::unique_ptr<std::atomic<quint64>[]> m_counts;
+    std::atomic<quint64> m_count{0};
+    std::atomic<qint64> m_sum{0};
+    std::atomic<qint64> m_max{0};
+};
+
+// 全局指标注册表
+// 注册 (查找/创建) 需要加锁，返回的指针在程序生命周期内稳定，热路径应缓存指针后直接更新
+class MetricsRegistry
+{
+public:
+    enum Type { Counter, Gauge, Histogram };
+
+    static MetricsRegistry &instance();
+
+    // labels 形如 ty="publish/RobotStatus"，同名不同标签是不同的序列；标签值用 label() 拼接以转义
+    // 同名指标只能是同一种类型，重复注册为其他类型是编程错误 (Debug 断言，Release 返回不导出的独立指标)
+    MetricCounter *counter(const QString &name, const QString &help, const QString &labels = QString());
+    MetricGauge *gauge(const QString &name, const QString &help, const QString &labels = QString());
+    MetricHistogram *histogram(const QString &name, const QString &help,
+                               const std::vector<qint64> &upperBounds, const QString &labels = QString());
+
+    // Prometheus 文本格式
+    QByteArray toPrometheusText() const;
+    // JSON 格式
+    QByteArray toJson() const;
+    // 给 QML 的快照：[{ name, labels, type, value, count, sum, p50, p90, p99, max }]
+    QVariantList snapshot() const;
+
+    // 按 Prometheus 文本格式转义标签值 (\ " 换行)
+    static QString escapeLabelValue(const QString &value);
+    // name="value"，value 已转义
+    static QString label(const QString &name, const QString &value);
+
+    // 常用桶边界
+    static std::vector<qint64> latencyBucketsUs();
+    static std::vector<qint64> sizeBucketsBytes();
+
+private:
+    MetricsRegistry() = default;
+
+    struct Entry
+    {
+        QString name;
+        QString help;
+        QString labels;
+        Type type = Counter;
+        bool exported = true; // 类型冲突的指标不进入导出
+        std::unique_ptr<MetricCounter> counter;
+        std::unique_ptr<MetricGauge> gauge;
+        std::unique_ptr<MetricHistogram> histogram;
+    };
+
+    Entry *findOrCreate(const QString &name, const QString &help, const QString &labels, Type type);
+
+    mutable QMutex m_mutex;
+    std::vector<std::unique_ptr<Entry>> m_entries; // 按注册顺序输出
+    QHash<QString, Entry *> m_index;               // key = name{labels}
+};
+
+#endif // METRICS_H
@@ -0,0 +1,517 @@
+#include "motionqueue.h"
+#include "Robotclient.h"
+#include "metrics.h"
+
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QTextStream>
+#include <QUrl>
+#include <cmath>
+
+namespace {
+
+// 状态 4 = RunTo (与 RobotClient::updateRobotState 一致)
+constexpr int kStateRunTo = 4;
+
+// 超时检查周期
+constexpr int kWatchdogMs = 50;
+
+// 段计时直方图桶 (微秒)：1ms ~ 60s
+std::vector<qint64> segmentBucketsUs()
+{
+    return { 1000, 5000, 10000, 25000, 50000, 100000, 250000, 500000,
+             1000000, 2500000, 5000000, 10000000, 30000000, 60000000 };
+}
+
+double nsToMs(qint64 ns)
+{
+    return ns < 0 ? -1.0 : ns / 1e6;
+}
+
+bool isPoseArray(const QJsonValue &value)
+{
+    if (!value.isArray()) return false;
+    const QJsonArray array = value.toArray();
+    if (array.size() != 6) return false;
+    for (const QJsonValue &v : array) {
+        if (!v.isDouble()) return false;
+    }
+    return true;
+}
+
+} // namespace
+
+MotionQueue::MotionQueue(RobotClient *robot, QObject *parent)
+    : QObject(parent)
+    , m_robot(robot)
+    , m_watchdog(new QTimer(this))
+{
+    // robotStateChanged 由 updateRobotState 在状态变化时发出 (回放注入的报文不会触发)
+    connect(m_robot, &RobotClient::robotStateChanged, this, &MotionQueue::onRobotStateChanged);
+    connect(m_robot, &RobotClient::robotPostureFrame, this, &MotionQueue::onRobotPosture);
+
+    m_watchdog->setInterval(kWatchdogMs);
+    connect(m_watchdog, &QTimer::timeout, this, &MotionQueue::onWatchdog);
+
+    MetricsRegistry &r = MetricsRegistry::instance();
+    m_ackHist = r.histogram("motion_segment_ack_us", "Time from moveTo send to RunTo state", segmentBucketsUs());
+    m_moveHist = r.histogram("motion_segment_move_us", "Time spent in RunTo per segment", segmentBucketsUs());
+    m_overheadHist = r.histogram("motion_segment_overhead_us",
+                                 "Idle time between the end of one segment and the start of the next",
+                                 segmentBucketsUs());
+}
+
+int MotionQueue::currentIndex() const
+{
+    return m_running && !m_inFlight.empty() ? m_inFlight.front() : -1;
+}
+
+void MotionQueue::setPreSend(bool enabled)
+{
+    if (m_preSend == enabled) return;
+    m_preSend = enabled;
+    emit preSendChanged();
+}
+
+void MotionQueue::setStartTimeoutMs(int ms)
+{
+    ms = qMax(100, ms);
+    if (m_startTimeoutMs == ms) return;
+    m_startTimeoutMs = ms;
+    emit timeoutsChanged();
+}
+
+void MotionQueue::setSegmentTimeoutMs(int ms)
+{
+    ms = qMax(1000, ms);
+    if (m_segmentTimeoutMs == ms) return;
+    m_segmentTimeoutMs = ms;
+    emit timeoutsChanged();
+}
+
+// ==========================================================
+// 路点
+// ==========================================================
+
+bool MotionQueue::parseWaypoint(const QVariant &value, Waypoint &out)
+{
+    const QJsonObject obj = QJsonObject::fromVariantMap(value.toMap());
+
+    if (obj.contains("type")) {
+        out.type = obj.value("type").toInt(-1);
+        out.target = obj.value("target").toObject();
+    } else if (obj.contains("jp")) {
+        out.type = JointMove;
+        out.target = QJsonObject{ { "jp", obj.value("jp") } };
+    } else if (obj.contains("cp")) {
+        out.type = LinearMove;
+        out.target = QJsonObject{ { "cp", obj.value("cp") } };
+    } else {
+        return false;
+    }
+
+    if (out.type < 0) return false;
+    // 带目标的路点必须是 6 个数值 (预设点位类型没有目标)
+    if (out.target.contains("jp") && !isPoseArray(out.target.value("jp"))) return false;
+    if (out.target.contains("cp") && !isPoseArray(out.target.value("cp"))) return false;
+    if (out.type == JointMove && !out.target.contains("jp")) return false;
+    if (out.type == LinearMove && !out.target.contains("cp")) return false;
+
+    out.poseKind = Waypoint::NoPose;
+    const char *poseKey = out.type == JointMove ? "jp" : (out.type == LinearMove ? "cp" : nullptr);
+    if (poseKey) {
+        const QJsonArray pose = out.target.value(poseKey).toArray();
+        for (int i = 0; i < 6; ++i) out.pose[i] = pose.at(i).toDouble();
+        out.poseKind = out.type == JointMove ? Waypoint::JointPose : Waypoint::CartesianPose;
+    }
+    return true;
+}
+
+void MotionQueue::setWaypoints(const QVariantList &waypoints)
+{
+    applyWaypoints(waypoints);
+}
+
+bool MotionQueue::applyWaypoints(const QVariantList &waypoints)
+{
+    if (m_running) {
+        emit errorOccurred("队列执行中，不能修改路点");
+        return false;
+    }
+
+    std::vector<Waypoint> parsed;
+    parsed.reserve(waypoints.size());
+    for (int i = 0; i < waypoints.size(); ++i) {
+        Waypoint waypoint;
+        if (!parseWaypoint(waypoints.at(i), waypoint)) {
+            emit errorOccurred(QString("第 %1 个路点格式错误").arg(i + 1));
+            return false;
+        }
+        parsed.push_back(waypoint);
+    }
+
+    m_waypoints = std::move(parsed);
+    m_segments.clear();
+    m_finished = 0;
+    emit waypointsChanged();
+    emit progressChanged();
+    return true;
+}
+
+void MotionQueue::addJointWaypoint(const QVariantList &jp)
+{
+    QVariantList list = waypoints();
+    list.append(QVariantMap{ { "jp", jp } });
+    setWaypoints(list);
+}
+
+void MotionQueue::addLinearWaypoint(const QVariantList &cp)
+{
+    QVariantList list = waypoints();
+    list.append(QVariantMap{ { "cp", cp } });
+    setWaypoints(list);
+}
+
+void MotionQueue::clear()
+{
+    setWaypoints(QVariantList());
+}
+
+QVariantList MotionQueue::waypoints() const
+{
+    QVariantList list;
+    list.reserve(static_cast<qsizetype>(m_waypoints.size()));
+    for (const Waypoint &waypoint : m_waypoints) {
+        list.append(QVariantMap{ { "type", waypoint.type }, { "target", waypoint.target.toVariantMap() } });
+    }
+    return list;
+}
+
+int MotionQueue::loadFile(const QString &path)
+{
+    const QString filePath = path.startsWith("file:") ? QUrl(path).toLocalFile() : path;
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        emit errorOccurred("无法打开路点文件: " + file.errorString());
+        return -1;
+    }
+
+    QVariantList list;
+    if (filePath.endsWith(".json", Qt::CaseInsensitive)) {
+        QJsonParseError error;
+        const QJsonDocument doc = QJsonDocument::fromJson(file.readAll(), &error);
+        if (!doc.isArray()) {
+            emit errorOccurred("路点文件不是 JSON 数组: " + error.errorString());
+            return -1;
+        }
+        list = doc.array().toVariantList();
+    } else {
+        QTextStream in(&file);
+        int lineNo = 0;
+        while (!in.atEnd()) {
+            const QString line = in.readLine().trimmed();
+            ++lineNo;
+            if (line.isEmpty() || line.startsWith('#')) continue;
+
+            const QStringList parts = line.split(',', Qt::SkipEmptyParts);
+            QVariantList pose;
+            bool ok = true;
+            for (int i = 1; ok && i < parts.size(); ++i) {
+                pose.append(parts.at(i).trimmed().toDouble(&ok));
+            }
+            const QString kind = parts.value(0).trimmed().toUpper();
+            if (!ok || pose.size() != 6 || (kind != "J" && kind != "L")) {
+                emit errorOccurred(QString("路点文件第 %1 行格式错误: %2").arg(lineNo).arg(line));
+                return -1;
+            }
+            list.append(QVariantMap{ { kind == "J" ? "jp" : "cp", pose } });
+        }
+    }
+
+    return applyWaypoints(list) ? count() : -1;
+}
+
+// ==========================================================
+// 执行
+// ==========================================================
+
+void MotionQueue::start()
+{
+    if (m_running) return;
+    if (m_waypoints.empty()) {
+        emit errorOccurred("路点队列为空");
+        return;
+    }
+    if (!m_robot->isConnected()) {
+        emit errorOccurred("未连接机器人");
+        return;
+    }
+
+    m_segments.assign(m_waypoints.size(), Segment());
+    m_inFlight.clear();
+    m_nextToSend = 0;
+    m_finished = 0;
+    m_inRunTo = m_robot->robotState() == kStateRunTo;
+    m_clock.start();
+
+    // 整个队列期间保持同一个心跳会话，段间短暂的空闲状态不会触发停心跳
+    m_robot->setHeartbeatHold(true);
+    m_running = true;
+    m_watchdog->start();
+    emit runningChanged();
+
+    sendNext();
+}
+
+void MotionQueue::stop()
+{
+    if (m_running) finish();
+}
+
+void MotionQueue::sendNext()
+{
+    if (m_nextToSend >= count()) return;
+
+    const int index = m_nextToSend++;
+    m_segments[index].sentNs = m_clock.nsecsElapsed();
+    m_inFlight.push_back(index);
+
+    const Waypoint &waypoint = m_waypoints[index];
+    m_robot->sendRunTo(waypoint.type, waypoint.target);
+    emit progressChanged();
+}
+
+void MotionQueue::onRobotStateChanged(int state)
+{
+    if (!m_running) return;
+
+    const bool inRunTo = state == kStateRunTo;
+    if (inRunTo == m_inRunTo) return;
+    m_inRunTo = inRunTo;
+
+    if (inRunTo) {
+        // 进入 RunTo：最早一个尚未开始的段开始运动
+        for (int index : m_inFlight) {
+            if (m_segments[index].startNs < 0) {
+                m_segments[index].startNs = m_clock.nsecsElapsed();
+                break;
+            }
+        }
+        if (m_preSend && m_inFlight.size() < 2) sendNext();
+        return;
+    }
+
+    // 离开 RunTo：当前段结束
+    if (!m_inFlight.empty() && m_segments[m_inFlight.front()].startNs >= 0) {
+        completeHead(false);
+    }
+    if (m_running && m_inFlight.empty()) sendNext();
+}
+
+bool MotionQueue::reachedTarget(const Waypoint &waypoint, const RobotPostureFrame &frame)
+{
+    if (waypoint.poseKind == Waypoint::JointPose) {
+        if (!(frame.present & 1u)) return false;
+        for (int i = 0; i < 6; ++i) {
+            if (std::abs(frame.joint[i] - waypoint.pose[i]) > kJointToleranceDeg) return false;
+        }
+        return true;
+    }
+    if (waypoint.poseKind == Waypoint::CartesianPose) {
+        if ((frame.present & 0x7eu) != 0x7eu) return false;
+        for (int i = 0; i < 3; ++i) {
+            if (std::abs(frame.end[i] - waypoint.pose[i]) > kPositionToleranceMm) return false;
+        }
+        for (int i = 3; i < 6; ++i) {
+            // 姿态角按 360° 回绕比较 (180 与 -180 相同)
+            const double diff = std::fmod(std::abs(frame.end[i] - waypoint.pose[i]), 360.0);
+            if (qMin(diff, 360.0 - diff) > kOrientationToleranceDeg) return false;
+        }
+        return true;
+    }
+    return false;
+}
+
+void MotionQueue::onRobotPosture(const RobotPostureFrame &frame)
+{
+    // 只关心预发送时当前段已开始、下一段已发出的情况
+    if (!m_running || !m_inRunTo || m_inFlight.size() < 2) return;
+
+    const int head = m_inFlight.front();
+    Segment &segment = m_segments[head];
+    if (segment.startNs < 0) return;
+
+    if (reachedTarget(m_waypoints[head], frame)) {
+        segment.reachedNs = m_clock.nsecsElapsed();
+        return;
+    }
+    if (segment.reachedNs < 0) return;
+
+    // 到过目标、仍在 RunTo 又离开了：控制器已直接开始执行下一段
+    const int next = m_inFlight[1];
+    const qint64 boundaryNs = segment.reachedNs;
+    completeHead(false, boundaryNs);
+    if (!m_running) return;
+    m_segments[next].startNs = qMax(boundaryNs, m_segments[next].sentNs);
+    if (m_preSend && m_inFlight.size() < 2) sendNext();
+}
+
+void MotionQueue::onWatchdog()
+{
+    if (!m_running) return;
+    if (!m_robot->isConnected()) {
+        finish("连接断开，运动队列已停止");
+        return;
+    }
+    if (m_inFlight.empty()) return;
+
+    const int index = m_inFlight.front();
+    const Segment &segment = m_segments[index];
+    const qint64 now = m_clock.nsecsElapsed();
+
+    if (segment.startNs < 0) {
+        // 预发送的段从上一段结束开始计时
+        const qint64 waitSince = qMax(segment.sentNs, previousDoneNs(index));
+        if (now - waitSince > qint64(m_startTimeoutMs) * 1000000) {
+            completeHead(true);
+            if (m_running && m_inFlight.empty()) sendNext();
+        }
+    } else if (now - segment.startNs > qint64(m_segmentTimeoutMs) * 1000000) {
+        finish(QString("第 %1 段运动超时 (%2 ms)").arg(index + 1).arg(m_segmentTimeoutMs));
+    }
+}
+
+void MotionQueue::completeHead(bool skipped, qint64 doneNs)
+{
+    const int index = m_inFlight.front();
+    m_inFlight.pop_front();
+
+    Segment &segment = m_segments[index];
+    segment.doneNs = doneNs >= 0 ? doneNs : m_clock.nsecsElapsed();
+    segment.skipped = skipped;
+    ++m_finished;
+
+    if (!skipped) {
+        m_ackHist->observe((segment.startNs - segment.sentNs) / 1000);
+        m_moveHist->observe((segment.doneNs - segment.startNs) / 1000);
+        m_overheadHist->observe(qMax<qint64>(0, segment.startNs - previousDoneNs(index)) / 1000);
+    }
+
+    emit segmentFinished(index, segmentTiming(index));
+    emit progressChanged();
+
+    if (m_finished >= count()) finish();
+}
+
+void MotionQueue::finish(const QString &error)
+{
+    m_running = false;
+    m_watchdog->stop();
+    m_inFlight.clear();
+    m_robot->setHeartbeatHold(false);
+    emit runningChanged();
+    emit progressChanged();
+
+    if (!error.isEmpty()) emit errorOccurred(error);
+    emit finished();
+}
+
+// ==========================================================
+// 计时报告
+// ==========================================================
+
+qint64 MotionQueue::previousDoneNs(int index) const
+{
+    return index == 0 ? 0 : m_segments[index - 1].doneNs;
+}
+
+QVariantMap MotionQueue::segmentTiming(int index) const
+{
+    const Segment &s = m_segments[index];
+    const qint64 prevDone = previousDoneNs(index);
+
+    QVariantMap timing;
+    timing["index"] = index;
+    timing["type"] = m_waypoints[index].type;
+    timing["skipped"] = s.skipped;
+    timing["sendGapMs"] = s.sentNs >= 0 && prevDone >= 0 ? nsToMs(s.sentNs - prevDone) : -1.0;
+    timing["ackMs"] = s.sentNs >= 0 && s.startNs >= 0 ? nsToMs(s.startNs - s.sentNs) : -1.0;
+    timing["moveMs"] = s.startNs >= 0 && s.doneNs >= 0 ? nsToMs(s.doneNs - s.startNs) : -1.0;
+    timing["cycleMs"] = s.doneNs >= 0 && prevDone >= 0 ? nsToMs(s.doneNs - prevDone) : -1.0;
+    return timing;
+}
+
+QVariantList MotionQueue::segmentReport() const
+{
+    QVariantList report;
+    for (int i = 0; i < static_cast<int>(m_segments.size()); ++i) {
+        if (m_segments[i].doneNs >= 0) report.append(segmentTiming(i));
+    }
+    return report;
+}
+
+QVariantMap MotionQueue::summary() const
+{
+    int segments = 0;
+    int skipped = 0;
+    qint64 lastDone = 0;
+    double ackSum = 0, ackMax = 0, moveSum = 0, cycleSum = 0, overheadSum = 0;
+
+    for (int i = 0; i < static_cast<int>(m_segments.size()); ++i) {
+        const Segment &s = m_segments[i];
+        if (s.doneNs < 0) continue;
+        lastDone = qMax(lastDone, s.doneNs);
+        if (s.skipped) {
+            ++skipped;
+            continue;
+        }
+        const double ack = nsToMs(s.startNs - s.sentNs);
+        ++segments;
+        ackSum += ack;
+        ackMax = qMax(ackMax, ack);
+        moveSum += nsToMs(s.doneNs - s.startNs);
+        cycleSum += nsToMs(s.doneNs - previousDoneNs(i));
+        overheadSum += nsToMs(qMax<qint64>(0, s.startNs - previousDoneNs(i)));
+    }
+
+    // 吞吐上限主要看 overhead：段与段之间机器人空闲的时间 (发送 + 控制器响应 + 状态上报)
+    QVariantMap result;
+    result["segments"] = segments;
+    result["skipped"] = skipped;
+    result["totalMs"] = nsToMs(lastDone);
+    result["segmentsPerSec"] = lastDone > 0 ? (segments + skipped) / (lastDone / 1e9) : 0.0;
+    result["avgAckMs"] = segments ? ackSum / segments : 0.0;
+    result["maxAckMs"] = ackMax;
+    result["avgMoveMs"] = segments ? moveSum / segments : 0.0;
+    result["avgCycleMs"] = segments ? cycleSum / segments : 0.0;
+    result["avgOverheadMs"] = segments ? overheadSum / segments : 0.0;
+    return result;
+}
+
+QString MotionQueue::exportReport(const QString &path) const
+{
+    QString filePath = path.startsWith("file:") ? QUrl(path).toLocalFile() : path;
+    if (filePath.isEmpty()) {
+        const QString timeStr = QDateTime::currentDateTime().toString("yyyyMMdd_HHmmss");
+        filePath = QCoreApplication::applicationDirPath() + "/Logs/motion_" + timeStr + ".csv";
+    }
+    QDir().mkpath(QFileInfo(filePath).absolutePath());
+
+    QSaveFile out(filePath);
+    if (!out.open(QIODevice::WriteOnly | QIODevice::Text)) return QString();
+
+    QTextStream stream(&out);
+    stream << "index,type,skipped,send_gap_ms,ack_ms,move_ms,cycle_ms\n";
+    for (const QVariant &row : segmentReport()) {
+        const QVariantMap t = row.toMap();
+        stream << t["index"].toInt() + 1 << ',' << t["type"].toInt() << ',' << (t["skipped"].toBool() ? 1 : 0) << ','
+               << t["sendGapMs"].toDouble() << ',' << t["ackMs"].toDouble() << ',' << t["moveMs"].toDouble() << ','
+               << t["cycleMs"].toDouble() << '\n';
+    }
+    stream.flush();
+    return out.commit() ? filePath : QString();
+}
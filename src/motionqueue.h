@@ -0,0 +1,156 @@
+#ifndef MOTIONQUEUE_H
+#define MOTIONQUEUE_H
+
+#include <QObject>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QJsonObject>
+#include <QVariantList>
+#include <QVariantMap>
+#include <array>
+#include <deque>
+#include <vector>
+#include "framescanner.h"
+
+class RobotClient;
+class MetricHistogram;
+
+// 运动队列：把一组关节 / 笛卡尔路点依次通过 RobotClient::sendRunTo 发给控制器
+// 以机器人状态进入 / 离开 RunTo(4) 判断每段的开始与结束，整个队列只使用一个心跳会话
+// 可选预发送：当前段进入 RunTo 后立即发出下一段，省去段间的往返时间 (是否排队取决于控制器)
+// 控制器不经过空闲直接执行预发送的段时没有状态跳变，此时按位姿判断段边界：
+// 到达当前段目标 (kJointToleranceDeg / kPositionToleranceMm / kOrientationToleranceDeg 内) 后仍在 RunTo 且离开目标，
+// 当前段在最后一次位于目标的时刻结束，下一段同时开始；预设点位 (没有目标位姿) 仍需要段间空闲
+// 只在 GUI 线程使用
+class MotionQueue : public QObject
+{
+    Q_OBJECT
+
+    Q_PROPERTY(int count READ count NOTIFY waypointsChanged)
+    Q_PROPERTY(bool running READ running NOTIFY runningChanged)
+    // 当前正在执行的段序号 (未运行时为 -1)
+    Q_PROPERTY(int currentIndex READ currentIndex NOTIFY progressChanged)
+    Q_PROPERTY(int finishedCount READ finishedCount NOTIFY progressChanged)
+    Q_PROPERTY(bool preSend READ preSend WRITE setPreSend NOTIFY preSendChanged)
+    // 发出后多久仍未进入 RunTo 视为该段无需运动 (目标即当前位置)，直接跳过
+    Q_PROPERTY(int startTimeoutMs READ startTimeoutMs WRITE setStartTimeoutMs NOTIFY timeoutsChanged)
+    // 单段运动超时，超时后停止队列
+    Q_PROPERTY(int segmentTimeoutMs READ segmentTimeoutMs WRITE setSegmentTimeoutMs NOTIFY timeoutsChanged)
+
+public:
+    // 与 PageMove.qml 中的运动类型一致
+    enum MoveType { JointMove = 4, LinearMove = 5 };
+
+    // 判断到达目标的位姿容差
+    static constexpr double kJointToleranceDeg = 0.05;
+    static constexpr double kPositionToleranceMm = 0.5;
+    static constexpr double kOrientationToleranceDeg = 0.1;
+
+    explicit MotionQueue(RobotClient *robot, QObject *parent = nullptr);
+
+    int count() const { return static_cast<int>(m_waypoints.size()); }
+    bool running() const { return m_running; }
+    int currentIndex() const;
+    int finishedCount() const { return m_finished; }
+    bool preSend() const { return m_preSend; }
+    void setPreSend(bool enabled);
+    int startTimeoutMs() const { return m_startTimeoutMs; }
+    void setStartTimeoutMs(int ms);
+    int segmentTimeoutMs() const { return m_segmentTimeoutMs; }
+    void setSegmentTimeoutMs(int ms);
+
+    // 路点格式: { "type": 4, "target": { "jp": [...] } } 或简写 { "jp": [...] } / { "cp": [...] }
+    Q_INVOKABLE void setWaypoints(const QVariantList &waypoints);
+    Q_INVOKABLE void addJointWaypoint(const QVariantList &jp);
+    Q_INVOKABLE void addLinearWaypoint(const QVariantList &cp);
+    Q_INVOKABLE void clear();
+    Q_INVOKABLE QVariantList waypoints() const;
+
+    // 从文件加载 (接受 file:/// URL)，返回路点数；失败返回 -1
+    // *.json: 路点数组；其他: 每行 "J,j1,...,j6" 或 "L,x,y,z,a,b,c"，# 开头为注释
+    Q_INVOKABLE int loadFile(const QString &path);
+
+    Q_INVOKABLE void start();
+    // 停止发送后续路点 (已发出的运动由控制器继续执行)，并释放心跳会话
+    Q_INVOKABLE void stop();
+
+    // 每段计时 (毫秒)：
+    //   sendGap  上一段结束到本段发出
+    //   ack      发出到进入 RunTo (控制器响应 + 状态上报延迟)
+    //   move     RunTo 持续时间
+    //   cycle    上一段结束到本段结束 (第一段从开始执行算起)
+    Q_INVOKABLE QVariantList segmentReport() const;
+    // { segments, skipped, totalMs, segmentsPerSec, avgAckMs, maxAckMs, avgMoveMs, avgCycleMs, avgOverheadMs }
+    Q_INVOKABLE QVariantMap summary() const;
+    // 导出为 CSV，path 为空时写到 Logs/motion_yyyyMMdd_HHmmss.csv，返回实际路径
+    Q_INVOKABLE QString exportReport(const QString &path = QString()) const;
+
+signals:
+    void waypointsChanged();
+    void runningChanged();
+    void progressChanged();
+    void preSendChanged();
+    void timeoutsChanged();
+    void segmentFinished(int index, const QVariantMap &timing);
+    void finished();
+    void errorOccurred(const QString &errorMsg);
+
+private slots:
+    void onRobotStateChanged(int state);
+    void onRobotPosture(const RobotPostureFrame &frame);
+    void onWatchdog();
+
+private:
+    struct Waypoint
+    {
+        int type;
+        QJsonObject target;
+        // 目标位姿 (jp 或 cp)，用于判断到达；预设点位没有
+        enum { NoPose, JointPose, CartesianPose } poseKind = NoPose;
+        std::array<double, 6> pose{};
+    };
+
+    // 时间点均为相对 m_clock 的纳秒，-1 表示未发生
+    struct Segment
+    {
+        qint64 sentNs = -1;
+        qint64 startNs = -1;
+        qint64 doneNs = -1;
+        qint64 reachedNs = -1; // 最近一次位姿位于目标的时刻
+        bool skipped = false;
+    };
+
+    static bool parseWaypoint(const QVariant &value, Waypoint &out);
+    bool applyWaypoints(const QVariantList &waypoints);
+    void sendNext();
+    static bool reachedTarget(const Waypoint &waypoint, const RobotPostureFrame &frame);
+    // doneNs < 0 时取当前时刻
+    void completeHead(bool skipped, qint64 doneNs = -1);
+    void finish(const QString &error = QString());
+    QVariantMap segmentTiming(int index) const;
+    // 上一段结束的时间 (第一段为队列开始，即 0)
+    qint64 previousDoneNs(int index) const;
+
+    RobotClient *m_robot;
+    std::vector<Waypoint> m_waypoints;
+
+    bool m_running = false;
+    bool m_preSend = false;
+    int m_startTimeoutMs = 3000;
+    int m_segmentTimeoutMs = 120000;
+
+    // 执行状态
+    QElapsedTimer m_clock;
+    QTimer *m_watchdog;
+    std::vector<Segment> m_segments; // 与 m_waypoints 一一对应
+    std::deque<int> m_inFlight;      // 已发出未结束的段 (预发送时最多 2 个)
+    int m_nextToSend = 0;
+    int m_finished = 0;
+    bool m_inRunTo = false;
+
+    MetricHistogram *m_ackHist;
+    MetricHistogram *m_moveHist;
+    MetricHistogram *m_overheadHist;
+};
+
+#endif // MOTIONQUEUE_H
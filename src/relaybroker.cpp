@@ -0,0 +1,351 @@
+#include "relaybroker.h"
+#include "Robotclient.h"
+#include "framescanner.h"
+#include "metrics.h"
+#include "tracer.h"
+
+#include <QDateTime>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <algorithm>
+
+namespace {
+
+// 下游请求缓冲上限：超过仍拼不出完整对象说明对端发的不是本协议，断开它
+constexpr qsizetype kMaxRequestBuffer = 1024 * 1024;
+
+bool isTopic(QByteArrayView type)
+{
+    return type.startsWith("publish/");
+}
+
+} // namespace
+
+RelayBroker::RelayBroker(RobotClient *robot, QObject *parent)
+    : QObject(parent)
+    , m_robot(robot)
+    , m_server(new QTcpServer(this))
+    , m_pendingTimer(new QTimer(this))
+{
+    m_clock.start();
+    connect(m_server, &QTcpServer::newConnection, this, &RelayBroker::onNewConnection);
+    connect(robot, &RobotClient::connected, this, &RelayBroker::onUpstreamConnected);
+
+    m_pendingTimer->setInterval(1000);
+    connect(m_pendingTimer, &QTimer::timeout, this, &RelayBroker::onPendingTimeout);
+
+    MetricsRegistry &r = MetricsRegistry::instance();
+    m_clientsGauge = r.gauge("relay_clients", "Downstream clients connected to the local relay");
+    m_requests = r.counter("relay_requests_total", "Downstream requests forwarded upstream by the relay");
+    m_replies = r.counter("relay_replies_total", "Upstream replies routed back to a downstream client");
+    m_pushed = r.counter("relay_push_frames_total", "publish/* frames written to downstream subscribers");
+    m_pushDropped = r.counter("relay_push_dropped_total", "publish/* frames dropped for a backlogged downstream client");
+    m_requestsDropped = r.counter("relay_requests_dropped_total", "Downstream requests dropped (upstream not connected or unparsable)");
+}
+
+RelayBroker::~RelayBroker()
+{
+    stop();
+}
+
+bool RelayBroker::running() const
+{
+    return m_server->isListening();
+}
+
+int RelayBroker::listenPort() const
+{
+    return m_server->isListening() ? m_server->serverPort() : 0;
+}
+
+bool RelayBroker::start(int port)
+{
+    stop();
+    if (!m_server->listen(QHostAddress::LocalHost, quint16(port))) {
+        log(QString("中继监听 127.0.0.1:%1 失败: %2").arg(port).arg(m_server->errorString()));
+        return false;
+    }
+    m_robot->setRelay(this);
+    m_pendingTimer->start();
+    log(QString("中继已启动: 127.0.0.1:%1").arg(listenPort()));
+    emit runningChanged();
+    return true;
+}
+
+void RelayBroker::stop()
+{
+    if (!m_server->isListening() && m_clients.empty()) return;
+
+    if (m_robot) m_robot->setRelay(nullptr);
+    m_server->close();
+    m_pendingTimer->stop();
+
+    while (!m_clients.empty()) removeClient(m_clients.back().get());
+    m_topics.clear();
+    m_pending.clear();
+    m_unidentified.clear();
+
+    log("中继已停止");
+    emit runningChanged();
+}
+
+QVariantList RelayBroker::clients() const
+{
+    QVariantList list;
+    for (const auto &client : m_clients) {
+        QStringList topics;
+        for (const QByteArray &topic : client->topics) topics << QString::fromUtf8(topic);
+        QVariantMap map;
+        map["peer"] = client->peer;
+        map["topics"] = topics;
+        map["requests"] = client->requests;
+        map["replies"] = client->replies;
+        map["pushed"] = client->pushed;
+        map["dropped"] = client->dropped;
+        map["backlogBytes"] = client->socket->bytesToWrite();
+        list.append(map);
+    }
+    return list;
+}
+
+// ==========================================================
+// 下游
+// ==========================================================
+
+void RelayBroker::onNewConnection()
+{
+    while (QTcpSocket *socket = m_server->nextPendingConnection()) {
+        socket->setSocketOption(QAbstractSocket::LowDelayOption, 1);
+
+        auto client = std::make_unique<Client>();
+        client->socket = socket;
+        client->peer = QString("%1:%2").arg(socket->peerAddress().toString()).arg(socket->peerPort());
+        Client *raw = client.get();
+        m_clients.push_back(std::move(client));
+
+        connect(socket, &QTcpSocket::readyRead, this, [this, raw] { onClientReadyRead(raw); });
+        connect(socket, &QTcpSocket::disconnected, this, [this, raw] { removeClient(raw); });
+
+        m_clientsGauge->set(qint64(m_clients.size()));
+        log("下游客户端接入: " + raw->peer);
+        emit clientsChanged();
+    }
+}
+
+void RelayBroker::removeClient(Client *client)
+{
+    const auto it = std::find_if(m_clients.begin(), m_clients.end(),
+                                 [client](const std::unique_ptr<Client> &c) { return c.get() == client; });
+    if (it == m_clients.end()) return;
+
+    for (Topic &topic : m_topics) {
+        auto &subs = topic.subscribers;
+        subs.erase(std::remove(subs.begin(), subs.end(), client), subs.end());
+    }
+
+    // 先从列表摘下再关闭，abort 同步发出的 disconnected 不会重入
+    std::unique_ptr<Client> owned = std::move(*it);
+    m_clients.erase(it);
+    owned->socket->disconnect(this);
+    owned->socket->abort();
+    owned->socket->deleteLater();
+
+    m_clientsGauge->set(qint64(m_clients.size()));
+    log("下游客户端断开: " + owned->peer);
+    emit clientsChanged();
+}
+
+void RelayBroker::onClientReadyRead(Client *client)
+{
+    client->buffer.append(client->socket->readAll());
+
+    for (;;) {
+        // 与 RobotClient 一致：跳过对象之前的换行等杂字节
+        const qsizetype brace = client->buffer.indexOf('{');
+        if (brace < 0) {
+            client->buffer.clear();
+            return;
+        }
+        if (brace > 0) client->buffer.remove(0, brace);
+
+        const qsizetype length = FrameScanner::objectLength(client->buffer);
+        if (length <= 0) break;
+
+        const QByteArray frame = client->buffer.left(length);
+        client->buffer.remove(0, length);
+        handleClientFrame(client, frame);
+    }
+
+    if (client->buffer.size() > kMaxRequestBuffer) {
+        log("下游请求过大或格式错误，断开: " + client->peer);
+        removeClient(client);
+    }
+}
+
+void RelayBroker::handleClientFrame(Client *client, const QByteArray &frame)
+{
+    TRACE_SCOPE("relay.request", "relay");
+
+    QByteArrayView type;
+    if (!FrameScanner::peekType(frame, type)) {
+        m_requestsDropped->add();
+        return;
+    }
+
+    // 订阅请求只在本地登记
+    if (isTopic(type)) {
+        subscribe(client, type, frame);
+        return;
+    }
+
+    if (!m_robot->isConnected()) {
+        m_requestsDropped->add();
+        return;
+    }
+
+    Pending pending{ client->socket, QByteArray(), type.toByteArray(), m_clock.elapsed() };
+    QByteArray upstream;
+    QByteArrayView idValue;
+    if (FrameScanner::findValue(frame, "id", idValue)) {
+        // 换成中继自己的 id ("r" 前缀，不会与 RobotClient 的数字 id 冲突)，其余字节不动
+        const QByteArray relayId = "\"r" + QByteArray::number(++m_nextId) + '"';
+        const qsizetype offset = idValue.data() - frame.constData();
+        pending.originalId = idValue.toByteArray();
+        upstream.reserve(frame.size() - idValue.size() + relayId.size());
+        upstream.append(frame.constData(), offset).append(relayId).append(frame.constData() + offset + idValue.size(),
+                                                                         frame.size() - offset - idValue.size());
+        m_pending.insert(relayId, pending);
+    } else {
+        upstream = frame;
+        m_unidentified.push_back(pending);
+    }
+
+    if (m_robot->writeRelayFrame(QString::fromUtf8(pending.type), upstream) < 0) {
+        m_requestsDropped->add();
+        return;
+    }
+    ++client->requests;
+    m_requests->add();
+}
+
+void RelayBroker::subscribe(Client *client, QByteArrayView name, const QByteArray &frame)
+{
+    auto it = std::find_if(m_topics.begin(), m_topics.end(), [name](const Topic &t) { return QByteArrayView(t.name) == name; });
+    if (it == m_topics.end()) {
+        m_topics.push_back({ name.toByteArray(), {} });
+        it = m_topics.end() - 1;
+    }
+    if (std::find(it->subscribers.begin(), it->subscribers.end(), client) != it->subscribers.end()) return;
+    it->subscribers.push_back(client);
+    client->topics.append(it->name);
+
+    // 默认主题 RobotClient 已经订阅；其他主题由中继向上游订阅一次
+    const QString topic = QString::fromUtf8(it->name);
+    if (!RobotClient::defaultTopics().contains(topic) && !m_upstreamTopics.contains(it->name)) {
+        m_upstreamTopics.append(it->name);
+        if (m_robot->isConnected()) m_robot->writeRelayFrame(topic, frame);
+        log("中继向上游订阅: " + topic);
+    }
+    emit clientsChanged();
+}
+
+// ==========================================================
+// 上游
+// ==========================================================
+
+bool RelayBroker::routeUpstreamFrame(const QByteArray &frame)
+{
+    if (m_clients.empty()) return false;
+
+    QByteArrayView type;
+    if (!FrameScanner::peekType(frame, type)) return false;
+
+    if (isTopic(type)) {
+        fanOut(type, frame);
+        return false;
+    }
+
+    QByteArrayView idValue;
+    if (FrameScanner::findValue(frame, "id", idValue)) {
+        if (!idValue.startsWith("\"r")) return false;
+        const auto it = m_pending.find(idValue.toByteArray());
+        if (it == m_pending.end()) return false;
+        const Pending pending = it.value();
+        m_pending.erase(it);
+
+        // 还原下游的原始 id
+        const qsizetype offset = idValue.data() - frame.constData();
+        QByteArray reply;
+        reply.reserve(frame.size() - idValue.size() + pending.originalId.size());
+        reply.append(frame.constData(), offset).append(pending.originalId).append(frame.constData() + offset + idValue.size(),
+                                                                                  frame.size() - offset - idValue.size());
+        deliverReply(pending, reply);
+        return true;
+    }
+
+    // 回复不带 id：交给同类型最早的未带 id 的下游请求
+    const auto it = std::find_if(m_unidentified.begin(), m_unidentified.end(),
+                                 [type](const Pending &p) { return QByteArrayView(p.type) == type; });
+    if (it == m_unidentified.end()) return false;
+    const Pending pending = *it;
+    m_unidentified.erase(it);
+    deliverReply(pending, frame);
+    return true;
+}
+
+void RelayBroker::fanOut(QByteArrayView name, const QByteArray &frame)
+{
+    const auto it = std::find_if(m_topics.begin(), m_topics.end(), [name](const Topic &t) { return QByteArrayView(t.name) == name; });
+    if (it == m_topics.end()) return;
+
+    TRACE_SCOPE("relay.fanOut", "relay");
+    for (Client *client : it->subscribers) {
+        if (client->socket->bytesToWrite() > kMaxBacklogBytes) {
+            ++client->dropped;
+            m_pushDropped->add();
+            continue;
+        }
+        // frame 隐式共享，写入只是拷进该客户端的发送缓冲
+        client->socket->write(frame);
+        ++client->pushed;
+        m_pushed->add();
+    }
+}
+
+void RelayBroker::deliverReply(const Pending &pending, const QByteArray &frame)
+{
+    if (!pending.socket) return; // 客户端已断开
+    pending.socket->write(frame);
+    m_replies->add();
+
+    const auto it = std::find_if(m_clients.begin(), m_clients.end(),
+                                 [&pending](const std::unique_ptr<Client> &c) { return c->socket == pending.socket; });
+    if (it != m_clients.end()) ++(*it)->replies;
+}
+
+void RelayBroker::onUpstreamConnected()
+{
+    // RobotClient 重连后只会重新订阅默认主题，中继额外订阅的主题在这里补上
+    for (const QByteArray &topic : m_upstreamTopics) {
+        m_robot->writeRelayFrame(QString::fromUtf8(topic), "{\"ty\":\"" + topic + "\",\"tc\":0}");
+    }
+}
+
+void RelayBroker::onPendingTimeout()
+{
+    // 超时或客户端已断开的请求不再等待 (上游断线重连后旧请求不会再有回复)
+    const qint64 now = m_clock.elapsed();
+    for (auto it = m_pending.begin(); it != m_pending.end();) {
+        if (!it->socket || now - it->sentMs > kPendingTimeoutMs) it = m_pending.erase(it);
+        else ++it;
+    }
+    while (!m_unidentified.empty()
+           && (!m_unidentified.front().socket || now - m_unidentified.front().sentMs > kPendingTimeoutMs)) {
+        m_unidentified.pop_front();
+    }
+}
+
+void RelayBroker::log(const QString &msg)
+{
+    emit logGenerated(QString("[%1] %2").arg(QDateTime::currentDateTime().toString("HH:mm:ss.zzz"), msg));
+}
@@ -0,0 +1,126 @@
+#ifndef RELAYBROKER_H
+#define RELAYBROKER_H
+
+#include <QObject>
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QPointer>
+#include <QTimer>
+#include <QVariantList>
+#include <deque>
+#include <memory>
+#include <vector>
+
+class QTcpServer;
+class QTcpSocket;
+class RobotClient;
+class MetricCounter;
+class MetricGauge;
+
+// 本地中继：在 127.0.0.1 上监听，让其他工具 (第二个本程序实例、Python 脚本 ...) 共用 RobotClient 唯一的上游连接
+// - 下游请求改写 id 后原样转发，回复按 id 找回原客户端并还原 id (按字节替换，不重新序列化)
+// - 下游的订阅请求只登记，不重复订阅上游；推送按主题只写给订阅了它的客户端，同一个 QByteArray 写入各自的发送缓冲
+// - 下游发送缓冲积压过多时丢弃推送 (回复不丢)，慢客户端不会拖住 GUI 线程
+class RelayBroker : public QObject
+{
+    Q_OBJECT
+
+    Q_PROPERTY(bool running READ running NOTIFY runningChanged)
+    Q_PROPERTY(int listenPort READ listenPort NOTIFY runningChanged)
+    Q_PROPERTY(int clientCount READ clientCount NOTIFY clientsChanged)
+
+public:
+    // 与控制器默认端口相同，下游工具只需把地址改成 127.0.0.1
+    static constexpr int kDefaultPort = 9001;
+    // 单个下游客户端发送缓冲上限，超过后丢弃推送
+    static constexpr qint64 kMaxBacklogBytes = 4 * 1024 * 1024;
+    // 下游请求等待回复的最长时间
+    static constexpr qint64 kPendingTimeoutMs = 30000;
+
+    explicit RelayBroker(RobotClient *robot, QObject *parent = nullptr);
+    ~RelayBroker();
+
+    bool running() const;
+    int listenPort() const;
+    int clientCount() const { return int(m_clients.size()); }
+
+    // 开始监听，返回是否成功
+    Q_INVOKABLE bool start(int port = kDefaultPort);
+    Q_INVOKABLE void stop();
+    // [{ peer, topics, requests, replies, pushed, dropped, backlogBytes }]
+    Q_INVOKABLE QVariantList clients() const;
+
+    // RobotClient 对每个上游帧调用：推送扇出给订阅者后返回 false (本地照常处理)
+    // 下游请求的回复转回原客户端后返回 true (本地不再分发)
+    bool routeUpstreamFrame(const QByteArray &frame);
+
+signals:
+    void runningChanged();
+    void clientsChanged();
+    void logGenerated(const QString &line);
+
+private slots:
+    void onNewConnection();
+    void onUpstreamConnected();
+    void onPendingTimeout();
+
+private:
+    struct Client
+    {
+        QTcpSocket *socket;
+        QString peer;
+        QByteArray buffer; // 未收全的请求
+        QList<QByteArray> topics;
+        quint64 requests = 0;
+        quint64 replies = 0;
+        quint64 pushed = 0;
+        quint64 dropped = 0;
+    };
+
+    // 一个推送主题及其下游订阅者
+    struct Topic
+    {
+        QByteArray name;
+        std::vector<Client *> subscribers;
+    };
+
+    // 等待回复的下游请求
+    struct Pending
+    {
+        QPointer<QTcpSocket> socket;
+        QByteArray originalId; // 原始 id 字节 (含引号)
+        QByteArray type;
+        qint64 sentMs;
+    };
+
+    void onClientReadyRead(Client *client);
+    void removeClient(Client *client);
+    void handleClientFrame(Client *client, const QByteArray &frame);
+    void subscribe(Client *client, QByteArrayView topic, const QByteArray &frame);
+    void fanOut(QByteArrayView topic, const QByteArray &frame);
+    void deliverReply(const Pending &pending, const QByteArray &frame);
+    void log(const QString &msg);
+
+    QPointer<RobotClient> m_robot; // 退出时 RobotClient 可能先于中继析构
+    QTcpServer *m_server;
+    std::vector<std::unique_ptr<Client>> m_clients;
+    std::vector<Topic> m_topics;       // 主题很少，线性查找比哈希 (需要构造 QByteArray 键) 更快
+    QList<QByteArray> m_upstreamTopics; // 由中继额外向上游订阅的主题 (默认主题由 RobotClient 订阅)
+
+    QHash<QByteArray, Pending> m_pending; // 中继 id (含引号) -> 请求
+    std::deque<Pending> m_unidentified;   // 下游未带 id 的请求，回复同样不带 id 时按类型取最早的
+    quint64 m_nextId = 0;
+    QElapsedTimer m_clock;
+    QTimer *m_pendingTimer;
+
+    MetricGauge *m_clientsGauge;
+    MetricCounter *m_requests;
+    MetricCounter *m_replies;
+    MetricCounter *m_pushed;
+    MetricCounter *m_pushDropped;
+    MetricCounter *m_requestsDropped;
+};
+
+#endif // RELAYBROKER_H
@@ -0,0 +1,182 @@
+#include "requestcache.h"
+
+#include <QJsonDocument>
+
+RequestCache::RequestCache()
+{
+    m_clock.start();
+}
+
+RequestCache::Policy RequestCache::classify(const QString &type)
+{
+    // 读接口 -> 资源；写接口 -> 失效的资源
+    // 正逆解 (Robot/apostocpos 等) 由 KinematicsService 自己缓存，这里不处理
+    struct Rule
+    {
+        const char *type;
+        Kind kind;
+        const char *resource;
+        bool cacheable;
+    };
+    static const Rule rules[] = {
+        { "globalVar/getVars", Read, "globalVar", true },
+        { "globalVar/GetProjectVarUpdate", Read, "projectVar", false },
+        { "IOManager/GetIOValue", Read, "io", true },
+        { "RegisterManager/GetRegisterValue", Read, "register", true },
+        { "globalVar/saveVars", Write, "globalVar", false },
+        { "globalVar/removeVars", Write, "globalVar", false },
+        { "IOManager/SetIOValue", Write, "io", false },
+        { "RegisterManager/SetRegisterValue", Write, "register", false },
+    };
+
+    Policy policy;
+    for (const Rule &rule : rules) {
+        if (type == QLatin1String(rule.type)) {
+            policy.kind = rule.kind;
+            policy.resources << rule.resource;
+            policy.cacheable = rule.cacheable;
+            return policy;
+        }
+    }
+
+    // 工程的运行 / 停止等操作会改变工程变量
+    if (type.startsWith("project/")) {
+        policy.kind = Write;
+        policy.resources << "projectVar";
+    }
+    return policy;
+}
+
+QByteArray RequestCache::makeKey(const QString &type, const QJsonValue &db)
+{
+    // QJsonObject 的键是有序的，紧凑输出即规范形式
+    QJsonObject wrapper;
+    wrapper["db"] = db;
+    return type.toUtf8() + '\n' + QJsonDocument(wrapper).toJson(QJsonDocument::Compact);
+}
+
+bool RequestCache::overlaps(const QStringList &a, const QStringList &b)
+{
+    for (const QString &resource : a) {
+        if (b.contains(resource)) return true;
+    }
+    return false;
+}
+
+bool RequestCache::lookup(const QByteArray &key, QJsonObject &reply)
+{
+    if (m_ttlMs <= 0) return false;
+
+    auto it = m_cache.find(key);
+    if (it == m_cache.end()) return false;
+    if (m_clock.elapsed() - it->storedMs > m_ttlMs) {
+        m_cache.erase(it);
+        return false;
+    }
+
+    reply = it->reply;
+    ++m_hits;
+    return true;
+}
+
+QString RequestCache::inFlightId(const QByteArray &key)
+{
+    auto it = m_inFlightByKey.find(key);
+    if (it == m_inFlightByKey.end()) return QString();
+
+    const QString id = it.value();
+    auto flight = m_inFlight.find(id);
+    if (flight == m_inFlight.end() || m_clock.elapsed() - flight->sentMs > kInFlightTimeoutMs) {
+        // 回复丢失：放弃这次在途请求，让调用方重新发送
+        m_inFlightByKey.erase(it);
+        if (flight != m_inFlight.end()) m_inFlight.erase(flight);
+        return QString();
+    }
+
+    ++m_collapsed;
+    return id;
+}
+
+void RequestCache::beginRead(const QString &id, const QString &type, const QByteArray &key, const Policy &policy)
+{
+    prune();
+
+    InFlight flight;
+    flight.type = type;
+    flight.key = key;
+    flight.resources = policy.resources;
+    flight.cacheable = policy.cacheable;
+    flight.sentMs = m_clock.elapsed();
+    m_inFlight.insert(id, flight);
+    m_inFlightByKey.insert(key, id);
+}
+
+void RequestCache::complete(const QString &id, const QString &type, const QJsonObject &reply)
+{
+    auto it = m_inFlight.end();
+    if (!id.isEmpty()) {
+        // 不认识的 id 是别的请求 (sendProbe 等不经过缓存) 的回复，不能当作在途读请求的结果
+        it = m_inFlight.find(id);
+        if (it == m_inFlight.end()) return;
+    } else {
+        // 控制器没带回 id：同类型最早发出的那个
+        for (auto candidate = m_inFlight.begin(); candidate != m_inFlight.end(); ++candidate) {
+            if (candidate->type != type) continue;
+            if (it == m_inFlight.end() || candidate->sentMs < it->sentMs) it = candidate;
+        }
+        if (it == m_inFlight.end()) return;
+    }
+
+    const InFlight flight = it.value();
+    const QString flightId = it.key();
+    m_inFlight.erase(it);
+    if (m_inFlightByKey.value(flight.key) == flightId) m_inFlightByKey.remove(flight.key);
+
+    if (flight.cacheable && !flight.stale && m_ttlMs > 0) {
+        prune();
+        m_cache.insert(flight.key, { reply, flight.resources, m_clock.elapsed() });
+    }
+}
+
+void RequestCache::prune()
+{
+    // 过期的缓存与丢了回复的在途请求只有相同请求再来时才会清掉，请求参数多变时会一直累积
+    const qint64 now = m_clock.elapsed();
+    if (now - m_lastPruneMs < kPruneIntervalMs) return;
+    m_lastPruneMs = now;
+
+    for (auto it = m_cache.begin(); it != m_cache.end();) {
+        if (now - it->storedMs > m_ttlMs) it = m_cache.erase(it);
+        else ++it;
+    }
+    for (auto it = m_inFlight.begin(); it != m_inFlight.end();) {
+        if (now - it->sentMs <= kInFlightTimeoutMs) {
+            ++it;
+            continue;
+        }
+        if (m_inFlightByKey.value(it->key) == it.key()) m_inFlightByKey.remove(it->key);
+        it = m_inFlight.erase(it);
+    }
+}
+
+void RequestCache::invalidate(const QStringList &resources)
+{
+    for (auto it = m_cache.begin(); it != m_cache.end();) {
+        if (overlaps(it->resources, resources)) it = m_cache.erase(it);
+        else ++it;
+    }
+
+    // 写之前发出的读请求：回复仍按 id 送达，但不能入缓存，之后的读也不能合并到它上面
+    for (auto it = m_inFlight.begin(); it != m_inFlight.end(); ++it) {
+        if (!overlaps(it->resources, resources)) continue;
+        it->stale = true;
+        if (m_inFlightByKey.value(it->key) == it.key()) m_inFlightByKey.remove(it->key);
+    }
+}
+
+void RequestCache::clear()
+{
+    m_inFlight.clear();
+    m_inFlightByKey.clear();
+    m_cache.clear();
+}
@@ -0,0 +1,88 @@
+#ifndef REQUESTCACHE_H
+#define REQUESTCACHE_H
+
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QJsonObject>
+#include <QString>
+#include <QStringList>
+
+// 幂等读请求的合并与缓存 (RobotClient 内部使用，只在 GUI 线程访问)
+// - 读接口: 相同 (类型 + db) 的请求在途时不再重复发送，沿用在途请求的 id，回复经 recvNormalMessage 广播给所有页面
+// - 可缓存的读接口: 回复在 TTL 内再次请求时直接返回缓存
+// - 写接口: 发送时使涉及资源的缓存失效，在途的旧读请求回复后也不再入缓存
+class RequestCache
+{
+public:
+    enum Kind { Passthrough, Read, Write };
+
+    struct Policy
+    {
+        Kind kind = Passthrough;
+        QStringList resources; // 读写涉及的资源，用于失效
+        bool cacheable = false; // 读接口回复能否在 TTL 内复用 (增量接口只合并不缓存)
+    };
+
+    // 在途请求超过该时间仍未回复时不再合并 (控制器丢了回复)
+    static constexpr qint64 kInFlightTimeoutMs = 3000;
+    // 插入时清理过期缓存与超时在途请求的最小间隔
+    static constexpr qint64 kPruneIntervalMs = 1000;
+
+    RequestCache();
+
+    static Policy classify(const QString &type);
+    static QByteArray makeKey(const QString &type, const QJsonValue &db);
+
+    void setTtlMs(int ms) { m_ttlMs = ms; }
+    int ttlMs() const { return m_ttlMs; }
+
+    // TTL 内的缓存回复
+    bool lookup(const QByteArray &key, QJsonObject &reply);
+    // 相同请求在途时返回它的 id，否则返回空串
+    QString inFlightId(const QByteArray &key);
+
+    void beginRead(const QString &id, const QString &type, const QByteArray &key, const Policy &policy);
+    // 收到回复；只有 id 为空时才按同类型最早的在途请求匹配，不认识的 id 忽略
+    void complete(const QString &id, const QString &type, const QJsonObject &reply);
+    void invalidate(const QStringList &resources);
+    void clear();
+
+    quint64 hits() const { return m_hits; }
+    quint64 collapsed() const { return m_collapsed; }
+    int size() const { return m_cache.size(); }
+    int inFlightCount() const { return m_inFlight.size(); }
+
+private:
+    struct InFlight
+    {
+        QString type;
+        QByteArray key;
+        QStringList resources;
+        bool cacheable = false;
+        bool stale = false; // 发出后资源被写过
+        qint64 sentMs = 0;
+    };
+
+    struct Cached
+    {
+        QJsonObject reply;
+        QStringList resources;
+        qint64 storedMs = 0;
+    };
+
+    static bool overlaps(const QStringList &a, const QStringList &b);
+    // 清掉过期缓存与超时在途请求 (beginRead / 入缓存时调用，间隔 kPruneIntervalMs)
+    void prune();
+
+    QElapsedTimer m_clock;
+    int m_ttlMs = 250;
+    qint64 m_lastPruneMs = 0;
+    QHash<QString, InFlight> m_inFlight;      // id -> 在途请求
+    QHash<QByteArray, QString> m_inFlightByKey; // 请求键 -> id (只含可合并的)
+    QHash<QByteArray, Cached> m_cache;
+    quint64 m_hits = 0;
+    quint64 m_collapsed = 0;
+};
+
+#endif // REQUESTCACHE_H
@@ -0,0 +1,205 @@
+#include "robotprotocol.h"
+
+#include <QSet>
+
+namespace RobotProtocol {
+
+QJsonArray toJsonArray(const Pose6 &pose)
+{
+    QJsonArray array;
+    for (double v : pose) array.append(v);
+    return array;
+}
+
+QJsonArray toJsonArray(const std::vector<double> &values)
+{
+    QJsonArray array;
+    for (double v : values) array.append(v);
+    return array;
+}
+
+bool parsePose(const QJsonValue &value, Pose6 &pose)
+{
+    const QJsonArray array = value.toArray();
+    if (array.size() != 6) return false;
+    for (int i = 0; i < 6; ++i) {
+        if (!array.at(i).isDouble()) return false;
+        pose[i] = array.at(i).toDouble();
+    }
+    return true;
+}
+
+bool parseNoReply(const QJsonValue &, NoReply &)
+{
+    // 命令类接口的回复只表示已受理，内容不做约束
+    return true;
+}
+
+bool parseIOType(const QString &name, IOType &type)
+{
+    static const IOType all[] = { IOType::DI, IOType::DO, IOType::AI, IOType::AO };
+    for (IOType candidate : all) {
+        if (name == QLatin1String(ioTypeName(candidate))) {
+            type = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+// ---------------- IOManager ----------------
+
+QJsonValue IOManager::GetIOValue::toDb() const
+{
+    QJsonArray array;
+    for (const IOPort &p : ports) {
+        array.append(QJsonObject{ { "type", QLatin1String(ioTypeName(p.type)) }, { "port", p.port } });
+    }
+    return array;
+}
+
+bool IOManager::GetIOValue::parseReply(const QJsonValue &db, Reply &reply)
+{
+    if (!db.isArray()) return false;
+    const QJsonArray array = db.toArray();
+    reply.clear();
+    reply.reserve(array.size());
+    for (const QJsonValue &item : array) {
+        const QJsonObject obj = item.toObject();
+        IOValue value;
+        if (!parseIOType(obj.value("type").toString(), value.type)) return false;
+        value.port = obj.value("port").toInt();
+        value.value = obj.value("value").toDouble();
+        reply.push_back(value);
+    }
+    return true;
+}
+
+QJsonValue IOManager::SetIOValue::toDb() const
+{
+    return QJsonObject{ { "type", QLatin1String(ioTypeName(type)) }, { "port", port }, { "value", value } };
+}
+
+// ---------------- RegisterManager ----------------
+
+QJsonValue RegisterManager::GetRegisterValue::toDb() const
+{
+    QJsonArray array;
+    for (int address : addresses) array.append(address);
+    return array;
+}
+
+bool RegisterManager::GetRegisterValue::parseReply(const QJsonValue &db, Reply &reply)
+{
+    if (!db.isArray()) return false;
+    const QJsonArray array = db.toArray();
+    reply.clear();
+    reply.reserve(array.size());
+    for (const QJsonValue &item : array) {
+        const QJsonObject obj = item.toObject();
+        if (!obj.contains("address")) return false;
+        reply.push_back({ obj.value("address").toInt(), obj.value("value").toDouble() });
+    }
+    return true;
+}
+
+QJsonValue RegisterManager::SetRegisterValue::toDb() const
+{
+    return QJsonObject{ { "address", address }, { "value", value } };
+}
+
+// ---------------- globalVar ----------------
+
+bool GlobalVarApi::GetVars::parseReply(const QJsonValue &db, Reply &reply)
+{
+    if (!db.isObject()) return false;
+    const QJsonObject obj = db.toObject();
+    reply.clear();
+    for (auto it = obj.begin(); it != obj.end(); ++it) {
+        const QJsonObject var = it.value().toObject();
+        reply[it.key()] = GlobalVar{ var.value("val"), var.value("nm").toString() };
+    }
+    return true;
+}
+
+bool GlobalVarApi::GetProjectVarUpdate::parseReply(const QJsonValue &db, Reply &reply)
+{
+    if (!db.isObject()) return false;
+    reply = db.toObject();
+    return true;
+}
+
+QJsonValue GlobalVarApi::SaveVars::toDb() const
+{
+    return QJsonObject{ { name, QJsonObject{ { "val", val }, { "nm", nm } } } };
+}
+
+// ---------------- Robot ----------------
+
+QJsonValue Robot::MoveTo::toDb() const
+{
+    QJsonObject db;
+    db["type"] = type;
+
+    QJsonObject targetObj = extraTarget;
+    if (targetKind == Joint) targetObj["jp"] = toJsonArray(target);
+    else if (targetKind == Cartesian) targetObj["cp"] = toJsonArray(target);
+    if (!targetObj.isEmpty()) db["target"] = targetObj;
+    return db;
+}
+
+QJsonValue Robot::ForwardKinematics::toDb() const
+{
+    return QJsonObject{ { "jp", toJsonArray(jp) },
+                        { "coor", toJsonArray(coor) },
+                        { "tool", toJsonArray(tool) },
+                        { "ep", toJsonArray(ep) } };
+}
+
+QJsonValue Robot::InverseKinematics::toDb() const
+{
+    return QJsonObject{ { "cp", toJsonArray(cp) }, { "rj", toJsonArray(rj) }, { "ep", toJsonArray(ep) } };
+}
+
+const QStringList &topics()
+{
+    static const QStringList topics = {
+        "publish/ProjectState",
+        "publish/VarUpdate",
+        "publish/RobotStatus",
+        "publish/RobotPosture",
+        "publish/RobotCoordinate",
+        "publish/Log",
+        "publish/Error"
+    };
+    return topics;
+}
+
+bool isKnownType(QStringView type)
+{
+    static const QSet<QString> known = [] {
+        QSet<QString> types(topics().begin(), topics().end());
+        const char *const requests[] = {
+            IOManager::GetIOValue::kType, IOManager::SetIOValue::kType,
+            RegisterManager::GetRegisterValue::kType, RegisterManager::SetRegisterValue::kType,
+            GlobalVarApi::GetVars::kType, GlobalVarApi::GetProjectVarUpdate::kType,
+            GlobalVarApi::SaveVars::kType, GlobalVarApi::RemoveVars::kType,
+            Robot::SwitchOn::kType, Robot::SwitchOff::kType, Robot::ToManual::kType,
+            Robot::ToAuto::kType, Robot::ToRemote::kType, Robot::MoveTo::kType,
+            Robot::MoveToHeartbeat::kType, Robot::ForwardKinematics::kType, Robot::InverseKinematics::kType,
+            Project::Run::kType, Project::RunStep::kType, Project::RunByIndex::kType,
+            Project::SetStartLine::kType, Project::Pause::kType, Project::Resume::kType,
+            Project::Stop::kType, Project::ClearStartLine::kType, Project::EnterRemoteScriptMode::kType,
+        };
+        for (const char *type : requests) types.insert(QString::fromLatin1(type));
+        return types;
+    }();
+    return known.contains(type.toString());
+}
+
+QString metricType(QStringView type)
+{
+    return isKnownType(type) ? type.toString() : QStringLiteral("other");
+}
+
+} // namespace RobotProtocol
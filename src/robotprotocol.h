@@ -0,0 +1,364 @@
+#ifndef ROBOTPROTOCOL_H
+#define ROBOTPROTOCOL_H
+
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QJsonValue>
+#include <QString>
+#include <QStringList>
+#include <array>
+#include <map>
+#include <vector>
+
+// 控制器 JSON 协议的强类型定义 (报文外层 {"id","ty","db"} 由 RobotClient 负责)
+//
+// 每个请求结构体提供:
+//   static constexpr char kType[]                 报文类型 "ty"，编译期常量
+//   QJsonValue toDb() const                       直接构造 db，不经过 QVariant 类型判断
+//   using Reply = ...;                            回复 db 解析后的类型 (无内容的回复为 NoReply)
+//   static bool parseReply(const QJsonValue &, Reply &)
+//
+// 通过 RobotClient::send<Request>() / RobotClient::call<Request>() 发送，类型不匹配在编译期报错
+// 自由格式的测试页面仍使用 sendJsonRequest(type, QVariant)
+namespace RobotProtocol {
+
+using Pose6 = std::array<double, 6>;
+
+// 回复没有需要解析的内容
+struct NoReply
+{
+};
+
+QJsonArray toJsonArray(const Pose6 &pose);
+QJsonArray toJsonArray(const std::vector<double> &values);
+bool parsePose(const QJsonValue &value, Pose6 &pose);
+bool parseNoReply(const QJsonValue &db, NoReply &reply);
+
+// ==========================================================
+// IOManager
+// ==========================================================
+
+enum class IOType { DI, DO, AI, AO };
+
+constexpr const char *ioTypeName(IOType type)
+{
+    switch (type) {
+    case IOType::DI: return "DI";
+    case IOType::DO: return "DO";
+    case IOType::AI: return "AI";
+    case IOType::AO: return "AO";
+    }
+    return "DI";
+}
+
+bool parseIOType(const QString &name, IOType &type);
+
+struct IOPort
+{
+    IOType type;
+    int port;
+};
+
+struct IOValue
+{
+    IOType type;
+    int port;
+    double value;
+};
+
+namespace IOManager {
+
+// db: [{"type":"DI","port":0}, ...]  回复: [{"type","port","value"}, ...]
+struct GetIOValue
+{
+    static constexpr char kType[] = "IOManager/GetIOValue";
+    std::vector<IOPort> ports;
+
+    QJsonValue toDb() const;
+    using Reply = std::vector<IOValue>;
+    static bool parseReply(const QJsonValue &db, Reply &reply);
+};
+
+// db: {"type":"DO","port":0,"value":1}
+struct SetIOValue
+{
+    static constexpr char kType[] = "IOManager/SetIOValue";
+    IOType type;
+    int port;
+    double value;
+
+    QJsonValue toDb() const;
+    using Reply = NoReply;
+    static bool parseReply(const QJsonValue &db, Reply &reply) { return parseNoReply(db, reply); }
+};
+
+} // namespace IOManager
+
+// ==========================================================
+// RegisterManager
+// ==========================================================
+
+struct RegisterValue
+{
+    int address;
+    double value;
+};
+
+namespace RegisterManager {
+
+// db: [10000, 20000]  回复: [{"address","value"}, ...]
+struct GetRegisterValue
+{
+    static constexpr char kType[] = "RegisterManager/GetRegisterValue";
+    std::vector<int> addresses;
+
+    QJsonValue toDb() const;
+    using Reply = std::vector<RegisterValue>;
+    static bool parseReply(const QJsonValue &db, Reply &reply);
+};
+
+// db: {"address":10000,"value":1.5}
+struct SetRegisterValue
+{
+    static constexpr char kType[] = "RegisterManager/SetRegisterValue";
+    int address;
+    double value;
+
+    QJsonValue toDb() const;
+    using Reply = NoReply;
+    static bool parseReply(const QJsonValue &db, Reply &reply) { return parseNoReply(db, reply); }
+};
+
+} // namespace RegisterManager
+
+// ==========================================================
+// globalVar
+// ==========================================================
+
+struct GlobalVar
+{
+    QJsonValue val;
+    QString nm; // 备注
+};
+
+namespace GlobalVarApi {
+
+// db: null  回复: {"name": {"val":..., "nm":"..."}, ...}
+struct GetVars
+{
+    static constexpr char kType[] = "globalVar/getVars";
+
+    QJsonValue toDb() const { return QJsonValue(); }
+    using Reply = std::map<QString, GlobalVar>;
+    static bool parseReply(const QJsonValue &db, Reply &reply);
+};
+
+// db: null  回复: {"name": 任意值 (点位等复杂对象原样保留), ...}
+struct GetProjectVarUpdate
+{
+    static constexpr char kType[] = "globalVar/GetProjectVarUpdate";
+
+    QJsonValue toDb() const { return QJsonValue(); }
+    using Reply = QJsonObject;
+    static bool parseReply(const QJsonValue &db, Reply &reply);
+};
+
+// db: {"name": {"val":..., "nm":"..."}}
+struct SaveVars
+{
+    static constexpr char kType[] = "globalVar/saveVars";
+    QString name;
+    QJsonValue val;
+    QString nm;
+
+    QJsonValue toDb() const;
+    using Reply = NoReply;
+    static bool parseReply(const QJsonValue &db, Reply &reply) { return parseNoReply(db, reply); }
+};
+
+// db: ["name", ...]
+struct RemoveVars
+{
+    static constexpr char kType[] = "globalVar/removeVars";
+    QStringList names;
+
+    QJsonValue toDb() const { return QJsonArray::fromStringList(names); }
+    using Reply = NoReply;
+    static bool parseReply(const QJsonValue &db, Reply &reply) { return parseNoReply(db, reply); }
+};
+
+} // namespace GlobalVarApi
+
+// ==========================================================
+// Robot
+// ==========================================================
+
+namespace Robot {
+
+// 无参数的状态切换命令，db 为空串 (与界面按钮发送的报文一致)
+template <const char *Type>
+struct Command
+{
+    static constexpr const char *kType = Type;
+
+    QJsonValue toDb() const { return QJsonValue(QString()); }
+    using Reply = NoReply;
+    static bool parseReply(const QJsonValue &db, Reply &reply) { return parseNoReply(db, reply); }
+};
+
+inline constexpr char kSwitchOn[] = "Robot/switchOn";
+inline constexpr char kSwitchOff[] = "Robot/switchOff";
+inline constexpr char kToManual[] = "Robot/toManual";
+inline constexpr char kToAuto[] = "Robot/toAuto";
+inline constexpr char kToRemote[] = "Robot/toRemote";
+
+using SwitchOn = Command<kSwitchOn>;
+using SwitchOff = Command<kSwitchOff>;
+using ToManual = Command<kToManual>;
+using ToAuto = Command<kToAuto>;
+using ToRemote = Command<kToRemote>;
+
+// db: {"type":4, "target":{"jp":[...]}} / {"type":5, "target":{"cp":[...]}} / 预设点位只有 type
+struct MoveTo
+{
+    static constexpr char kType[] = "Robot/moveTo";
+    enum TargetKind { NoTarget, Joint, Cartesian };
+
+    int type = 0;
+    TargetKind targetKind = NoTarget;
+    Pose6 target{};
+    QJsonObject extraTarget; // 其他目标字段原样合并 (兼容 sendRunTo 的自由格式)
+
+    QJsonValue toDb() const;
+    using Reply = NoReply;
+    static bool parseReply(const QJsonValue &db, Reply &reply) { return parseNoReply(db, reply); }
+};
+
+// db: null
+struct MoveToHeartbeat
+{
+    static constexpr char kType[] = "Robot/moveToHeartbeat";
+
+    QJsonValue toDb() const { return QJsonValue(); }
+    using Reply = NoReply;
+    static bool parseReply(const QJsonValue &db, Reply &reply) { return parseNoReply(db, reply); }
+};
+
+// 正解 db: {"jp","coor","tool","ep"}  回复: [x,y,z,a,b,c]
+struct ForwardKinematics
+{
+    static constexpr char kType[] = "Robot/apostocpos";
+    Pose6 jp{};
+    Pose6 coor{};
+    Pose6 tool{};
+    std::vector<double> ep;
+
+    QJsonValue toDb() const;
+    using Reply = Pose6;
+    static bool parseReply(const QJsonValue &db, Reply &reply) { return parsePose(db, reply); }
+};
+
+// 逆解 db: {"cp","rj","ep"}  回复: [j1..j6]
+struct InverseKinematics
+{
+    static constexpr char kType[] = "Robot/cpostoapos";
+    Pose6 cp{};
+    Pose6 rj{};
+    std::vector<double> ep;
+
+    QJsonValue toDb() const;
+    using Reply = Pose6;
+    static bool parseReply(const QJsonValue &db, Reply &reply) { return parsePose(db, reply); }
+};
+
+} // namespace Robot
+
+// ==========================================================
+// project
+// ==========================================================
+
+namespace Project {
+
+// db: {"id":"..."}
+struct Run
+{
+    static constexpr char kType[] = "project/run";
+    QString id;
+
+    QJsonValue toDb() const { return QJsonObject{ { "id", id } }; }
+    using Reply = NoReply;
+    static bool parseReply(const QJsonValue &db, Reply &reply) { return parseNoReply(db, reply); }
+};
+
+// db: {"id":"..."} 或 {} (继续单步)
+struct RunStep
+{
+    static constexpr char kType[] = "project/runStep";
+    QString id;
+
+    QJsonValue toDb() const { return id.isEmpty() ? QJsonObject() : QJsonObject{ { "id", id } }; }
+    using Reply = NoReply;
+    static bool parseReply(const QJsonValue &db, Reply &reply) { return parseNoReply(db, reply); }
+};
+
+// db: 索引 (0-127)
+struct RunByIndex
+{
+    static constexpr char kType[] = "project/runByIndex";
+    int index = 0;
+
+    QJsonValue toDb() const { return index; }
+    using Reply = NoReply;
+    static bool parseReply(const QJsonValue &db, Reply &reply) { return parseNoReply(db, reply); }
+};
+
+// db: 行号
+struct SetStartLine
+{
+    static constexpr char kType[] = "project/setStartLine";
+    int line = 1;
+
+    QJsonValue toDb() const { return line; }
+    using Reply = NoReply;
+    static bool parseReply(const QJsonValue &db, Reply &reply) { return parseNoReply(db, reply); }
+};
+
+// 无参数命令，db 为 null
+template <const char *Type>
+struct Command
+{
+    static constexpr const char *kType = Type;
+
+    QJsonValue toDb() const { return QJsonValue(); }
+    using Reply = NoReply;
+    static bool parseReply(const QJsonValue &db, Reply &reply) { return parseNoReply(db, reply); }
+};
+
+inline constexpr char kPause[] = "project/pause";
+inline constexpr char kResume[] = "project/resume";
+inline constexpr char kStop[] = "project/stop";
+inline constexpr char kClearStartLine[] = "project/clearStartLine";
+inline constexpr char kEnterRemoteScriptMode[] = "project/enterRemoteScriptMode";
+
+using Pause = Command<kPause>;
+using Resume = Command<kResume>;
+using Stop = Command<kStop>;
+using ClearStartLine = Command<kClearStartLine>;
+using EnterRemoteScriptMode = Command<kEnterRemoteScriptMode>;
+
+} // namespace Project
+
+// ==========================================================
+// 报文类型
+// ==========================================================
+
+// 控制器推送的主题 (RobotClient 连接后全部订阅)
+const QStringList &topics();
+// 推送主题与本文件定义的请求类型
+bool isKnownType(QStringView type);
+// 指标标签用的类型：已知类型原样返回，其余 (测试页面自由输入的类型) 归为 "other"，避免标签序列无限增长
+QString metricType(QStringView type);
+
+} // namespace RobotProtocol
+
+#endif // ROBOTPROTOCOL_H
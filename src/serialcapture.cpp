@@ -0,0 +1,326 @@
+#include "serialcapture.h"
+
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QtEndian>
+#include <cstring>
+#include <limits>
+
+// ==========================================================
+// SerialCaptureWriter
+// ==========================================================
+
+SerialCaptureWriter::SerialCaptureWriter(qsizetype blockSize)
+    : m_blockSize(blockSize)
+{
+}
+
+SerialCaptureWriter::~SerialCaptureWriter()
+{
+    close();
+}
+
+bool SerialCaptureWriter::open(const QString &path, qint64 epochMs)
+{
+    close();
+
+    m_file.setFileName(path);
+    if (!m_file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        return false;
+    }
+
+    m_block.clear();
+    m_block.reserve(m_blockSize + 64 * 1024);
+    m_baseUs = -1;
+    m_bytesWritten = 0;
+
+    char header[SerialCaptureFormat::kFileHeaderSize];
+    std::memcpy(header, SerialCaptureFormat::kMagic, 4);
+    qToLittleEndian<quint32>(SerialCaptureFormat::kVersion, header + 4);
+    qToLittleEndian<qint64>(epochMs, header + 8);
+    m_block.append(header, sizeof(header));
+    return true;
+}
+
+void SerialCaptureWriter::close()
+{
+    if (!m_file.isOpen()) return;
+    flush();
+    m_file.close();
+}
+
+void SerialCaptureWriter::append(qint64 timestampUs, quint8 direction, const QByteArray &data)
+{
+    if (!m_file.isOpen() || data.isEmpty()) return;
+
+    if (m_baseUs < 0) m_baseUs = timestampUs;
+
+    char header[SerialCaptureFormat::kRecordHeaderSize] = {};
+    qToLittleEndian<quint64>(static_cast<quint64>(timestampUs - m_baseUs), header);
+    qToLittleEndian<quint32>(static_cast<quint32>(data.size()), header + 8);
+    header[12] = static_cast<char>(direction);
+
+    m_block.append(header, sizeof(header));
+    m_block.append(data);
+
+    if (m_block.size() >= m_blockSize) flush();
+}
+
+void SerialCaptureWriter::flush()
+{
+    if (!m_file.isOpen() || m_block.isEmpty()) return;
+
+    const qint64 written = m_file.write(m_block);
+    if (written > 0) m_bytesWritten += written;
+    m_block.resize(0); // 保留容量，下一块不再重新分配
+}
+
+// ==========================================================
+// SerialCaptureModel
+// ==========================================================
+
+namespace {
+// 索引线程每隔这么久把新建的检查点交给 GUI 线程，列表随之增长
+constexpr qint64 kIndexBatchMs = 100;
+}
+
+struct SerialCaptureModel::IndexBatch
+{
+    quint64 generation = 0;
+    std::vector<qint64> checkpoints; // 接在已有检查点之后
+    qint64 recordCount = 0;          // 截至本批的记录总数
+    double progress = 0;
+    bool done = false;
+};
+
+SerialCaptureModel::SerialCaptureModel(QObject *parent)
+    : QAbstractListModel(parent)
+{
+    m_indexer.setMaxThreadCount(1);
+}
+
+SerialCaptureModel::~SerialCaptureModel()
+{
+    release();
+}
+
+int SerialCaptureModel::rowCount(const QModelIndex &parent) const
+{
+    if (parent.isValid()) return 0;
+    return static_cast<int>(qMin<qint64>(m_recordCount, std::numeric_limits<int>::max()));
+}
+
+QHash<int, QByteArray> SerialCaptureModel::roleNames() const
+{
+    return {
+        { TimeRole, "time" },
+        { OffsetUsRole, "offsetUs" },
+        { DirectionRole, "direction" },
+        { HexRole, "hex" },
+        { TextRole, "text" },
+        { LengthRole, "length" }
+    };
+}
+
+QVariant SerialCaptureModel::data(const QModelIndex &index, int role) const
+{
+    if (!m_map || !index.isValid() || index.row() >= rowCount()) return QVariant();
+
+    const uchar *p = m_map + recordOffset(index.row());
+    const quint64 offsetUs = qFromLittleEndian<quint64>(p);
+    const quint32 length = qFromLittleEndian<quint32>(p + 8);
+    const quint8 direction = p[12];
+    // 只包装映射内存，不拷贝
+    const QByteArray payload = QByteArray::fromRawData(
+        reinterpret_cast<const char *>(p + SerialCaptureFormat::kRecordHeaderSize), length);
+
+    switch (role) {
+    case TimeRole:
+        return QDateTime::fromMSecsSinceEpoch(m_epochMs + static_cast<qint64>(offsetUs / 1000))
+            .toString("HH:mm:ss.zzz");
+    case OffsetUsRole:
+        return static_cast<qint64>(offsetUs);
+    case DirectionRole:
+        return direction == 1 ? QStringLiteral("TX") : QStringLiteral("RX");
+    case HexRole:
+        return QString(payload.toHex(' ').toUpper());
+    case TextRole:
+        return QString::fromUtf8(payload);
+    case LengthRole:
+        return static_cast<int>(length);
+    default:
+        return QVariant();
+    }
+}
+
+qint64 SerialCaptureModel::recordOffset(qint64 row) const
+{
+    const qint64 checkpoint = row / kCheckpointEvery;
+    qint64 current = checkpoint * kCheckpointEvery;
+    qint64 pos = m_checkpoints[static_cast<size_t>(checkpoint)];
+    if (m_cursorRow >= current && m_cursorRow <= row) {
+        current = m_cursorRow;
+        pos = m_cursorOffset;
+    }
+    // 最多跳 kCheckpointEvery - 1 个记录头
+    for (; current < row; ++current) {
+        pos += SerialCaptureFormat::kRecordHeaderSize + qFromLittleEndian<quint32>(m_map + pos + 8);
+    }
+    m_cursorRow = row;
+    m_cursorOffset = pos;
+    return pos;
+}
+
+bool SerialCaptureModel::open(const QString &path)
+{
+    beginResetModel();
+    release();
+
+    m_file.setFileName(path);
+    bool ok = m_file.open(QIODevice::ReadOnly);
+    if (ok) {
+        m_mapSize = m_file.size();
+        m_map = m_mapSize >= SerialCaptureFormat::kFileHeaderSize ? m_file.map(0, m_mapSize) : nullptr;
+        ok = m_map && std::memcmp(m_map, SerialCaptureFormat::kMagic, 4) == 0;
+    }
+
+    if (ok) {
+        m_epochMs = qFromLittleEndian<qint64>(m_map + 8);
+        m_indexProgress = 0;
+        m_indexing = true;
+
+        const quint64 generation = ++m_generation;
+        const uchar *map = m_map;
+        const qint64 size = m_mapSize;
+        m_indexer.start([this, generation, map, size] { buildIndex(generation, map, size); });
+    } else {
+        const QString err = QString("无法打开录制文件: %1").arg(path);
+        if (m_map) m_file.unmap(const_cast<uchar *>(m_map));
+        m_map = nullptr;
+        m_mapSize = 0;
+        m_file.close();
+        emit errorOccurred(err);
+    }
+
+    endResetModel();
+    emit countChanged();
+    emit indexProgressChanged();
+    return ok;
+}
+
+void SerialCaptureModel::buildIndex(quint64 generation, const uchar *map, qint64 size)
+{
+    const qint64 dataSize = qMax<qint64>(1, size - SerialCaptureFormat::kFileHeaderSize);
+    auto batch = std::make_shared<IndexBatch>();
+    batch->generation = generation;
+
+    auto post = [this, &batch, generation, dataSize](qint64 count, qint64 pos, bool done) {
+        batch->recordCount = count;
+        batch->progress = double(pos - SerialCaptureFormat::kFileHeaderSize) / dataSize;
+        batch->done = done;
+        QMetaObject::invokeMethod(this, [this, batch] { applyBatch(batch); }, Qt::QueuedConnection);
+        batch = std::make_shared<IndexBatch>();
+        batch->generation = generation;
+    };
+
+    QElapsedTimer timer;
+    timer.start();
+
+    // 只沿记录头跳跃，不解码数据
+    qint64 pos = SerialCaptureFormat::kFileHeaderSize;
+    qint64 count = 0;
+    while (pos + SerialCaptureFormat::kRecordHeaderSize <= size) {
+        const quint32 length = qFromLittleEndian<quint32>(map + pos + 8);
+        const qint64 next = pos + SerialCaptureFormat::kRecordHeaderSize + length;
+        if (next > size) break; // 录制中断导致的半条记录
+
+        if (count % kCheckpointEvery == 0) batch->checkpoints.push_back(pos);
+        ++count;
+        pos = next;
+
+        if ((count & 0xFFFF) == 0) {
+            if (m_generation.load() != generation) return;
+            if (timer.elapsed() >= kIndexBatchMs) {
+                post(count, pos, false);
+                timer.restart();
+            }
+        }
+    }
+    post(count, size, true);
+}
+
+void SerialCaptureModel::applyBatch(const std::shared_ptr<IndexBatch> &batch)
+{
+    if (batch->generation != m_generation.load()) return; // 已关闭或打开了别的文件
+
+    m_checkpoints.insert(m_checkpoints.end(), batch->checkpoints.begin(), batch->checkpoints.end());
+
+    const int oldRows = rowCount();
+    const int newRows = static_cast<int>(qMin<qint64>(batch->recordCount, std::numeric_limits<int>::max()));
+    if (newRows > oldRows) {
+        beginInsertRows(QModelIndex(), oldRows, newRows - 1);
+        m_recordCount = batch->recordCount;
+        endInsertRows();
+    } else {
+        m_recordCount = batch->recordCount;
+    }
+
+    m_indexProgress = batch->progress;
+    m_indexing = !batch->done;
+    emit countChanged();
+    emit indexProgressChanged();
+}
+
+void SerialCaptureModel::release()
+{
+    ++m_generation;
+    m_indexer.waitForDone(); // 索引线程还在读映射内存
+
+    if (m_map) m_file.unmap(const_cast<uchar *>(m_map));
+    m_map = nullptr;
+    m_mapSize = 0;
+    m_file.close();
+
+    m_checkpoints.clear();
+    m_recordCount = 0;
+    m_indexProgress = 1.0;
+    m_indexing = false;
+    m_cursorRow = -1;
+}
+
+void SerialCaptureModel::close()
+{
+    if (!m_file.isOpen()) return;
+
+    beginResetModel();
+    release();
+    endResetModel();
+    emit countChanged();
+    emit indexProgressChanged();
+}
+
+int SerialCaptureModel::indexAtTime(qint64 offsetUs) const
+{
+    if (!m_map || m_recordCount == 0) return -1;
+
+    auto timeAt = [this](qint64 pos) { return static_cast<qint64>(qFromLittleEndian<quint64>(m_map + pos)); };
+
+    // 先在检查点中二分，找到第一个时间戳 >= offsetUs 的检查点，目标在它前一个检查点之后的这一段里
+    size_t low = 0;
+    size_t high = m_checkpoints.size();
+    while (low < high) {
+        const size_t mid = (low + high) / 2;
+        if (timeAt(m_checkpoints[mid]) < offsetUs) low = mid + 1;
+        else high = mid;
+    }
+    if (low == 0) return 0;
+
+    qint64 row = static_cast<qint64>(low - 1) * kCheckpointEvery;
+    qint64 pos = m_checkpoints[low - 1];
+    const qint64 end = qMin(m_recordCount, row + kCheckpointEvery);
+    while (row < end && timeAt(pos) < offsetUs) {
+        pos += SerialCaptureFormat::kRecordHeaderSize + qFromLittleEndian<quint32>(m_map + pos + 8);
+        ++row;
+    }
+    return static_cast<int>(qMin<qint64>(row, rowCount() - 1));
+}
@@ -0,0 +1,132 @@
+#ifndef SERIALCAPTURE_H
+#define SERIALCAPTURE_H
+
+#include <QAbstractListModel>
+#include <QByteArray>
+#include <QFile>
+#include <QString>
+#include <QThreadPool>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+// 串口录制文件格式 (小端)
+// 文件头: "SCAP" + u32 版本 + i64 录制开始墙钟时间(ms)
+// 记录:   u64 时间戳(us, 相对录制开始) + u32 长度 + u8 方向(0=RX, 1=TX) + 3 字节保留 + 数据
+namespace SerialCaptureFormat {
+constexpr char kMagic[4] = {'S', 'C', 'A', 'P'};
+constexpr quint32 kVersion = 1;
+constexpr int kFileHeaderSize = 16;
+constexpr int kRecordHeaderSize = 16;
+}
+
+// 流式录制：数据先写入大块内存缓冲，满了再顺序写盘，避免每包一次系统调用
+// 只在串口工作线程中使用
+class SerialCaptureWriter
+{
+public:
+    explicit SerialCaptureWriter(qsizetype blockSize = 4 * 1024 * 1024);
+    ~SerialCaptureWriter();
+
+    bool open(const QString &path, qint64 epochMs);
+    void close();
+    bool isOpen() const { return m_file.isOpen(); }
+
+    // 追加一条记录 (timestampUs 为单调时钟, 内部换算为相对录制开始)
+    void append(qint64 timestampUs, quint8 direction, const QByteArray &data);
+
+    // 把缓冲写入磁盘
+    void flush();
+
+    qint64 bytesWritten() const { return m_bytesWritten; }
+    QString errorString() const { return m_file.errorString(); }
+
+private:
+    QFile m_file;
+    QByteArray m_block;
+    qsizetype m_blockSize;
+    qint64 m_baseUs = -1;
+    qint64 m_bytesWritten = 0;
+};
+
+// 录制文件查看模型：内存映射整个文件，后台线程沿记录头跳跃建立稀疏索引 (每 kCheckpointEvery 条记一个偏移)
+// 索引边建边分批加入模型，打开即可滚动；行内容在 data() 中从最近的检查点顺序跳到目标记录后按需解码
+// 记录数按 qint64 统计，超过 INT_MAX 的部分列表视图无法显示 (count 封顶，recordCount 为真实条数)
+class SerialCaptureModel : public QAbstractListModel
+{
+    Q_OBJECT
+    Q_PROPERTY(int count READ rowCount NOTIFY countChanged)
+    Q_PROPERTY(qint64 recordCount READ recordCount NOTIFY countChanged)
+    Q_PROPERTY(QString filePath READ filePath NOTIFY countChanged)
+    // 索引进度 0..1 (按已扫描字节数)，indexing 为 false 时索引已完成
+    Q_PROPERTY(double indexProgress READ indexProgress NOTIFY indexProgressChanged)
+    Q_PROPERTY(bool indexing READ indexing NOTIFY indexProgressChanged)
+
+public:
+    static constexpr int kCheckpointEvery = 256;
+
+    enum Roles {
+        TimeRole = Qt::UserRole + 1, // 墙钟时间字符串
+        OffsetUsRole,                // 相对录制开始的微秒数
+        DirectionRole,               // "RX" / "TX"
+        HexRole,
+        TextRole,
+        LengthRole
+    };
+
+    explicit SerialCaptureModel(QObject *parent = nullptr);
+    ~SerialCaptureModel();
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role) const override;
+    QHash<int, QByteArray> roleNames() const override;
+
+    QString filePath() const { return m_file.fileName(); }
+    qint64 recordCount() const { return m_recordCount; }
+    double indexProgress() const { return m_indexProgress; }
+    bool indexing() const { return m_indexing; }
+
+    // 打开录制文件 (只校验文件头，索引在后台建立)，成功返回 true
+    Q_INVOKABLE bool open(const QString &path);
+    Q_INVOKABLE void close();
+
+    // 二分查找第一条时间戳 >= offsetUs 的记录，用于按时间跳转 (只在已索引的部分中查找)
+    Q_INVOKABLE int indexAtTime(qint64 offsetUs) const;
+
+signals:
+    void countChanged();
+    void indexProgressChanged();
+    void errorOccurred(const QString &errorMsg);
+
+private:
+    struct IndexBatch;
+
+    // 在索引线程执行
+    void buildIndex(quint64 generation, const uchar *map, qint64 size);
+    void applyBatch(const std::shared_ptr<IndexBatch> &batch);
+    // 停止后台索引并解除映射
+    void release();
+    // 第 row 条记录在文件中的偏移
+    qint64 recordOffset(qint64 row) const;
+
+    QFile m_file;
+    const uchar *m_map = nullptr;
+    qint64 m_mapSize = 0;
+    qint64 m_epochMs = 0;
+
+    // 索引线程 (单线程)，open / close 增加 generation 使其退出，解除映射前等待其结束
+    QThreadPool m_indexer;
+    std::atomic<quint64> m_generation{0};
+
+    // 以下只在 GUI 线程访问
+    std::vector<qint64> m_checkpoints; // 第 i * kCheckpointEvery 条记录的偏移
+    qint64 m_recordCount = 0;
+    double m_indexProgress = 1.0;
+    bool m_indexing = false;
+
+    // 上次解码位置，顺序滚动时从这里继续而不必回到检查点
+    mutable qint64 m_cursorRow = -1;
+    mutable qint64 m_cursorOffset = 0;
+};
+
+#endif // SERIALCAPTURE_H
@@ -1,22 +1,98 @@
 #include "SerialClient.h"
+#include "metrics.h"
+#include "tracer.h"
+#include "guiwatchdog.h"
 #include <QDebug>
+#include <QDateTime>
+#include <QDir>
+#include <QCoreApplication>
 
-SerialClient::SerialClient(QObject *parent) : QObject(parent)
+namespace {
+
+int hexNibble(ushort c)
 {
-    m_serial = new QSerialPort(this);
-    connect(m_serial, &QSerialPort::readyRead, this, &SerialClient::onReadyRead);
-    connect(m_serial, &QSerialPort::errorOccurred, this, &SerialClient::onError);
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+// 解析 HEX 字符串，忽略空格、换行等非 HEX 字符 (不构造正则，单次遍历)
+// 奇数个 HEX 字符时与 QByteArray::fromHex 一致：第一个字符单独成为一个字节
+QByteArray parseHex(const QString &text)
+{
+    int digits = 0;
+    for (const QChar ch : text) {
+        if (hexNibble(ch.unicode()) >= 0) ++digits;
+    }
+
+    QByteArray result;
+    result.reserve((digits + 1) / 2);
+
+    int high = (digits % 2) ? 0 : -1;
+    for (const QChar ch : text) {
+        const int nibble = hexNibble(ch.unicode());
+        if (nibble < 0) continue;
+
+        if (high < 0) {
+            high = nibble;
+        } else {
+            result.append(static_cast<char>((high << 4) | nibble));
+            high = -1;
+        }
+    }
+    return result;
+}
+
+} // namespace
+
+SerialClient::SerialClient(QObject *parent)
+    : QObject(parent)
+    , m_thread(new QThread(this))
+    , m_worker(new SerialWorker) // 不能有父对象，否则无法移动到工作线程
+{
+    m_thread->setObjectName("SerialWorker"); // 追踪/调试器中显示的线程名
+    m_worker->moveToThread(m_thread);
+
+    // 工作线程启动后在线程内创建 QSerialPort；线程结束时销毁 worker
+    connect(m_thread, &QThread::started, m_worker, &SerialWorker::initialize);
+    connect(m_thread, &QThread::finished, m_worker, &QObject::deleteLater);
+
+    // 跨线程信号自动使用排队连接
+    connect(m_worker, &SerialWorker::rxReady, this, &SerialClient::onRxReady);
+    connect(m_worker, &SerialWorker::connectionStatusChanged, this, &SerialClient::onWorkerConnectionChanged);
+    connect(m_worker, &SerialWorker::errorOccurred, this, &SerialClient::errorOccurred);
+    connect(m_worker, &SerialWorker::captureStatusChanged, this, &SerialClient::onCaptureStatusChanged);
+    connect(m_worker, &SerialWorker::frameStatsUpdated, this, [this](const QVariantMap &stats) {
+        m_frameStats = stats;
+    });
+    connect(m_worker, &SerialWorker::scheduleStatsUpdated, this, [this](const QVariantMap &stats) {
+        m_scheduleStats = stats;
+    });
+    connect(m_worker, &SerialWorker::scheduleStatusChanged, this, [this](bool running) {
+        m_scheduling = running;
+        emit scheduleStatusChanged();
+    });
+
+    // 串口读取优先级高于 GUI，避免高波特率下驱动缓冲溢出 (HighPriority 足以跟上 921600 波特率)
+    // 不用 TimeCriticalPriority：同一线程还做录制写盘、统计定时器和发送调度，不能让它饿死 GUI 与其他线程
+    m_thread->start(QThread::HighPriority);
+
     refreshPorts();
 }
 
 SerialClient::~SerialClient()
 {
-    close();
+    // 在工作线程内关闭串口、落盘录制数据，然后退出线程
+    SerialWorker *worker = m_worker;
+    QMetaObject::invokeMethod(m_worker, [worker]() { worker->shutdown(); }, Qt::BlockingQueuedConnection);
+    m_thread->quit();
+    m_thread->wait();
 }
 
 bool SerialClient::isConnected() const
 {
-    return m_serial->isOpen();
+    return m_connected;
 }
 
 QStringList SerialClient::portList() const
@@ -45,85 +121,207 @@ void SerialClient::refreshPorts()
 void SerialClient::open(const QString &portName, const QString &baudRate,
                         const QString &dataBits, const QString &parity, const QString &stopBits)
 {
-    if (m_serial->isOpen()) m_serial->close();
-
-    m_serial->setPortName(portName);
-    m_serial->setBaudRate(baudRate.toInt());
+    SerialPortSettings settings;
+    settings.portName = portName;
+    settings.baudRate = baudRate.toInt();
 
     // Data Bits
-    if (dataBits == "5") m_serial->setDataBits(QSerialPort::Data5);
-    else if (dataBits == "6") m_serial->setDataBits(QSerialPort::Data6);
-    else if (dataBits == "7") m_serial->setDataBits(QSerialPort::Data7);
-    else m_serial->setDataBits(QSerialPort::Data8);
+    if (dataBits == "5") settings.dataBits = QSerialPort::Data5;
+    else if (dataBits == "6") settings.dataBits = QSerialPort::Data6;
+    else if (dataBits == "7") settings.dataBits = QSerialPort::Data7;
+    else settings.dataBits = QSerialPort::Data8;
 
     // Parity
-    if (parity == "Even") m_serial->setParity(QSerialPort::EvenParity);
-    else if (parity == "Odd") m_serial->setParity(QSerialPort::OddParity);
-    else if (parity == "Space") m_serial->setParity(QSerialPort::SpaceParity);
-    else if (parity == "Mark") m_serial->setParity(QSerialPort::MarkParity);
-    else m_serial->setParity(QSerialPort::NoParity);
+    if (parity == "Even") settings.parity = QSerialPort::EvenParity;
+    else if (parity == "Odd") settings.parity = QSerialPort::OddParity;
+    else if (parity == "Space") settings.parity = QSerialPort::SpaceParity;
+    else if (parity == "Mark") settings.parity = QSerialPort::MarkParity;
+    else settings.parity = QSerialPort::NoParity;
 
     // Stop Bits
-    if (stopBits == "1.5") m_serial->setStopBits(QSerialPort::OneAndHalfStop);
-    else if (stopBits == "2") m_serial->setStopBits(QSerialPort::TwoStop);
-    else m_serial->setStopBits(QSerialPort::OneStop);
+    if (stopBits == "1.5") settings.stopBits = QSerialPort::OneAndHalfStop;
+    else if (stopBits == "2") settings.stopBits = QSerialPort::TwoStop;
+    else settings.stopBits = QSerialPort::OneStop;
 
-    if (m_serial->open(QIODevice::ReadWrite)) {
-        emit connectionStatusChanged(true);
-    } else {
-        emit errorOccurred("无法打开串口: " + m_serial->errorString());
-    }
+    SerialWorker *worker = m_worker;
+    QMetaObject::invokeMethod(m_worker, [worker, settings]() { worker->openPort(settings); }, Qt::QueuedConnection);
 }
 
 void SerialClient::close()
 {
-    if (m_serial->isOpen()) {
-        m_serial->close();
-        emit connectionStatusChanged(false);
-    }
+    SerialWorker *worker = m_worker;
+    QMetaObject::invokeMethod(m_worker, [worker]() { worker->closePort(); }, Qt::QueuedConnection);
 }
 
 void SerialClient::send(const QString &content, bool isHex)
 {
-    if (!m_serial->isOpen()) {
+    if (!m_connected) {
         emit errorOccurred("未连接串口");
         return;
     }
 
     QByteArray dataToSend;
     if (isHex) {
-        // 优化：自动清理非HEX字符（如空格、换行），容错处理
-        QString cleanHex = content;
-        cleanHex.remove(QRegularExpression("[^0-9A-Fa-f]"));
-        dataToSend = QByteArray::fromHex(cleanHex.toUtf8());
+        // 优化：自动跳过非HEX字符（如空格、换行），容错处理
+        dataToSend = parseHex(content);
     } else {
         dataToSend = content.toUtf8();
     }
 
-    m_serial->write(dataToSend);
+    SerialWorker *worker = m_worker;
+    QMetaObject::invokeMethod(m_worker, [worker, dataToSend]() { worker->write(dataToSend); }, Qt::QueuedConnection);
 }
 
-void SerialClient::onReadyRead()
+void SerialClient::onRxReady()
 {
-    QByteArray data = m_serial->readAll();
-    if (data.isEmpty()) return;
+    TRACE_SCOPE("serial.dispatch", "serial");
+
+    // 先清标记再取数据：取数据期间新入队的内容会触发下一次通知，不会遗漏
+    m_worker->clearNotifyFlag();
+
+    QByteArray rawData;
+    QVariantList frames;
+    const qint64 epochMs = m_worker->clockEpochMs();
+
+    SerialRxItem item;
+    qint64 drained = 0;
+    while (m_worker->rxQueue().pop(item)) {
+        ++drained;
+        if (!item.isFrame) {
+            // 原始模式：把积压的数据块合并成一次 UI 更新
+            rawData.append(item.data);
+            continue;
+        }
+
+        QVariantMap frame;
+        frame["text"] = QString::fromUtf8(item.data);
+        frame["hex"] = QString(item.data.toHex(' ').toUpper());
+        frame["time"] = QDateTime::fromMSecsSinceEpoch(epochMs + item.timestampUs / 1000).toString("HH:mm:ss.zzz");
+        frame["timestampUs"] = item.timestampUs;
+        frame["crc"] = item.crcStatus;
+        frame["length"] = item.data.size();
+        frames.append(frame);
+    }
+
+    if (!m_rxQueueGauge) {
+        m_rxQueueGauge = MetricsRegistry::instance().gauge("serial_rx_drain_batch", "Items drained from the RX hand-off queue in the last batch");
+    }
+    m_rxQueueGauge->set(drained);
+
+    if (!rawData.isEmpty()) {
+        // 优化：C++ 处理好两种格式，QML 直接选用，性能最高
+        // 1. 文本模式：转 UTF8
+        QString textMsg = QString::fromUtf8(rawData);
 
-    // 优化：C++ 处理好两种格式，QML 直接选用，性能最高
-    // 1. 文本模式：转 UTF8
-    QString textMsg = QString::fromUtf8(data);
+        // 2. HEX 模式：转大写，并用空格分隔 (例如: "AA BB CC")
+        QString hexMsg = rawData.toHex(' ').toUpper();
 
-    // 2. HEX 模式：转大写，并用空格分隔 (例如: "AA BB CC")
-    // .toHex(' ') 是 Qt 5.14+ 引入的便捷方法，如果你的 Qt 版本低，去掉 ' '
-    QString hexMsg = data.toHex(' ').toUpper();
+        TRACE_SCOPE("serial.qmlHandler", "qml");
+        GUI_DELIVERY_SCOPE("serial", QStringLiteral("messageReceived"));
+        emit messageReceived(textMsg, hexMsg);
+    }
 
-    emit messageReceived(textMsg, hexMsg);
+    if (!frames.isEmpty()) {
+        TRACE_SCOPE("serial.qmlHandler", "qml");
+        GUI_DELIVERY_SCOPE("serial", QStringLiteral("framesReceived"));
+        emit framesReceived(frames);
+    }
 }
 
-void SerialClient::onError(QSerialPort::SerialPortError error)
+void SerialClient::onWorkerConnectionChanged(bool isConnected)
 {
-    if (error == QSerialPort::NoError) return;
-    // 资源错误通常意味着设备被拔出
-    if (error == QSerialPort::ResourceError || error == QSerialPort::PermissionError) {
-        if(m_serial->isOpen()) close();
+    m_connected = isConnected;
+    emit connectionStatusChanged(isConnected);
+}
+
+void SerialClient::setFrameMode(const QString &mode, const QVariantMap &options)
+{
+    SerialFramer::Mode newMode = SerialFramer::Raw;
+    if (mode == "Delimiter") newMode = SerialFramer::Delimiter;
+    else if (mode == "LengthPrefix") newMode = SerialFramer::LengthPrefix;
+    else if (mode == "ModbusRTU") newMode = SerialFramer::ModbusRtu;
+
+    // HEX 参数在 GUI 线程解析成字节，工作线程只接收已解码的配置
+    QVariantMap workerOptions = options;
+    if (options.contains("delimiterHex")) {
+        workerOptions["delimiter"] = parseHex(options.value("delimiterHex").toString());
+    }
+    if (options.contains("headerHex")) {
+        workerOptions["header"] = parseHex(options.value("headerHex").toString());
+    }
+
+    SerialWorker *worker = m_worker;
+    QMetaObject::invokeMethod(m_worker, [worker, newMode, workerOptions]() {
+        worker->setFrameMode(newMode, workerOptions);
+    }, Qt::QueuedConnection);
+}
+
+QVariantMap SerialClient::frameStats() const
+{
+    QVariantMap stats = m_frameStats;
+    stats["rxQueueDepth"] = static_cast<int>(m_worker->rxQueue().size());
+    return stats;
+}
+
+void SerialClient::resetFrameStats()
+{
+    SerialWorker *worker = m_worker;
+    QMetaObject::invokeMethod(m_worker, [worker]() { worker->resetFrameStats(); }, Qt::QueuedConnection);
+}
+
+void SerialClient::startCapture(const QString &path)
+{
+    QString filePath = path;
+    if (filePath.isEmpty()) {
+        const QString dirPath = QCoreApplication::applicationDirPath() + "/Captures";
+        QDir().mkpath(dirPath);
+        filePath = dirPath + "/serial_" + QDateTime::currentDateTime().toString("yyyyMMdd_HHmmss") + ".scap";
+    }
+
+    SerialWorker *worker = m_worker;
+    QMetaObject::invokeMethod(m_worker, [worker, filePath]() { worker->startCapture(filePath); }, Qt::QueuedConnection);
+}
+
+void SerialClient::stopCapture()
+{
+    SerialWorker *worker = m_worker;
+    QMetaObject::invokeMethod(m_worker, [worker]() { worker->stopCapture(); }, Qt::QueuedConnection);
+}
+
+void SerialClient::onCaptureStatusChanged(bool capturing, const QString &path)
+{
+    m_capturing = capturing;
+    if (capturing) m_capturePath = path;
+    emit captureStatusChanged();
+}
+
+void SerialClient::startSchedule(const QVariantList &steps, int cycles, bool burst)
+{
+    QList<SerialTxStep> encoded;
+    encoded.reserve(steps.size());
+    for (const QVariant &value : steps) {
+        const QVariantMap map = value.toMap();
+        SerialTxStep step;
+        const QString content = map.value("data").toString();
+        step.payload = map.value("hex", false).toBool() ? parseHex(content) : content.toUtf8();
+        step.delayUs = static_cast<qint64>(map.value("delayMs", 0).toDouble() * 1000.0);
+        step.repeat = qMax(1, map.value("repeat", 1).toInt());
+        if (!step.payload.isEmpty()) encoded.append(step);
+    }
+
+    if (encoded.isEmpty()) {
+        emit errorOccurred("发送序列为空");
+        return;
     }
+
+    SerialWorker *worker = m_worker;
+    QMetaObject::invokeMethod(m_worker, [worker, encoded, cycles, burst]() {
+        worker->startSchedule(encoded, cycles, burst);
+    }, Qt::QueuedConnection);
+}
+
+void SerialClient::stopSchedule()
+{
+    SerialWorker *worker = m_worker;
+    QMetaObject::invokeMethod(m_worker, [worker]() { worker->stopSchedule(); }, Qt::QueuedConnection);
 }
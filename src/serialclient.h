@@ -5,7 +5,13 @@
 #include <QSerialPort>
 #include <QSerialPortInfo>
 #include <QStringList>
-#include <QRegularExpression>
+#include <QThread>
+#include <QVariantList>
+#include <QVariantMap>
+
+#include "serialworker.h"
+
+class MetricGauge;
 
 class SerialClient : public QObject
 {
@@ -20,11 +26,21 @@ class SerialClient : public QObject
     Q_PROPERTY(QStringList parityList READ parityList CONSTANT)
     Q_PROPERTY(QStringList stopBitsList READ stopBitsList CONSTANT)
 
+    // 录制状态
+    Q_PROPERTY(bool isCapturing READ isCapturing NOTIFY captureStatusChanged)
+    Q_PROPERTY(QString capturePath READ capturePath NOTIFY captureStatusChanged)
+
+    // 发送调度状态
+    Q_PROPERTY(bool isScheduling READ isScheduling NOTIFY scheduleStatusChanged)
+
 public:
     explicit SerialClient(QObject *parent = nullptr);
     ~SerialClient();
 
     bool isConnected() const;
+    bool isCapturing() const { return m_capturing; }
+    QString capturePath() const { return m_capturePath; }
+    bool isScheduling() const { return m_scheduling; }
 
     // 获取列表数据的 Getter
     QStringList portList() const;
@@ -48,6 +64,27 @@ public:
     // 发送数据 (content: 内容, isHex: 是否为16进制模式)
     Q_INVOKABLE void send(const QString &content, bool isHex);
 
+    // 设置分帧模式 mode: "Raw" / "Delimiter" / "LengthPrefix" / "ModbusRTU"
+    // options 可选键: delimiterHex, lengthOffset, lengthSize, bigEndian, lengthAdjust, headerHex, crc, maxFrameSize
+    Q_INVOKABLE void setFrameMode(const QString &mode, const QVariantMap &options = QVariantMap());
+
+    // 分帧统计 (帧数、CRC 结果、丢弃字节、帧长与帧间隔)，由工作线程定期刷新
+    Q_INVOKABLE QVariantMap frameStats() const;
+    Q_INVOKABLE void resetFrameStats();
+
+    // 开始录制到文件 (path 为空时自动生成 <appdir>/Captures/serial_yyyyMMdd_HHmmss.scap)
+    Q_INVOKABLE void startCapture(const QString &path = QString());
+    Q_INVOKABLE void stopCapture();
+
+    // 启动精确发送序列，载荷在此处一次性编码
+    // steps 每个元素: { data: 内容, hex: 是否 HEX, delayMs: 发送后间隔(可为小数), repeat: 重复次数 }
+    // cycles: 整个序列循环次数 (0 = 无限), burst: 忽略间隔，按串口吞吐连续发送
+    Q_INVOKABLE void startSchedule(const QVariantList &steps, int cycles = 0, bool burst = false);
+    Q_INVOKABLE void stopSchedule();
+
+    // 发送统计 (吞吐、帧间隔最小/最大/均值/抖动、迟发次数)
+    Q_INVOKABLE QVariantMap scheduleStats() const { return m_scheduleStats; }
+
 signals:
     void connectionStatusChanged(bool isConnected);
     void portsChanged();
@@ -55,15 +92,34 @@ signals:
     // 关键优化：同时发送文本和Hex字符串，UI根据复选框决定显示哪个
     void messageReceived(const QString &textMsg, const QString &hexMsg);
 
+    // 分帧模式下输出完整帧 (一批帧合并为一个信号，减少 QML 调用次数)
+    // 每个元素: { text, hex, time, timestampUs, crc, length }
+    void framesReceived(const QVariantList &frames);
+
     void errorOccurred(const QString &errorMsg);
 
+    void captureStatusChanged();
+    void scheduleStatusChanged();
+
 private slots:
-    void onReadyRead();
-    void onError(QSerialPort::SerialPortError error);
+    // 工作线程通知有新数据
+    void onRxReady();
+    void onWorkerConnectionChanged(bool isConnected);
+    void onCaptureStatusChanged(bool capturing, const QString &path);
 
 private:
-    QSerialPort *m_serial;
+    // 串口在工作线程中运行，GUI 线程只负责取数据和转发给 QML
+    QThread *m_thread;
+    SerialWorker *m_worker;
+
     QStringList m_availablePorts;
+    bool m_connected = false;
+    bool m_capturing = false;
+    QString m_capturePath;
+    QVariantMap m_frameStats;
+    bool m_scheduling = false;
+    QVariantMap m_scheduleStats;
+    MetricGauge *m_rxQueueGauge = nullptr;
 };
 
 #endif // SERIALCLIENT_H
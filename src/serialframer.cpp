@@ -0,0 +1,381 @@
+#include "serialframer.h"
+
+namespace {
+
+// CRC16 查找表在编译期生成，运行时每字节只需一次查表 + 移位
+struct Crc16Table
+{
+    quint16 value[256];
+};
+
+constexpr Crc16Table makeCrc16Table()
+{
+    Crc16Table table{};
+    for (int i = 0; i < 256; ++i) {
+        quint16 crc = static_cast<quint16>(i);
+        for (int bit = 0; bit < 8; ++bit) {
+            crc = (crc & 0x0001) ? static_cast<quint16>((crc >> 1) ^ 0xA001) : static_cast<quint16>(crc >> 1);
+        }
+        table.value[i] = crc;
+    }
+    return table;
+}
+
+constexpr Crc16Table kCrc16Table = makeCrc16Table();
+
+// Modbus RTU 单帧最大长度 (ADU)
+constexpr int kModbusMaxFrame = 256;
+
+// 读指针超过该值后整理缓冲区
+constexpr qsizetype kCompactThreshold = 64 * 1024;
+
+} // namespace
+
+SerialFramer::SerialFramer()
+{
+    m_buffer.reserve(8192);
+}
+
+void SerialFramer::setMode(Mode mode)
+{
+    if (m_mode == mode) return;
+    m_mode = mode;
+    reset();
+}
+
+void SerialFramer::setDelimiter(const QByteArray &delimiter)
+{
+    m_delimiter = delimiter;
+    m_scanPos = m_readPos;
+}
+
+void SerialFramer::setLengthPrefix(int lengthOffset, int lengthSize, bool bigEndian, int lengthAdjust,
+                                   const QByteArray &header)
+{
+    m_lengthOffset = qMax(0, lengthOffset);
+    // 长度字段只支持 1/2/4 字节
+    m_lengthSize = (lengthSize == 2 || lengthSize == 4) ? lengthSize : 1;
+    m_bigEndian = bigEndian;
+    m_lengthAdjust = lengthAdjust;
+    m_header = header;
+}
+
+void SerialFramer::setBaudRate(int baudRate, int bitsPerChar)
+{
+    if (baudRate <= 0) return;
+
+    // Modbus 规范：波特率大于 19200 时 t3.5 固定为 1750us
+    if (baudRate > 19200) {
+        m_gapUs = 1750;
+    } else {
+        m_gapUs = static_cast<qint64>(3.5 * bitsPerChar * 1000000.0 / baudRate);
+    }
+}
+
+void SerialFramer::reset()
+{
+    m_buffer.resize(0);
+    m_readPos = 0;
+    m_scanPos = 0;
+    m_lastByteUs = -1;
+}
+
+quint16 SerialFramer::crc16Modbus(const char *data, qsizetype length)
+{
+    quint16 crc = 0xFFFF;
+    const uchar *p = reinterpret_cast<const uchar *>(data);
+    for (qsizetype i = 0; i < length; ++i) {
+        crc = static_cast<quint16>((crc >> 8) ^ kCrc16Table.value[(crc ^ p[i]) & 0xFF]);
+    }
+    return crc;
+}
+
+void SerialFramer::feed(const QByteArray &chunk, qint64 nowUs, QList<SerialFrame> &out)
+{
+    if (chunk.isEmpty()) return;
+
+    // Modbus RTU：距离上次收到数据已超过 t3.5，说明上一帧已结束
+    if (m_mode == ModbusRtu && hasPending() && m_lastByteUs >= 0 && nowUs - m_lastByteUs >= m_gapUs) {
+        flushOnGap(m_lastByteUs, out);
+    }
+
+    m_buffer.append(chunk);
+    m_lastByteUs = nowUs;
+
+    switch (m_mode) {
+    case Raw:
+        emitFrame(m_buffer.size() - m_readPos, nowUs, false, 0, out);
+        break;
+    case Delimiter:
+        extractDelimited(nowUs, out);
+        break;
+    case LengthPrefix:
+        extractLengthPrefixed(nowUs, out);
+        break;
+    case ModbusRtu:
+        extractModbus(nowUs, out);
+        break;
+    }
+
+    compact();
+}
+
+void SerialFramer::flushOnGap(qint64 nowUs, QList<SerialFrame> &out)
+{
+    if (!hasPending()) return;
+
+    if (m_mode == Raw) {
+        emitFrame(m_buffer.size() - m_readPos, nowUs, false, 0, out);
+    } else if (m_mode == ModbusRtu) {
+        const qsizetype pending = m_buffer.size() - m_readPos;
+        if (pending < 4) {
+            // 不足一帧最小长度 (地址 + 功能码 + CRC)，视为噪声
+            dropBytes(pending);
+        } else {
+            emitFrame(pending, nowUs, true, 0, out);
+        }
+    }
+    // 分隔符/长度前缀模式不以静默间隔断帧
+
+    compact();
+}
+
+void SerialFramer::extractDelimited(qint64 nowUs, QList<SerialFrame> &out)
+{
+    if (m_delimiter.isEmpty()) {
+        emitFrame(m_buffer.size() - m_readPos, nowUs, false, 0, out);
+        return;
+    }
+
+    const qsizetype delimSize = m_delimiter.size();
+    while (hasPending()) {
+        const qsizetype from = qMax(m_scanPos, m_readPos);
+        const qsizetype index = m_buffer.indexOf(m_delimiter, from);
+
+        if (index < 0) {
+            // 下次从可能跨包的分隔符起点开始查找
+            m_scanPos = qMax(m_readPos, m_buffer.size() - (delimSize - 1));
+
+            if (m_buffer.size() - m_readPos > m_maxFrameSize) {
+                // 超过最大帧长仍未找到分隔符：丢弃，等待重新同步
+                ++m_stats.oversizeCount;
+                dropBytes(m_buffer.size() - m_readPos);
+            }
+            break;
+        }
+
+        emitFrame(index + delimSize - m_readPos, nowUs, m_crcEnabled, static_cast<int>(delimSize), out);
+        m_scanPos = m_readPos;
+    }
+}
+
+void SerialFramer::extractLengthPrefixed(qint64 nowUs, QList<SerialFrame> &out)
+{
+    const int headerLen = m_lengthOffset + m_lengthSize;
+
+    while (hasPending()) {
+        // 有帧头时先对齐到帧头
+        if (!m_header.isEmpty()) {
+            const qsizetype index = m_buffer.indexOf(m_header, m_readPos);
+            if (index < 0) {
+                // 保留可能是半个帧头的尾部字节
+                const qsizetype keep = qMin<qsizetype>(m_header.size() - 1, m_buffer.size() - m_readPos);
+                dropBytes(m_buffer.size() - m_readPos - keep);
+                break;
+            }
+            if (index > m_readPos) dropBytes(index - m_readPos);
+        }
+
+        const qsizetype available = m_buffer.size() - m_readPos;
+        if (available < headerLen) break;
+
+        const uchar *p = reinterpret_cast<const uchar *>(m_buffer.constData() + m_readPos + m_lengthOffset);
+        quint32 value = 0;
+        for (int i = 0; i < m_lengthSize; ++i) {
+            const int shift = m_bigEndian ? (m_lengthSize - 1 - i) * 8 : i * 8;
+            value |= static_cast<quint32>(p[i]) << shift;
+        }
+
+        const qint64 total = static_cast<qint64>(headerLen) + value + m_lengthAdjust;
+        if (total <= headerLen || total > m_maxFrameSize) {
+            // 长度字段不可信：丢 1 字节后重新同步
+            ++m_stats.oversizeCount;
+            dropBytes(1);
+            continue;
+        }
+
+        if (available < total) break; // 半包，等待更多数据
+
+        emitFrame(total, nowUs, m_crcEnabled, 0, out);
+    }
+}
+
+int SerialFramer::modbusCandidateLengths(const char *p, qsizetype available, int *lengths) const
+{
+    if (available < 2) return 0;
+
+    const uchar function = static_cast<uchar>(p[1]);
+    const auto byteAt = [&](int index) -> int {
+        return index < available ? static_cast<uchar>(p[index]) : -1;
+    };
+
+    // 异常响应：地址 + 功能码|0x80 + 异常码 + CRC
+    if (function & 0x80) {
+        lengths[0] = 5;
+        return 1;
+    }
+
+    int count = 0;
+    switch (function) {
+    case 0x01: case 0x02: case 0x03: case 0x04: {
+        // 请求固定 8 字节；响应为 地址 + 功能码 + 字节数 + 数据 + CRC
+        lengths[count++] = 8;
+        const int byteCount = byteAt(2);
+        if (byteCount >= 0) lengths[count++] = 5 + byteCount;
+        else lengths[count++] = kModbusMaxFrame + 1; // 未知，等待更多数据
+        break;
+    }
+    case 0x05: case 0x06:
+        lengths[count++] = 8;
+        break;
+    case 0x0F: case 0x10: {
+        // 响应固定 8 字节；请求为 9 + 字节数
+        lengths[count++] = 8;
+        const int byteCount = byteAt(6);
+        if (byteCount >= 0) lengths[count++] = 9 + byteCount;
+        break;
+    }
+    case 0x17: {
+        const int respCount = byteAt(2);
+        if (respCount >= 0) lengths[count++] = 5 + respCount;
+        const int reqCount = byteAt(10);
+        if (reqCount >= 0) lengths[count++] = 13 + reqCount;
+        break;
+    }
+    default:
+        break;
+    }
+    return count;
+}
+
+void SerialFramer::extractModbus(qint64 nowUs, QList<SerialFrame> &out)
+{
+    const int maxFrame = qMin(m_maxFrameSize, kModbusMaxFrame);
+
+    // 单纯依赖 readyRead 间隔无法区分被驱动合并的连续帧，
+    // 这里按功能码推算候选帧长并用 CRC 验证，命中即切帧
+    while (hasPending()) {
+        const qsizetype available = m_buffer.size() - m_readPos;
+        if (available < 4) break;
+
+        const char *p = m_buffer.constData() + m_readPos;
+        int lengths[4];
+        const int count = modbusCandidateLengths(p, available, lengths);
+
+        bool matched = false;
+        bool waiting = false;
+        for (int i = 0; i < count; ++i) {
+            const int length = lengths[i];
+            if (length > available) {
+                waiting = true;
+                continue;
+            }
+            const quint16 crc = crc16Modbus(p, length - 2);
+            const quint16 frameCrc = static_cast<quint16>(static_cast<uchar>(p[length - 2])
+                                                          | (static_cast<uchar>(p[length - 1]) << 8));
+            if (crc == frameCrc) {
+                emitFrame(length, nowUs, true, 0, out);
+                matched = true;
+                break;
+            }
+        }
+
+        if (matched) continue;
+        if (waiting && available <= maxFrame) break; // 半包：等待数据或静默间隔
+
+        if (available > maxFrame) {
+            // 超过 Modbus 最大帧长仍无法切分：丢 1 字节重新搜索帧起点
+            ++m_stats.oversizeCount;
+            dropBytes(1);
+            continue;
+        }
+
+        // 未知功能码：交给静默间隔断帧
+        break;
+    }
+}
+
+void SerialFramer::emitFrame(qsizetype length, qint64 nowUs, bool checkCrc, int trailer, QList<SerialFrame> &out)
+{
+    if (length <= 0) return;
+
+    SerialFrame frame;
+    frame.data = m_buffer.mid(m_readPos, length);
+    frame.timestampUs = nowUs;
+
+    if (checkCrc) {
+        const qsizetype body = length - trailer - 2;
+        if (body > 0) {
+            const char *p = frame.data.constData();
+            const quint16 crc = crc16Modbus(p, body);
+            const quint16 frameCrc = static_cast<quint16>(static_cast<uchar>(p[body])
+                                                          | (static_cast<uchar>(p[body + 1]) << 8));
+            frame.crcStatus = (crc == frameCrc) ? 1 : -1;
+        } else {
+            frame.crcStatus = -1;
+        }
+
+        if (frame.crcStatus > 0) ++m_stats.crcOkCount;
+        else ++m_stats.crcErrorCount;
+    }
+
+    m_readPos += length;
+
+    // 统计
+    const int len = static_cast<int>(length);
+    if (m_stats.frameCount == 0) {
+        m_stats.minLength = len;
+        m_stats.maxLength = len;
+    } else {
+        m_stats.minLength = qMin(m_stats.minLength, len);
+        m_stats.maxLength = qMax(m_stats.maxLength, len);
+    }
+
+    if (m_stats.lastFrameUs >= 0) {
+        const qint64 interval = nowUs - m_stats.lastFrameUs;
+        if (m_stats.frameCount == 1) {
+            m_stats.minIntervalUs = interval;
+            m_stats.maxIntervalUs = interval;
+        } else {
+            m_stats.minIntervalUs = qMin(m_stats.minIntervalUs, interval);
+            m_stats.maxIntervalUs = qMax(m_stats.maxIntervalUs, interval);
+        }
+        m_stats.sumIntervalUs += interval;
+    }
+    m_stats.lastFrameUs = nowUs;
+    ++m_stats.frameCount;
+    m_stats.frameBytes += length;
+
+    out.append(frame);
+}
+
+void SerialFramer::dropBytes(qsizetype count)
+{
+    if (count <= 0) return;
+    m_readPos += count;
+    m_stats.droppedBytes += count;
+}
+
+void SerialFramer::compact()
+{
+    if (m_readPos >= m_buffer.size()) {
+        // 全部消费：只重置长度，保留已分配的容量
+        m_buffer.resize(0);
+        m_scanPos = 0;
+        m_readPos = 0;
+    } else if (m_readPos > kCompactThreshold) {
+        m_buffer.remove(0, m_readPos);
+        m_scanPos = qMax<qsizetype>(0, m_scanPos - m_readPos);
+        m_readPos = 0;
+    }
+}
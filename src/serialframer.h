@@ -0,0 +1,121 @@
+#ifndef SERIALFRAMER_H
+#define SERIALFRAMER_H
+
+#include <QByteArray>
+#include <QList>
+#include <QtGlobal>
+
+// 一帧完整的串口数据
+struct SerialFrame
+{
+    QByteArray data;        // 帧原始字节 (包含 CRC)
+    qint64 timestampUs = 0; // 帧最后一个字节到达的时间 (单调时钟, 微秒)
+    int crcStatus = 0;      // 0 = 未校验, 1 = CRC 正确, -1 = CRC 错误
+};
+
+// 分帧统计信息 (每帧累计)
+struct SerialFrameStats
+{
+    quint64 frameCount = 0;     // 已输出帧数
+    quint64 frameBytes = 0;     // 已输出帧的总字节数
+    quint64 crcOkCount = 0;     // CRC 正确帧数
+    quint64 crcErrorCount = 0;  // CRC 错误帧数
+    quint64 droppedBytes = 0;   // 因同步失败被丢弃的字节数
+    quint64 oversizeCount = 0;  // 超长被截断/丢弃的次数
+    int minLength = 0;          // 最短帧
+    int maxLength = 0;          // 最长帧
+    qint64 minIntervalUs = 0;   // 最小帧间隔
+    qint64 maxIntervalUs = 0;   // 最大帧间隔
+    qint64 lastFrameUs = -1;    // 上一帧时间戳
+    double sumIntervalUs = 0;   // 帧间隔累计, 用于求平均
+};
+
+// 串口分帧器：位于 QSerialPort::readAll 与 UI 之间
+// 纯 C++ 实现，不依赖事件循环，由 SerialClient 负责喂数据和帧间隔定时
+class SerialFramer
+{
+public:
+    enum Mode {
+        Raw = 0,        // 不分帧，每次 readyRead 即一帧 (原有行为)
+        Delimiter,      // 分隔符结尾 (如 \r\n)
+        LengthPrefix,   // 长度前缀
+        ModbusRtu       // Modbus RTU：3.5 字符静默间隔 + CRC16
+    };
+
+    SerialFramer();
+
+    void setMode(Mode mode);
+    Mode mode() const { return m_mode; }
+
+    // 分隔符模式参数
+    void setDelimiter(const QByteArray &delimiter);
+
+    // 长度前缀模式参数
+    // 帧总长 = lengthOffset + lengthSize + 长度字段值 + lengthAdjust
+    // header 非空时用于丢失同步后重新定位帧头
+    void setLengthPrefix(int lengthOffset, int lengthSize, bool bigEndian, int lengthAdjust,
+                         const QByteArray &header = QByteArray());
+
+    // 分隔符/长度前缀模式下是否校验帧尾 CRC16 (Modbus 多项式, 低字节在前)
+    void setCrcEnabled(bool enabled) { m_crcEnabled = enabled; }
+
+    // 单帧最大长度，超过视为丢失同步
+    void setMaxFrameSize(int size) { m_maxFrameSize = qMax(4, size); }
+
+    // 根据波特率计算 Modbus RTU 帧间隔 (t3.5)
+    void setBaudRate(int baudRate, int bitsPerChar = 11);
+    qint64 gapUs() const { return m_gapUs; }
+
+    // 喂入新数据，完整帧追加到 out
+    void feed(const QByteArray &chunk, qint64 nowUs, QList<SerialFrame> &out);
+
+    // 帧间隔到期：把尚未闭合的数据作为一帧输出 (仅 Raw / ModbusRtu 有意义)
+    void flushOnGap(qint64 nowUs, QList<SerialFrame> &out);
+
+    // 是否有未闭合的数据
+    bool hasPending() const { return m_buffer.size() > m_readPos; }
+
+    // 清空缓冲区和统计
+    void reset();
+    void resetStats() { m_stats = SerialFrameStats(); }
+
+    const SerialFrameStats &stats() const { return m_stats; }
+
+    // 查表法 CRC16 (Modbus, 多项式 0xA001, 初值 0xFFFF)
+    static quint16 crc16Modbus(const char *data, qsizetype length);
+
+private:
+    void extractDelimited(qint64 nowUs, QList<SerialFrame> &out);
+    void extractLengthPrefixed(qint64 nowUs, QList<SerialFrame> &out);
+    void extractModbus(qint64 nowUs, QList<SerialFrame> &out);
+
+    // Modbus：根据功能码推测可能的帧长 (请求/响应各一种)，返回候选个数
+    int modbusCandidateLengths(const char *p, qsizetype available, int *lengths) const;
+
+    // 输出一帧；trailer 为 CRC 之后的尾部字节数 (如分隔符)
+    void emitFrame(qsizetype length, qint64 nowUs, bool checkCrc, int trailer, QList<SerialFrame> &out);
+    void dropBytes(qsizetype count);
+    void compact();
+
+    Mode m_mode = Raw;
+    QByteArray m_delimiter = QByteArray("\r\n");
+    int m_lengthOffset = 0;
+    int m_lengthSize = 1;
+    bool m_bigEndian = true;
+    int m_lengthAdjust = 0;
+    QByteArray m_header;
+    bool m_crcEnabled = false;
+    int m_maxFrameSize = 4096;
+    qint64 m_gapUs = 1750;
+
+    // 接收缓冲区：用读指针代替 remove(0, n)，避免每帧整体搬移
+    QByteArray m_buffer;
+    qsizetype m_readPos = 0;
+    qsizetype m_scanPos = 0; // 分隔符模式下已扫描过的位置，避免重复查找
+
+    qint64 m_lastByteUs = -1;
+
+    SerialFrameStats m_stats;
+};
+
+#endif // SERIALFRAMER_H
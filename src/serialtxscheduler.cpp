@@ -0,0 +1,224 @@
+#include "serialtxscheduler.h"
+#include "tracer.h"
+
+#include <QSerialPort>
+#include <QThread>
+#include <QtMath>
+
+namespace {
+
+// 串口写缓冲的高水位，超过后等待 bytesWritten 再继续 (burst 模式靠它限速，定时模式下防止波特率跟不上时缓冲无限增长)
+constexpr qint64 kTxHighWater = 64 * 1024;
+
+// 落后计划超过该值时重新对齐截止时间，避免卡顿后一口气补发
+constexpr qint64 kMaxCatchUpUs = 1000 * 1000;
+
+// 距截止时间不足该值时经 0ms 定时器反复检查 (每次先让出时间片)，否则用定时器睡过粗粒度部分
+// QTimer 只有毫秒精度，Windows 上还可能晚醒 1ms，睡眠提前 kMaxSpinUs / 2 结束
+constexpr qint64 kMaxSpinUs = 2000;
+
+// 定时模式的最小间隔，更短的间隔提升到该值 (需要更快请用 burst 模式)，提升的步数记入统计
+constexpr qint64 kMinDelayUs = kMaxSpinUs;
+
+} // namespace
+
+SerialTxScheduler::SerialTxScheduler(QSerialPort *serial, QObject *parent)
+    : QObject(parent)
+    , m_serial(serial)
+    , m_timer(new QTimer(this))
+{
+    m_timer->setSingleShot(true);
+    m_timer->setTimerType(Qt::PreciseTimer);
+    connect(m_timer, &QTimer::timeout, this, &SerialTxScheduler::onTick);
+    connect(m_serial, &QSerialPort::bytesWritten, this, &SerialTxScheduler::onBytesWritten);
+    m_clock.start();
+}
+
+void SerialTxScheduler::start(const QList<SerialTxStep> &steps, int cycles, bool burst)
+{
+    stop();
+
+    m_steps.clear();
+    m_clampedSteps = 0;
+    for (SerialTxStep step : steps) {
+        if (step.payload.isEmpty() || step.repeat <= 0) continue;
+        if (!burst && step.delayUs < kMinDelayUs) {
+            step.delayUs = kMinDelayUs;
+            ++m_clampedSteps;
+        }
+        m_steps.append(step);
+    }
+    if (m_steps.isEmpty() || !m_serial->isOpen()) return;
+
+    m_cycles = qMax(0, cycles);
+    m_burst = burst;
+    m_stepIndex = 0;
+    m_repeatDone = 0;
+    m_cycleDone = 0;
+
+    m_framesSent = 0;
+    m_bytesSent = 0;
+    m_bytesTransmitted = 0;
+    m_lateCount = 0;
+    m_sumLatenessUs = 0;
+    m_minIntervalUs = 0;
+    m_maxIntervalUs = 0;
+    m_meanIntervalUs = 0;
+    m_m2IntervalUs = 0;
+    m_intervalCount = 0;
+    m_lastSendUs = -1;
+
+    m_startUs = nowUs();
+    m_nextDueUs = m_startUs;
+    m_running = true;
+    emit runningChanged(true);
+
+    m_timer->start(0);
+}
+
+void SerialTxScheduler::stop()
+{
+    m_timer->stop();
+    m_waitingDrain = false;
+    if (m_running) {
+        m_running = false;
+        emit runningChanged(false);
+    }
+}
+
+void SerialTxScheduler::finish()
+{
+    stop();
+}
+
+void SerialTxScheduler::onTick()
+{
+    if (!m_running) return;
+    if (!m_serial->isOpen()) {
+        finish();
+        return;
+    }
+
+    // 写缓冲已积压：等串口真正发出去再继续
+    if (m_serial->bytesToWrite() > kTxHighWater) {
+        m_waitingDrain = true;
+        return;
+    }
+
+    const qint64 now = nowUs();
+    if (!m_burst && now < m_nextDueUs) {
+        scheduleNext(now);
+        return;
+    }
+
+    sendCurrent(now);
+    const qint64 delayUs = m_steps.at(m_stepIndex).delayUs;
+    if (!advance()) {
+        finish();
+        return;
+    }
+
+    if (!m_burst) {
+        // 以上一次的计划时间为基准排程，误差不累积
+        m_nextDueUs += delayUs;
+        if (now - m_nextDueUs > kMaxCatchUpUs) m_nextDueUs = now;
+    }
+    scheduleNext(nowUs());
+}
+
+void SerialTxScheduler::scheduleNext(qint64 now)
+{
+    // 每次 onTick 最多发一帧，之后回到事件循环：stopSchedule、接收数据与 bytesWritten 都能及时处理
+    const qint64 remainingUs = m_burst ? 0 : m_nextDueUs - now;
+    if (remainingUs >= kMaxSpinUs) {
+        m_timer->start(static_cast<int>((remainingUs - kMaxSpinUs / 2) / 1000));
+        return;
+    }
+    if (remainingUs > 0) QThread::yieldCurrentThread();
+    m_timer->start(0);
+}
+
+void SerialTxScheduler::onBytesWritten(qint64 bytes)
+{
+    if (!m_running) return;
+    m_bytesTransmitted += bytes;
+    if (m_waitingDrain && m_serial->bytesToWrite() <= kTxHighWater / 2) {
+        m_waitingDrain = false;
+        m_timer->start(0);
+    }
+}
+
+void SerialTxScheduler::sendCurrent(qint64 nowUs)
+{
+    TRACE_SCOPE("serial.txSend", "serial");
+
+    const QByteArray &payload = m_steps.at(m_stepIndex).payload;
+    m_serial->write(payload);
+    emit payloadSent(payload);
+
+    ++m_framesSent;
+    m_bytesSent += payload.size();
+
+    if (!m_burst) {
+        const qint64 lateness = nowUs - m_nextDueUs;
+        m_sumLatenessUs += lateness;
+        if (lateness > 1000) ++m_lateCount;
+    }
+
+    if (m_lastSendUs >= 0) {
+        const qint64 interval = nowUs - m_lastSendUs;
+        if (m_intervalCount == 0) {
+            m_minIntervalUs = interval;
+            m_maxIntervalUs = interval;
+        } else {
+            m_minIntervalUs = qMin(m_minIntervalUs, interval);
+            m_maxIntervalUs = qMax(m_maxIntervalUs, interval);
+        }
+        ++m_intervalCount;
+        const double delta = interval - m_meanIntervalUs;
+        m_meanIntervalUs += delta / m_intervalCount;
+        m_m2IntervalUs += delta * (interval - m_meanIntervalUs);
+    }
+    m_lastSendUs = nowUs;
+}
+
+bool SerialTxScheduler::advance()
+{
+    ++m_repeatDone;
+    if (m_repeatDone < m_steps.at(m_stepIndex).repeat) return true;
+
+    m_repeatDone = 0;
+    ++m_stepIndex;
+    if (m_stepIndex < m_steps.size()) return true;
+
+    m_stepIndex = 0;
+    ++m_cycleDone;
+    return m_cycles == 0 || m_cycleDone < m_cycles;
+}
+
+QVariantMap SerialTxScheduler::stats() const
+{
+    const qint64 elapsedUs = (m_lastSendUs > m_startUs) ? (m_lastSendUs - m_startUs) : 0;
+    const double seconds = elapsedUs / 1000000.0;
+
+    QVariantMap map;
+    map["running"] = m_running;
+    map["framesSent"] = m_framesSent;
+    map["bytesSent"] = m_bytesSent;
+    map["elapsedMs"] = elapsedUs / 1000.0;
+    map["framesPerSec"] = seconds > 0 ? m_framesSent / seconds : 0.0;
+    // 吞吐按串口实际发出的字节计 (bytesWritten)，framesSent / bytesSent 是已交给 QSerialPort 的量
+    map["bytesPerSec"] = seconds > 0 ? m_bytesTransmitted / seconds : 0.0;
+    map["bytesTransmitted"] = m_bytesTransmitted;
+    map["pendingBytes"] = m_serial->isOpen() ? m_serial->bytesToWrite() : 0;
+    map["minIntervalUs"] = m_minIntervalUs;
+    map["maxIntervalUs"] = m_maxIntervalUs;
+    map["meanIntervalUs"] = m_meanIntervalUs;
+    map["jitterUs"] = m_intervalCount > 1 ? qSqrt(m_m2IntervalUs / (m_intervalCount - 1)) : 0.0;
+    map["lateCount"] = m_lateCount;
+    map["meanLatenessUs"] = (!m_burst && m_framesSent) ? m_sumLatenessUs / m_framesSent : 0.0;
+    map["cycle"] = m_cycleDone;
+    map["clampedSteps"] = m_clampedSteps;
+    map["minDelayUs"] = kMinDelayUs;
+    return map;
+}
@@ -0,0 +1,85 @@
+#ifndef SERIALTXSCHEDULER_H
+#define SERIALTXSCHEDULER_H
+
+#include <QObject>
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QList>
+#include <QTimer>
+#include <QVariantMap>
+
+class QSerialPort;
+
+// 发送序列中的一步：载荷在 GUI 线程预先编码好，发送时不再做任何转换
+struct SerialTxStep
+{
+    QByteArray payload;
+    qint64 delayUs = 0; // 本步发送后到下一步的间隔
+    int repeat = 1;     // 本步连续发送次数
+};
+
+// 精确发送调度器 (运行在串口工作线程)
+// 按绝对截止时间排程，单次定时误差不会累积；burst 模式下忽略间隔，按串口写缓冲水位连续发送
+// 每次定时器回调最多发一帧，帧与帧之间总会回到事件循环；定时模式的间隔不小于 2ms (更短的提升到 2ms 并计入 clampedSteps)
+class SerialTxScheduler : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit SerialTxScheduler(QSerialPort *serial, QObject *parent = nullptr);
+
+    // cycles: 整个序列重复次数 (0 = 无限)
+    void start(const QList<SerialTxStep> &steps, int cycles, bool burst);
+    void stop();
+    bool isRunning() const { return m_running; }
+
+    QVariantMap stats() const;
+
+signals:
+    // 每次实际写出的数据 (工作线程据此录制 TX)
+    void payloadSent(const QByteArray &payload);
+    void runningChanged(bool running);
+
+private slots:
+    void onTick();
+    void onBytesWritten(qint64 bytes);
+
+private:
+    void sendCurrent(qint64 nowUs);
+    void scheduleNext(qint64 now);
+    bool advance(); // 前进到下一次发送，序列结束返回 false
+    void finish();
+    qint64 nowUs() const { return m_clock.nsecsElapsed() / 1000; }
+
+    QSerialPort *m_serial;
+    QTimer *m_timer;
+    QElapsedTimer m_clock;
+
+    QList<SerialTxStep> m_steps;
+    int m_cycles = 0;
+    bool m_burst = false;
+    bool m_running = false;
+    bool m_waitingDrain = false;
+
+    int m_stepIndex = 0;
+    int m_repeatDone = 0;
+    int m_cycleDone = 0;
+    qint64 m_nextDueUs = 0;
+
+    // 统计
+    qint64 m_startUs = 0;
+    qint64 m_lastSendUs = -1;
+    quint64 m_framesSent = 0;
+    quint64 m_bytesSent = 0;
+    quint64 m_bytesTransmitted = 0; // bytesWritten 报告的实际发出字节
+    int m_clampedSteps = 0;
+    quint64 m_lateCount = 0;      // 比计划晚 1ms 以上的发送次数
+    double m_sumLatenessUs = 0;   // 计划时间与实际发送时间的偏差累计
+    qint64 m_minIntervalUs = 0;
+    qint64 m_maxIntervalUs = 0;
+    double m_meanIntervalUs = 0;  // Welford 在线均值/方差
+    double m_m2IntervalUs = 0;
+    quint64 m_intervalCount = 0;
+};
+
+#endif // SERIALTXSCHEDULER_H
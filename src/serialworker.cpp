@@ -0,0 +1,306 @@
+#include "serialworker.h"
+#include "metrics.h"
+#include "tracer.h"
+
+#include <QDateTime>
+
+namespace {
+
+// 串口热路径指标 (工作线程更新，原子操作无需加锁)
+struct SerialMetrics
+{
+    MetricCounter *rxBytes;
+    MetricCounter *txBytes;
+    MetricCounter *frames;
+    MetricCounter *crcErrors;
+    MetricCounter *rxOverflow;
+
+    SerialMetrics()
+    {
+        MetricsRegistry &r = MetricsRegistry::instance();
+        rxBytes = r.counter("serial_rx_bytes_total", "Bytes read from the serial port");
+        txBytes = r.counter("serial_tx_bytes_total", "Bytes written to the serial port");
+        frames = r.counter("serial_frames_total", "Frames produced by the serial framer");
+        crcErrors = r.counter("serial_crc_errors_total", "Frames that failed CRC16 validation");
+        rxOverflow = r.counter("serial_rx_overflow_total", "RX items dropped because the GUI hand-off queue was full");
+    }
+};
+
+SerialMetrics &serialMetrics()
+{
+    static SerialMetrics metrics;
+    return metrics;
+}
+
+} // namespace
+
+SerialWorker::SerialWorker(QObject *parent) : QObject(parent)
+{
+    // 时钟在构造时启动，GUI 线程可以安全读取 m_clockEpochMs
+    m_clock.start();
+    m_clockEpochMs = QDateTime::currentMSecsSinceEpoch();
+}
+
+SerialWorker::~SerialWorker()
+{
+    m_capture.close();
+}
+
+void SerialWorker::initialize()
+{
+    // QSerialPort 和定时器必须在工作线程内创建，才能属于该线程的事件循环
+    m_serial = new QSerialPort(this);
+    connect(m_serial, &QSerialPort::readyRead, this, &SerialWorker::onReadyRead);
+    connect(m_serial, &QSerialPort::errorOccurred, this, &SerialWorker::onError);
+
+    // 读缓冲不限长度，数据由工作线程及时取走，不会因 GUI 卡顿而积压在驱动里
+    m_serial->setReadBufferSize(0);
+
+    m_gapTimer = new QTimer(this);
+    m_gapTimer->setSingleShot(true);
+    m_gapTimer->setTimerType(Qt::PreciseTimer);
+    connect(m_gapTimer, &QTimer::timeout, this, &SerialWorker::onFrameGapTimeout);
+
+    // 精确发送调度器：实际写出的数据同样进入录制文件
+    m_scheduler = new SerialTxScheduler(m_serial, this);
+    connect(m_scheduler, &SerialTxScheduler::payloadSent, this, [this](const QByteArray &payload) {
+        serialMetrics().txBytes->add(payload.size());
+        if (m_capture.isOpen()) m_capture.append(nowUs(), 1, payload);
+    });
+    connect(m_scheduler, &SerialTxScheduler::runningChanged, this, [this](bool running) {
+        // 先发最终统计再发状态，界面收到停止时已经能读到最后的数据
+        if (!running) emit scheduleStatsUpdated(m_scheduler->stats());
+        emit scheduleStatusChanged(running);
+    });
+
+    // 定期刷新录制缓冲、上报分帧统计
+    m_housekeepingTimer = new QTimer(this);
+    m_housekeepingTimer->setInterval(500);
+    connect(m_housekeepingTimer, &QTimer::timeout, this, &SerialWorker::onHousekeeping);
+    m_housekeepingTimer->start();
+}
+
+void SerialWorker::shutdown()
+{
+    stopCapture();
+    closePort();
+    if (m_housekeepingTimer) m_housekeepingTimer->stop();
+}
+
+void SerialWorker::openPort(const SerialPortSettings &settings)
+{
+    if (m_serial->isOpen()) m_serial->close();
+
+    m_serial->setPortName(settings.portName);
+    m_serial->setBaudRate(settings.baudRate);
+    m_serial->setDataBits(settings.dataBits);
+    m_serial->setParity(settings.parity);
+    m_serial->setStopBits(settings.stopBits);
+
+    // 分帧器需要知道每个字符占多少位来计算 t3.5
+    int bitsPerChar = 1 + static_cast<int>(settings.dataBits);
+    if (settings.parity != QSerialPort::NoParity) bitsPerChar += 1;
+    bitsPerChar += (settings.stopBits == QSerialPort::OneStop) ? 1 : 2;
+    m_framer.setBaudRate(settings.baudRate, bitsPerChar);
+    m_framer.reset();
+
+    if (m_serial->open(QIODevice::ReadWrite)) {
+        emit connectionStatusChanged(true);
+    } else {
+        emit errorOccurred("无法打开串口: " + m_serial->errorString());
+    }
+}
+
+void SerialWorker::closePort()
+{
+    if (m_scheduler) m_scheduler->stop();
+    if (m_serial && m_serial->isOpen()) {
+        m_serial->close();
+        m_gapTimer->stop();
+        m_framer.reset();
+        emit connectionStatusChanged(false);
+    }
+}
+
+void SerialWorker::write(const QByteArray &data)
+{
+    if (!m_serial || !m_serial->isOpen()) {
+        emit errorOccurred("未连接串口");
+        return;
+    }
+
+    m_serial->write(data);
+    serialMetrics().txBytes->add(data.size());
+    if (m_capture.isOpen()) m_capture.append(nowUs(), 1, data);
+}
+
+void SerialWorker::setFrameMode(SerialFramer::Mode mode, const QVariantMap &options)
+{
+    m_gapTimer->stop();
+    m_framer.setMode(mode);
+
+    if (options.contains("delimiter")) {
+        m_framer.setDelimiter(options.value("delimiter").toByteArray());
+    }
+    if (mode == SerialFramer::LengthPrefix) {
+        m_framer.setLengthPrefix(options.value("lengthOffset", 0).toInt(),
+                                 options.value("lengthSize", 1).toInt(),
+                                 options.value("bigEndian", true).toBool(),
+                                 options.value("lengthAdjust", 0).toInt(),
+                                 options.value("header").toByteArray());
+    }
+    m_framer.setCrcEnabled(options.value("crc", false).toBool());
+    if (options.contains("maxFrameSize")) {
+        m_framer.setMaxFrameSize(options.value("maxFrameSize").toInt());
+    }
+}
+
+void SerialWorker::resetFrameStats()
+{
+    m_framer.resetStats();
+    emit frameStatsUpdated(buildStats());
+}
+
+void SerialWorker::startCapture(const QString &path)
+{
+    if (m_capture.open(path, m_clockEpochMs + nowUs() / 1000)) {
+        emit captureStatusChanged(true, path);
+    } else {
+        emit errorOccurred("无法创建录制文件: " + m_capture.errorString());
+    }
+}
+
+void SerialWorker::stopCapture()
+{
+    if (!m_capture.isOpen()) return;
+    m_capture.close();
+    emit captureStatusChanged(false, QString());
+}
+
+void SerialWorker::startSchedule(const QList<SerialTxStep> &steps, int cycles, bool burst)
+{
+    if (!m_serial->isOpen()) {
+        emit errorOccurred("未连接串口");
+        return;
+    }
+    m_scheduler->start(steps, cycles, burst);
+}
+
+void SerialWorker::stopSchedule()
+{
+    m_scheduler->stop();
+}
+
+void SerialWorker::onReadyRead()
+{
+    TRACE_SCOPE("serial.read", "serial");
+
+    QByteArray data = m_serial->readAll();
+    if (data.isEmpty()) return;
+
+    const qint64 timestamp = nowUs();
+    serialMetrics().rxBytes->add(data.size());
+
+    // 录制原始字节 (分帧前)
+    if (m_capture.isOpen()) m_capture.append(timestamp, 0, data);
+
+    if (m_framer.mode() == SerialFramer::Raw) {
+        SerialRxItem item;
+        item.data = std::move(data);
+        item.timestampUs = timestamp;
+        pushItem(std::move(item));
+        return;
+    }
+
+    QList<SerialFrame> frames;
+    {
+        TRACE_SCOPE("serial.frame", "serial");
+        m_framer.feed(data, timestamp, frames);
+    }
+    pushFrames(frames);
+
+    // Modbus RTU 还有未闭合的数据：静默 t3.5 后断帧
+    if (m_framer.mode() == SerialFramer::ModbusRtu && m_framer.hasPending()) {
+        m_gapTimer->start(static_cast<int>(qMax<qint64>(1, (m_framer.gapUs() + 999) / 1000)));
+    }
+}
+
+void SerialWorker::onFrameGapTimeout()
+{
+    TRACE_SCOPE("serial.gapFlush", "serial");
+
+    QList<SerialFrame> frames;
+    m_framer.flushOnGap(nowUs(), frames);
+    pushFrames(frames);
+}
+
+void SerialWorker::pushFrames(const QList<SerialFrame> &frames)
+{
+    SerialMetrics &metrics = serialMetrics();
+    for (const SerialFrame &frame : frames) {
+        metrics.frames->add();
+        if (frame.crcStatus < 0) metrics.crcErrors->add();
+
+        SerialRxItem item;
+        item.data = frame.data;
+        item.timestampUs = frame.timestampUs;
+        item.crcStatus = frame.crcStatus;
+        item.isFrame = true;
+        pushItem(std::move(item));
+    }
+}
+
+void SerialWorker::pushItem(SerialRxItem &&item)
+{
+    if (!m_rxQueue.push(std::move(item))) {
+        // GUI 线程长时间未消费，宁可丢显示数据也不阻塞串口读取 (录制文件中仍然完整)
+        m_rxOverflow.fetch_add(1, std::memory_order_relaxed);
+        serialMetrics().rxOverflow->add();
+    }
+
+    // 只有在上一次通知已被处理后才再次通知，避免事件队列被大量信号淹没
+    if (!m_notifyPending.exchange(true, std::memory_order_acq_rel)) {
+        emit rxReady();
+    }
+}
+
+void SerialWorker::onError(QSerialPort::SerialPortError error)
+{
+    if (error == QSerialPort::NoError) return;
+    // 资源错误通常意味着设备被拔出
+    if (error == QSerialPort::ResourceError || error == QSerialPort::PermissionError) {
+        if (m_serial->isOpen()) closePort();
+    }
+}
+
+void SerialWorker::onHousekeeping()
+{
+    m_capture.flush();
+    if (m_framer.mode() != SerialFramer::Raw) {
+        emit frameStatsUpdated(buildStats());
+    }
+    if (m_scheduler->isRunning()) {
+        emit scheduleStatsUpdated(m_scheduler->stats());
+    }
+}
+
+QVariantMap SerialWorker::buildStats() const
+{
+    const SerialFrameStats &s = m_framer.stats();
+    QVariantMap map;
+    map["frameCount"] = s.frameCount;
+    map["frameBytes"] = s.frameBytes;
+    map["crcOk"] = s.crcOkCount;
+    map["crcError"] = s.crcErrorCount;
+    map["droppedBytes"] = s.droppedBytes;
+    map["oversize"] = s.oversizeCount;
+    map["minLength"] = s.minLength;
+    map["maxLength"] = s.maxLength;
+    map["avgLength"] = s.frameCount ? double(s.frameBytes) / s.frameCount : 0.0;
+    map["minIntervalUs"] = s.minIntervalUs;
+    map["maxIntervalUs"] = s.maxIntervalUs;
+    map["avgIntervalUs"] = s.frameCount > 1 ? s.sumIntervalUs / (s.frameCount - 1) : 0.0;
+    map["rxOverflow"] = rxOverflowCount();
+    map["captureBytes"] = m_capture.bytesWritten();
+    return map;
+}
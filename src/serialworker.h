@@ -0,0 +1,110 @@
+#ifndef SERIALWORKER_H
+#define SERIALWORKER_H
+
+#include <QObject>
+#include <QSerialPort>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QVariantMap>
+#include <atomic>
+
+#include "serialframer.h"
+#include "serialcapture.h"
+#include "spscqueue.h"
+#include "serialtxscheduler.h"
+
+// 工作线程交给 GUI 线程的一条接收数据
+struct SerialRxItem
+{
+    QByteArray data;
+    qint64 timestampUs = 0; // 单调时钟 (与 SerialWorker::clock 同源)
+    int crcStatus = 0;
+    bool isFrame = false;   // true = 分帧器输出的完整帧, false = 原始数据块
+};
+
+// 串口打开参数 (在 GUI 线程解析好再交给工作线程)
+struct SerialPortSettings
+{
+    QString portName;
+    qint32 baudRate = 115200;
+    QSerialPort::DataBits dataBits = QSerialPort::Data8;
+    QSerialPort::Parity parity = QSerialPort::NoParity;
+    QSerialPort::StopBits stopBits = QSerialPort::OneStop;
+};
+
+// 串口工作线程对象：QSerialPort、分帧器、录制都在这个线程里运行
+// GUI 线程卡顿不再影响 readyRead 的及时性
+class SerialWorker : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit SerialWorker(QObject *parent = nullptr);
+    ~SerialWorker();
+
+    // 接收队列：工作线程生产, GUI 线程消费
+    SpscQueue<SerialRxItem> &rxQueue() { return m_rxQueue; }
+
+    // GUI 线程消费完后清除通知标记，之后的新数据会再次触发通知
+    void clearNotifyFlag() { m_notifyPending.store(false, std::memory_order_release); }
+
+    // 队列满被丢弃的数据块数
+    quint64 rxOverflowCount() const { return m_rxOverflow.load(std::memory_order_relaxed); }
+
+    // 墙钟时间 = epochMs + timestampUs / 1000
+    qint64 clockEpochMs() const { return m_clockEpochMs; }
+
+    // 以下函数必须在工作线程中调用 (通过 QMetaObject::invokeMethod 排队)
+    void initialize();
+    void shutdown();
+    void openPort(const SerialPortSettings &settings);
+    void closePort();
+    void write(const QByteArray &data);
+    void setFrameMode(SerialFramer::Mode mode, const QVariantMap &options);
+    void resetFrameStats();
+    void startCapture(const QString &path);
+    void stopCapture();
+    void startSchedule(const QList<SerialTxStep> &steps, int cycles, bool burst);
+    void stopSchedule();
+
+signals:
+    // 有新数据入队 (同一批数据只通知一次)
+    void rxReady();
+    void connectionStatusChanged(bool isConnected);
+    void errorOccurred(const QString &errorMsg);
+    // 分帧统计快照，定期发出
+    void frameStatsUpdated(const QVariantMap &stats);
+    void captureStatusChanged(bool capturing, const QString &path);
+    void scheduleStatusChanged(bool running);
+    // 发送调度统计快照 (运行中定期发出, 结束时再发一次)
+    void scheduleStatsUpdated(const QVariantMap &stats);
+
+private slots:
+    void onReadyRead();
+    void onError(QSerialPort::SerialPortError error);
+    void onFrameGapTimeout();
+    void onHousekeeping();
+
+private:
+    void pushItem(SerialRxItem &&item);
+    void pushFrames(const QList<SerialFrame> &frames);
+    QVariantMap buildStats() const;
+    qint64 nowUs() const { return m_clock.nsecsElapsed() / 1000; }
+
+    QSerialPort *m_serial = nullptr;
+    QTimer *m_gapTimer = nullptr;
+    QTimer *m_housekeepingTimer = nullptr;
+    SerialTxScheduler *m_scheduler = nullptr;
+
+    SerialFramer m_framer;
+    SerialCaptureWriter m_capture;
+
+    QElapsedTimer m_clock;
+    qint64 m_clockEpochMs = 0;
+
+    SpscQueue<SerialRxItem> m_rxQueue{4096};
+    std::atomic<bool> m_notifyPending{false};
+    std::atomic<quint64> m_rxOverflow{0};
+};
+
+#endif // SERIALWORKER_H
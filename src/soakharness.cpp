@@ -0,0 +1,519 @@
+#include "soakharness.h"
+#include "Robotclient.h"
+#include "metrics.h"
+
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QDir>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <algorithm>
+#include <cmath>
+
+#if defined(Q_OS_WIN)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <psapi.h>
+#elif defined(Q_OS_LINUX)
+#include <malloc.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+constexpr int kTickMs = 10;
+constexpr int kRttProbeMs = 1000;
+
+} // namespace
+
+// ==========================================================
+// SimulatedController
+// ==========================================================
+
+SimulatedController::SimulatedController(const QElapsedTimer *clock, QObject *parent)
+    : QObject(parent)
+    , m_clock(clock)
+    , m_server(new QTcpServer(this))
+    , m_tickTimer(new QTimer(this))
+{
+    connect(m_server, &QTcpServer::newConnection, this, &SimulatedController::onNewConnection);
+
+    m_tickTimer->setTimerType(Qt::PreciseTimer);
+    m_tickTimer->setInterval(kTickMs);
+    connect(m_tickTimer, &QTimer::timeout, this, &SimulatedController::onTick);
+}
+
+SimulatedController::~SimulatedController()
+{
+    close();
+}
+
+bool SimulatedController::listen(quint16 port)
+{
+    if (!m_server->listen(QHostAddress::LocalHost, port)) return false;
+    m_startNs = m_clock->nsecsElapsed();
+    std::fill(std::begin(m_sent), std::end(m_sent), 0);
+    m_tickTimer->start();
+    return true;
+}
+
+quint16 SimulatedController::port() const
+{
+    return m_server->serverPort();
+}
+
+void SimulatedController::close()
+{
+    m_tickTimer->stop();
+    for (QTcpSocket *socket : std::as_const(m_clients)) {
+        socket->disconnect(this);
+        socket->abort();
+        socket->deleteLater();
+    }
+    m_clients.clear();
+    m_pending.clear();
+    m_server->close();
+}
+
+void SimulatedController::onNewConnection()
+{
+    while (QTcpSocket *socket = m_server->nextPendingConnection()) {
+        m_clients << socket;
+        connect(socket, &QTcpSocket::readyRead, this, [this, socket] { answer(socket); });
+        connect(socket, &QTcpSocket::disconnected, this, [this, socket] {
+            m_clients.removeOne(socket);
+            m_pending.remove(socket);
+            socket->deleteLater();
+        });
+    }
+}
+
+// 回复客户端的请求：按括号切出报文，原样带回 id 和 ty
+void SimulatedController::answer(QTcpSocket *socket)
+{
+    QByteArray &data = m_pending[socket];
+    data += socket->readAll();
+    int depth = 0;
+    int begin = -1;
+    int consumed = 0;
+    for (int i = 0; i < data.size(); ++i) {
+        const char c = data.at(i);
+        if (c == '{') {
+            if (depth++ == 0) begin = i;
+        } else if (c == '}' && depth > 0 && --depth == 0) {
+            const QJsonObject request = QJsonDocument::fromJson(data.mid(begin, i - begin + 1)).object();
+            consumed = i + 1;
+            if (request.isEmpty()) continue;
+
+            QJsonObject reply;
+            reply["id"] = request.value("id");
+            reply["ty"] = request.value("ty");
+            reply["db"] = QJsonObject();
+            socket->write(QJsonDocument(reply).toJson(QJsonDocument::Compact));
+            ++m_requestsAnswered;
+        }
+    }
+    data.remove(0, consumed);
+}
+
+void SimulatedController::broadcast(const QByteArray &frame)
+{
+    for (QTcpSocket *socket : std::as_const(m_clients)) socket->write(frame);
+    ++m_framesSent;
+}
+
+void SimulatedController::onTick()
+{
+    if (m_clients.isEmpty()) return;
+
+    const double elapsedSec = (m_clock->nsecsElapsed() - m_startNs) / 1e9;
+    const double rates[4] = { m_rates.statusHz, m_rates.postureHz, m_rates.projectHz, m_rates.logHz };
+    for (int kind = 0; kind < 4; ++kind) {
+        const quint64 due = quint64(rates[kind] * elapsedSec);
+        while (m_sent[kind] < due) {
+            switch (kind) {
+            case 0: broadcast(statusFrame()); break;
+            case 1: broadcast(postureFrame()); break;
+            case 2: broadcast(projectFrame()); break;
+            default: broadcast(logFrame()); break;
+            }
+            ++m_sent[kind];
+        }
+    }
+}
+
+QByteArray SimulatedController::statusFrame()
+{
+    QJsonObject db{ { "state", 0 }, { "mode", 1 }, { "moveRate", 50.0 }, { "manualMoveRate", 10.0 },
+                    { "runDuration", double(m_sent[0]) }, { "ToolId", 0 }, { "CoordinateId", 0 },
+                    { "PayloadId", 0 }, { "defaultToolId", 0 }, { "defaultCoordinateId", 0 },
+                    { "defaultPayloadId", 0 }, { "modeSwitch", 0 }, { "recoveryState", 0 },
+                    { "rescueFlag", false }, { "teachingPendant", true }, { "type", 0 },
+                    { "soakTs", m_clock->nsecsElapsed() } };
+    return QJsonDocument(QJsonObject{ { "ty", "publish/RobotStatus" }, { "db", db } }).toJson(QJsonDocument::Compact);
+}
+
+QByteArray SimulatedController::postureFrame()
+{
+    // 关节缓慢摆动，界面数值持续变化
+    const double phase = m_sent[1] * 0.01;
+    QJsonArray joint;
+    for (int i = 0; i < 6; ++i) joint.append(30.0 * std::sin(phase + i));
+    QJsonObject end{ { "x", 500 + 50 * std::cos(phase) }, { "y", 50 * std::sin(phase) }, { "z", 700.0 },
+                     { "a", 180.0 }, { "b", 0.0 }, { "c", -90.0 } };
+    QJsonObject db{ { "joint", joint }, { "end", end }, { "soakTs", m_clock->nsecsElapsed() } };
+    return QJsonDocument(QJsonObject{ { "ty", "publish/RobotPosture" }, { "db", db } }).toJson(QJsonDocument::Compact);
+}
+
+QByteArray SimulatedController::projectFrame()
+{
+    QJsonObject db{ { "state", int(m_sent[2] / 50 % 3) }, { "projectType", 0 }, { "soakTs", m_clock->nsecsElapsed() } };
+    return QJsonDocument(QJsonObject{ { "ty", "publish/ProjectState" }, { "db", db } }).toJson(QJsonDocument::Compact);
+}
+
+QByteArray SimulatedController::logFrame()
+{
+    // 格式与控制器一致: [[type, code, time, msg], ...]，用来压测界面日志列表与日志文件
+    QJsonArray entry{ 1, 1000 + int(m_sent[3] % 100), QDateTime::currentMSecsSinceEpoch(),
+                      QString("soak log #%1").arg(m_sent[3]) };
+    QJsonArray db;
+    db.append(entry); // 不能写成 QJsonArray{ entry }，那是拷贝而不是嵌套
+    return QJsonDocument(QJsonObject{ { "ty", "publish/Log" }, { "db", db } }).toJson(QJsonDocument::Compact);
+}
+
+// ==========================================================
+// SoakHarness
+// ==========================================================
+
+SoakHarness::SoakHarness(RobotClient *robot, QObject *parent)
+    : QObject(parent)
+    , m_robot(robot)
+    , m_controller(new SimulatedController(&m_clock, this))
+    , m_sampleTimer(new QTimer(this))
+    , m_rttTimer(new QTimer(this))
+    , m_durationTimer(new QTimer(this))
+{
+    m_clock.start();
+
+    connect(m_sampleTimer, &QTimer::timeout, this, &SoakHarness::onSample);
+
+    m_rttTimer->setInterval(kRttProbeMs);
+    connect(m_rttTimer, &QTimer::timeout, this, &SoakHarness::onRttProbe);
+
+    m_durationTimer->setSingleShot(true);
+    connect(m_durationTimer, &QTimer::timeout, this, &SoakHarness::stop);
+}
+
+bool SoakHarness::start(const QVariantMap &options)
+{
+    if (m_running) return false;
+    if (m_robot->isConnected() || m_robot->isConnecting()) {
+        emit errorOccurred("请先断开机器人连接，长稳测试会连接本地模拟控制器");
+        return false;
+    }
+
+    m_options = options;
+    SimulatedController::Rates rates;
+    rates.statusHz = options.value("statusHz", rates.statusHz).toDouble();
+    rates.postureHz = options.value("postureHz", rates.postureHz).toDouble();
+    rates.projectHz = options.value("projectHz", rates.projectHz).toDouble();
+    rates.logHz = options.value("logHz", rates.logHz).toDouble();
+    m_controller->setRates(rates);
+
+    m_clock.restart(); // 推送起点与采样时间都从这里算
+    if (!m_controller->listen()) {
+        emit errorOccurred("模拟控制器监听失败");
+        return false;
+    }
+
+    const QString dir = QCoreApplication::applicationDirPath() + "/Logs";
+    QDir().mkpath(dir);
+    const QString base = dir + "/soak_" + QDateTime::currentDateTime().toString("yyyyMMdd_HHmmss");
+    m_csv.setFileName(base + ".csv");
+    if (!m_csv.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) {
+        m_controller->close();
+        emit errorOccurred("无法创建采样文件: " + m_csv.fileName());
+        return false;
+    }
+    m_reportPath = base + "_report.txt";
+
+    m_samples.clear();
+    m_gaugeNames.clear();
+    m_latencyUs.clear();
+    m_rttUs.clear();
+    m_framesReceived = 0;
+    m_rttSentNs = -1;
+    m_lastSample.clear();
+    m_verdict.clear();
+
+    // 推送延迟：发送时刻写在 db.soakTs 中，与模拟控制器共用 m_clock
+    // 连接扫描结构体信号 (soakTs 是登记字段)，不连接 QJsonObject 信号，测的是应用实际走的扫描路径而不是 DOM
+    m_connections << connect(m_robot, &RobotClient::robotStatusFrame, this,
+                             [this](const RobotStatusFrame &frame) { onLatency(qint64(frame.soakTs)); });
+    m_connections << connect(m_robot, &RobotClient::robotPostureFrame, this,
+                             [this](const RobotPostureFrame &frame) { onLatency(qint64(frame.soakTs)); });
+    m_connections << connect(m_robot, &RobotClient::projectStateFrame, this,
+                             [this](const ProjectStateFrame &frame) { onLatency(qint64(frame.soakTs)); });
+    m_connections << connect(m_robot, &RobotClient::connected, this, [this] { m_rttTimer->start(); });
+
+    m_sampleTimer->start(qMax(1, options.value("sampleSec", 10).toInt()) * 1000);
+    const int durationMin = options.value("durationMin", 60).toInt();
+    if (durationMin > 0) m_durationTimer->start(durationMin * 60 * 1000);
+
+    m_running = true;
+    emit runningChanged();
+
+    m_robot->connectToRobot("127.0.0.1", m_controller->port());
+    return true;
+}
+
+void SoakHarness::stop()
+{
+    if (!m_running) return;
+    onSample(); // 最后一个窗口
+    finish();
+}
+
+void SoakHarness::onLatency(qint64 sentNs)
+{
+    if (sentNs < 0) return;
+    ++m_framesReceived;
+    m_latencyUs.push_back((m_clock.nsecsElapsed() - sentNs) / 1000);
+}
+
+// 往返时间：同一时刻只有一个探测请求在途，回复按 id 匹配
+// 用 sendProbe 直接发送：不经请求缓存 (不会与页面的同类请求合并)，回复也不广播给界面
+void SoakHarness::onRttProbe()
+{
+    if (m_rttSentNs >= 0 || !m_robot->isConnected()) return;
+    using Request = RobotProtocol::GlobalVarApi::GetProjectVarUpdate;
+    m_rttSentNs = m_clock.nsecsElapsed();
+    const QString id = m_robot->sendProbe(QLatin1String(Request::kType), Request{}.toDb(), this,
+                                          [this](const QJsonObject *root) {
+                                              if (root && m_rttSentNs >= 0) {
+                                                  m_rttUs.push_back((m_clock.nsecsElapsed() - m_rttSentNs) / 1000);
+                                              }
+                                              m_rttSentNs = -1;
+                                          });
+    if (id.isEmpty()) m_rttSentNs = -1;
+}
+
+qint64 SoakHarness::percentile(std::vector<qint64> &values, double q)
+{
+    if (values.empty()) return -1;
+    const size_t index = std::min(values.size() - 1, size_t(q * (values.size() - 1) + 0.5));
+    std::nth_element(values.begin(), values.begin() + index, values.end());
+    return values[index];
+}
+
+void SoakHarness::processMemory(qint64 &rssBytes, qint64 &heapBytes)
+{
+    rssBytes = -1;
+    heapBytes = -1;
+#if defined(Q_OS_WIN)
+    // 工作集 + 私有提交 (Windows 没有廉价的堆统计，私有提交包含所有堆)
+    PROCESS_MEMORY_COUNTERS_EX counters;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), reinterpret_cast<PROCESS_MEMORY_COUNTERS *>(&counters),
+                             sizeof(counters))) {
+        rssBytes = qint64(counters.WorkingSetSize);
+        heapBytes = qint64(counters.PrivateUsage);
+    }
+#elif defined(Q_OS_LINUX)
+    QFile statm("/proc/self/statm");
+    if (statm.open(QIODevice::ReadOnly)) {
+        const QList<QByteArray> fields = statm.readAll().split(' ');
+        if (fields.size() > 1) rssBytes = fields.at(1).toLongLong() * sysconf(_SC_PAGESIZE);
+    }
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+    heapBytes = qint64(mallinfo2().uordblks);
+#endif
+#endif
+}
+
+void SoakHarness::onSample()
+{
+    if (!m_running) return;
+
+    Sample s;
+    s.tSec = m_clock.elapsed() / 1000;
+    processMemory(s.rssBytes, s.heapBytes);
+    s.frames = m_framesReceived;
+    s.latP50Us = percentile(m_latencyUs, 0.50);
+    s.latP99Us = percentile(m_latencyUs, 0.99);
+    s.latMaxUs = m_latencyUs.empty() ? -1 : *std::max_element(m_latencyUs.begin(), m_latencyUs.end());
+    s.rttP50Us = percentile(m_rttUs, 0.50);
+    s.rttP99Us = percentile(m_rttUs, 0.99);
+    m_latencyUs.clear();
+    m_rttUs.clear();
+
+    // 队列深度：所有 gauge 指标 (接收缓冲、串口队列、在途请求等)
+    for (const QVariant &item : MetricsRegistry::instance().snapshot()) {
+        const QVariantMap m = item.toMap();
+        if (m.value("type").toString() != "gauge") continue;
+        const QString labels = m.value("labels").toString();
+        const QString name = m.value("name").toString() + (labels.isEmpty() ? QString() : "{" + labels + "}");
+        s.gauges[name] = m.value("value");
+    }
+    const QVariantMap cache = m_robot->requestCacheStats();
+    s.gauges["request_cache_in_flight"] = cache.value("inFlight");
+
+    // CSV：列在首次采样时确定
+    if (m_samples.empty()) {
+        m_gaugeNames = s.gauges.keys();
+        QByteArray header = "t_sec,rss_bytes,heap_bytes,frames,lat_p50_us,lat_p99_us,lat_max_us,rtt_p50_us,rtt_p99_us";
+        for (const QString &name : std::as_const(m_gaugeNames)) header += ",\"" + name.toUtf8() + "\"";
+        m_csv.write(header + "\n");
+    }
+    QByteArray row = QByteArray::number(s.tSec) + "," + QByteArray::number(s.rssBytes) + ","
+                     + QByteArray::number(s.heapBytes) + "," + QByteArray::number(s.frames) + ","
+                     + QByteArray::number(s.latP50Us) + "," + QByteArray::number(s.latP99Us) + ","
+                     + QByteArray::number(s.latMaxUs) + "," + QByteArray::number(s.rttP50Us) + ","
+                     + QByteArray::number(s.rttP99Us);
+    for (const QString &name : std::as_const(m_gaugeNames)) row += "," + s.gauges.value(name).toByteArray();
+    m_csv.write(row + "\n");
+    m_csv.flush();
+
+    m_samples.push_back(s);
+
+    m_lastSample = s.gauges;
+    m_lastSample["tSec"] = s.tSec;
+    m_lastSample["rssMb"] = s.rssBytes / 1048576.0;
+    m_lastSample["heapMb"] = s.heapBytes / 1048576.0;
+    m_lastSample["frames"] = double(s.frames);
+    m_lastSample["latP50Us"] = s.latP50Us;
+    m_lastSample["latP99Us"] = s.latP99Us;
+    m_lastSample["rttP50Us"] = s.rttP50Us;
+    emit sampled();
+}
+
+void SoakHarness::finish()
+{
+    m_sampleTimer->stop();
+    m_rttTimer->stop();
+    m_durationTimer->stop();
+    for (const QMetaObject::Connection &c : std::as_const(m_connections)) disconnect(c);
+    m_connections.clear();
+
+    m_robot->disconnectFromRobot();
+    m_controller->close();
+    m_csv.close();
+
+    m_lastElapsedSec = int(m_clock.elapsed() / 1000);
+    m_running = false;
+
+    bool passed = false;
+    m_reportPath = writeReport(passed);
+    emit runningChanged();
+    emit finished(passed, m_reportPath);
+}
+
+QString SoakHarness::writeReport(bool &passed)
+{
+    const qint64 warmupSec = m_options.value("warmupSec", 60).toLongLong();
+    const double maxRssGrowthMb = m_options.value("maxRssGrowthMb", 64).toDouble();
+    const double maxHeapGrowthMb = m_options.value("maxHeapGrowthMb", 32).toDouble();
+    const double maxDrift = m_options.value("maxLatencyDrift", 1.5).toDouble();
+    const qint64 floorUs = m_options.value("latencyFloorUs", 1000).toLongLong();
+
+    // 预热之后的采样 (样本太少时全部使用)
+    std::vector<const Sample *> steady;
+    for (const Sample &s : m_samples) {
+        if (s.tSec >= warmupSec) steady.push_back(&s);
+    }
+    if (steady.size() < 4) {
+        steady.clear();
+        for (const Sample &s : m_samples) steady.push_back(&s);
+    }
+
+    QStringList failures;
+    QStringList lines;
+    lines << QString("长稳测试报告  %1").arg(QDateTime::currentDateTime().toString("yyyy-MM-dd HH:mm:ss"));
+    lines << QString("时长 %1 s，采样 %2 次，模拟控制器发送 %3 帧、回复 %4 个请求，客户端收到 %5 帧")
+                 .arg(m_lastElapsedSec)
+                 .arg(m_samples.size())
+                 .arg(m_controller->framesSent())
+                 .arg(m_controller->requestsAnswered())
+                 .arg(m_framesReceived);
+    lines << QString("采样文件: %1").arg(m_csv.fileName());
+    lines << QString();
+
+    if (steady.size() < 2) {
+        failures << "采样不足 2 次，无法判断";
+    } else {
+        const Sample &first = *steady.front();
+        const Sample &last = *steady.back();
+
+        auto checkGrowth = [&](const char *label, qint64 from, qint64 to, double limitMb) {
+            if (from < 0 || to < 0) {
+                lines << QString("%1: 本平台不支持采集").arg(label);
+                return;
+            }
+            const double growthMb = (to - from) / 1048576.0;
+            lines << QString("%1: %2 MB -> %3 MB (增长 %4 MB，上限 %5 MB)")
+                         .arg(label)
+                         .arg(from / 1048576.0, 0, 'f', 1)
+                         .arg(to / 1048576.0, 0, 'f', 1)
+                         .arg(growthMb, 0, 'f', 1)
+                         .arg(limitMb);
+            if (growthMb > limitMb) failures << QString("%1 增长 %2 MB 超过上限").arg(label).arg(growthMb, 0, 'f', 1);
+        };
+        checkGrowth("常驻内存", first.rssBytes, last.rssBytes, maxRssGrowthMb);
+        checkGrowth("堆", first.heapBytes, last.heapBytes, maxHeapGrowthMb);
+
+        // 延迟漂移：前 1/4 与后 1/4 采样窗口分位数的中位数比较
+        const size_t quarter = std::max<size_t>(1, steady.size() / 4);
+        auto windowMedian = [&](bool head, qint64 Sample::*field) {
+            std::vector<qint64> values;
+            for (size_t i = 0; i < quarter; ++i) {
+                const Sample *s = head ? steady[i] : steady[steady.size() - 1 - i];
+                if (s->*field >= 0) values.push_back(s->*field);
+            }
+            return percentile(values, 0.5);
+        };
+        auto checkDrift = [&](const char *label, qint64 Sample::*field) {
+            const qint64 head = windowMedian(true, field);
+            const qint64 tail = windowMedian(false, field);
+            if (head < 0 || tail < 0) {
+                lines << QString("%1: 无数据").arg(label);
+                return;
+            }
+            const double ratio = head > 0 ? double(tail) / head : 1.0;
+            lines << QString("%1: 前段 %2 us -> 后段 %3 us (x%4，上限 x%5)")
+                         .arg(label)
+                         .arg(head)
+                         .arg(tail)
+                         .arg(ratio, 0, 'f', 2)
+                         .arg(maxDrift);
+            if (ratio > maxDrift && tail - head > floorUs) failures << QString("%1 漂移 x%2").arg(label).arg(ratio, 0, 'f', 2);
+        };
+        checkDrift("推送延迟 p50", &Sample::latP50Us);
+        checkDrift("推送延迟 p99", &Sample::latP99Us);
+        checkDrift("请求往返 p50", &Sample::rttP50Us);
+        checkDrift("请求往返 p99", &Sample::rttP99Us);
+
+        // 队列深度只记录首尾，供人工判断
+        lines << QString();
+        lines << "队列深度 (首 -> 尾):";
+        for (auto it = last.gauges.begin(); it != last.gauges.end(); ++it) {
+            lines << QString("  %1: %2 -> %3").arg(it.key(), first.gauges.value(it.key()).toString(), it.value().toString());
+        }
+    }
+
+    passed = failures.isEmpty();
+    m_verdict = passed ? "PASS" : "FAIL: " + failures.join("; ");
+    lines << QString();
+    lines << "结果: " + m_verdict;
+
+    QFile file(m_reportPath);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) {
+        emit errorOccurred("无法写入报告: " + m_reportPath);
+        return QString();
+    }
+    file.write(lines.join("\n").toUtf8() + "\n");
+    return m_reportPath;
+}
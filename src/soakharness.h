@@ -0,0 +1,159 @@
+#ifndef SOAKHARNESS_H
+#define SOAKHARNESS_H
+
+#include <QObject>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QHash>
+#include <QList>
+#include <QVariantMap>
+#include <vector>
+
+class QTcpServer;
+class QTcpSocket;
+class RobotClient;
+
+// 本地模拟控制器：监听 127.0.0.1，按设定频率推送 publish/* 报文，并对请求原样带回 id 回复
+// 推送的 db 中带 "soakTs" (发送时刻，纳秒，与长稳测试共用同一个时钟)，用于测量端到端延迟
+class SimulatedController : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Rates
+    {
+        double statusHz = 100;
+        double postureHz = 250;
+        double projectHz = 10;
+        double logHz = 5;
+    };
+
+    SimulatedController(const QElapsedTimer *clock, QObject *parent = nullptr);
+    ~SimulatedController();
+
+    bool listen(quint16 port = 0);
+    quint16 port() const;
+    void close();
+
+    void setRates(const Rates &rates) { m_rates = rates; }
+    quint64 framesSent() const { return m_framesSent; }
+    quint64 requestsAnswered() const { return m_requestsAnswered; }
+
+private slots:
+    void onNewConnection();
+    void onTick();
+
+private:
+    void broadcast(const QByteArray &frame);
+    void answer(QTcpSocket *socket);
+    QByteArray statusFrame();
+    QByteArray postureFrame();
+    QByteArray projectFrame();
+    QByteArray logFrame();
+
+    const QElapsedTimer *m_clock;
+    QTcpServer *m_server;
+    QList<QTcpSocket *> m_clients;
+    QHash<QTcpSocket *, QByteArray> m_pending; // 未收全的请求
+    QTimer *m_tickTimer;
+    Rates m_rates;
+
+    // 按累计应发数量补发，定时器抖动不影响平均频率
+    qint64 m_startNs = 0;
+    quint64 m_sent[4] = {};
+    quint64 m_framesSent = 0;
+    quint64 m_requestsAnswered = 0;
+};
+
+// 长稳测试：RobotClient 连接本地模拟控制器，长时间高频推送
+// 每 sampleSec 秒采样一次进程内存、堆、队列深度 (所有 gauge 指标)、端到端延迟与请求往返时间，写入 CSV
+// 结束时与预热后的基线比较，内存增长超过上限或延迟分位数漂移超过倍数时判定失败，并写出报告
+class SoakHarness : public QObject
+{
+    Q_OBJECT
+
+    Q_PROPERTY(bool running READ running NOTIFY runningChanged)
+    Q_PROPERTY(int elapsedSec READ elapsedSec NOTIFY sampled)
+    Q_PROPERTY(QVariantMap lastSample READ lastSample NOTIFY sampled)
+    Q_PROPERTY(QString verdict READ verdict NOTIFY finished)
+    Q_PROPERTY(QString reportPath READ reportPath NOTIFY finished)
+
+public:
+    explicit SoakHarness(RobotClient *robot, QObject *parent = nullptr);
+
+    bool running() const { return m_running; }
+    int elapsedSec() const { return m_running ? int(m_clock.elapsed() / 1000) : m_lastElapsedSec; }
+    QVariantMap lastSample() const { return m_lastSample; }
+    QString verdict() const { return m_verdict; }
+    QString reportPath() const { return m_reportPath; }
+
+    // options (均可省略):
+    //   durationMin (60)      测试时长，0 表示直到 stop()
+    //   sampleSec (10)        采样间隔
+    //   warmupSec (60)        预热时间，之后的第一次采样作为基线
+    //   statusHz / postureHz / projectHz / logHz   推送频率
+    //   maxRssGrowthMb (64)   常驻内存允许增长
+    //   maxHeapGrowthMb (32)  堆允许增长
+    //   maxLatencyDrift (1.5) 后段与前段延迟分位数的最大比值
+    //   latencyFloorUs (1000) 漂移的绝对阈值，低于它不判失败 (避免微秒级抖动误报)
+    // 机器人已连接时拒绝启动，返回 false
+    Q_INVOKABLE bool start(const QVariantMap &options = QVariantMap());
+    // 提前结束并出报告
+    Q_INVOKABLE void stop();
+
+signals:
+    void runningChanged();
+    void sampled();
+    void errorOccurred(const QString &message);
+    void finished(bool passed, const QString &reportPath);
+
+private slots:
+    void onSample();
+    void onRttProbe();
+
+private:
+    struct Sample
+    {
+        qint64 tSec;
+        qint64 rssBytes;
+        qint64 heapBytes;
+        quint64 frames;
+        qint64 latP50Us, latP99Us, latMaxUs;
+        qint64 rttP50Us, rttP99Us;
+        QVariantMap gauges;
+    };
+
+    static void processMemory(qint64 &rssBytes, qint64 &heapBytes);
+    static qint64 percentile(std::vector<qint64> &values, double q);
+    void onLatency(qint64 sentNs);
+    void finish();
+    QString writeReport(bool &passed);
+
+    RobotClient *m_robot;
+    SimulatedController *m_controller;
+    QTimer *m_sampleTimer;
+    QTimer *m_rttTimer;
+    QTimer *m_durationTimer;
+    QElapsedTimer m_clock;
+
+    bool m_running = false;
+    int m_lastElapsedSec = 0;
+    QVariantMap m_options;
+    QList<QMetaObject::Connection> m_connections;
+
+    // 当前采样窗口内的原始值 (微秒)，采样后清空
+    std::vector<qint64> m_latencyUs;
+    std::vector<qint64> m_rttUs;
+    quint64 m_framesReceived = 0;
+    qint64 m_rttSentNs = -1;
+
+    std::vector<Sample> m_samples;
+    QVariantMap m_lastSample;
+    QFile m_csv;
+    QStringList m_gaugeNames; // CSV 列，首次采样时确定
+    QString m_verdict;
+    QString m_reportPath;
+};
+
+#endif // SOAKHARNESS_H
@@ -0,0 +1,69 @@
+#ifndef SPSCQUEUE_H
+#define SPSCQUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+// 单生产者 / 单消费者无锁环形队列
+// 生产者 (串口工作线程) 只写 m_tail，消费者 (GUI 线程) 只写 m_head，互不加锁
+template <typename T>
+class SpscQueue
+{
+public:
+    // capacity 会向上取整为 2 的幂
+    explicit SpscQueue(std::size_t capacity = 1024)
+    {
+        std::size_t size = 2;
+        while (size < capacity) size <<= 1;
+        m_slots.resize(size);
+        m_mask = size - 1;
+    }
+
+    SpscQueue(const SpscQueue &) = delete;
+    SpscQueue &operator=(const SpscQueue &) = delete;
+
+    // 生产者调用；队列满时返回 false (由调用方决定丢弃还是重试)
+    bool push(T &&value)
+    {
+        const std::size_t tail = m_tail.load(std::memory_order_relaxed);
+        const std::size_t head = m_head.load(std::memory_order_acquire);
+        if (tail - head > m_mask) return false;
+
+        m_slots[tail & m_mask] = std::move(value);
+        m_tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // 消费者调用；队列空时返回 false
+    bool pop(T &value)
+    {
+        const std::size_t head = m_head.load(std::memory_order_relaxed);
+        const std::size_t tail = m_tail.load(std::memory_order_acquire);
+        if (head == tail) return false;
+
+        value = std::move(m_slots[head & m_mask]);
+        m_slots[head & m_mask] = T();
+        m_head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // 近似长度 (仅用于统计显示)
+    std::size_t size() const
+    {
+        return m_tail.load(std::memory_order_acquire) - m_head.load(std::memory_order_acquire);
+    }
+
+    std::size_t capacity() const { return m_mask + 1; }
+
+private:
+    std::vector<T> m_slots;
+    std::size_t m_mask = 0;
+
+    // 头尾指针分处不同缓存行，避免两个线程互相踩缓存
+    alignas(64) std::atomic<std::size_t> m_head{0};
+    alignas(64) std::atomic<std::size_t> m_tail{0};
+};
+
+#endif // SPSCQUEUE_H
@@ -0,0 +1,242 @@
+#include "telemetryclient.h"
+#include "Robotclient.h"
+
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <QUrl>
+
+namespace {
+
+// 回放刷新周期：50Hz 足够界面显示，同一周期内的多行只发最后一行
+constexpr int kPlayTickMs = 20;
+
+} // namespace
+
+TelemetryClient::TelemetryClient(RobotClient *robot, QObject *parent)
+    : QObject(parent)
+    , m_robot(robot)
+    , m_flushTimer(new QTimer(this))
+    , m_playTimer(new QTimer(this))
+{
+    // 每 10 秒把未满的块落盘，异常退出最多丢 10 秒
+    m_flushTimer->setInterval(10000);
+    connect(m_flushTimer, &QTimer::timeout, this, [this] { m_writer.flush(); });
+
+    m_playTimer->setTimerType(Qt::PreciseTimer);
+    m_playTimer->setInterval(kPlayTickMs);
+    connect(m_playTimer, &QTimer::timeout, this, &TelemetryClient::onPlayTick);
+}
+
+TelemetryClient::~TelemetryClient()
+{
+    // 关闭时写入块目录，下次打开无需扫描
+    m_writer.close();
+}
+
+QString TelemetryClient::toLocalPath(const QString &path)
+{
+    return path.startsWith("file:") ? QUrl(path).toLocalFile() : path;
+}
+
+// ==========================================================
+// 录制
+// ==========================================================
+
+QString TelemetryClient::startRecording(const QString &path)
+{
+    if (m_writer.isOpen()) return m_writer.path();
+
+    QString filePath = toLocalPath(path);
+    if (filePath.isEmpty()) {
+        const QString timeStr = QDateTime::currentDateTime().toString("yyyyMMdd_HHmmss");
+        filePath = QCoreApplication::applicationDirPath() + "/Telemetry/telemetry_" + timeStr + ".tcol";
+    }
+
+    if (!m_writer.open(filePath)) {
+        emit errorOccurred("无法创建录制文件: " + filePath);
+        return QString();
+    }
+
+    m_recordBaseUs = QDateTime::currentMSecsSinceEpoch() * 1000;
+    m_recordClock.start();
+    m_flushTimer->start();
+
+    // 只在录制期间连接：没有接收者时 RobotClient 不为推送主题构建 QJsonObject
+    // 只录制实时报文，回放注入的报文不会再被写回文件
+    m_recordConnections << connect(m_robot, &RobotClient::recvRobotPostureMessage, this, [this](const QJsonObject &db) {
+        if (!m_robot->isInjecting()) record(TelemetryPosture, db);
+    });
+    m_recordConnections << connect(m_robot, &RobotClient::recvRobotStatusMessage, this, [this](const QJsonObject &db) {
+        if (!m_robot->isInjecting()) record(TelemetryStatus, db);
+    });
+    m_recordConnections << connect(m_robot, &RobotClient::recvProjectStateMessage, this, [this](const QJsonObject &db) {
+        if (!m_robot->isInjecting()) record(TelemetryProject, db);
+    });
+    emit recordingChanged();
+    return filePath;
+}
+
+void TelemetryClient::stopRecording()
+{
+    if (!m_writer.isOpen()) return;
+    for (const QMetaObject::Connection &c : std::as_const(m_recordConnections)) disconnect(c);
+    m_recordConnections.clear();
+    m_flushTimer->stop();
+    m_writer.close();
+    emit recordingChanged();
+}
+
+QVariantMap TelemetryClient::recordingStats() const
+{
+    QVariantMap stats;
+    stats["rows"] = m_writer.rowCount();
+    stats["bytes"] = m_writer.bytesWritten();
+    stats["path"] = m_writer.path();
+    return stats;
+}
+
+void TelemetryClient::record(int table, const QJsonObject &db)
+{
+    if (!m_writer.isOpen()) return;
+    m_writer.append(table, m_recordBaseUs + m_recordClock.nsecsElapsed() / 1000, db);
+}
+
+// ==========================================================
+// 回放
+// ==========================================================
+
+bool TelemetryClient::openPlayback(const QString &path)
+{
+    closePlayback();
+
+    const QString filePath = toLocalPath(path);
+    QString error;
+    if (!m_reader.open(filePath, &error)) {
+        emit errorOccurred(error);
+        return false;
+    }
+
+    m_playbackPath = filePath;
+    m_positionUs = m_reader.startUs();
+    emit playbackChanged();
+    emit positionChanged();
+    emitLatest(m_positionUs);
+    return true;
+}
+
+void TelemetryClient::closePlayback()
+{
+    if (!m_reader.isOpen()) return;
+    pause();
+    m_reader.close();
+    m_playbackPath.clear();
+    m_positionUs = 0;
+    emit playbackChanged();
+    emit positionChanged();
+}
+
+void TelemetryClient::play()
+{
+    if (!m_reader.isOpen() || m_playTimer->isActive()) return;
+    if (m_positionUs >= m_reader.endUs()) seek(startMs()); // 放完后从头开始
+
+    m_playBaseUs = m_positionUs;
+    m_playClock.start();
+    m_playTimer->start();
+    emit playingChanged();
+}
+
+void TelemetryClient::pause()
+{
+    if (!m_playTimer->isActive()) return;
+    m_playTimer->stop();
+    emit playingChanged();
+}
+
+void TelemetryClient::setSpeed(double speed)
+{
+    speed = qBound(0.1, speed, 64.0);
+    if (qFuzzyCompare(speed, m_speed)) return;
+
+    // 以当前位置为新的起点，避免改倍速时位置跳变
+    m_playBaseUs = m_positionUs;
+    m_playClock.restart();
+    m_speed = speed;
+    emit speedChanged();
+}
+
+void TelemetryClient::seek(double positionMs)
+{
+    if (!m_reader.isOpen()) return;
+
+    m_positionUs = qBound(m_reader.startUs(), static_cast<qint64>(positionMs * 1000.0), m_reader.endUs());
+    m_playBaseUs = m_positionUs;
+    m_playClock.restart();
+    emitLatest(m_positionUs);
+    emit positionChanged();
+}
+
+void TelemetryClient::onPlayTick()
+{
+    const qint64 target = qMin(m_reader.endUs(),
+                               m_playBaseUs + static_cast<qint64>(m_playClock.nsecsElapsed() / 1000 * m_speed));
+    if (target > m_positionUs) {
+        emitRange(m_positionUs, target);
+        m_positionUs = target;
+        emit positionChanged();
+    }
+    if (m_positionUs >= m_reader.endUs()) pause();
+}
+
+void TelemetryClient::emitRange(qint64 fromUs, qint64 toUs)
+{
+    for (int table = 0; table < TelemetryTableCount; ++table) {
+        // 第一个 > toUs 的行的前一行，若它也在区间内则发出
+        TelemetryReader::Cursor cursor = m_reader.seek(table, toUs + 1);
+        if (!m_reader.previous(table, cursor)) continue;
+        if (m_reader.timeAt(table, cursor) > fromUs) emitRow(table, cursor);
+    }
+}
+
+void TelemetryClient::emitLatest(qint64 timeUs)
+{
+    for (int table = 0; table < TelemetryTableCount; ++table) {
+        TelemetryReader::Cursor cursor = m_reader.seek(table, timeUs + 1);
+        if (m_reader.previous(table, cursor)) emitRow(table, cursor);
+    }
+}
+
+void TelemetryClient::emitRow(int table, const TelemetryReader::Cursor &cursor)
+{
+    QJsonObject root;
+    root["ty"] = TelemetrySchema::messageType(table);
+    root["db"] = m_reader.rowAt(table, cursor);
+    m_robot->injectMessage(root);
+}
+
+QStringList TelemetryClient::exportCsv(const QString &dir)
+{
+    QStringList files;
+    if (!m_reader.isOpen()) {
+        emit errorOccurred("没有打开的录制文件");
+        return files;
+    }
+
+    const QFileInfo source(m_playbackPath);
+    QString outDir = toLocalPath(dir);
+    if (outDir.isEmpty()) outDir = source.absolutePath();
+    QDir().mkpath(outDir);
+
+    for (int table = 0; table < TelemetryTableCount; ++table) {
+        const QString outPath = outDir + "/" + source.completeBaseName() + "_" + TelemetrySchema::tableName(table) + ".csv";
+        QString error;
+        if (!m_reader.exportCsv(table, outPath, &error)) {
+            emit errorOccurred(error);
+            continue;
+        }
+        files << outPath;
+    }
+    return files;
+}
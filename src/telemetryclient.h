@@ -0,0 +1,105 @@
+#ifndef TELEMETRYCLIENT_H
+#define TELEMETRYCLIENT_H
+
+#include <QObject>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QStringList>
+#include <QVariantMap>
+#include <memory>
+
+#include "telemetrystore.h"
+
+class RobotClient;
+
+// 遥测录制与回放：
+// 录制时把位姿 / 机器人状态 / 工程状态三类订阅报文写成列式文件 (Telemetry/*.tcol)
+// 回放时按原始时间间隔 (可倍速) 把记录的报文重新注入 RobotClient，状态监控页面无需改动即可显示
+class TelemetryClient : public QObject
+{
+    Q_OBJECT
+
+    Q_PROPERTY(bool recording READ recording NOTIFY recordingChanged)
+    Q_PROPERTY(QString recordPath READ recordPath NOTIFY recordingChanged)
+    Q_PROPERTY(bool playbackOpen READ playbackOpen NOTIFY playbackChanged)
+    Q_PROPERTY(QString playbackPath READ playbackPath NOTIFY playbackChanged)
+    Q_PROPERTY(bool playing READ playing NOTIFY playingChanged)
+    // 回放倍速 (0.1 ~ 64)
+    Q_PROPERTY(double speed READ speed WRITE setSpeed NOTIFY speedChanged)
+    // 回放时间范围与当前位置 (墙钟毫秒)
+    Q_PROPERTY(double startMs READ startMs NOTIFY playbackChanged)
+    Q_PROPERTY(double endMs READ endMs NOTIFY playbackChanged)
+    Q_PROPERTY(double positionMs READ positionMs NOTIFY positionChanged)
+
+public:
+    explicit TelemetryClient(RobotClient *robot, QObject *parent = nullptr);
+    ~TelemetryClient();
+
+    bool recording() const { return m_writer.isOpen(); }
+    QString recordPath() const { return m_writer.path(); }
+    bool playbackOpen() const { return m_reader.isOpen(); }
+    QString playbackPath() const { return m_playbackPath; }
+    bool playing() const { return m_playTimer->isActive(); }
+    double speed() const { return m_speed; }
+    void setSpeed(double speed);
+    double startMs() const { return m_reader.startUs() / 1000.0; }
+    double endMs() const { return m_reader.endUs() / 1000.0; }
+    double positionMs() const { return m_positionUs / 1000.0; }
+
+    // 开始录制，path 为空时写到 Telemetry/telemetry_yyyyMMdd_HHmmss.tcol，返回实际路径
+    Q_INVOKABLE QString startRecording(const QString &path = QString());
+    Q_INVOKABLE void stopRecording();
+    // { rows, bytes, path }
+    Q_INVOKABLE QVariantMap recordingStats() const;
+
+    // 打开录制文件 (接受 QML 的 file:/// URL)
+    Q_INVOKABLE bool openPlayback(const QString &path);
+    Q_INVOKABLE void closePlayback();
+    Q_INVOKABLE void play();
+    Q_INVOKABLE void pause();
+    // 跳到指定时间，立即发出每张表在该时间之前的最后一行
+    Q_INVOKABLE void seek(double positionMs);
+
+    // 每张表导出一个 CSV (<dir>/<文件名>_<表名>.csv)，dir 为空时与录制文件同目录；返回生成的文件列表
+    Q_INVOKABLE QStringList exportCsv(const QString &dir = QString());
+
+signals:
+    void recordingChanged();
+    void playbackChanged();
+    void playingChanged();
+    void speedChanged();
+    void positionChanged();
+    void errorOccurred(const QString &errorMsg);
+
+private slots:
+    void onPlayTick();
+
+private:
+    void record(int table, const QJsonObject &db);
+    // 发出 (fromUs, toUs] 区间内每张表的最后一行；区间内没有行的表不发
+    void emitRange(qint64 fromUs, qint64 toUs);
+    // 发出每张表时间 <= timeUs 的最后一行
+    void emitLatest(qint64 timeUs);
+    void emitRow(int table, const TelemetryReader::Cursor &cursor);
+    static QString toLocalPath(const QString &path);
+
+    RobotClient *m_robot;
+
+    // 录制：墙钟起点 + 单调时钟偏移，避免系统时间跳变导致时间戳倒退
+    TelemetryWriter m_writer;
+    qint64 m_recordBaseUs = 0;
+    QElapsedTimer m_recordClock;
+    QList<QMetaObject::Connection> m_recordConnections;
+    QTimer *m_flushTimer;
+
+    // 回放
+    TelemetryReader m_reader;
+    QString m_playbackPath;
+    QTimer *m_playTimer;
+    QElapsedTimer m_playClock;
+    qint64 m_playBaseUs = 0; // play() 时的回放位置
+    qint64 m_positionUs = 0;
+    double m_speed = 1.0;
+};
+
+#endif // TELEMETRYCLIENT_H
@@ -0,0 +1,562 @@
+#include "telemetrystore.h"
+
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QSaveFile>
+#include <QtEndian>
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstring>
+
+// ==========================================================
+// TelemetrySchema
+// ==========================================================
+
+namespace TelemetrySchema {
+
+const std::vector<TelemetryColumn> &columns(int table)
+{
+    static const std::vector<TelemetryColumn> posture = {
+        { "joint1", TelemetryColumn::Float64 }, { "joint2", TelemetryColumn::Float64 },
+        { "joint3", TelemetryColumn::Float64 }, { "joint4", TelemetryColumn::Float64 },
+        { "joint5", TelemetryColumn::Float64 }, { "joint6", TelemetryColumn::Float64 },
+        { "x", TelemetryColumn::Float64 }, { "y", TelemetryColumn::Float64 }, { "z", TelemetryColumn::Float64 },
+        { "a", TelemetryColumn::Float64 }, { "b", TelemetryColumn::Float64 }, { "c", TelemetryColumn::Float64 }
+    };
+    static const std::vector<TelemetryColumn> status = {
+        { "state", TelemetryColumn::Int32 }, { "mode", TelemetryColumn::Int32 },
+        { "moveRate", TelemetryColumn::Float64 }, { "manualMoveRate", TelemetryColumn::Float64 },
+        { "runDuration", TelemetryColumn::Float64 },
+        { "ToolId", TelemetryColumn::Int32 }, { "CoordinateId", TelemetryColumn::Int32 },
+        { "PayloadId", TelemetryColumn::Int32 }, { "defaultToolId", TelemetryColumn::Int32 },
+        { "defaultCoordinateId", TelemetryColumn::Int32 }, { "defaultPayloadId", TelemetryColumn::Int32 },
+        { "modeSwitch", TelemetryColumn::Int32 }, { "recoveryState", TelemetryColumn::Int32 },
+        { "rescueFlag", TelemetryColumn::Int32 }, { "teachingPendant", TelemetryColumn::Int32 },
+        { "type", TelemetryColumn::Int32 }
+    };
+    static const std::vector<TelemetryColumn> project = {
+        { "state", TelemetryColumn::Int32 }, { "projectType", TelemetryColumn::Int32 }
+    };
+
+    switch (table) {
+    case TelemetryPosture: return posture;
+    case TelemetryStatus: return status;
+    default: return project;
+    }
+}
+
+const char *tableName(int table)
+{
+    switch (table) {
+    case TelemetryPosture: return "posture";
+    case TelemetryStatus: return "status";
+    default: return "project";
+    }
+}
+
+const char *messageType(int table)
+{
+    switch (table) {
+    case TelemetryPosture: return "publish/RobotPosture";
+    case TelemetryStatus: return "publish/RobotStatus";
+    default: return "publish/ProjectState";
+    }
+}
+
+} // namespace TelemetrySchema
+
+namespace {
+
+// 位姿的 joint 数组 / end 对象拆成 12 列
+const char *const kEndKeys[6] = { "x", "y", "z", "a", "b", "c" };
+
+bool fitsColumn(const QJsonValue &value, TelemetryColumn::Type type)
+{
+    if (!value.isDouble()) return false;
+    if (type == TelemetryColumn::Float64) return true;
+    const double v = value.toDouble();
+    return std::floor(v) == v && v >= INT32_MIN && v <= INT32_MAX;
+}
+
+// 把 db 拆成类型列 + 附加字段，返回有效位
+quint32 splitRow(int table, const QJsonObject &db, double *values, QJsonObject &extra)
+{
+    const std::vector<TelemetryColumn> &cols = TelemetrySchema::columns(table);
+    quint32 mask = 0;
+    extra = db;
+
+    if (table == TelemetryPosture) {
+        const QJsonArray joint = db.value("joint").toArray();
+        bool jointOk = joint.size() == 6;
+        for (int i = 0; jointOk && i < 6; ++i) jointOk = joint.at(i).isDouble();
+        if (jointOk) {
+            for (int i = 0; i < 6; ++i) {
+                values[i] = joint.at(i).toDouble();
+                mask |= 1u << i;
+            }
+            extra.remove("joint");
+        }
+
+        if (db.value("end").isObject()) {
+            QJsonObject end = db.value("end").toObject();
+            for (int i = 0; i < 6; ++i) {
+                const QJsonValue v = end.value(kEndKeys[i]);
+                if (!v.isDouble()) continue;
+                values[6 + i] = v.toDouble();
+                mask |= 1u << (6 + i);
+                end.remove(kEndKeys[i]);
+            }
+            if (end.isEmpty()) extra.remove("end");
+            else extra["end"] = end; // 其余键原样保留
+        }
+        return mask;
+    }
+
+    for (size_t i = 0; i < cols.size(); ++i) {
+        const QJsonValue v = db.value(cols[i].name);
+        if (!fitsColumn(v, cols[i].type)) continue; // 缺失或类型不符的值留在附加字段中
+        values[i] = v.toDouble();
+        mask |= 1u << i;
+        extra.remove(cols[i].name);
+    }
+    return mask;
+}
+
+qint64 totalColumnBytes(int table)
+{
+    qint64 bytes = 0;
+    for (const TelemetryColumn &col : TelemetrySchema::columns(table)) bytes += col.type;
+    return bytes;
+}
+
+QByteArray csvEscape(const QByteArray &text)
+{
+    if (text.isEmpty()) return text;
+    QByteArray quoted = text;
+    quoted.replace("\"", "\"\"");
+    return "\"" + quoted + "\"";
+}
+
+} // namespace
+
+// ==========================================================
+// TelemetryWriter
+// ==========================================================
+
+TelemetryWriter::TelemetryWriter() = default;
+
+TelemetryWriter::~TelemetryWriter()
+{
+    close();
+}
+
+bool TelemetryWriter::open(const QString &path)
+{
+    close();
+
+    QDir().mkpath(QFileInfo(path).absolutePath());
+    m_file.setFileName(path);
+    if (!m_file.open(QIODevice::WriteOnly | QIODevice::Truncate)) return false;
+
+    char header[TelemetryFormat::kFileHeaderSize] = {};
+    std::memcpy(header, TelemetryFormat::kFileMagic, 4);
+    qToLittleEndian<quint32>(TelemetryFormat::kVersion, header + 4);
+    qToLittleEndian<qint64>(QDateTime::currentMSecsSinceEpoch(), header + 8);
+    qToLittleEndian<quint32>(TelemetryTableCount, header + 16);
+    m_file.write(header, sizeof(header));
+
+    for (PendingTable &pending : m_pending) pending = PendingTable();
+    m_directory.clear();
+    m_rowCount = 0;
+    return true;
+}
+
+void TelemetryWriter::close()
+{
+    if (!m_file.isOpen()) return;
+    flush();
+
+    // 块目录 + 尾部，读取时不必扫描整个文件
+    const qint64 directoryOffset = m_file.pos();
+    QByteArray directory;
+    directory.reserve(static_cast<qsizetype>(m_directory.size()) * TelemetryFormat::kDirectoryEntrySize
+                      + TelemetryFormat::kTrailerSize);
+    for (const DirectoryEntry &entry : m_directory) {
+        char e[TelemetryFormat::kDirectoryEntrySize] = {};
+        e[0] = static_cast<char>(entry.table);
+        qToLittleEndian<qint64>(entry.offset, e + 8);
+        qToLittleEndian<quint32>(entry.rows, e + 16);
+        qToLittleEndian<qint64>(entry.minUs, e + 24);
+        qToLittleEndian<qint64>(entry.maxUs, e + 32);
+        directory.append(e, sizeof(e));
+    }
+
+    char trailer[TelemetryFormat::kTrailerSize] = {};
+    qToLittleEndian<quint32>(static_cast<quint32>(m_directory.size()), trailer);
+    qToLittleEndian<qint64>(directoryOffset, trailer + 8);
+    std::memcpy(trailer + 16, TelemetryFormat::kIndexMagic, 4);
+    directory.append(trailer, sizeof(trailer));
+
+    m_file.write(directory);
+    m_file.close();
+}
+
+void TelemetryWriter::append(int table, qint64 timeUs, const QJsonObject &db)
+{
+    if (!m_file.isOpen() || table < 0 || table >= TelemetryTableCount) return;
+
+    PendingTable &pending = m_pending[table];
+    const size_t columnCount = TelemetrySchema::columns(table).size();
+    if (pending.values.size() != columnCount) {
+        pending.values.assign(columnCount, std::vector<double>());
+        pending.extraOffsets.assign(1, 0);
+    }
+
+    double values[32] = {};
+    QJsonObject extra;
+    const quint32 mask = splitRow(table, db, values, extra);
+
+    pending.time.push_back(timeUs);
+    pending.mask.push_back(mask);
+    for (size_t i = 0; i < columnCount; ++i) pending.values[i].push_back(values[i]);
+    if (!extra.isEmpty()) pending.extra.append(QJsonDocument(extra).toJson(QJsonDocument::Compact));
+    pending.extraOffsets.push_back(static_cast<quint32>(pending.extra.size()));
+
+    ++m_rowCount;
+    if (pending.time.size() >= static_cast<size_t>(kRowsPerChunk)) flushTable(table);
+}
+
+void TelemetryWriter::flush()
+{
+    for (int table = 0; table < TelemetryTableCount; ++table) flushTable(table);
+    m_file.flush();
+}
+
+void TelemetryWriter::flushTable(int table)
+{
+    PendingTable &pending = m_pending[table];
+    const quint32 rows = static_cast<quint32>(pending.time.size());
+    if (!m_file.isOpen() || rows == 0) return;
+
+    const std::vector<TelemetryColumn> &cols = TelemetrySchema::columns(table);
+    const qint64 payloadBytes = qint64(rows) * (12 + totalColumnBytes(table)) + 4 * qint64(rows + 1)
+                                + pending.extra.size();
+
+    QByteArray chunk;
+    chunk.resize(TelemetryFormat::kChunkHeaderSize + payloadBytes);
+    char *p = chunk.data();
+
+    const auto [minIt, maxIt] = std::minmax_element(pending.time.begin(), pending.time.end());
+    std::memcpy(p, TelemetryFormat::kChunkMagic, 4);
+    p[4] = static_cast<char>(table);
+    p[5] = static_cast<char>(cols.size());
+    p[6] = p[7] = 0;
+    qToLittleEndian<quint32>(rows, p + 8);
+    qToLittleEndian<quint32>(static_cast<quint32>(payloadBytes), p + 12);
+    qToLittleEndian<qint64>(*minIt, p + 16);
+    qToLittleEndian<qint64>(*maxIt, p + 24);
+    p += TelemetryFormat::kChunkHeaderSize;
+
+    // 按列连续写入：同一列的值相邻，扫描单列时只触碰这一列的页
+    for (qint64 t : pending.time) { qToLittleEndian<qint64>(t, p); p += 8; }
+    for (quint32 m : pending.mask) { qToLittleEndian<quint32>(m, p); p += 4; }
+    for (size_t c = 0; c < cols.size(); ++c) {
+        if (cols[c].type == TelemetryColumn::Int32) {
+            for (double v : pending.values[c]) { qToLittleEndian<qint32>(static_cast<qint32>(v), p); p += 4; }
+        } else {
+            for (double v : pending.values[c]) { qToLittleEndian<double>(v, p); p += 8; }
+        }
+    }
+    for (quint32 o : pending.extraOffsets) { qToLittleEndian<quint32>(o, p); p += 4; }
+    std::memcpy(p, pending.extra.constData(), pending.extra.size());
+
+    m_directory.push_back({ table, m_file.pos(), rows, *minIt, *maxIt });
+    m_file.write(chunk);
+
+    pending.time.clear();
+    pending.mask.clear();
+    for (std::vector<double> &column : pending.values) column.clear();
+    pending.extraOffsets.assign(1, 0);
+    pending.extra.clear();
+}
+
+// ==========================================================
+// TelemetryReader
+// ==========================================================
+
+TelemetryReader::~TelemetryReader()
+{
+    close();
+}
+
+void TelemetryReader::close()
+{
+    if (m_map) m_file.unmap(const_cast<uchar *>(m_map));
+    m_map = nullptr;
+    m_size = 0;
+    m_file.close();
+    for (std::vector<Chunk> &chunks : m_chunks) chunks.clear();
+}
+
+bool TelemetryReader::open(const QString &path, QString *error)
+{
+    close();
+
+    m_file.setFileName(path);
+    if (!m_file.open(QIODevice::ReadOnly)) {
+        if (error) *error = m_file.errorString();
+        return false;
+    }
+    m_size = m_file.size();
+    m_map = m_size >= TelemetryFormat::kFileHeaderSize ? m_file.map(0, m_size) : nullptr;
+    if (!m_map || std::memcmp(m_map, TelemetryFormat::kFileMagic, 4) != 0) {
+        if (error) *error = QString("不是遥测录制文件: %1").arg(path);
+        close();
+        return false;
+    }
+
+    // 优先使用尾部目录；录制被异常中断时顺序扫描块头
+    bool indexed = false;
+    if (m_size >= TelemetryFormat::kFileHeaderSize + TelemetryFormat::kTrailerSize) {
+        const uchar *trailer = m_map + m_size - TelemetryFormat::kTrailerSize;
+        if (std::memcmp(trailer + 16, TelemetryFormat::kIndexMagic, 4) == 0) {
+            const quint32 count = qFromLittleEndian<quint32>(trailer);
+            const qint64 dirOffset = qFromLittleEndian<qint64>(trailer + 8);
+            if (dirOffset + qint64(count) * TelemetryFormat::kDirectoryEntrySize + TelemetryFormat::kTrailerSize == m_size) {
+                indexed = true;
+                for (quint32 i = 0; i < count && indexed; ++i) {
+                    const uchar *e = m_map + dirOffset + qint64(i) * TelemetryFormat::kDirectoryEntrySize;
+                    indexed = addChunk(qFromLittleEndian<qint64>(e + 8), error);
+                }
+            }
+        }
+    }
+    if (!indexed) {
+        for (std::vector<Chunk> &chunks : m_chunks) chunks.clear();
+        qint64 offset = TelemetryFormat::kFileHeaderSize;
+        while (offset + TelemetryFormat::kChunkHeaderSize <= m_size
+               && std::memcmp(m_map + offset, TelemetryFormat::kChunkMagic, 4) == 0) {
+            if (!addChunk(offset, nullptr)) break; // 最后一个块没写完
+            offset += TelemetryFormat::kChunkHeaderSize + qFromLittleEndian<quint32>(m_map + offset + 12);
+        }
+    }
+
+    m_startUs = 0;
+    m_endUs = 0;
+    bool first = true;
+    for (const std::vector<Chunk> &chunks : m_chunks) {
+        for (const Chunk &chunk : chunks) {
+            m_startUs = first ? chunk.minUs : qMin(m_startUs, chunk.minUs);
+            m_endUs = first ? chunk.maxUs : qMax(m_endUs, chunk.maxUs);
+            first = false;
+        }
+    }
+    return true;
+}
+
+bool TelemetryReader::addChunk(qint64 offset, QString *error)
+{
+    if (offset < TelemetryFormat::kFileHeaderSize || offset + TelemetryFormat::kChunkHeaderSize > m_size
+        || std::memcmp(m_map + offset, TelemetryFormat::kChunkMagic, 4) != 0) {
+        if (error) *error = QString("数据块损坏 @%1").arg(offset);
+        return false;
+    }
+
+    const uchar *header = m_map + offset;
+    const int table = header[4];
+    const quint32 rows = qFromLittleEndian<quint32>(header + 8);
+    const quint32 payloadBytes = qFromLittleEndian<quint32>(header + 12);
+    if (table >= TelemetryTableCount || header[5] != TelemetrySchema::columns(table).size()
+        || offset + TelemetryFormat::kChunkHeaderSize + payloadBytes > m_size
+        || qint64(rows) * (12 + totalColumnBytes(table)) + 4 * qint64(rows + 1) > payloadBytes) {
+        if (error) *error = QString("数据块损坏 @%1").arg(offset);
+        return false;
+    }
+
+    Chunk chunk;
+    chunk.base = header + TelemetryFormat::kChunkHeaderSize;
+    chunk.rows = rows;
+    chunk.minUs = qFromLittleEndian<qint64>(header + 16);
+    chunk.maxUs = qFromLittleEndian<qint64>(header + 24);
+    m_chunks[table].push_back(chunk);
+    return true;
+}
+
+qint64 TelemetryReader::rowCount(int table) const
+{
+    qint64 rows = 0;
+    for (const Chunk &chunk : m_chunks[table]) rows += chunk.rows;
+    return rows;
+}
+
+const uchar *TelemetryReader::columnData(const Chunk &chunk, int table, int column) const
+{
+    const std::vector<TelemetryColumn> &cols = TelemetrySchema::columns(table);
+    qint64 offset = qint64(chunk.rows) * 12;
+    for (int i = 0; i < column; ++i) offset += qint64(chunk.rows) * cols[i].type;
+    return chunk.base + offset;
+}
+
+double TelemetryReader::valueAt(const Chunk &chunk, int table, int column, quint32 row) const
+{
+    const uchar *data = columnData(chunk, table, column);
+    if (TelemetrySchema::columns(table)[column].type == TelemetryColumn::Int32) {
+        return qFromLittleEndian<qint32>(data + 4 * qint64(row));
+    }
+    return qFromLittleEndian<double>(data + 8 * qint64(row));
+}
+
+quint32 TelemetryReader::maskAt(const Chunk &chunk, quint32 row) const
+{
+    return qFromLittleEndian<quint32>(chunk.base + qint64(chunk.rows) * 8 + 4 * qint64(row));
+}
+
+QByteArray TelemetryReader::extraAt(const Chunk &chunk, int table, quint32 row) const
+{
+    const uchar *offsets = chunk.base + qint64(chunk.rows) * (12 + totalColumnBytes(table));
+    const uchar *bytes = offsets + 4 * qint64(chunk.rows + 1);
+    const quint32 begin = qFromLittleEndian<quint32>(offsets + 4 * qint64(row));
+    const quint32 end = qFromLittleEndian<quint32>(offsets + 4 * qint64(row + 1));
+    return QByteArray::fromRawData(reinterpret_cast<const char *>(bytes + begin), end - begin);
+}
+
+TelemetryReader::Cursor TelemetryReader::seek(int table, qint64 timeUs) const
+{
+    const std::vector<Chunk> &chunks = m_chunks[table];
+
+    // 第一个 maxUs >= timeUs 的块
+    auto it = std::lower_bound(chunks.begin(), chunks.end(), timeUs,
+                               [](const Chunk &c, qint64 value) { return c.maxUs < value; });
+    Cursor cursor;
+    cursor.chunk = static_cast<int>(it - chunks.begin());
+    if (it == chunks.end()) return cursor;
+
+    // 块内时间列二分
+    quint32 low = 0;
+    quint32 high = it->rows;
+    while (low < high) {
+        const quint32 mid = (low + high) / 2;
+        if (qFromLittleEndian<qint64>(it->base + 8 * qint64(mid)) < timeUs) low = mid + 1;
+        else high = mid;
+    }
+    cursor.row = low;
+    if (cursor.row >= it->rows) {
+        ++cursor.chunk;
+        cursor.row = 0;
+    }
+    return cursor;
+}
+
+bool TelemetryReader::isValid(int table, const Cursor &cursor) const
+{
+    return cursor.chunk >= 0 && cursor.chunk < static_cast<int>(m_chunks[table].size())
+           && cursor.row < m_chunks[table][cursor.chunk].rows;
+}
+
+void TelemetryReader::next(int table, Cursor &cursor) const
+{
+    if (++cursor.row >= m_chunks[table][cursor.chunk].rows) {
+        ++cursor.chunk;
+        cursor.row = 0;
+    }
+}
+
+bool TelemetryReader::previous(int table, Cursor &cursor) const
+{
+    if (cursor.row > 0) {
+        --cursor.row;
+        return true;
+    }
+    if (cursor.chunk <= 0) return false;
+    --cursor.chunk;
+    cursor.row = m_chunks[table][cursor.chunk].rows - 1;
+    return true;
+}
+
+qint64 TelemetryReader::timeAt(int table, const Cursor &cursor) const
+{
+    return qFromLittleEndian<qint64>(m_chunks[table][cursor.chunk].base + 8 * qint64(cursor.row));
+}
+
+QJsonObject TelemetryReader::rowAt(int table, const Cursor &cursor) const
+{
+    const Chunk &chunk = m_chunks[table][cursor.chunk];
+    const std::vector<TelemetryColumn> &cols = TelemetrySchema::columns(table);
+    const quint32 mask = maskAt(chunk, cursor.row);
+
+    const QByteArray extra = extraAt(chunk, table, cursor.row);
+    QJsonObject db = extra.isEmpty() ? QJsonObject() : QJsonDocument::fromJson(extra).object();
+
+    if (table == TelemetryPosture) {
+        if ((mask & 0x3F) == 0x3F) {
+            QJsonArray joint;
+            for (int i = 0; i < 6; ++i) joint.append(valueAt(chunk, table, i, cursor.row));
+            db["joint"] = joint;
+        }
+        if (mask & 0xFC0) {
+            QJsonObject end = db.value("end").toObject();
+            for (int i = 0; i < 6; ++i) {
+                if (mask & (1u << (6 + i))) end[kEndKeys[i]] = valueAt(chunk, table, 6 + i, cursor.row);
+            }
+            db["end"] = end;
+        }
+        return db;
+    }
+
+    for (size_t i = 0; i < cols.size(); ++i) {
+        if (!(mask & (1u << i))) continue;
+        const double v = valueAt(chunk, table, static_cast<int>(i), cursor.row);
+        if (cols[i].type == TelemetryColumn::Int32) db[cols[i].name] = static_cast<int>(v);
+        else db[cols[i].name] = v;
+    }
+    return db;
+}
+
+bool TelemetryReader::exportCsv(int table, const QString &outPath, QString *error) const
+{
+    QSaveFile out(outPath);
+    if (!out.open(QIODevice::WriteOnly)) {
+        if (error) *error = out.errorString();
+        return false;
+    }
+
+    const std::vector<TelemetryColumn> &cols = TelemetrySchema::columns(table);
+    QByteArray buffer = "time_us,time";
+    for (const TelemetryColumn &col : cols) buffer += QByteArray(",") + col.name;
+    buffer += ",extra\n";
+
+    for (const Chunk &chunk : m_chunks[table]) {
+        for (quint32 row = 0; row < chunk.rows; ++row) {
+            const qint64 t = qFromLittleEndian<qint64>(chunk.base + 8 * qint64(row));
+            const quint32 mask = maskAt(chunk, row);
+            buffer += QByteArray::number(t) + ","
+                      + QDateTime::fromMSecsSinceEpoch(t / 1000).toString("yyyy-MM-dd HH:mm:ss.zzz").toLatin1();
+            for (size_t c = 0; c < cols.size(); ++c) {
+                buffer += ',';
+                if (!(mask & (1u << c))) continue;
+                const double v = valueAt(chunk, table, static_cast<int>(c), row);
+                buffer += cols[c].type == TelemetryColumn::Int32 ? QByteArray::number(static_cast<int>(v))
+                                                                 : QByteArray::number(v, 'g', 12);
+            }
+            buffer += ',';
+            buffer += csvEscape(extraAt(chunk, table, row));
+            buffer += '\n';
+
+            if (buffer.size() >= 1024 * 1024) {
+                out.write(buffer);
+                buffer.resize(0);
+            }
+        }
+    }
+
+    out.write(buffer);
+    if (!out.commit()) {
+        if (error) *error = out.errorString();
+        return false;
+    }
+    return true;
+}
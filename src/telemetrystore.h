@@ -0,0 +1,160 @@
+#ifndef TELEMETRYSTORE_H
+#define TELEMETRYSTORE_H
+
+#include <QByteArray>
+#include <QFile>
+#include <QJsonObject>
+#include <QString>
+#include <vector>
+
+// 遥测列式文件格式 (小端)
+// 文件头 (32B): "TCOL" + u32 版本 + i64 开始墙钟(ms) + u32 表数量 + 12 字节保留
+// 数据块 (每块一张表的若干行，按列连续存放):
+//   块头 (32B): "TCHK" + u8 表 + u8 列数 + u16 保留 + u32 行数 + u32 数据长度 + i64 最小时间(us) + i64 最大时间(us)
+//   数据: i64 时间[n] + u32 有效位[n] + 各类型列[n] + u32 附加字段偏移[n+1] + 附加字段 (紧凑 JSON)
+// 目录 (关闭时写入): 每块 40B (u8 表 + 7 保留 + i64 偏移 + u32 行数 + 4 保留 + i64 最小时间 + i64 最大时间)
+// 尾部 (24B): u32 块数 + 4 保留 + i64 目录偏移 + "TIDX" + 4 保留
+// 异常退出没有目录时，读取端顺序扫描块头重建
+namespace TelemetryFormat {
+constexpr char kFileMagic[4] = {'T', 'C', 'O', 'L'};
+constexpr char kChunkMagic[4] = {'T', 'C', 'H', 'K'};
+constexpr char kIndexMagic[4] = {'T', 'I', 'D', 'X'};
+constexpr quint32 kVersion = 1;
+constexpr int kFileHeaderSize = 32;
+constexpr int kChunkHeaderSize = 32;
+constexpr int kDirectoryEntrySize = 40;
+constexpr int kTrailerSize = 24;
+}
+
+// 三张表：位姿 / 机器人状态 / 工程状态
+enum TelemetryTable : int {
+    TelemetryPosture = 0,
+    TelemetryStatus = 1,
+    TelemetryProject = 2,
+    TelemetryTableCount = 3
+};
+
+struct TelemetryColumn
+{
+    enum Type : quint8 { Int32 = 4, Float64 = 8 }; // 枚举值即元素字节数
+    const char *name;
+    Type type;
+};
+
+// 各表的固定列定义：数值字段进类型列，其余字段 (字符串、对象、类型不符的值) 进附加 JSON
+namespace TelemetrySchema {
+const std::vector<TelemetryColumn> &columns(int table);
+const char *tableName(int table);      // "posture" / "status" / "project"
+const char *messageType(int table);    // "publish/RobotPosture" ...
+}
+
+// 写入：每张表在内存中攒满 kRowsPerChunk 行 (或调用 flush) 后写一个块
+// 只在 GUI 线程使用
+class TelemetryWriter
+{
+public:
+    static constexpr int kRowsPerChunk = 4096;
+
+    TelemetryWriter();
+    ~TelemetryWriter();
+
+    bool open(const QString &path);
+    void close();
+    bool isOpen() const { return m_file.isOpen(); }
+    QString path() const { return m_file.fileName(); }
+
+    // 追加一行 (db 为报文中的 db 对象)
+    void append(int table, qint64 timeUs, const QJsonObject &db);
+
+    // 把所有表未满的行写成块
+    void flush();
+
+    qint64 rowCount() const { return m_rowCount; }
+    qint64 bytesWritten() const { return m_file.isOpen() ? m_file.pos() : 0; }
+
+private:
+    struct PendingTable
+    {
+        std::vector<qint64> time;
+        std::vector<quint32> mask;
+        std::vector<std::vector<double>> values; // 按列
+        std::vector<quint32> extraOffsets;
+        QByteArray extra;
+    };
+
+    struct DirectoryEntry
+    {
+        int table;
+        qint64 offset;
+        quint32 rows;
+        qint64 minUs;
+        qint64 maxUs;
+    };
+
+    void flushTable(int table);
+
+    QFile m_file;
+    PendingTable m_pending[TelemetryTableCount];
+    std::vector<DirectoryEntry> m_directory;
+    qint64 m_rowCount = 0;
+};
+
+// 读取：内存映射整个文件，按块目录二分定位时间，块内再二分
+class TelemetryReader
+{
+public:
+    // 行游标：块序号 + 块内行号
+    struct Cursor
+    {
+        int chunk = 0;
+        quint32 row = 0;
+    };
+
+    TelemetryReader() = default;
+    ~TelemetryReader();
+
+    bool open(const QString &path, QString *error = nullptr);
+    void close();
+    bool isOpen() const { return m_map != nullptr; }
+
+    qint64 startUs() const { return m_startUs; }
+    qint64 endUs() const { return m_endUs; }
+    qint64 rowCount(int table) const;
+
+    // 第一行时间 >= timeUs 的位置 (O(log 块数 + log 块内行数))
+    Cursor seek(int table, qint64 timeUs) const;
+    bool isValid(int table, const Cursor &cursor) const;
+    void next(int table, Cursor &cursor) const;
+    bool previous(int table, Cursor &cursor) const;
+
+    qint64 timeAt(int table, const Cursor &cursor) const;
+    // 还原为与实时报文相同结构的 db 对象
+    QJsonObject rowAt(int table, const Cursor &cursor) const;
+
+    // 导出一张表为 CSV (时间、各列、附加字段)
+    bool exportCsv(int table, const QString &outPath, QString *error = nullptr) const;
+
+private:
+    struct Chunk
+    {
+        const uchar *base = nullptr; // 数据区起点 (块头之后)
+        quint32 rows = 0;
+        qint64 minUs = 0;
+        qint64 maxUs = 0;
+    };
+
+    const uchar *columnData(const Chunk &chunk, int table, int column) const;
+    double valueAt(const Chunk &chunk, int table, int column, quint32 row) const;
+    quint32 maskAt(const Chunk &chunk, quint32 row) const;
+    QByteArray extraAt(const Chunk &chunk, int table, quint32 row) const;
+    bool addChunk(qint64 offset, QString *error);
+
+    QFile m_file;
+    const uchar *m_map = nullptr;
+    qint64 m_size = 0;
+    qint64 m_startUs = 0;
+    qint64 m_endUs = 0;
+    std::vector<Chunk> m_chunks[TelemetryTableCount];
+};
+
+#endif // TELEMETRYSTORE_H
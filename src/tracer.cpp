@@ -0,0 +1,203 @@
+#include "tracer.h"
+
+#include <QCoreApplication>
+#include <QSaveFile>
+#include <QThread>
+#include <algorithm>
+#include <chrono>
+
+std::atomic<bool> Tracer::s_enabled{false};
+
+namespace {
+
+// 当前线程的缓冲区指针 (首次记录时向 Tracer 登记)
+thread_local TraceThreadBuffer *t_buffer = nullptr;
+
+// 进程内唯一的线程序号，导出时作为 tid
+std::atomic<quint64> g_nextThreadId{1};
+
+// JSON 字符串转义 (只处理必须转义的字符)
+void appendEscaped(QByteArray &out, const QByteArray &text)
+{
+    for (char c : text) {
+        switch (c) {
+        case '"': out += "\\\""; break;
+        case '\\': out += "\\\\"; break;
+        case '\n': out += "\\n"; break;
+        case '\r': out += "\\r"; break;
+        case '\t': out += "\\t"; break;
+        default:
+            if (static_cast<unsigned char>(c) < 0x20) {
+                out += "\\u00";
+                out += "0123456789abcdef"[(c >> 4) & 0xF];
+                out += "0123456789abcdef"[c & 0xF];
+            } else {
+                out += c;
+            }
+        }
+    }
+}
+
+// 纳秒 -> 微秒字符串 (保留 3 位小数，chrome://tracing 支持小数时间戳)
+QByteArray usText(qint64 ns)
+{
+    return QByteArray::number(ns / 1000.0, 'f', 3);
+}
+
+} // namespace
+
+Tracer &Tracer::instance()
+{
+    static Tracer tracer;
+    return tracer;
+}
+
+qint64 Tracer::nowNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void Tracer::setEnabled(bool enabled)
+{
+    s_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+TraceThreadBuffer *Tracer::threadBuffer()
+{
+    if (t_buffer) return t_buffer;
+
+    auto buffer = std::make_unique<TraceThreadBuffer>();
+    buffer->events.resize(kEventsPerThread);
+    buffer->threadId = g_nextThreadId.fetch_add(1, std::memory_order_relaxed);
+
+    QThread *thread = QThread::currentThread();
+    QString name = thread ? thread->objectName() : QString();
+    if (name.isEmpty()) {
+        name = (QCoreApplication::instance() && thread == QCoreApplication::instance()->thread())
+                   ? QStringLiteral("GUI") : QStringLiteral("Thread %1").arg(buffer->threadId);
+    }
+    buffer->threadName = name.toUtf8();
+
+    QMutexLocker locker(&m_mutex);
+    t_buffer = buffer.get();
+    m_buffers.push_back(std::move(buffer));
+    return t_buffer;
+}
+
+void Tracer::record(const char *name, const char *category, qint64 startNs, qint64 durationNs, QByteArray &&arg)
+{
+    TraceThreadBuffer *buffer = threadBuffer();
+
+    QMutexLocker locker(&buffer->mutex);
+    TraceEvent &event = buffer->events[buffer->next];
+    event.name = name;
+    event.category = category;
+    event.startNs = startNs;
+    event.durationNs = durationNs;
+    event.arg = std::move(arg);
+
+    buffer->next = (buffer->next + 1) % buffer->events.size();
+    ++buffer->written;
+}
+
+void Tracer::clear()
+{
+    QMutexLocker locker(&m_mutex);
+    for (const auto &buffer : m_buffers) {
+        QMutexLocker bufferLocker(&buffer->mutex);
+        buffer->next = 0;
+        buffer->written = 0;
+    }
+}
+
+QByteArray Tracer::toChromeJson() const
+{
+    QMutexLocker locker(&m_mutex);
+
+    // 时间戳以最早的事件为零点，数字更短也更好读
+    qint64 originNs = -1;
+    for (const auto &buffer : m_buffers) {
+        QMutexLocker bufferLocker(&buffer->mutex);
+        const size_t count = std::min<quint64>(buffer->written, buffer->events.size());
+        const size_t first = (buffer->written > buffer->events.size()) ? buffer->next : 0;
+        if (count > 0) {
+            const qint64 start = buffer->events[first].startNs;
+            if (originNs < 0 || start < originNs) originNs = start;
+        }
+    }
+    if (originNs < 0) originNs = 0;
+
+    QByteArray out;
+    out.reserve(1024 * 1024);
+    out += "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    bool firstEvent = true;
+    const QByteArray pid = QByteArray::number(QCoreApplication::applicationPid());
+
+    for (const auto &buffer : m_buffers) {
+        QMutexLocker bufferLocker(&buffer->mutex);
+        const QByteArray tid = QByteArray::number(buffer->threadId);
+
+        // 线程名元数据
+        if (!firstEvent) out += ",\n";
+        firstEvent = false;
+        out += "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":" + pid + ",\"tid\":" + tid + ",\"args\":{\"name\":\"";
+        appendEscaped(out, buffer->threadName);
+        out += "\"}}";
+
+        const size_t size = buffer->events.size();
+        const size_t count = std::min<quint64>(buffer->written, size);
+        const size_t first = (buffer->written > size) ? buffer->next : 0;
+
+        for (size_t i = 0; i < count; ++i) {
+            const TraceEvent &event = buffer->events[(first + i) % size];
+            out += ",\n{\"ph\":\"X\",\"name\":\"";
+            out += event.name;
+            out += "\",\"cat\":\"";
+            out += event.category;
+            out += "\",\"pid\":" + pid + ",\"tid\":" + tid;
+            out += ",\"ts\":" + usText(event.startNs - originNs);
+            out += ",\"dur\":" + usText(event.durationNs);
+            if (!event.arg.isEmpty()) {
+                out += ",\"args\":{\"detail\":\"";
+                appendEscaped(out, event.arg);
+                out += "\"}";
+            }
+            out += "}";
+        }
+    }
+
+    out += "\n]}\n";
+    return out;
+}
+
+bool Tracer::exportChromeJson(const QString &path) const
+{
+    const QByteArray json = toChromeJson();
+
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) return false;
+    file.write(json);
+    return file.commit();
+}
+
+QVariantMap Tracer::stats() const
+{
+    QMutexLocker locker(&m_mutex);
+
+    quint64 events = 0;
+    quint64 dropped = 0;
+    for (const auto &buffer : m_buffers) {
+        QMutexLocker bufferLocker(&buffer->mutex);
+        const quint64 size = buffer->events.size();
+        events += std::min<quint64>(buffer->written, size);
+        if (buffer->written > size) dropped += buffer->written - size;
+    }
+
+    QVariantMap map;
+    map["enabled"] = isEnabled();
+    map["events"] = events;
+    map["dropped"] = dropped;
+    map["threads"] = static_cast<int>(m_buffers.size());
+    return map;
+}
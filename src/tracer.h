@@ -0,0 +1,127 @@
+#ifndef TRACER_H
+#define TRACER_H
+
+#include <QByteArray>
+#include <QMutex>
+#include <QString>
+#include <QVariantMap>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+// 一个已完成的区间 (Chrome trace-event 的 "X" 事件)
+// name / category 必须是字符串字面量：记录时只保存指针，不做拷贝
+struct TraceEvent
+{
+    const char *name = nullptr;
+    const char *category = nullptr;
+    qint64 startNs = 0;
+    qint64 durationNs = 0;
+    QByteArray arg; // 可选参数，例如消息类型 ty
+};
+
+// 每个线程独占的环形缓冲区，写满后覆盖最旧的事件
+// 锁只在导出时才会有竞争，平时是无竞争加锁 (一次原子操作)
+struct TraceThreadBuffer
+{
+    QMutex mutex;
+    std::vector<TraceEvent> events;
+    size_t next = 0;        // 下一个写入位置
+    quint64 written = 0;    // 累计写入数 (大于容量说明有覆盖)
+    quint64 threadId = 0;
+    QByteArray threadName;
+};
+
+// 轻量级区间追踪器：记录消息生命周期各阶段耗时，导出为 chrome://tracing / Perfetto 可读的 JSON
+// 关闭时每个埋点只有一次 relaxed 原子读，可以常驻在发布版本中
+class Tracer
+{
+public:
+    static Tracer &instance();
+
+    static bool isEnabled() { return s_enabled.load(std::memory_order_relaxed); }
+    void setEnabled(bool enabled);
+
+    // 单调时钟 (纳秒)
+    static qint64 nowNs();
+
+    // 追加一个已完成的区间到当前线程的缓冲区
+    void record(const char *name, const char *category, qint64 startNs, qint64 durationNs, QByteArray &&arg);
+
+    // 清空所有线程的缓冲区
+    void clear();
+
+    // Chrome trace-event JSON ({"traceEvents":[...]})
+    QByteArray toChromeJson() const;
+    // 写入文件，成功返回 true
+    bool exportChromeJson(const QString &path) const;
+
+    // { enabled, events, dropped, threads }
+    QVariantMap stats() const;
+
+    // 每个线程缓冲区的事件容量
+    static constexpr size_t kEventsPerThread = 65536;
+
+private:
+    Tracer() = default;
+
+    TraceThreadBuffer *threadBuffer();
+
+    static std::atomic<bool> s_enabled;
+
+    mutable QMutex m_mutex; // 保护 m_buffers 列表本身
+    // 缓冲区在线程退出后仍保留，保证导出时能看到已结束线程的事件
+    std::vector<std::unique_ptr<TraceThreadBuffer>> m_buffers;
+};
+
+// RAII 区间：构造时记录开始时间，析构时写入缓冲区
+class TraceScope
+{
+public:
+    TraceScope(const char *name, const char *category)
+        : m_name(name)
+        , m_category(category)
+        , m_startNs(Tracer::isEnabled() ? Tracer::nowNs() : -1)
+    {
+    }
+
+    // 参数由 argFn() 给出，只在追踪开启时调用
+    template <typename ArgFn>
+    TraceScope(const char *name, const char *category, ArgFn &&argFn)
+        : TraceScope(name, category)
+    {
+        if (active()) setArg(argFn());
+    }
+
+    ~TraceScope()
+    {
+        if (m_startNs >= 0) {
+            Tracer::instance().record(m_name, m_category, m_startNs, Tracer::nowNs() - m_startNs, std::move(m_arg));
+        }
+    }
+
+    TraceScope(const TraceScope &) = delete;
+    TraceScope &operator=(const TraceScope &) = delete;
+
+    bool active() const { return m_startNs >= 0; }
+    void setArg(const QString &arg) { m_arg = arg.toUtf8(); }
+
+private:
+    const char *m_name;
+    const char *m_category;
+    qint64 m_startNs;
+    QByteArray m_arg;
+};
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+
+// 用法：TRACE_SCOPE("onReadyRead", "robot");
+#define TRACE_SCOPE(name, category) TraceScope TRACE_CONCAT(_traceScope, __LINE__)(name, category)
+
+// 带参数的区间：参数表达式只在追踪开启时才求值
+// 展开为单个声明，不会留下悬空的 if 让后面的 else 绑定上去
+#define TRACE_SCOPE_ARG(name, category, arg) \
+    TraceScope TRACE_CONCAT(_traceScope, __LINE__)(name, category, [&]() -> QString { return (arg); })
+
+#endif // TRACER_H